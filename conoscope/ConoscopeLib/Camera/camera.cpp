@@ -1,8 +1,14 @@
 #include "camera.h"
 
+#include <QElapsedTimer>
+
 Camera::Camera(QObject *parent) : ClassCommon(parent)
 {
     mModel = CameraModel_Unknown;
+
+    mTelemetryPeriodMs = TELEMETRY_PERIOD_MS;
+
+    mRecordLineStep = 0;
 }
 
 Camera::~Camera()
@@ -137,11 +143,99 @@ ClassCommon::Error Camera::GetStatus(enum Status& )
     return ClassCommon::Error::Ok;
 }
 
-ClassCommon::Error Camera::GetRawData(struct RawDataInfo &, QByteArray& , QByteArray &)
+ClassCommon::Error Camera::GetRawData(struct RawDataInfo &, FrameBuffer& , QByteArray &)
 {
     return ClassCommon::Error::Ok;
 }
 
+ClassCommon::Error Camera::WaitForMeasurement(int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    QMutexLocker locker(&mMeasurementMutex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Status eStatus;
+    GetStatus(eStatus);
+
+    // the state is changed before _NotifyMeasurement takes the mutex, so no wake up is lost
+    while((eStatus == Status::MeasurementPending) && (eError == ClassCommon::Error::Ok))
+    {
+        qint64 remainingMs = timeoutMs - timer.elapsed();
+
+        if((remainingMs <= 0) ||
+           (mMeasurementCondition.wait(&mMeasurementMutex, (unsigned long)remainingMs) == false))
+        {
+            eError = ClassCommon::Error::Timeout;
+        }
+
+        GetStatus(eStatus);
+    }
+
+    if(eStatus != Status::MeasurementPending)
+    {
+        eError = ClassCommon::Error::Ok;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error Camera::StreamStart(int)
+{
+    // not supported by this camera
+    return ClassCommon::Error::Failed;
+}
+
+ClassCommon::Error Camera::StreamRead(struct RawDataInfo &, FrameBuffer& , int)
+{
+    return ClassCommon::Error::InvalidState;
+}
+
+ClassCommon::Error Camera::StreamStop()
+{
+    return ClassCommon::Error::Ok;
+}
+
+ClassCommon::Error Camera::SetExposureTime(int& )
+{
+    return ClassCommon::Error::Failed;
+}
+
+void Camera::SetTelemetryPeriod(int periodMs)
+{
+    mTelemetryPeriodMs = (periodMs > 0) ? periodMs : 0;
+}
+
+void Camera::SetRecording(QString filePath, int lineStep)
+{
+    mRecordFilePath = filePath;
+    mRecordLineStep = (lineStep > 0) ? lineStep : 0;
+}
+
+ClassCommon::Error Camera::ReadTelemetry(CameraTelemetry_t& )
+{
+    return ClassCommon::Error::Failed;
+}
+
+ClassCommon::Error Camera::RefreshTelemetry(CameraTelemetry_t& )
+{
+    return ClassCommon::Error::Failed;
+}
+
+bool Camera::GetTelemetry(CameraTelemetry_t& )
+{
+    return false;
+}
+
+void Camera::_NotifyMeasurement()
+{
+    QMutexLocker locker(&mMeasurementMutex);
+
+    mMeasurementCondition.wakeAll();
+}
+
 #ifdef SOAP_INTERFACE
 void Camera::SetPrnu(ns1__prnu *data, struct ns1__setPRNUResponse &_param_1)
 {}
@@ -391,6 +485,16 @@ void Camera::SetHw(QString , QString , float , int )
 
 }
 
+float Camera::GetHw(HwFeature_t eFeature)
+{
+    return GetHw(CameraHwFeature::GetDeviceName(eFeature), CameraHwFeature::GetFeatureName(eFeature));
+}
+
+void Camera::SetHw(HwFeature_t eFeature, float value, int index)
+{
+    SetHw(CameraHwFeature::GetDeviceName(eFeature), CameraHwFeature::GetFeatureName(eFeature), value, index);
+}
+
 void Camera::_LogMessage(QString message)
 {
     emit LogMessage(message);
@@ -11,10 +11,15 @@
 
 #include "classcommon.h"
 #include "toolTypes.h"
+#include "toolFrameBuffer.h"
 #include "imageConfigurationConst.h"
+#include "cameraHwFeature.h"
+#include "cameraTelemetry.h"
 
 #include <QSharedPointer>
 #include <QRect>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include <QJsonObject>
 
@@ -53,6 +58,7 @@ public:
         bool mbTestPattern;
         int mnTrigDelayMicros;
         bool bStoreStdDev;
+        QRect mcAccumulationArea; // part of the image read after the capture (empty: whole image)
 
         CaptureConfig()
             : mnExposureMicros(0)
@@ -63,6 +69,7 @@ public:
             , mbTestPattern(false)
             , mnTrigDelayMicros(0)
             , bStoreStdDev(false)
+            , mcAccumulationArea()
         {}
     };
 
@@ -142,6 +149,7 @@ public:
         MeasurementDone = 2,
         Fault = 3,
         Connected = 4,
+        Streaming = 5,
         NotInitialised,
         Invalid
     };
@@ -164,6 +172,20 @@ protected:
 
     CameraModel_t mModel;
 
+    // signal the end of a measurement to WaitForMeasurement
+    QMutex         mMeasurementMutex;
+    QWaitCondition mMeasurementCondition;
+
+    // to be called each time the capture state changes
+    void _NotifyMeasurement();
+
+    // period of the background telemetry refresh (0: no refresh)
+    int mTelemetryPeriodMs;
+
+    // record of the grabber activity (empty: no record)
+    QString mRecordFilePath;
+    int     mRecordLineStep;
+
 public:
     Camera(QObject *parent = nullptr);
 
@@ -230,7 +252,38 @@ public:
 
     virtual ClassCommon::Error GetStatus(enum Status& eStatus);
 
-    virtual ClassCommon::Error GetRawData(struct RawDataInfo &info, QByteArray& arr, QByteArray &stdDev);
+    virtual ClassCommon::Error GetRawData(struct RawDataInfo &info, FrameBuffer& frame, QByteArray &stdDev);
+
+    // wait until the measurement is not pending anymore (Timeout if it is still pending after timeoutMs)
+    virtual ClassCommon::Error WaitForMeasurement(int timeoutMs);
+
+    // continuous acquisition with the configuration set by Configure
+    // each frame is the average of averageNumber images
+    virtual ClassCommon::Error StreamStart(int averageNumber);
+
+    // wait for the next frame of the stream (Timeout if there is none after timeoutMs)
+    virtual ClassCommon::Error StreamRead(struct RawDataInfo &info, FrameBuffer& frame, int timeoutMs);
+
+    virtual ClassCommon::Error StreamStop();
+
+    // change the exposure time without stopping the stream (exposureUs is updated with the time set)
+    virtual ClassCommon::Error SetExposureTime(int& exposureUs);
+
+    // period of the background telemetry refresh, applied at the next connection (0: no refresh)
+    void SetTelemetryPeriod(int periodMs);
+
+    // record the buffers and the features of the grabber in filePath, applied at the next connection
+    // one line every lineStep lines of the images is recorded (0: only the time of arrival)
+    void SetRecording(QString filePath, int lineStep);
+
+    // read the telemetry from the camera (blocking)
+    virtual ClassCommon::Error ReadTelemetry(CameraTelemetry_t& telemetry);
+
+    // read the telemetry unless a capture or a stream uses the camera (InvalidState)
+    virtual ClassCommon::Error RefreshTelemetry(CameraTelemetry_t& telemetry);
+
+    // last telemetry read in background (false if there is none, ReadTelemetry must be used)
+    virtual bool GetTelemetry(CameraTelemetry_t& telemetry);
 
 #ifdef SOAP_INTERFACE
     virtual void SetPrnu(ns1__prnu *data, struct ns1__setPRNUResponse &_param_1);
@@ -314,6 +367,10 @@ public:
     virtual float   GetHw(QString hwDeviceName, QString hwFeature);
     virtual void    SetHw(QString hwDeviceName, QString hwFeature, float value, int index = 0);
 
+    // same with a feature resolved once (the default implementation uses the names)
+    virtual float   GetHw(HwFeature_t eFeature);
+    virtual void    SetHw(HwFeature_t eFeature, float value, int index = 0);
+
 signals:
     void EventOccured(int event);
 
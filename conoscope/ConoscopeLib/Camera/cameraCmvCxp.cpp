@@ -1,6 +1,7 @@
 #include "cameraCmvCxp.h"
 
 #include <QFuture>
+#include <QDateTime>
 #include <QtConcurrent/qtconcurrentrun.h>
 
 #include "HwTool.h"
@@ -10,15 +11,25 @@
 
 #define PRINT
 
-#define INVALID_FRAME_INDEX -1
-
 #define LOG_DEBUG(message) _LogMessage(QString("CmvCamera - %1").arg(message))
 
-CameraCmvCxp::CameraCmvCxp(QObject *parent) : Camera(parent)
+// older telemetry is not used (the refresh is skipped during a capture)
+#define TELEMETRY_MAX_AGE_PERIODS 3
+
+// DeviceTemperatureSelector values
+#define TEMPERATURE_SELECTOR_SENSOR    "Sensor"
+#define TEMPERATURE_SELECTOR_MAINBOARD "Mainboard"
+#define TEMPERATURE_SELECTOR_CPU       "CPU"
+
+CameraCmvCxp::CameraCmvCxp(QObject *parent) : Camera(parent), mHwMutex(QMutex::Recursive)
 {
     mGentl = NULL;
     mGrabber = NULL;
 
+    mTelemetry = NULL;
+
+    _ResolveHwFeatures();
+
     eState = CameraState_NotConnected;
 
     mCaptureState = Camera::Status::NotInitialised;
@@ -31,8 +42,12 @@ CameraCmvCxp::CameraCmvCxp(QObject *parent) : Camera(parent)
 
 CameraCmvCxp::~CameraCmvCxp()
 {
+    _StopTelemetry();
+
     if(mGrabber != NULL)
     {
+        mGrabber->RecordClose();
+
         delete(mGrabber);
         mGrabber = NULL;
     }
@@ -217,6 +232,9 @@ ClassCommon::Error CameraCmvCxp::_Connect(bool bPowerCycle)
         mGrabber->GetCameraInfo(cameraInfo);
         mModel = GetCameraModel(cameraInfo);
 
+        // the hardware features depend on the model
+        _ResolveHwFeatures();
+
         // imageConfiguration (default value matches cmv8000)
         ImageConfiguration* imageConfiguration = ImageConfiguration::Get();
 
@@ -263,8 +281,10 @@ ClassCommon::Error CameraCmvCxp::_Connect(bool bPowerCycle)
 
         // connect the signal on the signal
 #ifdef FRAME_CAPTURED_SIGNAL
+        // direct connection: the slot is executed in the grabber thread
+        // so the thread waiting for the measurement is woken up without processing events
         connect(mGrabber, &CoaXpressGrabber::FrameCaptured,
-                this, &CameraCmvCxp::onFrameCaptured);
+                this, &CameraCmvCxp::onFrameCaptured, Qt::DirectConnection);
 #endif
 
         PRINT("Grabber", "Created");
@@ -272,6 +292,13 @@ ClassCommon::Error CameraCmvCxp::_Connect(bool bPowerCycle)
         eState = CameraState_Connected;
         mCaptureState = Camera::Status::Ready;
 
+        _StartTelemetry();
+
+        if(mRecordFilePath.isEmpty() == false)
+        {
+            mGrabber->RecordOpen(mRecordFilePath, mRecordLineStep);
+        }
+
         NotifyEvent(Event::Connect);
     }
     catch(gentl_error gentlException)
@@ -293,8 +320,13 @@ ClassCommon::Error CameraCmvCxp::_Connect(bool bPowerCycle)
 
 ClassCommon::Error CameraCmvCxp::_Disconnect()
 {
+    // the poller uses the grabber
+    _StopTelemetry();
+
     if(mGrabber != NULL)
     {
+        mGrabber->RecordClose();
+
         delete(mGrabber);
         mGrabber = NULL;
     }
@@ -305,6 +337,9 @@ ClassCommon::Error CameraCmvCxp::_Disconnect()
         mGentl = NULL;
     }
 
+    // no hardware access without the grabber
+    _ResolveHwFeatures();
+
     mCaptureState = Camera::Status::NotInitialised;
 
     return ClassCommon::Error::Ok;
@@ -362,7 +397,7 @@ ClassCommon::Error CameraCmvCxp::GetInfo(CameraInfo_t& info)
 
         // mModel = GetCameraModel(cameraInfo);
 
-        mGrabber->GetTemperature(info.settings);
+        _GetTemperature(info.settings);
 
         info.cameraBoardSerialNumber = QString("%1").arg(cameraInfo.cameraSerialNumber.c_str());
         info.CpuBoardRev       = "";
@@ -487,6 +522,8 @@ void CameraCmvCxp::onFrameCaptured(int frameIndex)
         mCaptureState = Camera::Status::MeasurementDone;
         mCurrentFrameIndex = frameIndex;
 
+        _NotifyMeasurement();
+
         emit FrameCaptured(frameIndex);
     }
 }
@@ -512,6 +549,14 @@ ClassCommon::Error CameraCmvCxp::Configure(struct CaptureConfig* pConfig)
 #ifdef STD_DEV_FILE
         config.bStoreStdDev      = pConfig->bStoreStdDev;
 #endif
+
+        // the image starts after the blanking lines of the frame (see GetRawData)
+        if((pConfig->mcAccumulationArea.isEmpty() == false) &&
+           ((mModel == CameraModel_CmvCxp_50k) || (mModel == CameraModel_CmvCxp_8k)))
+        {
+            config.accumulationArea = pConfig->mcAccumulationArea.translated(0, CRITICAL_LINK_VERTICAL_OFFSET);
+        }
+
         if(mGrabber != NULL)
         {
             mGrabber->Configure(config);
@@ -558,10 +603,22 @@ ClassCommon::Error CameraCmvCxp::StartMeasurement()
     _LogInFile("[Camera]", "StartMeasurement");
 #endif
 
-    if((mCaptureState == Camera::Status::Ready) && (mGrabber != NULL))
+    bool bStart = false;
+
     {
-        mCaptureState = Camera::Status::MeasurementPending;
+        // a telemetry refresh in progress ends before the state changes, the next ones are
+        // skipped while the measurement is pending (the mutex is not held during the capture)
+        QMutexLocker locker(&mHwMutex);
+
+        if((mCaptureState == Camera::Status::Ready) && (mGrabber != NULL))
+        {
+            mCaptureState = Camera::Status::MeasurementPending;
+            bStart = true;
+        }
+    }
 
+    if(bStart == true)
+    {
         // launch the capture
 #ifdef FRAME_CAPTURED_SIGNAL
         mGrabber->Start();
@@ -590,6 +647,14 @@ ClassCommon::Error CameraCmvCxp::StartMeasurement()
             // somehow emulate the signal
             onFrameCaptured(frameIndex);
         }
+        else
+        {
+            // capture not started (no frame available)
+            mCaptureState = Camera::Status::Fault;
+            _NotifyMeasurement();
+
+            eError = ClassCommon::Error::Failed;
+        }
 #endif
     }
     else
@@ -604,12 +669,23 @@ ClassCommon::Error CameraCmvCxp::StopMeasurement()
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
+    QMutexLocker locker(&mHwMutex);
+
     if((mCaptureState != Camera::Status::Ready) && (mGrabber != NULL))
     {
         mCaptureState = Camera::Status::Ready;
 
         // stop the capture
         mGrabber->Stop();
+
+        _NotifyMeasurement();
+
+        if(mCurrentFrameIndex != INVALID_FRAME_INDEX)
+        {
+            // frame captured but not read
+            CoaXpressFrame::ReleaseImage(mCurrentFrameIndex);
+            mCurrentFrameIndex = INVALID_FRAME_INDEX;
+        }
     }
     else
     {
@@ -623,213 +699,341 @@ ClassCommon::Error CameraCmvCxp::GetPulse(struct Pulse* pPulse){
     return ClassCommon::Error::Ok;
 }
 
-ClassCommon::Error CameraCmvCxp::GetRawData(struct RawDataInfo &info, QByteArray& arr, QByteArray& stdDev)
+ClassCommon::Error CameraCmvCxp::StreamStart(int averageNumber)
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    if(mCaptureState == Camera::Status::MeasurementDone)
+    // a telemetry refresh in progress ends before the stream (the next ones are skipped)
+    QMutexLocker locker(&mHwMutex);
+
+    if((mCaptureState == Camera::Status::Ready) && (mGrabber != NULL))
     {
-        if(mCurrentFrameIndex != INVALID_FRAME_INDEX)
+        if(mGrabber->StreamStart(averageNumber) == true)
+        {
+            mCaptureState = Camera::Status::Streaming;
+        }
+        else
+        {
+            eError = ClassCommon::Error::Failed;
+        }
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraCmvCxp::StreamRead(struct RawDataInfo &info, FrameBuffer& frame, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if((mCaptureState == Camera::Status::Streaming) && (mGrabber != NULL))
+    {
+        int frameIndex = mGrabber->StreamRead(timeoutMs);
+
+        if(frameIndex != INVALID_FRAME_INDEX)
+        {
+            _GetTemperature(info.settings);
+
+            eError = _ReadFrame(frameIndex, info, frame, mStreamStdDev);
+        }
+        else
+        {
+            eError = ClassCommon::Error::Timeout;
+        }
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraCmvCxp::StreamStop()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    QMutexLocker locker(&mHwMutex);
+
+    if((mCaptureState == Camera::Status::Streaming) && (mGrabber != NULL))
+    {
+        mGrabber->StreamStop();
+
+        mCaptureState = Camera::Status::Ready;
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraCmvCxp::SetExposureTime(int& exposureUs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mGrabber != NULL)
+    {
+        try
         {
-            // retrieve picture
-            ImageFrame* pFrame = CoaXpressFrame::GetImage(mCurrentFrameIndex);
+            mGrabber->SetExposureTime(exposureUs);
+        }
+        catch(...)
+        {
+            eError = ClassCommon::Error::Failed;
+        }
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
 
-            // fill the info structure
-            info.miLines = pFrame->mFeature.height;
-            info.miCols  = pFrame->mFeature.width;
+    return eError;
+}
 
+ClassCommon::Error CameraCmvCxp::GetRawData(struct RawDataInfo &info, FrameBuffer& frame, QByteArray& stdDev)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mCaptureState == Camera::Status::MeasurementDone)
+    {
+        if(mCurrentFrameIndex != INVALID_FRAME_INDEX)
+        {
             // temperature should be captured at the moment of the frame capture
+            // (the last refresh is done before the capture)
             if(mGrabber != NULL)
             {
-                mGrabber->GetTemperature(info.settings);
+                _GetTemperature(info.settings);
             }
 
-            // fill the raw data array
-            // pFrame->mImageVector
+            eError = _ReadFrame(mCurrentFrameIndex, info, frame, stdDev);
 
-            int arraySize = info.miLines * info.miCols * sizeof(uint16_t);
-#ifdef STD_DEV_FILE
-#ifndef STD_DEV_FLOAT
-            int stdDevArraySize = arraySize;
-#else
-            int stdDevArraySize = info.miLines * info.miCols * sizeof(float);
-#endif
-#endif /* STD_DEV_FILE */
-            arr.resize(arraySize);
+            mCurrentFrameIndex = INVALID_FRAME_INDEX;
 
-#ifdef STD_DEV_FILE
-            if(pFrame->bStoreStdDev == true)
+            if(eError == ClassCommon::Error::InvalidParameter)
             {
-                stdDev.resize(stdDevArraySize);
+                // the frame has been overwritten by another capture
+                mCaptureState = Camera::Status::Fault;
             }
-#endif
+            else
+            {
+                mCaptureState = Camera::Status::Ready;
+            }
+        }
+        else
+        {
+            mCaptureState = Camera::Status::Fault;
+            eError = ClassCommon::Error::InvalidParameter;
+        }
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraCmvCxp::_ReadFrame(int slotIndex, struct RawDataInfo &info, FrameBuffer& frame, QByteArray& stdDev)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    // retrieve picture
+    ImageFrame* pFrame = CoaXpressFrame::GetImage(slotIndex);
+
+    if(pFrame == NULL)
+    {
+        // the frame has been overwritten by another capture
+        return ClassCommon::Error::InvalidParameter;
+    }
+
+    // fill the info structure
+    info.miLines = pFrame->mFeature.height;
+    info.miCols  = pFrame->mFeature.width;
 
-            uchar* pLine = (uchar*)arr.data();
 #ifdef STD_DEV_FILE
-            uchar* pStdDev = (uchar*)stdDev.data();
+#ifndef STD_DEV_FLOAT
+    int stdDevArraySize = info.miLines * info.miCols * sizeof(uint16_t);
+#else
+    int stdDevArraySize = info.miLines * info.miCols * sizeof(float);
 #endif
 
-            if(pFrame->mFeature.eCameraManufacturer == CameraManufacturer_CriticalLink)
-            {
-                // resize the picture to the right dimensions
+    if(pFrame->bStoreStdDev == true)
+    {
+        stdDev.resize(stdDevArraySize);
+    }
 
-                // on the original picture stitch appear at 3960. that means that there is no lateral offset
-                // vertical offset is 22 (CRITICAL_LINK_VERTICAL_OFFSET)
+    uchar* pStdDev = (uchar*)stdDev.data();
+#endif /* STD_DEV_FILE */
+
+    if(pFrame->mFeature.eCameraManufacturer == CameraManufacturer_CriticalLink)
+    {
+        // resize the picture to the right dimensions
+
+        // on the original picture stitch appear at 3960. that means that there is no lateral offset
+        // vertical offset is 22 (CRITICAL_LINK_VERTICAL_OFFSET)
 
 #ifndef CRITICAL_LINK_FULL_FRAME
-                char* ptrDst = (char*)pLine;
-                char* ptrSrc = (char*)&pFrame->mImageVector[0];
 #ifdef STD_DEV_FILE
-                char* ptrDstStdDev = (char*)&pFrame->mStdVector[0];
+        char* ptrDstStdDev = (char*)&pFrame->mStdVector[0];
 #endif
 
-                int offsetY = 0;
+        int offsetY = 0;
 
-                if(mModel == CameraModel_CmvCxp_50k)
-                {
-                    offsetY = CRITICAL_LINK_VERTICAL_OFFSET - pFrame->mFeature.offsetY;
-                }
-                else if(mModel == CameraModel_CmvCxp_8k)
-                {
-                    offsetY = 0;
-                }
+        if(mModel == CameraModel_CmvCxp_50k)
+        {
+            offsetY = CRITICAL_LINK_VERTICAL_OFFSET - pFrame->mFeature.offsetY;
+        }
+        else if(mModel == CameraModel_CmvCxp_8k)
+        {
+            offsetY = 0;
+        }
 
 // #define TEST_MEASUREMENT
 #ifdef TEST_MEASUREMENT
-                // following part is used to check AE area
-                // the capture is divided into 4 parts
-                // where value depends from exposure time
-                // so depending on the AE ROI, the result exposure time will not be the same
-                // (of course those test data are in a location where there is no AE... so it should not be in this component)
-                int exposureTime;
-                mGrabber->GetExposureTime(exposureTime);
-
-                float factLine = 1;
-                float factCol  = 1;
-                float value = 0;
-
-                int frameIndex = CRITICAL_LINK_VERTICAL_OFFSET * pFrame->mWidth;
-                for(int lineIndex = 0; lineIndex < 6004; lineIndex ++)
-                {
-                    if(lineIndex == 3002)
-                    {
-                        factLine += 0.6;
-                    }
+        // following part is used to check AE area
+        // the capture is divided into 4 parts
+        // where value depends from exposure time
+        // so depending on the AE ROI, the result exposure time will not be the same
+        // (of course those test data are in a location where there is no AE... so it should not be in this component)
+        int exposureTime;
+        mGrabber->GetExposureTime(exposureTime);
 
-                    factCol = factLine;
+        float factLine = 1;
+        float factCol  = 1;
+        float value = 0;
 
-                    for(int rowIndex = 0; rowIndex < pFrame->mWidth; rowIndex ++)
-                    {
-                        if(rowIndex == 3960)
-                        {
-                            factCol += 0.3;
-                        }
+        // the test pattern is written in the whole frame
+        CoaXpressFrame::ReadImage(slotIndex, QRect(0, 0, pFrame->mFeature.width, pFrame->mFeature.height), pFrame->mImage);
 
-                        value = ((float)exposureTime / 10.0);
-                        value = (int)((float)value * factCol);
+        uint16_t* pImage = pFrame->mImage.GetData();
 
-                        if(value > 4095) value = 4095;
+        int frameIndex = CRITICAL_LINK_VERTICAL_OFFSET * pFrame->mWidth;
+        for(int lineIndex = 0; lineIndex < 6004; lineIndex ++)
+        {
+            if(lineIndex == 3002)
+            {
+                factLine += 0.6;
+            }
 
-                        pFrame->mImageVector[frameIndex ++] = (int)value;
-                    }
+            factCol = factLine;
+
+            for(int rowIndex = 0; rowIndex < pFrame->mWidth; rowIndex ++)
+            {
+                if(rowIndex == 3960)
+                {
+                    factCol += 0.3;
                 }
+
+                value = ((float)exposureTime / 10.0);
+                value = (int)((float)value * factCol);
+
+                if(value > 4095) value = 4095;
+
+                pImage[frameIndex ++] = (int)value;
+            }
+        }
 #endif
 
-                int cropOffsetX = info.cropArea.x();
-                int cropOffsetY = info.cropArea.y();
+        int cropOffsetX = info.cropArea.x();
+        int cropOffsetY = info.cropArea.y();
 
-                int lineLenght = info.cropArea.width();
-                int nbLines    = info.cropArea.height();
+        int lineLenght = info.cropArea.width();
+        int nbLines    = info.cropArea.height();
 
 #ifdef AE_ROI
-                if((pFrame->mFeature.width >= IMAGE_WIDTH) ||
-                   (pFrame->mFeature.height >= IMAGE_HEIGHT))
-                {
-                    cropOffsetX = 0;
-                    cropOffsetY = 0;
-                    lineLenght  = IMAGE_WIDTH;
-                    nbLines     = IMAGE_HEIGHT;
+        if((pFrame->mFeature.width >= IMAGE_WIDTH) ||
+           (pFrame->mFeature.height >= IMAGE_HEIGHT))
+        {
+            cropOffsetX = 0;
+            cropOffsetY = 0;
+            lineLenght  = IMAGE_WIDTH;
+            nbLines     = IMAGE_HEIGHT;
 
-                    offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
-                }
-                else
-                {
-                    cropOffsetX = 0;
-                    cropOffsetY = 0;
+            offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
+        }
+        else
+        {
+            cropOffsetX = 0;
+            cropOffsetY = 0;
 
-                    offsetY = 0;
-                }
+            offsetY = 0;
+        }
 #else
-                if(lineLenght == 0 || nbLines == 0)
-                {
-                    cropOffsetX = 0;
-                    cropOffsetY = 0;
-                    lineLenght  = IMAGE_WIDTH;
-                    nbLines     = IMAGE_HEIGHT;
+        if(lineLenght == 0 || nbLines == 0)
+        {
+            cropOffsetX = 0;
+            cropOffsetY = 0;
+            lineLenght  = IMAGE_WIDTH;
+            nbLines     = IMAGE_HEIGHT;
 
-                    offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
-                }
-                else
-                {
-                    // full frame is captured, so need to add the offset to remove blanking lines
-                    offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
-                }
+            offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
+        }
+        else
+        {
+            // full frame is captured, so need to add the offset to remove blanking lines
+            offsetY = CRITICAL_LINK_VERTICAL_OFFSET;
+        }
 #endif
 
-#pragma omp parallel for num_threads(4)
-                for(int lineIndex = 0; lineIndex < nbLines; lineIndex ++)
-                {
-                    memcpy(&ptrDst[lineIndex * lineLenght * sizeof(uint16_t)],
-                           &ptrSrc[(lineIndex + offsetY + cropOffsetY) * pFrame->mFeature.width * sizeof(uint16_t) +
-                                   (cropOffsetX * sizeof(uint16_t))],
-                           lineLenght * sizeof(uint16_t));
-                }
-
-                info.miLines = nbLines;
-                info.miCols  = lineLenght;
+        // only the crop area is averaged in the output frame
+        QRect cropArea(cropOffsetX, offsetY + cropOffsetY, lineLenght, nbLines);
 
-                int arraySize = info.miLines * info.miCols * sizeof(uint16_t);
-                arr.resize(arraySize);
+#ifdef TEST_MEASUREMENT
+        frame = pFrame->mImage.Crop(cropArea);
 #else
-                memcpy(pLine, &pFrame->mImageVector[0], arraySize);
+        CoaXpressFrame::ReadImage(slotIndex, cropArea, frame);
 #endif
-            }
-            else
-            {
-                if(pFrame->mFeature.eFormat == PixelFormat_Mono8)
-                {
-                    // can not copy the pixel directly because input is store in 8 bits
-                    // and output in 16 bits
-                    for(int pixelIndex = 0; pixelIndex < info.miLines * info.miCols; pixelIndex++)
-                    {
-                        pLine[pixelIndex] = pFrame->mImageVector[pixelIndex];
-                    }
-                }
-                else
-                {
-                    memcpy(pLine, &pFrame->mImageVector[0], arraySize);
-                }
 
-#ifdef STD_DEV_FILE
-                if(pFrame->bStoreStdDev == true)
-                {
-                    memcpy(pStdDev, &pFrame->mStdVector[0], stdDevArraySize);
-                }
+        info.miLines = frame.GetHeight();
+        info.miCols  = frame.GetWidth();
+#else
+        CoaXpressFrame::ReadImage(slotIndex, QRect(0, 0, info.miCols, info.miLines), frame);
 #endif
-            }
+    }
+    else
+    {
+        if(pFrame->mFeature.eFormat == PixelFormat_Mono8)
+        {
+            // can not copy the pixel directly because input is store in 8 bits
+            // and output in 16 bits
+            FrameBuffer image;
+            CoaXpressFrame::ReadImage(slotIndex, QRect(0, 0, info.miCols, info.miLines), image);
 
-            mCurrentFrameIndex = INVALID_FRAME_INDEX;
-            mCaptureState = Camera::Status::Ready;
+            frame = FrameBuffer(info.miCols, info.miLines);
+
+            uchar* pLine = (uchar*)frame.GetData();
+            uint16_t* pImage = image.GetData();
+
+            for(int pixelIndex = 0; pixelIndex < info.miLines * info.miCols; pixelIndex++)
+            {
+                pLine[pixelIndex] = pImage[pixelIndex];
+            }
         }
         else
         {
-            mCaptureState = Camera::Status::Fault;
-            eError = ClassCommon::Error::InvalidParameter;
+            CoaXpressFrame::ReadImage(slotIndex, QRect(0, 0, info.miCols, info.miLines), frame);
+        }
+
+#ifdef STD_DEV_FILE
+        if(pFrame->bStoreStdDev == true)
+        {
+            memcpy(pStdDev, &pFrame->mStdVector[0], stdDevArraySize);
         }
+#endif
     }
-    else
+
+    // the slot can be used by the next capture, the frame buffer is still used by the caller
+    CoaXpressFrame::ReleaseImage(slotIndex);
+
+    if(frame.IsNull() == true)
     {
-        eError = ClassCommon::Error::InvalidState;
+        // the frame could not be read (empty area or no memory)
+        eError = ClassCommon::Error::Failed;
     }
 
     return eError;
@@ -882,7 +1086,7 @@ void CameraCmvCxp::GetCameraInfo(
 
         CameraSettings settings;
 
-        mGrabber->GetTemperature(settings);
+        _GetTemperature(settings);
 
         mGrabber->GetInfo(infoData);
 
@@ -1230,8 +1434,7 @@ void  CameraCmvCxp::HW_SetTriggerGain (UCHAR ubGain)
 //-----------------------------------------------------------------------------
 float CameraCmvCxp::HW_Get_TEC_Hot_Temperature()
 {
-    float fResult = HW_TMP10XReadTemperature(I2C_BUS_TEC_TMP102, I2C_ADDR_TEC_TMP102);
-    return (fResult);
+    return GetHw(HwFeature_TecHotTemperature);
 }
 
 //-----------------------------------------------------------------------------
@@ -1239,8 +1442,7 @@ float CameraCmvCxp::HW_Get_TEC_Hot_Temperature()
 //-----------------------------------------------------------------------------
 float CameraCmvCxp::HW_Get_Sensor_Cold_Temperature()
 {
-    float fResult = HW_TMP10XReadTemperature(I2C_BUS_SENSOR_TMP102, I2C_ADDR_SENSOR_TMP102);
-    return (fResult);
+    return GetHw(HwFeature_SensorColdTemperature);
 }
 
 #define DAC8571_WRITE_DATA_LOAD       0x10
@@ -1342,23 +1544,23 @@ void  CameraCmvCxp::HW_Set_DAC_TEC_OutputValue (float fValue)
 
 float CameraCmvCxp::HW_Get_CMOSTemperature()
 {
-    SetStringValue("DeviceTemperatureSelector", "Sensor");
-    QThread::msleep(10);
-    return (GetFloatValue("DeviceTemperature"));
+    return GetHw(HwFeature_SensorCmosTemperature);
 }
 
 float CameraCmvCxp::HW_Get_MainboardTemperature()
 {
-    SetStringValue("DeviceTemperatureSelector", "Mainboard");
-    QThread::msleep(10);
-    return (GetFloatValue("DeviceTemperature"));
+    static const std::string selector(TEMPERATURE_SELECTOR_MAINBOARD);
+
+    QMutexLocker locker(&mHwMutex);
+    return _ReadDeviceTemperature(selector);
 }
 
 float CameraCmvCxp::HW_Get_CPUTemperature()
 {
-     SetStringValue("DeviceTemperatureSelector", "CPU");
-    QThread::msleep(10);
-    return (GetFloatValue("DeviceTemperature"));
+    static const std::string selector(TEMPERATURE_SELECTOR_CPU);
+
+    QMutexLocker locker(&mHwMutex);
+    return _ReadDeviceTemperature(selector);
 }
 
 #define FAN_MAX_RPM 6850.0 // Datasheet 9GA0612P6G001
@@ -1528,61 +1730,248 @@ void  CameraCmvCxp::SetFloatValue(const std::string feature, float value)
 
 float CameraCmvCxp::GetHw(QString hwDeviceName, QString hwFeature)
 {
-    float value = 0.0;
+    HwFeature_t eFeature = CameraHwFeature::Get(hwDeviceName, hwFeature);
 
-    // better is following is in a map
-    if(hwDeviceName == "TEC")
+    if(eFeature == HwFeature_Invalid)
     {
-        if(hwFeature == "HotTemperature")
-        {
-            value = HW_Get_TEC_Hot_Temperature();
-        }
-        else if(hwFeature == "AdcITec")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_ADC_ITEC);
-        }
-        else if(hwFeature == "VTec")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_ADC_VTEC);
-        }
-        else if(hwFeature == "DacOutput")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_DAC_OUTPUT, true);
-        }
-        else if(hwFeature == "AdcVin")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_ADC_VIN);
-        }
-        else if(hwFeature == "Adc5V")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_ADC_5V);
-        }
-        else if(hwFeature == "Adc3V3")
-        {
-            value = HW_ADC_TEC_Value(CameraCmvCxp::e_ADC_3V3);
-        }
+        return 0.0;
     }
-    else if(hwDeviceName == "Sensor")
+
+    return GetHw(eFeature);
+}
+
+void CameraCmvCxp::SetHw(QString hwDeviceName, QString hwFeature, float value, int index)
+{
+    HwFeature_t eFeature = CameraHwFeature::Get(hwDeviceName, hwFeature);
+
+    if(eFeature != HwFeature_Invalid)
     {
-        if(hwFeature == "ColdTemperature")
-        {
-            value = HW_Get_Sensor_Cold_Temperature() ;
-        }
-        else if(hwFeature == "CmosTemperature")
-        {
-            value = HW_Get_CMOSTemperature() ;
-        }
+        SetHw(eFeature, value, index);
     }
+}
+
+float CameraCmvCxp::GetHw(HwFeature_t eFeature)
+{
+    QMutexLocker locker(&mHwMutex);
+
+    if((int)eFeature >= HwFeature_Count)
+    {
+        return 0.0;
+    }
+
+    const HwHandle_t& handle = mHwHandle[eFeature];
+
+    float value = HW_INVALID_VALUE;
+
+    switch(handle.eAccess)
+    {
+    case HwAccess_Tmp10x:
+        value = HW_TMP10XReadTemperature(handle.bus, handle.address);
+        break;
+
+    case HwAccess_AdcTec:
+        value = HW_ADC_TEC_Value(handle.eChannel, handle.bInPercent);
+        break;
+
+    case HwAccess_DeviceTemperature:
+        value = _ReadDeviceTemperature(handle.selector);
+        break;
+
+    case HwAccess_Fan:
+        // write only
+        value = 0.0;
+        break;
+
+    case HwAccess_None:
+        break;
+    }
+
     return value;
 }
 
-void CameraCmvCxp::SetHw(QString hwDeviceName, QString hwFeature, float value, int index)
+void CameraCmvCxp::SetHw(HwFeature_t eFeature, float value, int index)
+{
+    QMutexLocker locker(&mHwMutex);
+
+    if(((int)eFeature < HwFeature_Count) &&
+       (mHwHandle[eFeature].eAccess == HwAccess_Fan))
+    {
+        HW_Set_FanSpeed(index, value);
+    }
+}
+
+void CameraCmvCxp::_ResolveHwFeatures()
+{
+    QMutexLocker locker(&mHwMutex);
+
+    for(int index = 0; index < HwFeature_Count; index ++)
+    {
+        mHwHandle[index].eAccess    = HwAccess_None;
+        mHwHandle[index].bus        = 0;
+        mHwHandle[index].address    = 0;
+        mHwHandle[index].eChannel   = e_ADC_ZERO;
+        mHwHandle[index].bInPercent = false;
+        mHwHandle[index].selector.clear();
+    }
+
+    // the TEC and sensor boards are only on the CriticalLink cameras
+    if((mGrabber == NULL) ||
+       ((mModel != CameraModel_CmvCxp_50k) && (mModel != CameraModel_CmvCxp_8k)))
+    {
+        return;
+    }
+
+    mHwHandle[HwFeature_TecHotTemperature].eAccess = HwAccess_Tmp10x;
+    mHwHandle[HwFeature_TecHotTemperature].bus     = I2C_BUS_TEC_TMP102;
+    mHwHandle[HwFeature_TecHotTemperature].address = I2C_ADDR_TEC_TMP102;
+
+    mHwHandle[HwFeature_SensorColdTemperature].eAccess = HwAccess_Tmp10x;
+    mHwHandle[HwFeature_SensorColdTemperature].bus     = I2C_BUS_SENSOR_TMP102;
+    mHwHandle[HwFeature_SensorColdTemperature].address = I2C_ADDR_SENSOR_TMP102;
+
+    const struct
+    {
+        HwFeature_t  eFeature;
+        eDAC_Channel eChannel;
+        bool         bInPercent;
+    } adcFeatures[] =
+    {
+        {HwFeature_TecAdcITec,   e_ADC_ITEC,   false},
+        {HwFeature_TecVTec,      e_ADC_VTEC,   false},
+        {HwFeature_TecDacOutput, e_DAC_OUTPUT, true},
+        {HwFeature_TecAdcVin,    e_ADC_VIN,    false},
+        {HwFeature_TecAdc5V,     e_ADC_5V,     false},
+        {HwFeature_TecAdc3V3,    e_ADC_3V3,    false},
+    };
+
+    for(const auto& adcFeature : adcFeatures)
+    {
+        mHwHandle[adcFeature.eFeature].eAccess    = HwAccess_AdcTec;
+        mHwHandle[adcFeature.eFeature].eChannel   = adcFeature.eChannel;
+        mHwHandle[adcFeature.eFeature].bInPercent = adcFeature.bInPercent;
+    }
+
+    mHwHandle[HwFeature_SensorCmosTemperature].eAccess  = HwAccess_DeviceTemperature;
+    mHwHandle[HwFeature_SensorCmosTemperature].selector = TEMPERATURE_SELECTOR_SENSOR;
+
+    mHwHandle[HwFeature_FanSpeed].eAccess = HwAccess_Fan;
+}
+
+float CameraCmvCxp::_ReadDeviceTemperature(const std::string& selector)
 {
-    if(hwDeviceName == "Fan")
+    // GenAPI names are built once
+    static const std::string temperatureSelector("DeviceTemperatureSelector");
+    static const std::string temperature("DeviceTemperature");
+
+    if(mGrabber == NULL)
+    {
+        return HW_INVALID_VALUE;
+    }
+
+    try
     {
-        if(hwFeature == "Speed")
+        mGrabber->setString<Euresys::RemoteModule>(temperatureSelector, selector);
+        QThread::msleep(10);
+        return mGrabber->getFloat<Euresys::RemoteModule>(temperature);
+    }
+    catch(...)
+    {
+        return 0;
+    }
+}
+
+ClassCommon::Error CameraCmvCxp::ReadTelemetry(CameraTelemetry_t& telemetry)
+{
+    QMutexLocker locker(&mHwMutex);
+
+    if(mGrabber == NULL)
+    {
+        return ClassCommon::Error::InvalidState;
+    }
+
+    mGrabber->GetTemperature(telemetry.settings);
+
+    telemetry.hw.clear();
+
+    const HwFeature_t features[] =
+    {
+        HwFeature_TecHotTemperature,
+        HwFeature_TecAdcITec,
+        HwFeature_SensorColdTemperature,
+        HwFeature_SensorCmosTemperature
+    };
+
+    for(HwFeature_t eFeature : features)
+    {
+        if(mHwHandle[eFeature].eAccess != HwAccess_None)
         {
-            HW_Set_FanSpeed(index, value) ;
+            telemetry.hw.insert(eFeature, GetHw(eFeature));
         }
     }
+
+    telemetry.timeStampMs = QDateTime::currentMSecsSinceEpoch();
+
+    return ClassCommon::Error::Ok;
+}
+
+ClassCommon::Error CameraCmvCxp::RefreshTelemetry(CameraTelemetry_t& telemetry)
+{
+    // the state is changed with the mutex held, a capture or a stream can not start during the read
+    QMutexLocker locker(&mHwMutex);
+
+    if((mCaptureState == Camera::Status::MeasurementPending) ||
+       (mCaptureState == Camera::Status::Streaming))
+    {
+        // the control channel is left to the capture
+        return ClassCommon::Error::InvalidState;
+    }
+
+    return ReadTelemetry(telemetry);
+}
+
+bool CameraCmvCxp::GetTelemetry(CameraTelemetry_t& telemetry)
+{
+    if((mTelemetry == NULL) || (mTelemetry->Get(telemetry) == false))
+    {
+        return false;
+    }
+
+    qint64 ageMs = QDateTime::currentMSecsSinceEpoch() - telemetry.timeStampMs;
+
+    return (ageMs <= (qint64)mTelemetryPeriodMs * TELEMETRY_MAX_AGE_PERIODS) ? true : false;
+}
+
+void CameraCmvCxp::_StartTelemetry()
+{
+    if((mTelemetry == NULL) && (mTelemetryPeriodMs > 0))
+    {
+        mTelemetry = new CameraTelemetry(this, mTelemetryPeriodMs);
+        mTelemetry->start();
+    }
+}
+
+void CameraCmvCxp::_StopTelemetry()
+{
+    if(mTelemetry != NULL)
+    {
+        // the destructor waits for the end of the refresh
+        delete(mTelemetry);
+        mTelemetry = NULL;
+    }
+}
+
+void CameraCmvCxp::_GetTemperature(CameraSettings& settings)
+{
+    CameraTelemetry_t telemetry;
+
+    if(GetTelemetry(telemetry) == true)
+    {
+        settings.Copy(telemetry.settings);
+    }
+    else
+    {
+        QMutexLocker locker(&mHwMutex);
+
+        mGrabber->GetTemperature(settings);
+    }
 }
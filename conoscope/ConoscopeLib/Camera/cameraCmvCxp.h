@@ -89,7 +89,21 @@ public:
 
     ClassCommon::Error GetStatus(enum Status& eStatus);
 
-    ClassCommon::Error GetRawData(struct RawDataInfo &info, QByteArray& arr, QByteArray &stdDev);
+    ClassCommon::Error GetRawData(struct RawDataInfo &info, FrameBuffer& frame, QByteArray &stdDev);
+
+    ClassCommon::Error StreamStart(int averageNumber);
+
+    ClassCommon::Error StreamRead(struct RawDataInfo &info, FrameBuffer& frame, int timeoutMs);
+
+    ClassCommon::Error StreamStop();
+
+    ClassCommon::Error SetExposureTime(int& exposureUs);
+
+    ClassCommon::Error ReadTelemetry(CameraTelemetry_t& telemetry);
+
+    ClassCommon::Error RefreshTelemetry(CameraTelemetry_t& telemetry);
+
+    bool GetTelemetry(CameraTelemetry_t& telemetry);
 
 #ifndef COAXPRESS_FRAME_AVERAGE
     void UpdateCaptureConfiguration(
@@ -164,6 +178,9 @@ public:
     float   GetHw(QString hwDeviceName, QString hwFeature);
     void    SetHw(QString hwDeviceName, QString hwFeature, float value, int index = 0);
 
+    float   GetHw(HwFeature_t eFeature);
+    void    SetHw(HwFeature_t eFeature, float value, int index = 0);
+
      UCHAR   CurrentI2C_BUS_PCA ;
 
 signals:
@@ -187,10 +204,57 @@ private:
     Camera::Status mCaptureState;
     int mCurrentFrameIndex;
 
+    // standard deviation is not provided with the stream
+    QByteArray mStreamStdDev;
+
+    // background read of the temperatures (NULL when not connected)
+    CameraTelemetry* mTelemetry;
+
+    // the hardware values are read with a selector, the sequences must not be interleaved
+    // (also held by a capture and by the stream start / stop, see RefreshTelemetry)
+    QMutex mHwMutex;
+
+    typedef enum
+    {
+        HwAccess_None,              // not available with the camera connected
+        HwAccess_Tmp10x,            // I2C temperature sensor
+        HwAccess_AdcTec,            // I2C ADC of the TEC board
+        HwAccess_DeviceTemperature, // DeviceTemperatureSelector / DeviceTemperature
+        HwAccess_Fan                // FanSelect / FanPeriod / FanWidth (write only)
+    } HwAccess_t;
+
+    // how to access a hardware feature, resolved at the connection
+    typedef struct
+    {
+        HwAccess_t   eAccess;
+        UCHAR        bus;
+        UCHAR        address;
+        eDAC_Channel eChannel;
+        bool         bInPercent;
+        std::string  selector;
+    } HwHandle_t;
+
+    HwHandle_t mHwHandle[HwFeature_Count];
+
+    // depends on the camera model
+    void _ResolveHwFeatures();
+
+    float _ReadDeviceTemperature(const std::string& selector);
+
+    void _StartTelemetry();
+
+    void _StopTelemetry();
+
+    // last telemetry, or read from the camera if there is none
+    void _GetTemperature(CameraSettings& settings);
+
     void NotifyEvent(Event eEvent);
 
     void onFrameCaptured(int frameIndex);
 
+    // read the frame of the slot (and release the slot)
+    ClassCommon::Error _ReadFrame(int slotIndex, struct RawDataInfo &info, FrameBuffer& frame, QByteArray& stdDev);
+
     ClassCommon::Error _Disconnect();
 
     ClassCommon::Error _Connect(bool bPowerCycle);
@@ -1,6 +1,7 @@
 #include "cameraDummy.h"
 
 #include <QFuture>
+#include <QThread>
 #include <QtConcurrent/qtconcurrentrun.h>
 
 #include "HwTool.h"
@@ -9,10 +10,31 @@
 
 #include "imageConfiguration.h"
 #include "ConoscopeResource.h"
+#include "CoaXpressFrame.h"
+#include "toolRawCodec.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+#include <string.h>
 
 #define PRINT
 
-#define INVALID_FRAME_INDEX -1
+#define SYNTHETIC_LABEL "Synthetic"
+
+#define CAPTURE_FILTER "*.bin"
+
+// wait until dueUs after the start of the timer
+static void _WaitUntil(QElapsedTimer& timer, qint64 dueUs)
+{
+    qint64 waitUs = dueUs - timer.nsecsElapsed() / 1000;
+
+    if(waitUs > 0)
+    {
+        QThread::usleep((unsigned long)waitUs);
+    }
+}
 
 CameraDummy::CameraDummy(QObject *parent) : Camera(parent)
 {
@@ -21,6 +43,18 @@ CameraDummy::CameraDummy(QObject *parent) : Camera(parent)
     mCaptureState = Camera::Status::NotInitialised;
     mCurrentFrameIndex = INVALID_FRAME_INDEX;
 
+    mStreaming        = false;
+    mStreamFrameRate  = 0;
+    mStreamFrameCount = 0;
+    mStreamAverage    = 1;
+
+    mSource      = DummySource_File;
+    mFolderIndex = 0;
+
+    mFrameOffsetY   = 0;
+    mReplayStarted  = false;
+    mReplayOriginUs = 0;
+
     // following may not change
     mFwType.insert("FPGA", CoaXpressGrabber::eFirmwareType::FPGA);
     mFwType.insert("NIOS", CoaXpressGrabber::eFirmwareType::NIOS);
@@ -28,13 +62,81 @@ CameraDummy::CameraDummy(QObject *parent) : Camera(parent)
 
 CameraDummy::~CameraDummy()
 {
+    mMeasurement.waitForFinished();
 }
 
 ClassCommon::Error CameraDummy::LoadRawImage(QString path, QMap<QString, QVariant>& settings)
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    mDummyRawImagePath = path;
+    QFileInfo pathInfo(path);
+
+    if(pathInfo.isDir() == true)
+    {
+        mSource = DummySource_Folder;
+
+        QStringList captureList = QDir(path).entryList(QStringList() << CAPTURE_FILTER, QDir::Files, QDir::Name);
+
+        if(captureList.isEmpty() == true)
+        {
+            return ClassCommon::Error::Failed;
+        }
+
+        mFolderIndex = mFolderIndex % captureList.count();
+
+        mDummyRawImagePath = QDir(path).filePath(captureList.at(mFolderIndex));
+        mFolderIndex ++;
+    }
+    else if(pathInfo.suffix() == "json")
+    {
+        mSource = DummySource_Synthetic;
+
+        eError = _ReadSyntheticConfig(path);
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            const SyntheticConfig_t& config = mSynthetic.GetConfig();
+
+            mHwValueMap["HotTemperature"]  = config.sensorTemperature;
+            mHwValueMap["ColdTemperature"] = config.sensorTemperature;
+            mHwValueMap["CmosTemperature"] = config.sensorTemperature;
+
+            mHwValueMap["AdcITec"] = 2;
+
+            mRawDataInfo.cameraSerialNumber = SYNTHETIC_LABEL;
+        }
+
+        // the measurement configuration is the one requested
+        return eError;
+    }
+    else if(pathInfo.suffix() == RECORD_EXTENSION)
+    {
+        mSource = DummySource_Recording;
+
+        // the replay goes on from the last acquisition replayed
+        if((mReplay.IsOpen() == false) || (mDummyRawImagePath != path))
+        {
+            mReplayStarted = false;
+
+            if(mReplay.Open(path) == false)
+            {
+                return ClassCommon::Error::Failed;
+            }
+
+            mDummyRawImagePath = path;
+        }
+
+        mRawDataInfo.cameraSerialNumber = pathInfo.baseName();
+
+        // the measurement configuration is the one requested
+        return eError;
+    }
+    else
+    {
+        mSource = DummySource_File;
+
+        mDummyRawImagePath = path;
+    }
 
     eError = _ReadImageFile(
                 mDummyRawImagePath,
@@ -69,6 +171,44 @@ ClassCommon::Error CameraDummy::LoadRawImage(QString path, QMap<QString, QVarian
     return eError;
 }
 
+bool CameraDummy::HasCaptureSettings()
+{
+    return ((mSource == DummySource_File) || (mSource == DummySource_Folder)) ? true : false;
+}
+
+bool CameraDummy::_IsAccumulated()
+{
+    return ((mSource == DummySource_Synthetic) || (mSource == DummySource_Recording)) ? true : false;
+}
+
+ClassCommon::Error CameraDummy::_ReadSyntheticConfig(QString filePath)
+{
+    QFile file(filePath);
+
+    if(file.open(QIODevice::ReadOnly | QIODevice::Text) == false)
+    {
+        return ClassCommon::Error::Failed;
+    }
+
+    QJsonObject jsonObject = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    if(jsonObject.contains(SYNTHETIC_LABEL) == false)
+    {
+        return ClassCommon::Error::InvalidConfiguration;
+    }
+
+    SyntheticConfig_t config = SyntheticFrame::ReadConfig(jsonObject[SYNTHETIC_LABEL].toObject());
+
+    // the precomputed images are kept while the description does not change
+    if(memcmp(&config, &mSynthetic.GetConfig(), sizeof(SyntheticConfig_t)) != 0)
+    {
+        mSynthetic.SetConfig(config);
+    }
+
+    return ClassCommon::Error::Ok;
+}
+
 bool CameraDummy::IsConnected()
 {
     return(eState == CameraState_Connected) ? true : false;
@@ -193,6 +333,8 @@ ClassCommon::Error CameraDummy::_Connect(bool)
 
 ClassCommon::Error CameraDummy::_Disconnect()
 {
+    mMeasurement.waitForFinished();
+
     mCaptureState = Camera::Status::NotInitialised;
     return ClassCommon::Error::Ok;
 }
@@ -294,6 +436,44 @@ ClassCommon::Error CameraDummy::Configure(struct CaptureConfig* pConfig)
 
     if(mCaptureState == Camera::Status::Ready)
     {
+        mCaptureConfig = *pConfig;
+
+        if(_IsAccumulated() == true)
+        {
+            ImageFeature frameFeature;
+
+            if(mSource == DummySource_Recording)
+            {
+                // frames of the recorded camera
+                frameFeature = mReplay.GetFrameFeature();
+            }
+            else
+            {
+                // same frames as the CriticalLink camera (without the blanking lines)
+                frameFeature.width               = IMAGE_WIDTH;
+                frameFeature.height              = IMAGE_HEIGHT;
+                frameFeature.eFormat             = PixelFormat_Mono12;
+                frameFeature.eCameraManufacturer = CameraManufacturer_CriticalLink;
+
+                mSyntheticImage.resize((size_t)IMAGE_WIDTH * IMAGE_HEIGHT);
+            }
+
+            if((mFrameFeature.width   != frameFeature.width) ||
+               (mFrameFeature.height  != frameFeature.height) ||
+               (mFrameFeature.eFormat != frameFeature.eFormat))
+            {
+                mFrameFeature = frameFeature;
+
+                CoaXpressFrame::SetFrameSize(mFrameFeature);
+            }
+
+            // the sensor frame of the CriticalLink camera starts with blanking lines
+            mFrameOffsetY = ((mFrameFeature.eCameraManufacturer == CameraManufacturer_CriticalLink) &&
+                             (mFrameFeature.height > IMAGE_HEIGHT)) ? CRITICAL_LINK_VERTICAL_OFFSET : 0;
+
+            CoaXpressFrame::SetAccumulationArea(pConfig->mcAccumulationArea.translated(0, mFrameOffsetY));
+        }
+
         // configure the camera according to the parameters
         CoaXpressGrabber_Config config;
 
@@ -337,6 +517,21 @@ ClassCommon::Error CameraDummy::StartMeasurement()
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
+    // the replayed capture is already there
+    if(_IsAccumulated() == true)
+    {
+        if(mCaptureState == Camera::Status::Ready)
+        {
+            mCaptureState = Camera::Status::MeasurementPending;
+
+            mMeasurement = QtConcurrent::run(this, &CameraDummy::_Measure, mCaptureConfig.mnNumImages);
+        }
+        else
+        {
+            eError = ClassCommon::Error::InvalidState;
+        }
+    }
+
     return eError;
 }
 
@@ -344,22 +539,305 @@ ClassCommon::Error CameraDummy::StopMeasurement()
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
+    mMeasurement.waitForFinished();
+
+    if(mCurrentFrameIndex != INVALID_FRAME_INDEX)
+    {
+        // the frame is not read
+        CoaXpressFrame::ReleaseImage(mCurrentFrameIndex);
+        mCurrentFrameIndex = INVALID_FRAME_INDEX;
+    }
+
+    if((mCaptureState == Camera::Status::MeasurementDone) ||
+       (mCaptureState == Camera::Status::Fault))
+    {
+        mCaptureState = Camera::Status::Ready;
+    }
+
     return eError;
 }
 
+int CameraDummy::_Capture(int imageNumber)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int frameIndex = CoaXpressFrame::GetImageIndex();
+
+    if(frameIndex == INVALID_FRAME_INDEX)
+    {
+        return INVALID_FRAME_INDEX;
+    }
+
+    int exposureUs = mCaptureConfig.mnExposureMicros;
+    int periodUs   = mSynthetic.GetImagePeriodUs(exposureUs);
+
+    ImageBuffer imageBuffer;
+
+    imageBuffer.ptr     = mSyntheticImage.data();
+    imageBuffer.bufSize = mSyntheticImage.size() * sizeof(uint16_t);
+    imageBuffer.width   = mFrameFeature.width;
+    imageBuffer.height  = mFrameFeature.height;
+
+    for(int imageIndex = 0; imageIndex < imageNumber; imageIndex ++)
+    {
+        if(mSource == DummySource_Recording)
+        {
+            if(_ReplayBuffer(imageBuffer) == false)
+            {
+                CoaXpressFrame::ReleaseImage(frameIndex);
+                return INVALID_FRAME_INDEX;
+            }
+        }
+        else
+        {
+            mSynthetic.Generate(imageBuffer.width, imageBuffer.height, exposureUs, mSyntheticImage.data());
+
+            // an image is delivered at the end of its period
+            _WaitUntil(timer, (qint64)(imageIndex + 1) * periodUs);
+        }
+
+        CoaXpressFrame::AppendImage(frameIndex, imageBuffer);
+    }
+
+    if(mSource == DummySource_Synthetic)
+    {
+        _WaitUntil(timer, (qint64)imageNumber * periodUs + (qint64)mSynthetic.GetConfig().readoutMs * 1000);
+    }
+
+    CoaXpressFrame::SetImageReady(frameIndex);
+
+    return frameIndex;
+}
+
+bool CameraDummy::_ReplayBuffer(ImageBuffer& imageBuffer)
+{
+    CoaXpressRecordBuffer_t buffer;
+
+    if((mReplayStarted == false) || (mReplay.NextBuffer(buffer) == false))
+    {
+        // next acquisition of the recording
+        int imageNumber;
+        QStringList features;
+
+        if(mReplay.NextStart(imageNumber, mReplayOriginUs, features) == false)
+        {
+            return false;
+        }
+
+        if(features.isEmpty() == false)
+        {
+            _LogInFile("[Replay]", features.join(", "));
+        }
+
+        mReplayTimer.start();
+        mReplayStarted = true;
+
+        if(mReplay.NextBuffer(buffer) == false)
+        {
+            // acquisition without buffer
+            mReplayStarted = false;
+            return false;
+        }
+    }
+
+    size_t bufSize = (size_t)buffer.lineBytes * buffer.height;
+
+    if(mReplayImage.size() != bufSize)
+    {
+        mReplayImage.assign(bufSize, 0);
+    }
+
+    // the lines that are not recorded are copies of the previous recorded line
+    // (the previous image is kept when the contents are not recorded)
+    if(buffer.lineStep > 0)
+    {
+        int lineCount = (buffer.height + buffer.lineStep - 1) / buffer.lineStep;
+
+        if(buffer.data.size() == lineCount * buffer.lineBytes)
+        {
+            for(int lineIndex = 0; lineIndex < buffer.height; lineIndex ++)
+            {
+                memcpy(&mReplayImage[(size_t)lineIndex * buffer.lineBytes],
+                       buffer.data.constData() + (size_t)(lineIndex / buffer.lineStep) * buffer.lineBytes,
+                       buffer.lineBytes);
+            }
+        }
+    }
+
+    imageBuffer.ptr     = mReplayImage.data();
+    imageBuffer.bufSize = bufSize;
+    imageBuffer.width   = buffer.width;
+    imageBuffer.height  = buffer.height;
+
+    // the buffer is delivered at the same time after the start as when it was recorded
+    _WaitUntil(mReplayTimer, buffer.timeUs - mReplayOriginUs);
+
+    return true;
+}
+
+void CameraDummy::_Measure(int imageNumber)
+{
+    // each measurement replays an acquisition of the recording
+    mReplayStarted = false;
+
+    mCurrentFrameIndex = _Capture(imageNumber);
+
+    mCaptureState = (mCurrentFrameIndex != INVALID_FRAME_INDEX) ? Camera::Status::MeasurementDone : Camera::Status::Fault;
+
+    _NotifyMeasurement();
+}
+
+ClassCommon::Error CameraDummy::_ReadFrame(int slotIndex, struct RawDataInfo &info, FrameBuffer& frame)
+{
+    ImageFrame* pFrame = CoaXpressFrame::GetImage(slotIndex);
+
+    if(pFrame == NULL)
+    {
+        return ClassCommon::Error::InvalidParameter;
+    }
+
+    QRect area = info.cropArea;
+
+    if(area.isEmpty() == true)
+    {
+        area = QRect(0, 0,
+                     qMin(pFrame->mFeature.width, IMAGE_WIDTH),
+                     qMin(pFrame->mFeature.height - mFrameOffsetY, IMAGE_HEIGHT));
+    }
+
+    area.translate(0, mFrameOffsetY);
+
+    bool bRead = CoaXpressFrame::ReadImage(slotIndex, area, frame);
+
+    CoaXpressFrame::ReleaseImage(slotIndex);
+
+    info.miLines = frame.GetHeight();
+    info.miCols  = frame.GetWidth();
+
+    return (bRead == true) ? ClassCommon::Error::Ok : ClassCommon::Error::Failed;
+}
+
 ClassCommon::Error CameraDummy::GetPulse(struct Pulse*){
     return ClassCommon::Error::Ok;
 }
 
-ClassCommon::Error CameraDummy::GetRawData(struct RawDataInfo&, QByteArray& arr, QByteArray&)
+ClassCommon::Error CameraDummy::GetRawData(struct RawDataInfo& info, FrameBuffer& frame, QByteArray&)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(_IsAccumulated() == false)
+    {
+        frame = mRawData;
+    }
+    else if(mCaptureState == Camera::Status::MeasurementDone)
+    {
+        eError = _ReadFrame(mCurrentFrameIndex, info, frame);
+
+        mCurrentFrameIndex = INVALID_FRAME_INDEX;
+        mCaptureState = Camera::Status::Ready;
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraDummy::StreamStart(int averageNumber)
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    arr = mRawData;
+    if(mStreaming == false)
+    {
+        mStreaming = true;
+        mStreamAverage = (averageNumber > 0) ? averageNumber : 1;
+        mReplayStarted = false;
+        mStreamFrameCount = 0;
+        mStreamTimer.start();
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error CameraDummy::StreamRead(struct RawDataInfo &info, FrameBuffer& frame, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mStreaming == false)
+    {
+        return ClassCommon::Error::InvalidState;
+    }
+
+    if(_IsAccumulated() == true)
+    {
+        // the synthetic sensor or the recording gives the pace
+        int frameIndex = _Capture(mStreamAverage);
+
+        if(frameIndex == INVALID_FRAME_INDEX)
+        {
+            return ClassCommon::Error::Failed;
+        }
+
+        mStreamFrameCount ++;
+
+        return _ReadFrame(frameIndex, info, frame);
+    }
+
+    if(mStreamFrameRate > 0)
+    {
+        // time when the next frame is delivered
+        qint64 dueMs  = (qint64)((double)mStreamFrameCount * 1000.0 / mStreamFrameRate);
+        qint64 waitMs = dueMs - mStreamTimer.elapsed();
+
+        if(waitMs > timeoutMs)
+        {
+            QThread::msleep(timeoutMs);
+            return ClassCommon::Error::Timeout;
+        }
+
+        if(waitMs > 0)
+        {
+            QThread::msleep((unsigned long)waitMs);
+        }
+    }
+
+    mStreamFrameCount ++;
+
+    frame = mRawData;
+
+    info.miLines = frame.GetHeight();
+    info.miCols  = frame.GetWidth();
 
     return eError;
 }
 
+ClassCommon::Error CameraDummy::StreamStop()
+{
+    mStreaming = false;
+
+    return ClassCommon::Error::Ok;
+}
+
+ClassCommon::Error CameraDummy::SetExposureTime(int& exposureUs)
+{
+    // the same image is replayed whatever the exposure time
+    // generated images use the exposure time of the next capture
+    mCaptureConfig.mnExposureMicros = exposureUs;
+
+    return ClassCommon::Error::Ok;
+}
+
+void CameraDummy::SetStreamFrameRate(float frameRate)
+{
+    mStreamFrameRate = frameRate;
+}
+
 #ifndef COAXPRESS_FRAME_AVERAGE
 void CameraDummy::UpdateCaptureConfiguration(
             int& numberReads, int& numberCaptures)
@@ -800,19 +1278,15 @@ void CameraDummy::SetHw(QString hwDeviceName, QString hwFeature, float value, in
 
 ClassCommon::Error CameraDummy::_ReadImageFile(
         QString acFilename,
-        QByteArray& imgData,
+        FrameBuffer& imgData,
         ImageInfoRead_t& info)
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
     QFile ff(QString("%1").arg(acFilename));
 
-    if(ff.exists() && ff.open(QFile::ReadOnly))
-    {
-        imgData = ff.readAll();
-        ff.close();
-    }
-    else
+    // the image width is in the json file, the data is read after it
+    if((ff.exists() == false) || (ff.open(QFile::ReadOnly) == false))
     {
         //writeInfo(QString("Image does not exist or couldn't be open: %1").arg(acFilename));
         eError = ClassCommon::Error::Failed;
@@ -844,6 +1318,28 @@ ClassCommon::Error CameraDummy::_ReadImageFile(
         eError = _ReadImageInfo(rawFileName, info);
     }
 
+    if(eError == ClassCommon::Error::Ok)
+    {
+        // a 16 bits file is mapped in the frame buffer (not read), a container is decoded
+        int size = (int)ff.size();
+        int width = info.cameraWidth;
+
+        if((width <= 0) || ((size % (width * (int)sizeof(uint16_t))) != 0))
+        {
+            // unknown width, the data is read as a single line
+            width = 0;
+        }
+
+        imgData = RawCodec::ReadFile(acFilename, width);
+
+        if(imgData.IsNull() == true)
+        {
+            eError = ClassCommon::Error::Failed;
+        }
+    }
+
+    ff.close();
+
     return eError;
 }
 
@@ -2,8 +2,11 @@
 #define CAMERA_DUMMY_H
 
 #include <QMap>
+#include <QElapsedTimer>
+#include <QFuture>
 
 #include "camera.h"
+#include "syntheticFrame.h"
 
 #include <EGenTL.h>
 #include <EGrabber.h>
@@ -13,6 +16,7 @@
 #define USE_CUSTOM_GRABBER
 #ifdef USE_CUSTOM_GRABBER
 #include "CoaXpressGrabber.h"
+#include "CoaXpressRecord.h"
 #endif
 
 #include <QMap>
@@ -40,8 +44,19 @@ public:
 
     ~CameraDummy();
 
+    // path of the source of the images
+    //   capture (.bin):     the capture is replayed
+    //   folder:             the captures of the folder are replayed one after the other
+    //   description (.json with a "Synthetic" object): the images are generated (SyntheticFrame)
+    //                       and averaged by CoaXpressFrame like the images of a camera
+    //   recording (.cxprec): the buffers recorded by CoaXpressRecorder are delivered at the
+    //                       recorded time and averaged by CoaXpressFrame
     Error LoadRawImage(QString path, QMap<QString, QVariant> &settings);
 
+    // the measurement configuration comes from the loaded capture
+    // (false for generated images and recordings: the requested configuration is used)
+    bool HasCaptureSettings();
+
     bool IsConnected();
 
     bool IsFileTransferSupported();
@@ -96,7 +111,21 @@ public:
 
     ClassCommon::Error GetStatus(enum Status& eStatus);
 
-    ClassCommon::Error GetRawData(struct RawDataInfo &info, QByteArray& arr, QByteArray &stdDev);
+    ClassCommon::Error GetRawData(struct RawDataInfo &info, FrameBuffer& frame, QByteArray &stdDev);
+
+    // the loaded raw image is replayed at the stream frame rate
+    // (generated images are delivered at the rate of the synthetic sensor,
+    // recorded buffers at their recorded time)
+    ClassCommon::Error StreamStart(int averageNumber);
+
+    ClassCommon::Error StreamRead(struct RawDataInfo &info, FrameBuffer& frame, int timeoutMs);
+
+    ClassCommon::Error StreamStop();
+
+    ClassCommon::Error SetExposureTime(int& exposureUs);
+
+    // frames per second delivered by the stream (0 means as fast as possible)
+    void SetStreamFrameRate(float frameRate);
 
 #ifndef COAXPRESS_FRAME_AVERAGE
     void UpdateCaptureConfiguration(
@@ -227,16 +256,63 @@ private:
     } ImageInfoRead_t;
 
     QString mDummyRawImagePath;
-    QByteArray mRawData;
+    FrameBuffer mRawData; // shared by all the measurements
     ImageInfoRead_t mRawDataInfo;
 
+    bool          mStreaming;
+    float         mStreamFrameRate;
+    QElapsedTimer mStreamTimer;
+    qint64        mStreamFrameCount;
+    int           mStreamAverage;
+
+    typedef enum
+    {
+        DummySource_File,
+        DummySource_Folder,
+        DummySource_Synthetic,
+        DummySource_Recording
+    } DummySource_t;
+
+    DummySource_t mSource;
+    int           mFolderIndex; // next capture of the folder
+
+    SyntheticFrame        mSynthetic;
+    std::vector<uint16_t> mSyntheticImage;
+    CaptureConfig         mCaptureConfig;
+    ImageFeature          mFrameFeature; // size of the CoaXpressFrame slots
+    int                   mFrameOffsetY; // blanking lines at the top of the frame
+    QFuture<void>         mMeasurement;
+
+    CoaXpressReplay      mReplay;
+    std::vector<uint8_t> mReplayImage;
+    bool                 mReplayStarted;  // an acquisition of the recording is being replayed
+    qint64               mReplayOriginUs; // recorded start of this acquisition
+    QElapsedTimer        mReplayTimer;
+
+    // the images are averaged in CoaXpressFrame (generated or recorded)
+    bool _IsAccumulated();
+
+    ClassCommon::Error _ReadSyntheticConfig(QString filePath);
+
+    // generate and average the images in a CoaXpressFrame slot (INVALID_FRAME_INDEX on failure)
+    int _Capture(int imageNumber);
+
+    // next recorded buffer, returned at its recorded time of arrival
+    bool _ReplayBuffer(ImageBuffer& imageBuffer);
+
+    // capture done in background by StartMeasurement
+    void _Measure(int imageNumber);
+
+    // read the slot (and release it)
+    ClassCommon::Error _ReadFrame(int slotIndex, struct RawDataInfo &info, FrameBuffer& frame);
+
     QMap<QString, float> mFloatValueMap;
     QMap<QString, float> mHwValueMap;
 
 
     ClassCommon::Error _ReadImageFile(
             QString acFilename,
-            QByteArray& imgData,
+            FrameBuffer& imgData,
             ImageInfoRead_t& info);
 
     ClassCommon::Error _ReadImageInfo(
@@ -0,0 +1,64 @@
+#include "cameraHwFeature.h"
+
+#include <QHash>
+
+typedef struct
+{
+    const char* device;
+    const char* feature;
+} HwFeatureName_t;
+
+// same order as HwFeature_t
+static const HwFeatureName_t hwFeatureNames[HwFeature_Count] =
+{
+    {"TEC",    "HotTemperature"},
+    {"TEC",    "AdcITec"},
+    {"TEC",    "VTec"},
+    {"TEC",    "DacOutput"},
+    {"TEC",    "AdcVin"},
+    {"TEC",    "Adc5V"},
+    {"TEC",    "Adc3V3"},
+    {"Sensor", "ColdTemperature"},
+    {"Sensor", "CmosTemperature"},
+    {"Fan",    "Speed"},
+};
+
+static QString _GetKey(QString hwDeviceName, QString hwFeature)
+{
+    return QString("%1/%2").arg(hwDeviceName).arg(hwFeature);
+}
+
+static QHash<QString, HwFeature_t> _BuildFeatureMap()
+{
+    QHash<QString, HwFeature_t> map;
+
+    for(int index = 0; index < HwFeature_Count; index ++)
+    {
+        map.insert(_GetKey(hwFeatureNames[index].device, hwFeatureNames[index].feature), (HwFeature_t)index);
+    }
+
+    return map;
+}
+
+HwFeature_t CameraHwFeature::Get(QString hwDeviceName, QString hwFeature)
+{
+    // built at the first call
+    static const QHash<QString, HwFeature_t> featureMap = _BuildFeatureMap();
+
+    return featureMap.value(_GetKey(hwDeviceName, hwFeature), HwFeature_Invalid);
+}
+
+QString CameraHwFeature::GetDeviceName(HwFeature_t eFeature)
+{
+    return ((int)eFeature < HwFeature_Count) ? QString(hwFeatureNames[eFeature].device) : QString();
+}
+
+QString CameraHwFeature::GetFeatureName(HwFeature_t eFeature)
+{
+    return ((int)eFeature < HwFeature_Count) ? QString(hwFeatureNames[eFeature].feature) : QString();
+}
+
+QString CameraHwFeature::GetName(HwFeature_t eFeature)
+{
+    return _GetKey(GetDeviceName(eFeature), GetFeatureName(eFeature));
+}
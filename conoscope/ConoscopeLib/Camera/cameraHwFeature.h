@@ -0,0 +1,46 @@
+#ifndef CAMERA_HW_FEATURE_H
+#define CAMERA_HW_FEATURE_H
+
+#include <QString>
+
+// value returned when a hardware feature can not be read
+#define HW_INVALID_VALUE -255.0f
+
+typedef enum
+{
+    HwFeature_TecHotTemperature,
+    HwFeature_TecAdcITec,
+    HwFeature_TecVTec,
+    HwFeature_TecDacOutput,
+    HwFeature_TecAdcVin,
+    HwFeature_TecAdc5V,
+    HwFeature_TecAdc3V3,
+    HwFeature_SensorColdTemperature,
+    HwFeature_SensorCmosTemperature,
+    HwFeature_FanSpeed,
+    HwFeature_Count,
+    HwFeature_Invalid = HwFeature_Count
+} HwFeature_t;
+
+/* Class CameraHwFeature
+ * names of the hardware features (GetHw / SetHw string interface)
+ *
+ * the string interface is kept for compatibility, the names are resolved once
+ * into an HwFeature_t that the cameras use to access the feature.
+ */
+
+class CameraHwFeature
+{
+public:
+    // HwFeature_Invalid if the feature is unknown
+    static HwFeature_t Get(QString hwDeviceName, QString hwFeature);
+
+    static QString GetDeviceName(HwFeature_t eFeature);
+
+    static QString GetFeatureName(HwFeature_t eFeature);
+
+    // "device/feature"
+    static QString GetName(HwFeature_t eFeature);
+};
+
+#endif // CAMERA_HW_FEATURE_H
@@ -0,0 +1,75 @@
+#include "cameraTelemetry.h"
+
+#include <QMutexLocker>
+#include <QDateTime>
+
+#include "camera.h"
+
+CameraTelemetry::CameraTelemetry(Camera* camera, int periodMs, QObject *parent)
+    : QThread(parent)
+{
+    mCamera   = camera;
+    mPeriodMs = periodMs;
+
+    mStopRequest = false;
+}
+
+CameraTelemetry::~CameraTelemetry()
+{
+    RequestStop();
+    wait();
+}
+
+void CameraTelemetry::RequestStop()
+{
+    QMutexLocker locker(&mMutex);
+
+    mStopRequest = true;
+
+    // do not wait for the end of the period
+    mStopCondition.wakeAll();
+}
+
+bool CameraTelemetry::Get(CameraTelemetry_t& telemetry) const
+{
+    std::shared_ptr<const CameraTelemetry_t> last = std::atomic_load(&mTelemetry);
+
+    if(!last)
+    {
+        return false;
+    }
+
+    telemetry = *last;
+
+    return true;
+}
+
+void CameraTelemetry::_Refresh()
+{
+    std::shared_ptr<CameraTelemetry_t> telemetry = std::make_shared<CameraTelemetry_t>();
+
+    // not read during a capture or a stream (the last values are kept)
+    if(mCamera->RefreshTelemetry(*telemetry) == ClassCommon::Error::Ok)
+    {
+        telemetry->timeStampMs = QDateTime::currentMSecsSinceEpoch();
+
+        std::atomic_store(&mTelemetry, std::shared_ptr<const CameraTelemetry_t>(telemetry));
+    }
+}
+
+void CameraTelemetry::run()
+{
+    QMutexLocker locker(&mMutex);
+
+    while(mStopRequest == false)
+    {
+        locker.unlock();
+        _Refresh();
+        locker.relock();
+
+        if(mStopRequest == false)
+        {
+            mStopCondition.wait(&mMutex, (unsigned long)mPeriodMs);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CAMERA_TELEMETRY_H
+#define CAMERA_TELEMETRY_H
+
+#include <QThread>
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QMap>
+
+#include <memory>
+
+#include "classcommon.h"
+#include "toolTypes.h"
+#include "cameraHwFeature.h"
+
+// default refresh period of the telemetry
+#define TELEMETRY_PERIOD_MS 1000
+
+class Camera;
+
+typedef struct
+{
+    // temperatures and voltages of the camera (grabber GetTemperature)
+    CameraSettings settings;
+
+    // board values read with GetHw
+    QMap<HwFeature_t, float> hw;
+
+    // time of the read (ms since epoch)
+    qint64 timeStampMs;
+} CameraTelemetry_t;
+
+/* Class CameraTelemetry
+ * read the telemetry of a camera periodically and keep the last values
+ *
+ * the values are published as an immutable snapshot, a reader never waits for the
+ * control channel. The refresh is skipped while a measurement is pending or the
+ * camera is streaming.
+ */
+
+class CameraTelemetry : public QThread
+{
+    Q_OBJECT
+
+public:
+    CameraTelemetry(Camera* camera, int periodMs, QObject *parent = nullptr);
+
+    ~CameraTelemetry();
+
+    // the thread ends after the refresh being done
+    void RequestStop();
+
+    // last values read (false if there is none yet)
+    bool Get(CameraTelemetry_t& telemetry) const;
+
+protected:
+    void run() override;
+
+private:
+    Camera* mCamera;
+    int     mPeriodMs;
+
+    QMutex         mMutex;
+    QWaitCondition mStopCondition;
+    bool           mStopRequest;
+
+    // replaced as a whole at each refresh (atomic_load / atomic_store)
+    std::shared_ptr<const CameraTelemetry_t> mTelemetry;
+
+    void _Refresh();
+};
+
+#endif // CAMERA_TELEMETRY_H
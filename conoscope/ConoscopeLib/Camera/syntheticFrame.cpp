@@ -0,0 +1,235 @@
+#include "syntheticFrame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// 12 bits sensor
+#define SYNTHETIC_MAX_LEVEL 4095
+
+// noise of the readout (ADU)
+#define SYNTHETIC_READ_NOISE 2.0f
+
+// number of samples of the normal distribution (power of 2)
+#define SYNTHETIC_GAUSSIAN_SIZE 65536
+
+// radius of the disc relative to the half of the smallest dimension of the frame
+#define SYNTHETIC_DISC_RADIUS 0.95f
+
+// relative signal of a hot pixel (saturated whatever the exposure time)
+#define SYNTHETIC_HOT_PIXEL 1.0e6f
+
+// 32 bits hash, used to seed the generator of each line
+static inline uint32_t _Hash(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7FEB352D;
+    value ^= value >> 15;
+    value *= 0x846CA68B;
+    value ^= value >> 16;
+
+    return value;
+}
+
+SyntheticFrame::SyntheticFrame()
+{
+    mConfig = ReadConfig(QJsonObject());
+
+    mProfileWidth  = 0;
+    mProfileHeight = 0;
+    mExposureUs    = -1;
+    mImageCount    = 0;
+}
+
+SyntheticConfig_t SyntheticFrame::ReadConfig(const QJsonObject& object)
+{
+    SyntheticConfig_t config;
+
+    QString pattern = object["pattern"].toString("disc");
+
+    if(pattern == "flat")
+    {
+        config.ePattern = SyntheticPattern_Flat;
+    }
+    else if(pattern == "gradient")
+    {
+        config.ePattern = SyntheticPattern_Gradient;
+    }
+    else
+    {
+        config.ePattern = SyntheticPattern_Disc;
+    }
+
+    config.frameRate         = (float)object["frameRate"].toDouble(0);
+    config.readoutMs         = object["readoutMs"].toInt(0);
+    config.darkLevel         = (float)object["darkLevel"].toDouble(40);
+    config.signalPerUs       = (float)object["signalPerUs"].toDouble(0.05);
+    config.defectCount       = object["defectCount"].toInt(0);
+    config.seed              = (unsigned int)object["seed"].toInt(1);
+    config.sensorTemperature = (float)object["sensorTemperature"].toDouble(25);
+
+    return config;
+}
+
+void SyntheticFrame::SetConfig(const SyntheticConfig_t& config)
+{
+    mConfig = config;
+
+    // everything is computed again with the new configuration
+    mProfileWidth  = 0;
+    mProfileHeight = 0;
+    mExposureUs    = -1;
+    mImageCount    = 0;
+
+    mSigma.resize(SYNTHETIC_MAX_LEVEL + 1);
+
+    for(int level = 0; level <= SYNTHETIC_MAX_LEVEL; level ++)
+    {
+        float signal = std::max((float)level - mConfig.darkLevel, 0.0f);
+
+        mSigma[level] = std::sqrt(signal + SYNTHETIC_READ_NOISE * SYNTHETIC_READ_NOISE);
+    }
+
+    std::mt19937 generator(mConfig.seed);
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+
+    mGaussian.resize(SYNTHETIC_GAUSSIAN_SIZE);
+
+    for(int index = 0; index < SYNTHETIC_GAUSSIAN_SIZE; index ++)
+    {
+        mGaussian[index] = distribution(generator);
+    }
+}
+
+const SyntheticConfig_t& SyntheticFrame::GetConfig() const
+{
+    return mConfig;
+}
+
+int SyntheticFrame::GetImagePeriodUs(int exposureUs) const
+{
+    int periodUs = 0;
+
+    if(mConfig.frameRate > 0)
+    {
+        periodUs = (int)(1000000.0f / mConfig.frameRate);
+    }
+
+    return std::max(periodUs, exposureUs);
+}
+
+void SyntheticFrame::_BuildProfile(int width, int height)
+{
+    mProfile.resize((size_t)width * height);
+
+    float centerX = width / 2.0f;
+    float centerY = height / 2.0f;
+    float radius  = SYNTHETIC_DISC_RADIUS * std::min(width, height) / 2.0f;
+
+#pragma omp parallel for num_threads(4)
+    for(int lineIndex = 0; lineIndex < height; lineIndex ++)
+    {
+        float* pLine = &mProfile[(size_t)lineIndex * width];
+
+        for(int colIndex = 0; colIndex < width; colIndex ++)
+        {
+            float value = 1.0f;
+
+            switch(mConfig.ePattern)
+            {
+            case SyntheticPattern_Flat:
+                break;
+
+            case SyntheticPattern_Gradient:
+                value = 0.5f * colIndex / width + 0.5f * lineIndex / height;
+                break;
+
+            case SyntheticPattern_Disc:
+            {
+                float dx = colIndex - centerX;
+                float dy = lineIndex - centerY;
+                float r2 = (dx * dx + dy * dy) / (radius * radius);
+
+                // the luminance decreases with the viewing angle
+                value = (r2 < 1.0f) ? 1.0f - 0.6f * r2 : 0.0f;
+                break;
+            }
+            }
+
+            pLine[colIndex] = value;
+        }
+    }
+
+    // defects at the same place for a seed
+    std::mt19937 generator(mConfig.seed);
+    std::uniform_int_distribution<size_t> position(0, mProfile.size() - 1);
+
+    for(int index = 0; index < mConfig.defectCount; index ++)
+    {
+        mProfile[position(generator)] = ((index % 2) == 0) ? SYNTHETIC_HOT_PIXEL : 0.0f;
+    }
+
+    mProfileWidth  = width;
+    mProfileHeight = height;
+    mExposureUs    = -1;
+}
+
+void SyntheticFrame::_BuildSignal(int exposureUs)
+{
+    mSignal.resize(mProfile.size());
+
+    float gain = mConfig.signalPerUs * exposureUs;
+    int   count = (int)mProfile.size();
+
+#pragma omp parallel for num_threads(4)
+    for(int index = 0; index < count; index ++)
+    {
+        float level = mConfig.darkLevel + mProfile[index] * gain;
+
+        mSignal[index] = (uint16_t)std::min(std::max(level, 0.0f), (float)SYNTHETIC_MAX_LEVEL);
+    }
+
+    mExposureUs = exposureUs;
+}
+
+void SyntheticFrame::Generate(int width, int height, int exposureUs, uint16_t* pDst)
+{
+    if(mSigma.empty() == true)
+    {
+        SetConfig(mConfig);
+    }
+
+    if((width != mProfileWidth) || (height != mProfileHeight))
+    {
+        _BuildProfile(width, height);
+    }
+
+    if(exposureUs != mExposureUs)
+    {
+        _BuildSignal(exposureUs);
+    }
+
+    uint32_t imageSeed = _Hash(mConfig.seed ^ _Hash(mImageCount ++));
+
+#pragma omp parallel for num_threads(4)
+    for(int lineIndex = 0; lineIndex < height; lineIndex ++)
+    {
+        const uint16_t* pSignal = &mSignal[(size_t)lineIndex * width];
+        uint16_t*       pLine   = &pDst[(size_t)lineIndex * width];
+
+        // xorshift generator of the line
+        uint32_t state = _Hash(imageSeed + (uint32_t)lineIndex) | 1;
+
+        for(int colIndex = 0; colIndex < width; colIndex ++)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            uint16_t signal = pSignal[colIndex];
+            float    level  = signal + mSigma[signal] * mGaussian[state & (SYNTHETIC_GAUSSIAN_SIZE - 1)];
+
+            pLine[colIndex] = (uint16_t)std::min(std::max(level + 0.5f, 0.0f), (float)SYNTHETIC_MAX_LEVEL);
+        }
+    }
+}
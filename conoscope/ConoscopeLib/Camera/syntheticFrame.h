@@ -0,0 +1,84 @@
+#ifndef SYNTHETIC_FRAME_H
+#define SYNTHETIC_FRAME_H
+
+#include <QString>
+#include <QJsonObject>
+
+#include <vector>
+#include <stdint.h>
+
+typedef enum
+{
+    SyntheticPattern_Flat,     // uniform illumination
+    SyntheticPattern_Gradient, // horizontal and vertical ramp
+    SyntheticPattern_Disc      // conoscopic disc centered in the frame
+} SyntheticPattern_t;
+
+typedef struct
+{
+    SyntheticPattern_t ePattern;
+
+    float frameRate;   // images per second of the sensor (0: as fast as the exposure time)
+    int   readoutMs;   // time between the last image and the end of the capture
+
+    float darkLevel;   // ADU without signal
+    float signalPerUs; // ADU per us of exposure of the brightest part of the pattern
+
+    int   defectCount; // hot and dead pixels added to the pattern
+    unsigned int seed;
+
+    float sensorTemperature;
+} SyntheticConfig_t;
+
+/* Class SyntheticFrame
+ * 12 bits images of a procedural pattern with shot noise
+ *
+ * the noiseless image is computed once for a size and an exposure time, the
+ * noise (gaussian approximation of the poisson noise of the signal) is added
+ * to each image. Two images are never the same.
+ */
+
+class SyntheticFrame
+{
+public:
+    SyntheticFrame();
+
+    // default configuration updated with the values of the json object
+    static SyntheticConfig_t ReadConfig(const QJsonObject& object);
+
+    void SetConfig(const SyntheticConfig_t& config);
+
+    const SyntheticConfig_t& GetConfig() const;
+
+    // time the sensor needs for an image
+    int GetImagePeriodUs(int exposureUs) const;
+
+    // pDst is width * height pixels
+    void Generate(int width, int height, int exposureUs, uint16_t* pDst);
+
+private:
+    SyntheticConfig_t mConfig;
+
+    // relative signal of each pixel (0 to 1, defects are out of range)
+    std::vector<float> mProfile;
+    int mProfileWidth;
+    int mProfileHeight;
+
+    // noiseless image of mExposureUs
+    std::vector<uint16_t> mSignal;
+    int mExposureUs;
+
+    // standard deviation of the noise of a signal level
+    std::vector<float> mSigma;
+
+    // samples of the normal distribution
+    std::vector<float> mGaussian;
+
+    uint32_t mImageCount;
+
+    void _BuildProfile(int width, int height);
+
+    void _BuildSignal(int exposureUs);
+};
+
+#endif // SYNTHETIC_FRAME_H
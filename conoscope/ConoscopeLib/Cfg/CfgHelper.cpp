@@ -3,8 +3,14 @@
 #include <QFileInfo>
 #include <QProcess>
 #include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QtEndian>
 
 #include "ConoscopeResource.h"
+#include "toolFrameBuffer.h"
 
 #define LOG_HEADER "[cfgHelper]"
 #define LogInFile(text) RESOURCE->AppendLog(QString("%1 | %2").arg(LOG_HEADER, -20).arg(text))
@@ -14,6 +20,155 @@
 
 #define CONVERT_TO_QSTRING(a) QString::fromUtf8(a.c_str())
 
+// "CCAL"
+#define CFG_CACHE_MAGIC   0x4C414343
+// 2: the flat field of a previous camera is not cached anymore
+#define CFG_CACHE_VERSION 2
+
+#define CFG_CACHE_HEADER_SIZE 64
+#define CFG_CACHE_ALIGNMENT   64
+
+typedef enum
+{
+    CfgCacheSection_Meta,          // the fields of the cfg (QDataStream)
+    CfgCacheSection_Prnu,          // int16 per pixel
+    CfgCacheSection_Defects,       // x (16 bits), y (16 bits), type (32 bits) per pixel
+    CfgCacheSection_Linearization, // A1, A3, A5, A7, A9 (float)
+    CfgCacheSection_FlatField,     // int16 per pixel
+    CfgCacheSection_Count
+} CfgCacheSection_t;
+
+// fields of the cfg which are not in an array
+#define CFG_CACHE_FIELDS(FIELD) \
+    FIELD(calibrationStep.value) \
+    FIELD(equipement.type) \
+    FIELD(equipement.description) \
+    FIELD(equipement.location) \
+    FIELD(equipement.revision) \
+    FIELD(equipement.serialNumber) \
+    FIELD(calibrationSummary.date) \
+    FIELD(calibrationSummary.time) \
+    FIELD(calibrationSummary.comment) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.slope) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.table) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.correctionEnable) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.timeStamp) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.sensorSerialNumber) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.stationSerialNumber) \
+    FIELD(opticalColumnCalibration.sensorTemperatureDependency.calibrationDone) \
+    FIELD(opticalColumnCalibration.captureArea.opticalAxis.X) \
+    FIELD(opticalColumnCalibration.captureArea.opticalAxis.Y) \
+    FIELD(opticalColumnCalibration.captureArea.measurementRadius) \
+    FIELD(opticalColumnCalibration.captureArea.timeStamp) \
+    FIELD(opticalColumnCalibration.captureArea.equipmentSerialNumber) \
+    FIELD(opticalColumnCalibration.captureArea.stationSerialNumber) \
+    FIELD(opticalColumnCalibration.captureArea.calibrationDone) \
+    FIELD(opticalColumnCalibration.maximumIncidentAngle) \
+    FIELD(opticalColumnCalibration.calibratedDataRadius) \
+    FIELD(opticalColumnCalibration.linearizationCoefficients.timeStamp) \
+    FIELD(opticalColumnCalibration.linearizationCoefficients.equipmentSerialNumber) \
+    FIELD(opticalColumnCalibration.linearizationCoefficients.stationSerialNumber) \
+    FIELD(opticalColumnCalibration.linearizationCoefficients.calibrationDone) \
+    FIELD(opticalColumnCalibration.flatField.isCalibrated) \
+    FIELD(opticalColumnCalibration.flatField.conversionFactor) \
+    FIELD(opticalColumnCalibration.flatField.maximumIncidentAngle) \
+    FIELD(opticalColumnCalibration.flatField.radius) \
+    FIELD(opticalColumnCalibration.flatField.maxBinaryValue) \
+    FIELD(opticalColumnCalibration.flatField.saturationOccurs) \
+    FIELD(opticalColumnCalibration.flatField.timeStamp) \
+    FIELD(opticalColumnCalibration.flatField.sensorTemperature) \
+    FIELD(opticalColumnCalibration.flatField.equipmentSerialNumber) \
+    FIELD(opticalColumnCalibration.flatField.stationSerialNumber) \
+    FIELD(opticalColumnCalibration.flatField.calibrationDone) \
+    FIELD(opticalColumnCalibration.conversionFactor.value) \
+    FIELD(opticalColumnCalibration.conversionFactor.sensorTemperature) \
+    FIELD(opticalColumnCalibration.conversionFactor.timeStamp) \
+    FIELD(opticalColumnCalibration.conversionFactor.equipmentSerialNumber) \
+    FIELD(opticalColumnCalibration.conversionFactor.stationSerialNumber) \
+    FIELD(opticalColumnCalibration.conversionFactor.calibrationDone) \
+    FIELD(cameraPipeline.biasMode.mode) \
+    FIELD(cameraPipeline.biasMode.compensationEnabled) \
+    FIELD(cameraPipeline.sensorSaturation.value) \
+    FIELD(cameraPipeline.sensorSaturation.sensorTemperature) \
+    FIELD(cameraPipeline.sensorSaturation.timeStamp) \
+    FIELD(cameraPipeline.sensorSaturation.sensorSerialNumber) \
+    FIELD(cameraPipeline.sensorSaturation.stationSerialNumber) \
+    FIELD(cameraPipeline.sensorSaturation.calibrationDone) \
+    FIELD(cameraPipeline.sensorDefects.correctionEnabled) \
+    FIELD(cameraPipeline.sensorDefects.sensorTemperature) \
+    FIELD(cameraPipeline.sensorDefects.timeStamp) \
+    FIELD(cameraPipeline.sensorDefects.sensorSerialNumber) \
+    FIELD(cameraPipeline.sensorDefects.stationSerialNumber) \
+    FIELD(cameraPipeline.sensorDefects.calibrationDone) \
+    FIELD(cameraPipeline.sensorPrnu.captureSize.width) \
+    FIELD(cameraPipeline.sensorPrnu.captureSize.height) \
+    FIELD(cameraPipeline.sensorPrnu.scaleFactor) \
+    FIELD(cameraPipeline.sensorPrnu.correctionEnabled) \
+    FIELD(cameraPipeline.sensorPrnu.sensorTemperature) \
+    FIELD(cameraPipeline.sensorPrnu.timeStamp) \
+    FIELD(cameraPipeline.sensorPrnu.sensorSerialNumber) \
+    FIELD(cameraPipeline.sensorPrnu.stationSerialNumber) \
+    FIELD(cameraPipeline.sensorPrnu.calibrationDone) \
+    FIELD(currentGain.value)
+
+template<typename T>
+static void CacheWrite(QDataStream& stream, const T& value)
+{
+    stream << value;
+}
+
+static void CacheWrite(QDataStream& stream, const std::string& value)
+{
+    stream << QString::fromStdString(value);
+}
+
+static void CacheWrite(QDataStream& stream, const long& value)
+{
+    stream << (qint64)value;
+}
+
+static void CacheWrite(QDataStream& stream, const BiasMode_t& value)
+{
+    stream << (qint32)value;
+}
+
+static void CacheWrite(QDataStream& stream, const SensorTemperature_t& value)
+{
+    stream << value.die.current << value.die.averaged << value.heatsink;
+}
+
+template<typename T>
+static void CacheRead(QDataStream& stream, T& value)
+{
+    stream >> value;
+}
+
+static void CacheRead(QDataStream& stream, std::string& value)
+{
+    QString text;
+    stream >> text;
+    value = text.toStdString();
+}
+
+static void CacheRead(QDataStream& stream, long& value)
+{
+    qint64 data;
+    stream >> data;
+    value = (long)data;
+}
+
+static void CacheRead(QDataStream& stream, BiasMode_t& value)
+{
+    qint32 data;
+    stream >> data;
+    value = (BiasMode_t)data;
+}
+
+static void CacheRead(QDataStream& stream, SensorTemperature_t& value)
+{
+    stream >> value.die.current >> value.die.averaged >> value.heatsink;
+}
+
 CfgHelper* CfgHelper::mInstance = nullptr;
 
 #define INSTANCE(instance) CfgHelper* instance = CfgHelper::getInstance()
@@ -56,6 +211,10 @@ bool CfgHelper::_ReadCfgFile(QString fileName, ConfigContent_t& configContent)
 
     _Log("Read config file");
 
+    QString cfgFileName = fileName;
+    QByteArray cfgData;
+    QByteArray checksum;
+
     QFile file(fileName);
     // open the file
     if(!file.open(QIODevice::ReadOnly))
@@ -64,20 +223,32 @@ bool CfgHelper::_ReadCfgFile(QString fileName, ConfigContent_t& configContent)
         LogInFile("Can not read configuration file");
         res = false;
     }
+    else
+    {
+        cfgData = file.readAll();
+        file.close();
+
+        // the cfg is not parsed again while it does not change
+        checksum = QCryptographicHash::hash(cfgData, QCryptographicHash::Sha1);
+
+        if(_ReadCfgCache(cfgFileName, checksum, configContent) == true)
+        {
+            LogInFile(QString("  CameraCfg: read %1").arg(CAMERA_CACHE_PATH(cfgFileName)));
+            return true;
+        }
+    }
 
     QDomDocument cfgConfig("STORMHOLDCONFIGFILE");
 
     // read the content of the file
     if(res == true)
     {
-        if(!cfgConfig.setContent(&file))
+        if(!cfgConfig.setContent(cfgData))
         {
             LogInFile("  CameraCfg: ERROR can not set content file");
             _Log("Can not set contentfile");
             res = false;
         }
-
-        file.close();
     }
 
     if(res == true)
@@ -93,11 +264,15 @@ bool CfgHelper::_ReadCfgFile(QString fileName, ConfigContent_t& configContent)
         QDomElement inEquipment = Content.firstChildElement("Equipment");
         _ReadEquipmentSection(inEquipment, configContent.equipement);
 
-        // Read OpticalColumnCalibration
+        // Read OpticalColumnCalibration (the flat field of the previous camera is replaced)
+        configContent.opticalColumnCalibration.flatField.data.clear();
+
         QDomElement inOpticalColumnCalibration = Content.firstChildElement("OpticalColumnCalibration");
         _ReadOpticalColumnCalibrationSection(inOpticalColumnCalibration, configContent.opticalColumnCalibration);
 
-        // Read CameraPipeLine
+        // Read CameraPipeLine (the defects of the previous camera are replaced)
+        configContent.cameraPipeline.sensorDefects.pixels.clear();
+
         QDomElement inCameraPipeline = Content.firstChildElement("CameraPipeline");
         _ReadCameraPipeLineSection(inCameraPipeline, configContent.cameraPipeline);
 
@@ -139,9 +314,214 @@ bool CfgHelper::_ReadCfgFile(QString fileName, ConfigContent_t& configContent)
         }
     }
 
+    // the next open reads the cache
+    if(res == true)
+    {
+        if(_WriteCfgCache(cfgFileName, checksum, configContent) == false)
+        {
+            LogInFile(QString("  CameraCfg: ERROR can not write %1").arg(CAMERA_CACHE_PATH(cfgFileName)));
+        }
+    }
+
+    return res;
+}
+
+/* calibration cache
+ *
+ * layout (little endian)
+ *   header    magic, version (16 bits), section count (16 bits),
+ *             sha1 of the cfg file (20 bytes), reserved (32 bits),
+ *             size and date (ms) of the prnu file (64 bits each), reserved    64 bytes
+ *   sections  offset (64 bits), size (64 bits)                               16 bytes per section
+ *   data      CFG_CACHE_ALIGNMENT aligned sections
+ *
+ * the cache is mapped, the arrays are copied from the map in the cfg content
+ * (only the arrays read from the cfg and the prnu file, the flat field file is loaded after)
+ */
+bool CfgHelper::_ReadCfgCache(QString fileName, const QByteArray& checksum, ConfigContent_t &configContent)
+{
+    QFile cacheFile(CAMERA_CACHE_PATH(fileName));
+
+    if(cacheFile.open(QIODevice::ReadOnly) == false)
+    {
+        return false;
+    }
+
+    qint64 fileSize = cacheFile.size();
+    qint64 tableSize = CFG_CACHE_HEADER_SIZE + CfgCacheSection_Count * 16;
+
+    uchar* pMap = (fileSize >= tableSize) ? cacheFile.map(0, fileSize) : NULL;
+
+    if(pMap == NULL)
+    {
+        return false;
+    }
+
+    // the prnu file is not part of the cfg
+    QFileInfo prnuFileInfo(CAMERA_PRNU_PATH(QString(fileName)));
+
+    bool res = (qFromLittleEndian<uint32_t>(&pMap[0]) == CFG_CACHE_MAGIC) &&
+               (qFromLittleEndian<uint16_t>(&pMap[4]) == CFG_CACHE_VERSION) &&
+               (qFromLittleEndian<uint16_t>(&pMap[6]) == CfgCacheSection_Count) &&
+               (memcmp(&pMap[8], checksum.constData(), 20) == 0) &&
+               (prnuFileInfo.exists() == true) &&
+               (qFromLittleEndian<qint64>(&pMap[32]) == prnuFileInfo.size()) &&
+               (qFromLittleEndian<qint64>(&pMap[40]) == prnuFileInfo.lastModified().toMSecsSinceEpoch());
+
+    qint64 offset[CfgCacheSection_Count];
+    qint64 size[CfgCacheSection_Count];
+
+    for(int section = 0; (section < CfgCacheSection_Count) && (res == true); section ++)
+    {
+        offset[section] = qFromLittleEndian<qint64>(&pMap[CFG_CACHE_HEADER_SIZE + section * 16]);
+        size[section]   = qFromLittleEndian<qint64>(&pMap[CFG_CACHE_HEADER_SIZE + section * 16 + 8]);
+
+        res = (offset[section] >= tableSize) && (size[section] >= 0) && (offset[section] + size[section] <= fileSize);
+    }
+
+    res = res && (size[CfgCacheSection_Linearization] == 5 * (qint64)sizeof(float)) &&
+                 ((size[CfgCacheSection_Defects] % 8) == 0);
+
+    if(res == true)
+    {
+        QByteArray meta = QByteArray::fromRawData((const char*)&pMap[offset[CfgCacheSection_Meta]], size[CfgCacheSection_Meta]);
+        QDataStream stream(meta);
+        stream.setVersion(QDataStream::Qt_5_12);
+
+#define CFG_CACHE_READ(field) CacheRead(stream, configContent.field);
+        CFG_CACHE_FIELDS(CFG_CACHE_READ)
+#undef CFG_CACHE_READ
+
+        res = (stream.status() == QDataStream::Ok);
+
+        if(res == true)
+        {
+            const uchar* pData = &pMap[offset[CfgCacheSection_Linearization]];
+
+            configContent.opticalColumnCalibration.linearizationCoefficients.A1 = qFromLittleEndian<float>(&pData[0]);
+            configContent.opticalColumnCalibration.linearizationCoefficients.A3 = qFromLittleEndian<float>(&pData[4]);
+            configContent.opticalColumnCalibration.linearizationCoefficients.A5 = qFromLittleEndian<float>(&pData[8]);
+            configContent.opticalColumnCalibration.linearizationCoefficients.A7 = qFromLittleEndian<float>(&pData[12]);
+            configContent.opticalColumnCalibration.linearizationCoefficients.A9 = qFromLittleEndian<float>(&pData[16]);
+
+            pData = &pMap[offset[CfgCacheSection_Defects]];
+            int defectCount = (int)(size[CfgCacheSection_Defects] / 8);
+
+            configContent.cameraPipeline.sensorDefects.pixels.resize(defectCount);
+
+            for(int index = 0; index < defectCount; index ++)
+            {
+                Defect& defect = configContent.cameraPipeline.sensorDefects.pixels[index];
+
+                defect.coord.x = qFromLittleEndian<qint16>(&pData[index * 8]);
+                defect.coord.y = qFromLittleEndian<qint16>(&pData[index * 8 + 2]);
+                defect.type    = (DefectType_t)qFromLittleEndian<qint32>(&pData[index * 8 + 4]);
+            }
+
+            configContent.cameraPipeline.sensorPrnu.data.assign((const char*)&pMap[offset[CfgCacheSection_Prnu]],
+                                                                (const char*)&pMap[offset[CfgCacheSection_Prnu] + size[CfgCacheSection_Prnu]]);
+
+            configContent.opticalColumnCalibration.flatField.data.assign((const char*)&pMap[offset[CfgCacheSection_FlatField]],
+                                                                         (const char*)&pMap[offset[CfgCacheSection_FlatField] + size[CfgCacheSection_FlatField]]);
+        }
+    }
+
+    cacheFile.unmap(pMap);
+
     return res;
 }
 
+bool CfgHelper::_WriteCfgCache(QString fileName, const QByteArray& checksum, const ConfigContent_t &configContent)
+{
+    QByteArray section[CfgCacheSection_Count];
+
+    // fields
+    QDataStream stream(&section[CfgCacheSection_Meta], QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+#define CFG_CACHE_WRITE(field) CacheWrite(stream, configContent.field);
+    CFG_CACHE_FIELDS(CFG_CACHE_WRITE)
+#undef CFG_CACHE_WRITE
+
+    // arrays
+    const std::vector<char>& prnu = configContent.cameraPipeline.sensorPrnu.data;
+    section[CfgCacheSection_Prnu] = QByteArray::fromRawData(prnu.data(), (int)prnu.size());
+
+    const std::vector<char>& flatField = configContent.opticalColumnCalibration.flatField.data;
+    section[CfgCacheSection_FlatField] = QByteArray::fromRawData(flatField.data(), (int)flatField.size());
+
+    const std::vector<Defect>& defects = configContent.cameraPipeline.sensorDefects.pixels;
+    section[CfgCacheSection_Defects].resize((int)defects.size() * 8);
+
+    for(int index = 0; index < (int)defects.size(); index ++)
+    {
+        uchar* pData = (uchar*)section[CfgCacheSection_Defects].data() + index * 8;
+
+        qToLittleEndian<qint16>(defects[index].coord.x,      &pData[0]);
+        qToLittleEndian<qint16>(defects[index].coord.y,      &pData[2]);
+        qToLittleEndian<qint32>((qint32)defects[index].type, &pData[4]);
+    }
+
+    section[CfgCacheSection_Linearization].resize(5 * sizeof(float));
+    uchar* pData = (uchar*)section[CfgCacheSection_Linearization].data();
+
+    qToLittleEndian<float>(configContent.opticalColumnCalibration.linearizationCoefficients.A1, &pData[0]);
+    qToLittleEndian<float>(configContent.opticalColumnCalibration.linearizationCoefficients.A3, &pData[4]);
+    qToLittleEndian<float>(configContent.opticalColumnCalibration.linearizationCoefficients.A5, &pData[8]);
+    qToLittleEndian<float>(configContent.opticalColumnCalibration.linearizationCoefficients.A7, &pData[12]);
+    qToLittleEndian<float>(configContent.opticalColumnCalibration.linearizationCoefficients.A9, &pData[16]);
+
+    // header and section table
+    QFileInfo prnuFileInfo(CAMERA_PRNU_PATH(QString(fileName)));
+
+    QByteArray header(CFG_CACHE_HEADER_SIZE + CfgCacheSection_Count * 16, 0);
+    uchar* pHeader = (uchar*)header.data();
+
+    qToLittleEndian<uint32_t>(CFG_CACHE_MAGIC,       &pHeader[0]);
+    qToLittleEndian<uint16_t>(CFG_CACHE_VERSION,     &pHeader[4]);
+    qToLittleEndian<uint16_t>(CfgCacheSection_Count, &pHeader[6]);
+    memcpy(&pHeader[8], checksum.constData(), qMin(checksum.size(), 20));
+    qToLittleEndian<qint64>(prnuFileInfo.size(),                           &pHeader[32]);
+    qToLittleEndian<qint64>(prnuFileInfo.lastModified().toMSecsSinceEpoch(), &pHeader[40]);
+
+    qint64 offset = header.size();
+
+    for(int index = 0; index < CfgCacheSection_Count; index ++)
+    {
+        offset = (offset + CFG_CACHE_ALIGNMENT - 1) / CFG_CACHE_ALIGNMENT * CFG_CACHE_ALIGNMENT;
+
+        qToLittleEndian<qint64>(offset,                &pHeader[CFG_CACHE_HEADER_SIZE + index * 16]);
+        qToLittleEndian<qint64>(section[index].size(), &pHeader[CFG_CACHE_HEADER_SIZE + index * 16 + 8]);
+
+        offset += section[index].size();
+    }
+
+    // the cache is replaced when it is complete
+    QSaveFile cacheFile(CAMERA_CACHE_PATH(fileName));
+
+    if(cacheFile.open(QIODevice::WriteOnly) == false)
+    {
+        return false;
+    }
+
+    bool res = (cacheFile.write(header) == header.size());
+
+    for(int index = 0; (index < CfgCacheSection_Count) && (res == true); index ++)
+    {
+        qint64 padding = (CFG_CACHE_ALIGNMENT - (cacheFile.pos() % CFG_CACHE_ALIGNMENT)) % CFG_CACHE_ALIGNMENT;
+
+        res = (cacheFile.write(QByteArray((int)padding, 0)) == padding) &&
+              (cacheFile.write(section[index]) == section[index].size());
+    }
+
+    if(res == false)
+    {
+        cacheFile.cancelWriting();
+    }
+
+    return (cacheFile.commit() == true) && (res == true);
+}
+
 bool CfgHelper::_ReadCalibrationStep(QDomElement& inCalibrationStep,
                                     CalibrationStep_t& calibrationStep)
 {
@@ -1174,7 +1554,6 @@ bool CfgHelper::_ReadFlatFieldFile(
         long expectedSize)
 {
     bool res = true;
-    QByteArray buffer;
 
     QFile ff(QString("%1").arg(fileName));
 
@@ -1184,13 +1563,20 @@ bool CfgHelper::_ReadFlatFieldFile(
 
         if(fileSize == (expectedSize * sizeof(int16)))
         {
-            buffer.resize(fileSize);
-            buffer = ff.readAll();
+            // the file is mapped and copied once in the flat field
+            FrameBuffer buffer = FrameBuffer::MapFile(fileName, 0);
+
+            if(buffer.GetSize() == fileSize)
+            {
+                data.resize(fileSize);
+                buffer.CopyTo(data.data());
+            }
+            else
+            {
+                LogInFile(QString("  ERROR can not read %1").arg(fileName));
 
-            data.resize(fileSize);
-            std::memcpy(data.data(),
-                        buffer.data(),
-                        fileSize);
+                res = false;
+            }
         }
         else
         {
@@ -15,6 +15,9 @@
 
 #define CAMERA_PRNU_PATH(x) x.replace(".cfg", "_prnu.bin")
 
+// binary copy of the camera cfg (rebuilt when the cfg or the prnu file changes)
+#define CAMERA_CACHE_PATH(x) QString(x).replace(".cfg", "_cache.bin")
+
 #define OPTICAL_COLUMN_FILE_NAME "OpticalColumn.xml"
 #define FLAT_FIELD_CFG_FILE_NAME "FlatField.xml"
 #define FLAT_FIELD_FILE_NAME     "FlatField_iris_%1_filter_%2.bin"
@@ -296,6 +299,9 @@ private:
 
     bool _ReadCfgFile(QString fileName, ConfigContent_t &configContent);
 
+    bool _ReadCfgCache(QString fileName, const QByteArray& checksum, ConfigContent_t &configContent);
+    bool _WriteCfgCache(QString fileName, const QByteArray& checksum, const ConfigContent_t &configContent);
+
     bool _ReadCalibrationStep(QDomElement& inCalibrationStep, CalibrationStep_t& calibrationStep);
 
     bool _ReadSummarySection(QDomElement& inSummary, Summary_t &summary);
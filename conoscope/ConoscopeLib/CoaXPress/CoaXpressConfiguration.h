@@ -2,7 +2,9 @@
 #define COAXPRESS_CONFIGURATION_H
 
 
-#define NUMBER_OF_FRAME 1
+// frames of the ring: one is filled by the grabber while the previous one is read
+// (each frame has a 32 bits accumulator of the sensor size)
+#define NUMBER_OF_FRAME 2
 
 #define COAXPRESS_FRAME_AVERAGE
 
@@ -21,6 +23,10 @@
 // this is for debug: pixel format is mono8: faster to display
 //#define DISPLAY_FRAME_FORMAT
 
+// the grabber does not unpack the 12 bits pixels (Mono12p in host memory)
+// they are unpacked while they are accumulated
+#define PACKED_PIXEL_DELIVERY
+
 // configuration of the capture sequance
 #define PROCESSING_TIME_US           100000
 #define PROCESSING_SENSOR_LAG_US     1000
@@ -31,6 +37,9 @@
 
 #define MAX_ACQUISITION_FRAME_PERIOD 1000000
 
+// number of buffers of the grabber while streaming
+#define STREAM_BUFFER_NUMBER         4
+
 // #define QUIET_MODE
 
 #endif // COAXPRESS_CONFIGURATION_H
@@ -1,4 +1,5 @@
 #include "CoaXpressFrame.h"
+#include "CoaXpressKernels.h"
 
 CoaXpressFrame* CoaXpressFrame::mInstance = NULL;
 
@@ -15,8 +16,7 @@ void ImageFrame::SetFeature(ImageFeature& feature)
     // TODO maybe concider the pixel format (if ever it is more than 8 bits)
     mPixelNumber = mFeature.height * mFeature.width;
 
-    mImageVector.clear();
-    mImageVector.resize(mPixelNumber);
+    mImage.Release();
 
     mAccumulatedVector.clear();
     mAccumulatedVector.resize(mPixelNumber);
@@ -40,13 +40,7 @@ int ImageFrame::Initialise(int height, int width)
     mHeight = height;
     mWidth = width;
 
-    int pixelNumber = height * width;
-
-    if(mAccumulatedCount == 0)
-    {
-        memset(mAccumulatedVector.data(), 0, pixelNumber * sizeof(uint32_t));
-    }
-
+    // the first image initialises the accumulated area (no need to clear it)
     return  mHeight * mWidth;
 }
 #endif
@@ -56,7 +50,10 @@ CoaXpressFrame::CoaXpressFrame()
     mFrame.clear();
     mFrame.resize(NUMBER_OF_FRAME);
 
-    mFreeIndex = 0;
+    mWriteIndex = 0;
+    mSequence   = 0;
+    mPolicy     = FrameOverwrite_Oldest;
+    mArea       = QRect();
 }
 
 CoaXpressFrame* CoaXpressFrame::GetInstance()
@@ -73,19 +70,130 @@ void CoaXpressFrame::SetFrameSize(ImageFeature feature)
 {
     CoaXpressFrame* instance = GetInstance();
 
+    QMutexLocker locker(&instance->mMutex);
+
     int index = 0;
 
     while(index < (int)instance->mFrame.size())
     {
         instance->mFrame.at(index).SetFeature(feature);
+        instance->mFrame.at(index).mState = FrameSlot_Free;
         index ++;
     }
+
+    instance->mWriteIndex = 0;
+}
+
+void CoaXpressFrame::SetOverwritePolicy(FrameOverwritePolicy_t ePolicy)
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    instance->mPolicy = ePolicy;
+}
+
+void CoaXpressFrame::SetAccumulationArea(const QRect& area)
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    instance->mArea = area;
 }
 
 int CoaXpressFrame::GetImageIndex()
 {
-    // for now there is only one frame
-    return 0;
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    int frameCount = (int)instance->mFrame.size();
+    int imageIndex = INVALID_FRAME_INDEX;
+
+    // first free slot after the last one filled
+    for(int count = 0; count < frameCount; count ++)
+    {
+        int index = (instance->mWriteIndex + count) % frameCount;
+
+        if(instance->mFrame.at(index).mState == FrameSlot_Free)
+        {
+            imageIndex = index;
+            break;
+        }
+    }
+
+    // no free slot, the oldest frame not read is dropped
+    if((imageIndex == INVALID_FRAME_INDEX) && (instance->mPolicy == FrameOverwrite_Oldest))
+    {
+        imageIndex = instance->_GetOldest(FrameSlot_Ready);
+    }
+
+    if(imageIndex != INVALID_FRAME_INDEX)
+    {
+        instance->mFrame.at(imageIndex).mState = FrameSlot_Filling;
+        instance->mFrame.at(imageIndex).mAccumulatedCount = 0;
+        instance->mFrame.at(imageIndex).mArea = instance->mArea;
+
+        instance->mWriteIndex = (imageIndex + 1) % frameCount;
+    }
+
+    return imageIndex;
+}
+
+void CoaXpressFrame::SetImageReady(int imageIndex)
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    if((imageIndex >= 0) && (imageIndex < (int)instance->mFrame.size()) &&
+       (instance->mFrame.at(imageIndex).mState == FrameSlot_Filling))
+    {
+        instance->mFrame.at(imageIndex).mState = FrameSlot_Ready;
+        instance->mFrame.at(imageIndex).mSequence = ++ instance->mSequence;
+    }
+}
+
+int CoaXpressFrame::GetReadyImageIndex()
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    return instance->_GetOldest(FrameSlot_Ready);
+}
+
+void CoaXpressFrame::ReleaseImage(int imageIndex)
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    QMutexLocker locker(&instance->mMutex);
+
+    if((imageIndex >= 0) && (imageIndex < (int)instance->mFrame.size()))
+    {
+        instance->mFrame.at(imageIndex).mState = FrameSlot_Free;
+        instance->mFrame.at(imageIndex).mAccumulatedCount = 0;
+
+        // the image goes back to the pool once the camera does not use it anymore
+        instance->mFrame.at(imageIndex).mImage.Release();
+    }
+}
+
+int CoaXpressFrame::_GetOldest(FrameSlotState_t eState)
+{
+    int imageIndex = INVALID_FRAME_INDEX;
+
+    for(int index = 0; index < (int)mFrame.size(); index ++)
+    {
+        if((mFrame.at(index).mState == eState) &&
+           ((imageIndex == INVALID_FRAME_INDEX) || (mFrame.at(index).mSequence < mFrame.at(imageIndex).mSequence)))
+        {
+            imageIndex = index;
+        }
+    }
+
+    return imageIndex;
 }
 
 int CoaXpressFrame::StoreImage(ImageBuffer& imageBuffer)
@@ -99,15 +207,41 @@ int CoaXpressFrame::StoreImage(ImageBuffer& imageBuffer)
     uint16_t* pData16 = (uint16_t*)imageBuffer.ptr;
 #endif
 
-    int bufferSize = (int)instance->mFrame.at(instance->mFreeIndex).mImageVector.size();
-    bufferSize *= instance->mFrame.at(instance->mFreeIndex).mNbBytesPerPixel;
-    uint8_t* pDst = (uint8_t*)instance->mFrame.at(instance->mFreeIndex).mImageVector.data();
+    int imageIndex = GetImageIndex();
+
+    if(imageIndex == INVALID_FRAME_INDEX)
+    {
+        // all the frames are used
+        return INVALID_FRAME_INDEX;
+    }
+
+    ImageFrame& frame = instance->mFrame.at(imageIndex);
+
+    frame.mImage = FrameBuffer(frame.mFeature.width, frame.mFeature.height);
+
+    int bufferSize = frame.mFeature.width * frame.mFeature.height;
+    bufferSize *= frame.mNbBytesPerPixel;
+    uint8_t* pDst = (uint8_t*)frame.mImage.GetData();
     uint8_t* pSrc = (uint8_t*)imageBuffer.ptr;
 
-    int memoryChunckSize = instance->mFrame.at(instance->mFreeIndex).mFeature.width *
-                           instance->mFrame.at(instance->mFreeIndex).mNbBytesPerPixel;
+    int memoryChunckSize = frame.mFeature.width * frame.mNbBytesPerPixel;
+
+    int remain = (pDst != NULL) ? bufferSize : 0;
+
+    if((remain > 0) && (frame.mFeature.eFormat == PixelFormat_Mono12p))
+    {
+        // unpacked line by line
+        const FrameKernels_t& kernels = CoaXpressKernels::Get();
+
+        for(int lineIndex = 0; lineIndex < frame.mFeature.height; lineIndex ++)
+        {
+            kernels.Unpack12p(frame.mImage.GetLine(lineIndex),
+                              &pSrc[PACKED_12P_BYTES(lineIndex * frame.mFeature.width)],
+                              frame.mFeature.width);
+        }
 
-    int remain = bufferSize;
+        remain = 0;
+    }
 
     while(remain > 0)
     {
@@ -121,9 +255,11 @@ int CoaXpressFrame::StoreImage(ImageBuffer& imageBuffer)
         remain -= memoryChunckSize;
     }
 
-    instance->mFrame.at(instance->mFreeIndex).debugStoreTime = instance->debugTimer.elapsed();
+    frame.debugStoreTime = instance->debugTimer.elapsed();
+
+    SetImageReady(imageIndex);
 
-    return 0;
+    return imageIndex;
 }
 
 #ifdef STD_DEV_FILE
@@ -138,6 +274,12 @@ void CoaXpressFrame::AppendImage(int imageIndex, ImageBuffer& imageBuffer)
 {
     CoaXpressFrame* instance = GetInstance();
 
+    if((imageIndex < 0) || (imageIndex >= (int)instance->mFrame.size()))
+    {
+        // no slot taken for this capture
+        return;
+    }
+
     instance->debugTimer.start();
 
     uint16_t* pData16 = (uint16_t*)imageBuffer.ptr;
@@ -154,6 +296,15 @@ void CoaXpressFrame::AppendImage(int imageIndex, ImageBuffer& imageBuffer)
         return;
     }
 
+    bool bPacked = (instance->mFrame.at(imageIndex).mFeature.eFormat == PixelFormat_Mono12p);
+
+    // a packed buffer must contain the whole frame
+    if((bPacked == true) &&
+       ((int)imageBuffer.bufSize < PACKED_12P_BYTES(imageBuffer.width * imageBuffer.height)))
+    {
+        return;
+    }
+
 #ifdef FRAME_FEATURE
     instance->mFrame.at(imageIndex).mFeature.width = imageBuffer.width;
     instance->mFrame.at(imageIndex).mFeature.height = imageBuffer.height;
@@ -169,31 +320,120 @@ void CoaXpressFrame::AppendImage(int imageIndex, ImageBuffer& imageBuffer)
     }
 #endif
 
-    uint32_t* pDataAverage = (uint32_t*)instance->mFrame.at(imageIndex).mAccumulatedVector.data();
+    ImageFrame& frame = instance->mFrame.at(imageIndex);
+
+    bool bFirst = (frame.mAccumulatedCount == 0);
+
+    if(bFirst == true)
+    {
+        QRect frameArea(0, 0, frame.mFeature.width, frame.mFeature.height);
+
+        bool bUseArea = (frame.mArea.isEmpty() == false);
 
 #ifdef STD_DEV_FILE
-    uint32_t* pDataStdDev = (uint32_t*)instance->mFrame.at(imageIndex).mAccumulatedSquareVector.data();
+        // the standard deviation is done on the whole frame
+        bUseArea = bUseArea && (frame.bStoreStdDev == false);
 #endif
 
-    if(instance->mFrame.at(imageIndex).mAccumulatedCount == 0)
+        frame.mAccumulatedArea = (bUseArea == true) ? frame.mArea.intersected(frameArea) : frameArea;
+
+        if((bPacked == true) && (frame.mAccumulatedArea != frameArea))
+        {
+            // packed pixels are read by pairs: the area starts and ends on an even pixel
+            int left  = frame.mAccumulatedArea.x() & ~1;
+            int right = qMin(frame.mAccumulatedArea.x() + frame.mAccumulatedArea.width() + 1, frameArea.width()) & ~1;
+
+            frame.mAccumulatedArea.setX(left);
+            frame.mAccumulatedArea.setWidth(right - left);
+        }
+    }
+
+    QRect area = frame.mAccumulatedArea;
+    int frameWidth = frame.mFeature.width;
+    int firstPixel = area.y() * frameWidth + area.x();
+
+    uint32_t* pDataAverage = &frame.mAccumulatedVector.data()[firstPixel];
+    uint16_t* pDataArea    = &pData16[firstPixel];
+
+    // the pixels of a packed buffer are unpacked in the accumulation (the frame width is even)
+    uint8_t* pPackedArea   = &((uint8_t*)imageBuffer.ptr)[PACKED_12P_BYTES(firstPixel)];
+
+#ifdef STD_DEV_FILE
+    uint32_t* pDataStdDev = (uint32_t*)frame.mAccumulatedSquareVector.data();
+#endif
+
+    const FrameKernels_t& kernels = CoaXpressKernels::Get();
+
+    // the first frame initialises the sum, the following ones are added to it
+    if(area.width() == frameWidth)
     {
+        // complete lines, the area is contiguous
+        int areaPixelNumber = area.height() * frameWidth;
+
+        int blockNumber = (areaPixelNumber + FRAME_KERNEL_BLOCK_SIZE - 1) / FRAME_KERNEL_BLOCK_SIZE;
+
 #pragma omp parallel for num_threads(4)
-        for(int index = 0; index < pixelNumber; index ++)
+        for(int blockIndex = 0; blockIndex < blockNumber; blockIndex ++)
         {
-            pDataAverage[index] = pData16[index];
+            int index = blockIndex * FRAME_KERNEL_BLOCK_SIZE;
+            int count = qMin(FRAME_KERNEL_BLOCK_SIZE, areaPixelNumber - index);
+
+            if(bPacked == true)
+            {
+                if(bFirst == true)
+                {
+                    kernels.Widen12p(&pDataAverage[index], &pPackedArea[PACKED_12P_BYTES(index)], count);
+                }
+                else
+                {
+                    kernels.Accumulate12p(&pDataAverage[index], &pPackedArea[PACKED_12P_BYTES(index)], count);
+                }
+            }
+            else if(bFirst == true)
+            {
+                kernels.Widen(&pDataAverage[index], &pDataArea[index], count);
+            }
+            else
+            {
+                kernels.Accumulate(&pDataAverage[index], &pDataArea[index], count);
+            }
         }
     }
     else
     {
+        // only the columns of the area are read
+        int lineNumber = area.height();
+
 #pragma omp parallel for num_threads(4)
-        for(int index = 0; index < pixelNumber; index ++)
+        for(int lineIndex = 0; lineIndex < lineNumber; lineIndex ++)
         {
-            pDataAverage[index] += pData16[index];
+            int index = lineIndex * frameWidth;
+
+            if(bPacked == true)
+            {
+                if(bFirst == true)
+                {
+                    kernels.Widen12p(&pDataAverage[index], &pPackedArea[PACKED_12P_BYTES(index)], area.width());
+                }
+                else
+                {
+                    kernels.Accumulate12p(&pDataAverage[index], &pPackedArea[PACKED_12P_BYTES(index)], area.width());
+                }
+            }
+            else if(bFirst == true)
+            {
+                kernels.Widen(&pDataAverage[index], &pDataArea[index], area.width());
+            }
+            else
+            {
+                kernels.Accumulate(&pDataAverage[index], &pDataArea[index], area.width());
+            }
         }
     }
 
 #ifdef STD_DEV_FILE
-    if(instance->mFrame.at(imageIndex).bStoreStdDev == true)
+    // only done with unpacked pixels
+    if((frame.bStoreStdDev == true) && (bPacked == false))
     {
 #pragma omp parallel for num_threads(4)
         for(int index = 0; index < pixelNumber; index ++)
@@ -205,28 +445,41 @@ void CoaXpressFrame::AppendImage(int imageIndex, ImageBuffer& imageBuffer)
     }
 #endif
 
-    instance->mFrame.at(imageIndex).mAccumulatedCount ++;
+    frame.mAccumulatedCount ++;
 }
 
 ImageFrame* CoaXpressFrame::GetImage(int imageIndex)
 {
     CoaXpressFrame* instance = GetInstance();
 
-    if(instance->mFrame.at(imageIndex).mAccumulatedCount != 0)
+    if((imageIndex < 0) || (imageIndex >= (int)instance->mFrame.size()))
     {
-        int pixelNumber = instance->mFrame.at(imageIndex).mPixelNumber;
-        int mAccumulatedCount = instance->mFrame.at(imageIndex).mAccumulatedCount;
+        return NULL;
+    }
 
-        uint16_t* pDst = (uint16_t*)instance->mFrame.at(imageIndex).mImageVector.data();
-        uint32_t* pAccumulated = (uint32_t*)instance->mFrame.at(imageIndex).mAccumulatedVector.data();
+    ImageFrame& frame = instance->mFrame.at(imageIndex);
 
-#pragma omp parallel for num_threads(4)
-        for(int index = 0; index < pixelNumber; index ++)
+    {
+        QMutexLocker locker(&instance->mMutex);
+
+        // only a frame handed over by the grabber can be read
+        if((frame.mState != FrameSlot_Ready) && (frame.mState != FrameSlot_Reading))
         {
-            pDst[index] = pAccumulated[index] / mAccumulatedCount;
+            return NULL;
         }
 
+        frame.mState = FrameSlot_Reading;
+    }
+
 #ifdef STD_DEV_FILE
+    if(frame.mAccumulatedCount != 0)
+    {
+        int mAccumulatedCount = frame.mAccumulatedCount;
+
+        int pixelNumber = frame.mFeature.width * frame.mFeature.height;
+
+        uint32_t* pAccumulated = (uint32_t*)frame.mAccumulatedVector.data();
+
         // process the standard deviation
         uint32_t* pStdDev = (uint32_t*)instance->mFrame.at(imageIndex).mAccumulatedSquareVector.data();
 
@@ -246,7 +499,7 @@ ImageFrame* CoaXpressFrame::GetImage(int imageIndex)
             for(int index = 0; index < pixelNumber; index ++)
             {
                 stdDev = pStdDev[index] / mAccumulatedCount;
-                avg = pDst[index];
+                avg = pAccumulated[index] / mAccumulatedCount;
                 stdDev = stdDev - (avg * avg);
                 stdDev = sqrt(stdDev);
 
@@ -256,18 +509,89 @@ ImageFrame* CoaXpressFrame::GetImage(int imageIndex)
                 pDstStd[index] = stdDev;
             }
         }
+    }
 #endif
+
+    return &frame;
+}
+
+bool CoaXpressFrame::ReadImage(int imageIndex, const QRect& area, FrameBuffer& image)
+{
+    CoaXpressFrame* instance = GetInstance();
+
+    image.Release();
+
+    if((imageIndex < 0) || (imageIndex >= (int)instance->mFrame.size()))
+    {
+        return false;
     }
 
-    instance->mFrame.at(imageIndex).mAccumulatedCount = 0;
+    ImageFrame& frame = instance->mFrame.at(imageIndex);
 
-    if(imageIndex < (int)instance->mFrame.size())
     {
-        return &instance->mFrame.at(imageIndex);
+        QMutexLocker locker(&instance->mMutex);
+
+        // GetImage must be called first
+        if(frame.mState != FrameSlot_Reading)
+        {
+            return false;
+        }
     }
-    else
+
+    QRect readArea = area.intersected(QRect(0, 0, frame.mFeature.width, frame.mFeature.height));
+
+    if(readArea.isEmpty() == true)
     {
-        return NULL;
+        return false;
+    }
+
+    if(frame.mAccumulatedCount == 0)
+    {
+        // the frame has been stored, the area is a view on it
+        image = frame.mImage.Crop(readArea);
+
+        return (image.IsNull() == false);
+    }
+
+    image = FrameBuffer(readArea.width(), readArea.height());
+
+    if(image.IsNull() == true)
+    {
+        return false;
+    }
+
+    // the average of the area is done directly in the image
+    const FrameKernels_t& kernels = CoaXpressKernels::Get();
+    FrameReciprocal_t reciprocal = CoaXpressKernels::GetReciprocal(frame.mAccumulatedCount);
+
+    uint32_t* pAccumulated = (uint32_t*)frame.mAccumulatedVector.data();
+
+    int frameWidth = frame.mFeature.width;
+
+    // only the accumulated part of the area is averaged, the remaining pixels are 0
+    QRect averageArea = readArea.intersected(frame.mAccumulatedArea);
+
+    if(averageArea != readArea)
+    {
+        for(int lineIndex = 0; lineIndex < readArea.height(); lineIndex ++)
+        {
+            memset(image.GetLine(lineIndex), 0, readArea.width() * sizeof(uint16_t));
+        }
     }
+
+    int lineNumber  = averageArea.height();
+    int lineOffsetY = averageArea.y() - readArea.y();
+    int lineOffsetX = averageArea.x() - readArea.x();
+
+#pragma omp parallel for num_threads(4)
+    for(int lineIndex = 0; lineIndex < lineNumber; lineIndex ++)
+    {
+        kernels.Average(&image.GetLine(lineOffsetY + lineIndex)[lineOffsetX],
+                        &pAccumulated[(averageArea.y() + lineIndex) * frameWidth + averageArea.x()],
+                        reciprocal,
+                        averageArea.width());
+    }
+
+    return true;
 }
 
@@ -3,12 +3,31 @@
 
 #include "CoaXpressConfiguration.h"
 #include "CoaXpressTypes.h"
+#include "toolFrameBuffer.h"
 
 #include <vector>
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QRect>
 
 #define FRAME_FEATURE
 
+#define INVALID_FRAME_INDEX -1
+
+typedef enum
+{
+    FrameSlot_Free,     // can be used by the grabber
+    FrameSlot_Filling,  // the grabber stores images in it
+    FrameSlot_Ready,    // capture done, waiting to be read
+    FrameSlot_Reading   // the camera reads it
+} FrameSlotState_t;
+
+typedef enum
+{
+    FrameOverwrite_Oldest, // the oldest frame not read is used for the next capture
+    FrameOverwrite_Block   // no capture until a frame is released
+} FrameOverwritePolicy_t;
+
 class ImageFrame
 {
 public:
@@ -17,9 +36,11 @@ public:
 
     void* srcBuf;
     int mPixelNumber;
-    std::vector<uint16_t> mImageVector;
+    FrameBuffer mImage; // stored frame (StoreImage), the averaged frames are read with ReadImage
     int mAccumulatedCount;
     std::vector<uint32_t> mAccumulatedVector;
+    QRect mArea;            // part of the frame to average (empty: whole frame)
+    QRect mAccumulatedArea; // part of mAccumulatedVector that is valid
 
 #ifdef STD_DEV_FILE
     bool bStoreStdDev;
@@ -35,8 +56,13 @@ public:
 
     int debugStoreTime;
 
+    FrameSlotState_t mState;
+    int mSequence; // order of the captures, used to find the oldest frame
+
     ImageFrame()
     {
+        mState = FrameSlot_Free;
+        mSequence = 0;
     }
 
     void SetFeature(ImageFeature& feature);
@@ -49,6 +75,14 @@ public:
 #endif
 };
 
+/* Class CoaXpressFrame
+ * ring of NUMBER_OF_FRAME frames
+ *
+ * the grabber takes a slot (GetImageIndex), stores the images in it and hands
+ * it over (SetImageReady). The camera reads it (GetImage) and gives it back
+ * (ReleaseImage), so the next capture can be done in another slot while the
+ * previous frame is read.
+ */
 class CoaXpressFrame
 {
 private:
@@ -60,15 +94,37 @@ private:
 
 protected:
     std::vector<ImageFrame> mFrame;
-    int   mFreeIndex; // currently not used
+    int   mWriteIndex; // next slot to fill
+    int   mSequence;
+    FrameOverwritePolicy_t mPolicy;
+    QRect mArea;       // area of the next captures
+    QMutex mMutex;     // protects the state of the slots
     QElapsedTimer debugTimer; // for debug purpose
 
+    int _GetOldest(FrameSlotState_t eState);
+
 public:
 
     static void SetFrameSize(ImageFeature feature);
 
+    static void SetOverwritePolicy(FrameOverwritePolicy_t ePolicy);
+
+    // only this area of the next captures is averaged (empty: whole frame)
+    // the pixels outside it are read as 0
+    static void SetAccumulationArea(const QRect& area);
+
+    // take a slot for the next capture (INVALID_FRAME_INDEX if none is available)
     static int GetImageIndex();
 
+    // the capture is done, the frame can be read
+    static void SetImageReady(int imageIndex);
+
+    // oldest frame ready to be read (INVALID_FRAME_INDEX if none)
+    static int GetReadyImageIndex();
+
+    // the slot can be used for another capture
+    static void ReleaseImage(int imageIndex);
+
     static int StoreImage(ImageBuffer& imageBuffer);
 
 #ifdef STD_DEV_FILE
@@ -77,7 +133,11 @@ public:
 
     static void AppendImage(int imageIndex, ImageBuffer& imageBuffer);
 
+    // the frame is read by the camera (NULL if it is not ready)
     static ImageFrame* GetImage(int imageIndex);
+
+    // average of an area of the frame in a new packed image (view on the frame if it was stored)
+    static bool ReadImage(int imageIndex, const QRect& area, FrameBuffer& image);
 };
 
 #endif // COAXPRESSFRAME_H
@@ -38,6 +38,7 @@ CoaXpressGrabber_Config::CoaXpressGrabber_Config(const CoaXpressGrabber_Config&
     bExtTrig          = value.bExtTrig;
     bTestPattern      = value.bTestPattern;
     trigDelayMs       = value.trigDelayMs;
+    accumulationArea  = value.accumulationArea;
 }
 
 #ifndef USE_POP
@@ -92,6 +93,13 @@ void CoaXpressGrabber::DetectCamera(std::string connection)
 {
     mCameraManufacturer = CameraManufacturer_Unknown;
     mAcquisitionCount = 0;
+    mCurrentFrameIndex = INVALID_FRAME_INDEX;
+
+    mStreaming        = false;
+    mStreamAverage    = 1;
+    mStreamSkipCount  = 0;
+    mStreamFrameIndex = INVALID_FRAME_INDEX;
+    mStreamImageCount = 0;
 
     // runScript("config.js");
 
@@ -295,6 +303,11 @@ void CoaXpressGrabber::SetCameraDefaultConfiguration()
             }
         }
 
+#ifdef PACKED_PIXEL_DELIVERY
+        // 2 pixels in 3 bytes instead of 4 in the buffers
+        setString<Euresys::StreamModule>("UnpackingMode", "Off");
+#endif
+
         setString<Euresys::RemoteModule>("TestPattern", "Off");
 
         setString<Euresys::RemoteModule>("AcquisitionMode", "Continuous");
@@ -400,6 +413,56 @@ void CoaXpressGrabber::SetCameraConstants()
 
 #define EXPOSURE_TIME_MIN 100
 
+int CoaXpressGrabber::_GetAcquisitionFramePeriod(int exposureTimeUs)
+{
+    int framePeriod;
+
+#ifndef FIXED_FPS
+    // adjust acquisition period
+    // it should be bigger than the processing time
+    framePeriod = (exposureTimeUs > PROCESSING_TIME_US) ? exposureTimeUs : PROCESSING_TIME_US;
+
+    framePeriod = (framePeriod < mAcquisitionFramePeriodMin) ?
+                mAcquisitionFramePeriodMin : framePeriod;
+
+    // there are some lag in the sensor capture
+    framePeriod += PROCESSING_SENSOR_LAG_US;
+
+#ifdef STD_DEV_FILE
+    if(mConfig.bStoreStdDev == true)
+    {
+        framePeriod += PROCESSING_STD_DEV_PROC_US;
+    }
+#endif
+#else
+    // for debug purpose
+    framePeriod = 1000000;
+#endif
+
+    return framePeriod;
+}
+
+void CoaXpressGrabber::_SetAcquisitionFramePeriod(int framePeriod)
+{
+    switch(mCameraManufacturer)
+    {
+    case CameraManufacturer_Adimec:
+        if(framePeriod > MAX_ACQUISITION_FRAME_PERIOD)
+        {
+            framePeriod = MAX_ACQUISITION_FRAME_PERIOD;
+        }
+
+        _SetInteger("AcquisitionFramePeriod", framePeriod);
+        break;
+
+    case CameraManufacturer_CriticalLink:
+        _SetFloat("MSRM_Int_AcquisitionFrameInterval", framePeriod);
+        break;
+    }
+
+    mCurrentAcquisitionFramePeriod = framePeriod;
+}
+
 void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
 {
     // store the configuration
@@ -417,27 +480,7 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
         config.exposureUs = exposureTimeUs;
     }
 
-#ifndef FIXED_FPS
-    // adjust acquisition period
-    // it should be bigger than the processing time
-    mCurrentAcquisitionFramePeriod = (exposureTimeUs > PROCESSING_TIME_US) ? exposureTimeUs : PROCESSING_TIME_US;
-
-    mCurrentAcquisitionFramePeriod = (mCurrentAcquisitionFramePeriod < mAcquisitionFramePeriodMin) ?
-                mAcquisitionFramePeriodMin : mCurrentAcquisitionFramePeriod;
-
-    // there are some lag in the sensor capture
-    mCurrentAcquisitionFramePeriod += PROCESSING_SENSOR_LAG_US;
-
-#ifdef STD_DEV_FILE
-    if(config.bStoreStdDev == true)
-    {
-        mCurrentAcquisitionFramePeriod += PROCESSING_STD_DEV_PROC_US;
-    }
-#endif
-#else
-    // for debug purpose
-    mCurrentAcquisitionFramePeriod = 1000000;
-#endif
+    mCurrentAcquisitionFramePeriod = _GetAcquisitionFramePeriod(exposureTimeUs);
 
     int imageWidth  = config.dimensions.width();
     int imageHeight = config.dimensions.height();
@@ -454,18 +497,18 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
             mCurrentAcquisitionFramePeriod = MAX_ACQUISITION_FRAME_PERIOD;
         }
 
-        setInteger<Euresys::RemoteModule>("AcquisitionFramePeriod", mCurrentAcquisitionFramePeriod);
+        _SetInteger("AcquisitionFramePeriod", mCurrentAcquisitionFramePeriod);
         PRINT("  grabber", QString("AcquisitionFramePeriod = %1").arg(mCurrentAcquisitionFramePeriod));
 
         // dimension
         xOffset = config.dimensions.x();
         yOffset = config.dimensions.y();
 
-        setInteger<Euresys::RemoteModule>("Width", imageWidth);
-        setInteger<Euresys::RemoteModule>("Height", imageHeight);
+        _SetInteger("Width", imageWidth);
+        _SetInteger("Height", imageHeight);
 
-        setInteger<Euresys::RemoteModule>("OffsetX", xOffset);
-        setInteger<Euresys::RemoteModule>("OffsetY", yOffset);
+        _SetInteger("OffsetX", xOffset);
+        _SetInteger("OffsetY", yOffset);
 
         break;
 
@@ -474,7 +517,7 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
         // mCurrentAcquisitionFramePeriod = 1000000;
         // mCurrentAcquisitionFramePeriod = 1000000;
 
-        setFloat<Euresys::RemoteModule>("MSRM_Int_AcquisitionFrameInterval", mCurrentAcquisitionFramePeriod);
+        _SetFloat("MSRM_Int_AcquisitionFrameInterval", mCurrentAcquisitionFramePeriod);
 
 #ifdef LOG_ACQUISITION_FRAME_PERIOD
         AcqFR = getFloat<Euresys::RemoteModule>("AcquisitionFrameRate");
@@ -487,11 +530,11 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
         if(config.bTestPattern == true)
         {
             // setString<Euresys::RemoteModule>("AcquisitionMode", "Continuous");
-            setString<Euresys::RemoteModule>("TestPattern", "SensorTestPattern");
+            _SetString("TestPattern", "SensorTestPattern");
         }
         else
         {
-            setString<Euresys::RemoteModule>("TestPattern", "Off");
+            _SetString("TestPattern", "Off");
         }
 
         if((config.dimensions.height() >= 6004) || (config.dimensions.width() >= 7920))
@@ -501,18 +544,18 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
             mImageFeature.offsetX = 0;
             mImageFeature.offsetY = 0;
             // keep the size of the sensor, image is cropped when retrieved
-            setInteger<Euresys::RemoteModule>("OffsetX", mImageFeature.offsetX);
-            setInteger<Euresys::RemoteModule>("OffsetY", mImageFeature.offsetY);
-            setInteger<Euresys::RemoteModule>("Width",   mImageFeature.width);
-            setInteger<Euresys::RemoteModule>("Height",  mImageFeature.height);
+            _SetInteger("OffsetX", mImageFeature.offsetX);
+            _SetInteger("OffsetY", mImageFeature.offsetY);
+            _SetInteger("Width",   mImageFeature.width);
+            _SetInteger("Height",  mImageFeature.height);
 
         }
         else
         {
-            setInteger<Euresys::RemoteModule>("Width",   config.dimensions.width());
-            setInteger<Euresys::RemoteModule>("Height",  config.dimensions.height());
-            setInteger<Euresys::RemoteModule>("OffsetX", config.dimensions.x());
-            setInteger<Euresys::RemoteModule>("OffsetY", config.dimensions.y());
+            _SetInteger("Width",   config.dimensions.width());
+            _SetInteger("Height",  config.dimensions.height());
+            _SetInteger("OffsetX", config.dimensions.x());
+            _SetInteger("OffsetY", config.dimensions.y());
 
             mImageFeature.width   = config.dimensions.width();
             mImageFeature.height  = config.dimensions.height();
@@ -524,7 +567,7 @@ void CoaXpressGrabber::Configure(CoaXpressGrabber_Config& config)
     }
 
     // set exposure time
-    setFloat<Euresys::RemoteModule>("ExposureTime", exposureTimeUs);
+    _SetFloat("ExposureTime", exposureTimeUs);
     PRINT("  grabber", QString("ExposureTime           = %1").arg(exposureTimeUs));
 
     // binning
@@ -601,6 +644,13 @@ void CoaXpressGrabber::UpdateFrameSize()
     else if((pixelFormat == "Mono12") || (pixelFormat == "Mono12p"))
     {
         mImageFeature.eFormat = PixelFormat_Mono12;
+
+#ifdef PACKED_PIXEL_DELIVERY
+        if(getString<Euresys::StreamModule>("UnpackingMode") == "Off")
+        {
+            mImageFeature.eFormat = PixelFormat_Mono12p;
+        }
+#endif
     }
     else
     {
@@ -611,6 +661,8 @@ void CoaXpressGrabber::UpdateFrameSize()
 
 #ifdef NOT_VALID_SIZE
     CoaXpressFrame::SetFrameSize(mImageFeature);
+
+    mFrameFeature = mImageFeature;
 #else
     // set frame size to sensor size
     ImageFeature imageFeature;
@@ -624,7 +676,13 @@ void CoaXpressGrabber::UpdateFrameSize()
     imageFeature.eCameraManufacturer = mImageFeature.eCameraManufacturer;
 
     CoaXpressFrame::SetFrameSize(imageFeature);
+
+    mFrameFeature = imageFeature;
 #endif
+
+    CoaXpressRecorder::RecordFrame(mFrameFeature);
+
+    CoaXpressFrame::SetAccumulationArea(config.accumulationArea);
 }
 
 void CoaXpressGrabber::PowerCycle()
@@ -704,6 +762,12 @@ void CoaXpressGrabber::onNewBufferEvent(const NewBufferData &data)
 #ifndef USE_POP
     ScopedBuffer buf(*this, data);
 
+    if(mAcquisitionCount <= 0)
+    {
+        // late buffer of a capture stopped
+        return;
+    }
+
     ImageBuffer imageBuffer;
 
     imageBuffer.width   = mImageFeature.width;
@@ -717,13 +781,22 @@ void CoaXpressGrabber::onNewBufferEvent(const NewBufferData &data)
     CoaXpressFrame::AppendImage(mCurrentFrameIndex, imageBuffer);
 #endif
 
+    if(CoaXpressRecorder::IsOpen() == true)
+    {
+        CoaXpressRecorder::RecordBuffer(imageBuffer, buf.getInfo<uint64_t>(GenTL::BUFFER_INFO_TIMESTAMP));
+    }
+
     mAcquisitionCount --;
 
     if(mAcquisitionCount == 0)
     {
         stop();
+        CoaXpressRecorder::RecordStop();
 
 #ifdef COAXPRESS_FRAME_AVERAGE
+        // hand the frame over to the camera
+        CoaXpressFrame::SetImageReady(mCurrentFrameIndex);
+
         emit FrameCaptured(mCurrentFrameIndex);
 #endif
     }
@@ -751,14 +824,24 @@ bool CoaXpressGrabber::Start(int acquisitionNumber)
         acquisitionNumber = mConfig.acquisitionNumber;
     }
 
+#ifdef COAXPRESS_FRAME_AVERAGE
     if(mAcquisitionCount == 0)
     {
-        mAcquisitionCount = acquisitionNumber;
-
-#ifdef COAXPRESS_FRAME_AVERAGE
+        // take a slot of the ring for this capture
         mCurrentFrameIndex = CoaXpressFrame::GetImageIndex();
+
+        if(mCurrentFrameIndex == INVALID_FRAME_INDEX)
+        {
+            PRINT("  grabber", QString("      no frame available"));
+            return res;
+        }
+    }
 #endif
 
+    if(mAcquisitionCount == 0)
+    {
+        mAcquisitionCount = acquisitionNumber;
+
 #ifdef STD_DEV_FILE
         CoaXpressFrame::StoreStdDev(mCurrentFrameIndex, mConfig.bStoreStdDev);
 #endif
@@ -769,6 +852,7 @@ bool CoaXpressGrabber::Start(int acquisitionNumber)
 #endif
 
         start(acquisitionNumber);
+        CoaXpressRecorder::RecordStart(acquisitionNumber);
 
 #ifdef USE_POP
         uint64_t timeout = 100000;
@@ -808,14 +892,25 @@ bool CoaXpressGrabber::Start(int acquisitionNumber)
             CoaXpressFrame::AppendImage(mCurrentFrameIndex, imageBuffer);
 #endif
 
+            if(CoaXpressRecorder::IsOpen() == true)
+            {
+                CoaXpressRecorder::RecordBuffer(imageBuffer, buf.getInfo<uint64_t>(GenTL::BUFFER_INFO_TIMESTAMP));
+            }
+
             mAcquisitionCount --;
-        } while (mAcquisitionCount != 0);
+        } while (mAcquisitionCount > 0);
 
 #ifdef CAMERA_LOG_IN_FILE
         _LogInFile("loop done");
         _LogInFile("stop");
 #endif
         stop();
+        CoaXpressRecorder::RecordStop();
+
+#ifdef COAXPRESS_FRAME_AVERAGE
+        // hand the frame over to the camera
+        CoaXpressFrame::SetImageReady(mCurrentFrameIndex);
+#endif
 
 #ifdef CAMERA_LOG_IN_FILE
         _LogInFile("FrameCaptured");
@@ -839,6 +934,206 @@ void CoaXpressGrabber::Stop()
 {
     // use configuration
     stop();
+    CoaXpressRecorder::RecordStop();
+
+#ifdef COAXPRESS_FRAME_AVERAGE
+    if(mAcquisitionCount != 0)
+    {
+        // capture aborted, the slot is given back
+        CoaXpressFrame::ReleaseImage(mCurrentFrameIndex);
+
+        // a late buffer is not appended to the slot released
+        mCurrentFrameIndex = INVALID_FRAME_INDEX;
+    }
+#endif
+
+    // the next Start takes a new slot
+    mAcquisitionCount = 0;
+}
+
+bool CoaXpressGrabber::StreamStart(int averageNumber)
+{
+    bool res = false;
+
+#ifdef USE_POP
+    if((mAcquisitionCount == 0) && (mStreaming == false) && (averageNumber > 0))
+    {
+        mStreamAverage    = averageNumber;
+        mStreamSkipCount  = 0;
+        mStreamFrameIndex = INVALID_FRAME_INDEX;
+        mStreamImageCount = 0;
+
+        reallocBuffers(STREAM_BUFFER_NUMBER);
+        flushBuffers();
+
+        // no frame count, the acquisition runs until StreamStop
+        start();
+        CoaXpressRecorder::RecordStart(0);
+
+        mStreaming = true;
+        res = true;
+
+        PRINT("  grabber", QString("stream started"));
+    }
+    else
+    {
+        PRINT("  grabber", QString("      stream not started"));
+    }
+#else
+    // the images are only handled in the callback
+    PRINT("  grabber", QString("      stream not supported"));
+#endif
+
+    return res;
+}
+
+int CoaXpressGrabber::StreamRead(int timeoutMs)
+{
+#ifdef USE_POP
+    if(mStreaming == false)
+    {
+        return INVALID_FRAME_INDEX;
+    }
+
+    if(mStreamFrameIndex == INVALID_FRAME_INDEX)
+    {
+        mStreamFrameIndex = CoaXpressFrame::GetImageIndex();
+        mStreamImageCount = 0;
+    }
+
+    if(mStreamFrameIndex == INVALID_FRAME_INDEX)
+    {
+        PRINT("  grabber", QString("      no frame available"));
+        return INVALID_FRAME_INDEX;
+    }
+
+    try
+    {
+        while(mStreamImageCount < mStreamAverage)
+        {
+            NewBufferData buffer(pop(timeoutMs));
+
+            ScopedBuffer buf(*this, buffer);
+
+            if(mStreamSkipCount > 0)
+            {
+                // image exposed before the last change of the exposure time
+                mStreamSkipCount --;
+                continue;
+            }
+
+            ImageBuffer imageBuffer;
+
+            imageBuffer.width   = mImageFeature.width;
+            imageBuffer.height  = mImageFeature.height;
+            imageBuffer.bufSize = buf.getInfo<size_t>(GenTL::BUFFER_INFO_SIZE);
+            imageBuffer.ptr     = buf.getInfo<void*>(GenTL::BUFFER_INFO_BASE);
+
+            CoaXpressFrame::AppendImage(mStreamFrameIndex, imageBuffer);
+
+            if(CoaXpressRecorder::IsOpen() == true)
+            {
+                CoaXpressRecorder::RecordBuffer(imageBuffer, buf.getInfo<uint64_t>(GenTL::BUFFER_INFO_TIMESTAMP));
+            }
+
+            mStreamImageCount ++;
+        }
+    }
+    catch(...)
+    {
+        // timeout (the caller checks its stop request), the images already
+        // accumulated are kept and the next call goes on with the same frame
+        return INVALID_FRAME_INDEX;
+    }
+
+    int frameIndex = mStreamFrameIndex;
+
+    mStreamFrameIndex = INVALID_FRAME_INDEX;
+    mStreamImageCount = 0;
+
+    // hand the frame over to the camera
+    CoaXpressFrame::SetImageReady(frameIndex);
+
+    return frameIndex;
+#else
+    Q_UNUSED(timeoutMs);
+
+    return INVALID_FRAME_INDEX;
+#endif
+}
+
+void CoaXpressGrabber::StreamStop()
+{
+    if(mStreaming == true)
+    {
+        stop();
+        CoaXpressRecorder::RecordStop();
+
+        _StreamReleaseFrame();
+
+        mStreaming = false;
+
+        PRINT("  grabber", QString("stream stopped"));
+    }
+}
+
+bool CoaXpressGrabber::RecordOpen(QString filePath, int lineStep)
+{
+    // the recording starts with the size of the current frames
+    return CoaXpressRecorder::Open(filePath, lineStep, mFrameFeature);
+}
+
+void CoaXpressGrabber::RecordClose()
+{
+    CoaXpressRecorder::Close();
+}
+
+void CoaXpressGrabber::SetExposureTime(int& exposureUs)
+{
+    if(exposureUs < EXPOSURE_TIME_MIN)
+    {
+        exposureUs = EXPOSURE_TIME_MIN;
+    }
+
+    mConfig.exposureUs = exposureUs;
+
+    int framePeriod = _GetAcquisitionFramePeriod(exposureUs);
+
+    // the exposure time must stay shorter than the frame period while both are changed
+    if(framePeriod < mCurrentAcquisitionFramePeriod)
+    {
+        _SetFloat("ExposureTime", exposureUs);
+        _SetAcquisitionFramePeriod(framePeriod);
+    }
+    else
+    {
+        _SetAcquisitionFramePeriod(framePeriod);
+        _SetFloat("ExposureTime", exposureUs);
+    }
+
+    GetExposureTime(exposureUs);
+
+    PRINT("  grabber", QString("ExposureTime           = %1").arg(exposureUs));
+
+    if(mStreaming == true)
+    {
+        // the images waiting in the queue and the one being exposed use the previous exposure time
+        mStreamSkipCount = (int)getInfo<StreamModule, size_t>(GenTL::STREAM_INFO_NUM_AWAIT_DELIVERY) + 1;
+
+        // the frame being averaged does not mix both exposure times
+        _StreamReleaseFrame();
+    }
+}
+
+void CoaXpressGrabber::_StreamReleaseFrame()
+{
+    if(mStreamFrameIndex != INVALID_FRAME_INDEX)
+    {
+        CoaXpressFrame::ReleaseImage(mStreamFrameIndex);
+    }
+
+    mStreamFrameIndex = INVALID_FRAME_INDEX;
+    mStreamImageCount = 0;
 }
 
 #define CAMERA_SETTING_TEMP(a, b) CameraSettingItem("Temperature", a, b, "deg")
@@ -1392,24 +1687,34 @@ bool CoaXpressGrabber::I2CSendAndReceiveData(const unsigned char *TXBuffer, unsi
      int        intResult ;
      char       rx_count ;
 
+     // GenAPI names are built once (this is called in the temperature regulation loop)
+     static const std::string passlock("I2CPasslock");
+     static const std::string passlockExecute("i2cexecute");
+     static const std::string busNum("I2CBusNum");
+     static const std::string slaveAddr("I2CSlaveAddr");
+     static const std::string txCount("I2CTxCount");
+     static const std::string rxCount("I2CRxCount");
+     static const std::string i2cExecute("I2CExecute");
+     static const std::string operationResult("I2COperationResult");
+
      try
      {
-        setString<Euresys::RemoteModule>("I2CPasslock", "i2cexecute") ;
-        setInteger<Euresys::RemoteModule>("I2CBusNum", mucBus) ;
-        setInteger<Euresys::RemoteModule>("I2CSlaveAddr", mucSlaveAddress) ;
+        setString<Euresys::RemoteModule>(passlock, passlockExecute) ;
+        setInteger<Euresys::RemoteModule>(busNum, mucBus) ;
+        setInteger<Euresys::RemoteModule>(slaveAddr, mucSlaveAddress) ;
         gcWritePortData<Euresys::RemoteModule>(tx_address, (char *)TXBuffer, TXCount);
 
-        setString<Euresys::RemoteModule>("I2CPasslock", "i2cexecute") ;
+        setString<Euresys::RemoteModule>(passlock, passlockExecute) ;
 
-        setInteger<Euresys::RemoteModule>("I2CTxCount", TXCount) ;
-        setInteger<Euresys::RemoteModule>("I2CRxCount", RXCount) ;
+        setInteger<Euresys::RemoteModule>(txCount, TXCount) ;
+        setInteger<Euresys::RemoteModule>(rxCount, RXCount) ;
 
-        execute<Euresys::RemoteModule>("I2CExecute") ;
-        intResult =  getInteger<Euresys::RemoteModule>("I2COperationResult") ;
+        execute<Euresys::RemoteModule>(i2cExecute) ;
+        intResult =  getInteger<Euresys::RemoteModule>(operationResult) ;
 
         if (intResult != 0)
             return (false) ;
-        rx_count = getInteger<Euresys::RemoteModule>("I2CRxCount") ;
+        rx_count = getInteger<Euresys::RemoteModule>(rxCount) ;
         gcReadPortData<Euresys::RemoteModule>(rx_address, (char *)RXBuffer, RXCount);
 
         return (true)     ;
@@ -1529,6 +1834,27 @@ void CoaXpressGrabber::_ReadCameraInfo()
     }
 }
 
+void CoaXpressGrabber::_SetInteger(const std::string& feature, int64_t value)
+{
+    setInteger<Euresys::RemoteModule>(feature, value);
+
+    CoaXpressRecorder::RecordFeature(feature, QString::number(value));
+}
+
+void CoaXpressGrabber::_SetFloat(const std::string& feature, double value)
+{
+    setFloat<Euresys::RemoteModule>(feature, value);
+
+    CoaXpressRecorder::RecordFeature(feature, QString::number(value));
+}
+
+void CoaXpressGrabber::_SetString(const std::string& feature, const std::string& value)
+{
+    setString<Euresys::RemoteModule>(feature, value);
+
+    CoaXpressRecorder::RecordFeature(feature, QString::fromStdString(value));
+}
+
 void CoaXpressGrabber::_LogInFile(QString message)
 {
     emit LogInFile("[Grabber]", message);
@@ -9,6 +9,7 @@ using namespace Euresys;
 #include "CoaXpressConfiguration.h"
 #include "CoaXpressTypes.h"
 #include "CoaXpressFrame.h"
+#include "CoaXpressRecord.h"
 
 #include <QTime>
 // TODO replace QRect by custom class
@@ -131,6 +132,7 @@ public:
     bool  bExtTrig;
     bool  bTestPattern;
     int   trigDelayMs;
+    QRect accumulationArea;   // part of the frame averaged (empty: whole frame)
 #ifdef STD_DEV_FILE
     bool  bStoreStdDev;
 #endif
@@ -183,6 +185,25 @@ public:
 
     void Stop();
 
+    // continuous acquisition, the grabber stays armed until StreamStop
+    // each frame is the average of averageNumber images
+    bool StreamStart(int averageNumber);
+
+    // wait for the next frame of the stream (INVALID_FRAME_INDEX on timeout)
+    // timeoutMs applies to each image, the average goes on at the next call after a timeout
+    int StreamRead(int timeoutMs);
+
+    void StreamStop();
+
+    // record the acquisitions in a file (CoaXpressRecorder), one line every lineStep lines
+    // of the images is recorded (0: only the arrival of the buffers)
+    bool RecordOpen(QString filePath, int lineStep);
+
+    void RecordClose();
+
+    // applied to the next images, exposureUs is updated with the time set
+    void SetExposureTime(int& exposureUs);
+
     void GetTemperature(CameraSettings &settings);
 
     void GetExposureTime(int &exposureTime);
@@ -288,12 +309,19 @@ private:
     virtual void onNewBufferEvent(const NewBufferData &data);
 
     ImageFeature                    mImageFeature;
+    ImageFeature                    mFrameFeature; // size of the CoaXpressFrame slots
     int                             mAcquisitionCount;
     int                             mCurrentFrameIndex;
     int                             mCurrentAcquisitionFramePeriod;
     int                             mAcquisitionFramePeriodMin;
 
     CoaXpressGrabber_Config         mConfig;
+
+    bool                            mStreaming;
+    int                             mStreamAverage;
+    int                             mStreamSkipCount; // images to drop after an exposure time change
+    int                             mStreamFrameIndex; // frame being averaged (kept when StreamRead times out)
+    int                             mStreamImageCount; // images already accumulated in this frame
     CameraManufacturer_t            mCameraManufacturer;
     CoaXpressGrabber_CameraInfo     mCameraInfo;
     CoaXpressGrabber_CameraSettings mCameraSettings;
@@ -319,6 +347,20 @@ private:
     int mFileTransferPacketSize;
 
     void _LogInFile(QString message);
+
+    int _GetAcquisitionFramePeriod(int exposureTimeUs);
+
+    void _SetAcquisitionFramePeriod(int framePeriod);
+
+    // give back the slot of the frame being averaged by the stream
+    void _StreamReleaseFrame();
+
+    // features of the camera written during the acquisitions (recorded)
+    void _SetInteger(const std::string& feature, int64_t value);
+
+    void _SetFloat(const std::string& feature, double value);
+
+    void _SetString(const std::string& feature, const std::string& value);
 };
 
 #endif // COAXPRESSGRABBER_H
@@ -0,0 +1,238 @@
+#include "CoaXpressKernels.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+FrameKernelIsa_t CoaXpressKernels::mIsa     = FrameKernelIsa_Scalar;
+FrameKernels_t   CoaXpressKernels::mKernels[FrameKernelIsa_Count];
+
+#define CPUID1_ECX_OSXSAVE (1 << 27)
+#define CPUID1_ECX_AVX     (1 << 28)
+#define CPUID7_EBX_AVX2    (1 << 5)
+
+#define XCR0_SSE_AVX_STATE 0x6
+
+// the multiplier is exact while the error (count * 65535 * count) stays below 2^shift
+#define RECIPROCAL_MAX_LOG2 14
+
+static void _Cpuid(int leaf, int subLeaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, leaf, subLeaf);
+
+    for(int index = 0; index < 4; index ++)
+    {
+        regs[index] = (unsigned int)info[index];
+    }
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    __get_cpuid_count(leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+}
+
+static uint64_t _Xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static void Widen(uint32_t* dst, const uint16_t* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = src[index];
+    }
+}
+
+static void Accumulate(uint32_t* dst, const uint16_t* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] += src[index];
+    }
+}
+
+static void Average(uint16_t* dst, const uint32_t* src, const FrameReciprocal_t& reciprocal, int count)
+{
+    if(reciprocal.multiplier == 0)
+    {
+        for(int index = 0; index < count; index ++)
+        {
+            dst[index] = src[index] / reciprocal.count;
+        }
+    }
+    else
+    {
+        for(int index = 0; index < count; index ++)
+        {
+            dst[index] = (uint16_t)(((uint64_t)src[index] * reciprocal.multiplier) >> reciprocal.shift);
+        }
+    }
+}
+
+// pixel of a Mono12p buffer
+static inline uint16_t _Unpack12p(const uint8_t* src, int index)
+{
+    const uint8_t* pPair = &src[(index >> 1) * 3];
+
+    if((index & 1) == 0)
+    {
+        return (uint16_t)(pPair[0] | ((pPair[1] & 0x0F) << 8));
+    }
+    else
+    {
+        return (uint16_t)((pPair[1] >> 4) | (pPair[2] << 4));
+    }
+}
+
+static void Widen12p(uint32_t* dst, const uint8_t* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = _Unpack12p(src, index);
+    }
+}
+
+static void Accumulate12p(uint32_t* dst, const uint8_t* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] += _Unpack12p(src, index);
+    }
+}
+
+static void Unpack12p(uint16_t* dst, const uint8_t* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = _Unpack12p(src, index);
+    }
+}
+
+void CoaXpressKernels_Scalar(FrameKernels_t& kernels)
+{
+    kernels.Widen         = Widen;
+    kernels.Accumulate    = Accumulate;
+    kernels.Average       = Average;
+    kernels.Widen12p      = Widen12p;
+    kernels.Accumulate12p = Accumulate12p;
+    kernels.Unpack12p     = Unpack12p;
+}
+
+void CoaXpressKernels::_Initialise()
+{
+    // filled once, the first callers (grabber callback and camera thread) wait for it
+    static bool bReady = [] ()
+    {
+        CoaXpressKernels_Scalar(mKernels[FrameKernelIsa_Scalar]);
+        CoaXpressKernels_Avx2(mKernels[FrameKernelIsa_Avx2]);
+
+        mIsa = _DetectIsa();
+
+        return true;
+    } ();
+
+    (void)bReady;
+}
+
+const FrameKernels_t& CoaXpressKernels::Get()
+{
+    _Initialise();
+    return mKernels[mIsa];
+}
+
+const FrameKernels_t& CoaXpressKernels::Get(FrameKernelIsa_t eIsa)
+{
+    _Initialise();
+    return mKernels[eIsa];
+}
+
+FrameKernelIsa_t CoaXpressKernels::GetIsa()
+{
+    _Initialise();
+    return mIsa;
+}
+
+bool CoaXpressKernels::Select(FrameKernelIsa_t eIsa)
+{
+    _Initialise();
+
+    if((int)eIsa > (int)_DetectIsa())
+    {
+        return false;
+    }
+
+    mIsa = eIsa;
+    return true;
+}
+
+FrameReciprocal_t CoaXpressKernels::GetReciprocal(int count)
+{
+    FrameReciprocal_t reciprocal;
+
+    reciprocal.count      = (count > 0) ? count : 1;
+    reciprocal.multiplier = 0;
+    reciprocal.shift      = 0;
+
+    int log2 = 0;
+
+    while((reciprocal.count >> (log2 + 1)) != 0)
+    {
+        log2 ++;
+    }
+
+    if((reciprocal.count & (reciprocal.count - 1)) == 0)
+    {
+        // power of 2: shift only
+        reciprocal.multiplier = 1;
+        reciprocal.shift      = log2;
+    }
+    else if(log2 <= RECIPROCAL_MAX_LOG2)
+    {
+        // ceil(2^(32 + log2) / count) fits in 32 bits as count is not a power of 2
+        reciprocal.shift      = 32 + log2;
+        reciprocal.multiplier = (uint32_t)((((uint64_t)1 << reciprocal.shift) + reciprocal.count - 1) / reciprocal.count);
+    }
+
+    return reciprocal;
+}
+
+FrameKernelIsa_t CoaXpressKernels::_DetectIsa()
+{
+    FrameKernelIsa_t eIsa = FrameKernelIsa_Scalar;
+
+    unsigned int regs[4];
+
+    _Cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+
+    if(maxLeaf >= 7)
+    {
+        _Cpuid(1, 0, regs);
+        unsigned int ecx = regs[2];
+
+        // AVX2 also needs the OS to save the ymm registers
+        if((ecx & CPUID1_ECX_OSXSAVE) &&
+           (ecx & CPUID1_ECX_AVX) &&
+           ((_Xgetbv() & XCR0_SSE_AVX_STATE) == XCR0_SSE_AVX_STATE))
+        {
+            _Cpuid(7, 0, regs);
+
+            if(regs[1] & CPUID7_EBX_AVX2)
+            {
+                eIsa = FrameKernelIsa_Avx2;
+            }
+        }
+    }
+
+    return eIsa;
+}
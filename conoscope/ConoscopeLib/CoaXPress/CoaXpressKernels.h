@@ -0,0 +1,90 @@
+#ifndef COAXPRESSKERNELS_H
+#define COAXPRESSKERNELS_H
+
+#include <stdint.h>
+
+/* Class CoaXpressKernels
+ * per pixel primitives used to average the frames
+ *
+ * each primitive has a scalar and an AVX2 implementation, the implementation is
+ * selected once (cpuid). Both implementations return exactly the same result.
+ */
+
+#if defined(_MSC_VER)
+#define FRAME_KERNEL_TARGET_AVX2
+#else
+#define FRAME_KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// number of pixels processed by a thread at once
+#define FRAME_KERNEL_BLOCK_SIZE 16384
+
+// Mono12p: 2 pixels in 3 bytes (lsb first)
+// a packed buffer is always addressed from an even pixel
+#define PACKED_12P_BYTES(pixelCount) (((pixelCount) * 3 + 1) / 2)
+
+typedef enum
+{
+    FrameKernelIsa_Scalar,
+    FrameKernelIsa_Avx2,
+    FrameKernelIsa_Count
+} FrameKernelIsa_t;
+
+// sum / count is done as (sum * multiplier) >> shift
+// multiplier is 0 when the count does not allow it (the division is used)
+typedef struct
+{
+    uint32_t count;
+    uint32_t multiplier;
+    int      shift;
+} FrameReciprocal_t;
+
+typedef struct
+{
+    // dst = src
+    void (*Widen)(uint32_t* dst, const uint16_t* src, int count);
+
+    // dst += src
+    void (*Accumulate)(uint32_t* dst, const uint16_t* src, int count);
+
+    // dst = (uint16_t)(src / reciprocal.count) (truncation)
+    void (*Average)(uint16_t* dst, const uint32_t* src, const FrameReciprocal_t& reciprocal, int count);
+
+    // same as Widen and Accumulate with a Mono12p src (the unpacked pixels are not stored)
+    void (*Widen12p)(uint32_t* dst, const uint8_t* src, int count);
+    void (*Accumulate12p)(uint32_t* dst, const uint8_t* src, int count);
+
+    // dst = unpacked Mono12p src
+    void (*Unpack12p)(uint16_t* dst, const uint8_t* src, int count);
+} FrameKernels_t;
+
+class CoaXpressKernels
+{
+public:
+    static const FrameKernels_t& Get();
+
+    static FrameKernelIsa_t GetIsa();
+
+    // force an implementation (for test purpose), false if the cpu does not support it
+    static bool Select(FrameKernelIsa_t eIsa);
+
+    static const FrameKernels_t& Get(FrameKernelIsa_t eIsa);
+
+    // reciprocal of the number of accumulated frames
+    // exact for sums of up to count 16 bits values
+    static FrameReciprocal_t GetReciprocal(int count);
+
+private:
+    static FrameKernelIsa_t mIsa;
+    static FrameKernels_t   mKernels[FrameKernelIsa_Count];
+
+    static void _Initialise();
+
+    static FrameKernelIsa_t _DetectIsa();
+};
+
+// implementations
+void CoaXpressKernels_Scalar(FrameKernels_t& kernels);
+void CoaXpressKernels_Avx2(FrameKernels_t& kernels);
+
+#endif // COAXPRESSKERNELS_H
@@ -0,0 +1,190 @@
+#include "CoaXpressKernels.h"
+
+#include <immintrin.h>
+
+// AVX2 implementation, 16 pixels per iteration
+// the tail of each buffer is done by the scalar implementation
+
+#define AVX_STEP 16
+
+// _mm256_packus_epi32 works per 128 bits lane, this restores the pixel order
+#define PACK_ORDER 0xD8
+
+// the 16 pixels of an iteration are in 24 bytes, but 32 bytes are loaded
+#define PACKED_12P_LOAD_SIZE 32
+
+// odd pixels of the 16 bits words (_mm256_blend_epi16)
+#define ODD_WORDS 0xAA
+
+static FrameKernels_t scalar;
+
+FRAME_KERNEL_TARGET_AVX2 static void Widen(uint32_t* dst, const uint16_t* src, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)&src[index]);
+
+        _mm256_storeu_si256((__m256i*)&dst[index],     _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data)));
+        _mm256_storeu_si256((__m256i*)&dst[index + 8], _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1)));
+    }
+
+    scalar.Widen(&dst[index], &src[index], count - index);
+}
+
+FRAME_KERNEL_TARGET_AVX2 static void Accumulate(uint32_t* dst, const uint16_t* src, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)&src[index]);
+
+        __m256i sumLow  = _mm256_loadu_si256((const __m256i*)&dst[index]);
+        __m256i sumHigh = _mm256_loadu_si256((const __m256i*)&dst[index + 8]);
+
+        sumLow  = _mm256_add_epi32(sumLow,  _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data)));
+        sumHigh = _mm256_add_epi32(sumHigh, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1)));
+
+        _mm256_storeu_si256((__m256i*)&dst[index],     sumLow);
+        _mm256_storeu_si256((__m256i*)&dst[index + 8], sumHigh);
+    }
+
+    scalar.Accumulate(&dst[index], &src[index], count - index);
+}
+
+// (src * multiplier) >> shift of 8 values, the result is below 2^16
+FRAME_KERNEL_TARGET_AVX2 static inline __m256i _Divide(__m256i src, __m256i multiplier, __m128i shift)
+{
+    __m256i even = _mm256_srl_epi64(_mm256_mul_epu32(src, multiplier), shift);
+    __m256i odd  = _mm256_srl_epi64(_mm256_mul_epu32(_mm256_srli_epi64(src, 32), multiplier), shift);
+
+    return _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+}
+
+FRAME_KERNEL_TARGET_AVX2 static void Average(uint16_t* dst, const uint32_t* src, const FrameReciprocal_t& reciprocal, int count)
+{
+    int index = 0;
+
+    if(reciprocal.multiplier != 0)
+    {
+        __m256i multiplier = _mm256_set1_epi32((int)reciprocal.multiplier);
+        __m128i shift      = _mm_cvtsi32_si128(reciprocal.shift);
+
+        for(; index + AVX_STEP <= count; index += AVX_STEP)
+        {
+            __m256i low  = _Divide(_mm256_loadu_si256((const __m256i*)&src[index]),     multiplier, shift);
+            __m256i high = _Divide(_mm256_loadu_si256((const __m256i*)&src[index + 8]), multiplier, shift);
+
+            __m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), PACK_ORDER);
+
+            _mm256_storeu_si256((__m256i*)&dst[index], result);
+        }
+    }
+
+    scalar.Average(&dst[index], &src[index], reciprocal, count - index);
+}
+
+// unpack 16 Mono12p pixels (24 bytes)
+FRAME_KERNEL_TARGET_AVX2 static inline __m256i _Unpack12p(const uint8_t* src)
+{
+    // each 128 bits lane gets the 12 bytes of its 8 pixels
+    __m256i data = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)src),
+                                               _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6));
+
+    // pixel 2k is in bytes 3k and 3k+1, pixel 2k+1 in bytes 3k+1 and 3k+2
+    __m256i shuffle = _mm256_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+                                       0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+
+    data = _mm256_shuffle_epi8(data, shuffle);
+
+    __m256i even = _mm256_and_si256(data, _mm256_set1_epi16(0x0FFF));
+    __m256i odd  = _mm256_srli_epi16(data, 4);
+
+    return _mm256_blend_epi16(even, odd, ODD_WORDS);
+}
+
+// number of pixels that can be unpacked with the AVX2 implementation
+static inline int _GetPacked12pVectorCount(int count)
+{
+    int packedBytes = PACKED_12P_BYTES(count);
+
+    if(packedBytes < PACKED_12P_LOAD_SIZE)
+    {
+        return 0;
+    }
+
+    // the last load must stay in the buffer
+    int vectorCount = ((packedBytes - PACKED_12P_LOAD_SIZE) * 2) / 3;
+
+    if(vectorCount > count)
+    {
+        vectorCount = count;
+    }
+
+    return vectorCount - (vectorCount % AVX_STEP);
+}
+
+FRAME_KERNEL_TARGET_AVX2 static void Widen12p(uint32_t* dst, const uint8_t* src, int count)
+{
+    int vectorCount = _GetPacked12pVectorCount(count);
+    int index = 0;
+
+    for(; index < vectorCount; index += AVX_STEP)
+    {
+        __m256i data = _Unpack12p(&src[(index / 2) * 3]);
+
+        _mm256_storeu_si256((__m256i*)&dst[index],     _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data)));
+        _mm256_storeu_si256((__m256i*)&dst[index + 8], _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1)));
+    }
+
+    scalar.Widen12p(&dst[index], &src[(index / 2) * 3], count - index);
+}
+
+FRAME_KERNEL_TARGET_AVX2 static void Accumulate12p(uint32_t* dst, const uint8_t* src, int count)
+{
+    int vectorCount = _GetPacked12pVectorCount(count);
+    int index = 0;
+
+    for(; index < vectorCount; index += AVX_STEP)
+    {
+        __m256i data = _Unpack12p(&src[(index / 2) * 3]);
+
+        __m256i sumLow  = _mm256_loadu_si256((const __m256i*)&dst[index]);
+        __m256i sumHigh = _mm256_loadu_si256((const __m256i*)&dst[index + 8]);
+
+        sumLow  = _mm256_add_epi32(sumLow,  _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data)));
+        sumHigh = _mm256_add_epi32(sumHigh, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1)));
+
+        _mm256_storeu_si256((__m256i*)&dst[index],     sumLow);
+        _mm256_storeu_si256((__m256i*)&dst[index + 8], sumHigh);
+    }
+
+    scalar.Accumulate12p(&dst[index], &src[(index / 2) * 3], count - index);
+}
+
+FRAME_KERNEL_TARGET_AVX2 static void Unpack12p(uint16_t* dst, const uint8_t* src, int count)
+{
+    int vectorCount = _GetPacked12pVectorCount(count);
+    int index = 0;
+
+    for(; index < vectorCount; index += AVX_STEP)
+    {
+        _mm256_storeu_si256((__m256i*)&dst[index], _Unpack12p(&src[(index / 2) * 3]));
+    }
+
+    scalar.Unpack12p(&dst[index], &src[(index / 2) * 3], count - index);
+}
+
+void CoaXpressKernels_Avx2(FrameKernels_t& kernels)
+{
+    CoaXpressKernels_Scalar(scalar);
+
+    kernels.Widen         = Widen;
+    kernels.Accumulate    = Accumulate;
+    kernels.Average       = Average;
+    kernels.Widen12p      = Widen12p;
+    kernels.Accumulate12p = Accumulate12p;
+    kernels.Unpack12p     = Unpack12p;
+}
@@ -0,0 +1,514 @@
+#include "CoaXpressRecord.h"
+
+#include <string.h>
+
+// "CXPR"
+#define RECORD_MAGIC   0x52505843
+#define RECORD_VERSION 1
+
+QMutex CoaXpressRecorder::mInstanceMutex;
+std::atomic<CoaXpressRecorder*> CoaXpressRecorder::mInstance(NULL);
+
+static void _WriteFeature(QDataStream& stream, const ImageFeature& frame)
+{
+    stream << (qint32)frame.width
+           << (qint32)frame.height
+           << (qint32)frame.offsetX
+           << (qint32)frame.offsetY
+           << (qint32)frame.eFormat
+           << (qint32)frame.eCameraManufacturer;
+}
+
+CoaXpressRecorder::CoaXpressRecorder(QString filePath, int lineStep) : QThread()
+{
+    mFile.setFileName(filePath);
+
+    mLineStep    = (lineStep > 0) ? lineStep : 0;
+    mQueueBytes  = 0;
+    mStopRequest = false;
+}
+
+CoaXpressRecorder::~CoaXpressRecorder()
+{
+    if(mFile.isOpen() == true)
+    {
+        mFile.close();
+    }
+}
+
+bool CoaXpressRecorder::Open(QString filePath, int lineStep, const ImageFeature& frame)
+{
+    Close();
+
+    CoaXpressRecorder* recorder = new CoaXpressRecorder(filePath, lineStep);
+
+    if(recorder->mFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        delete recorder;
+        return false;
+    }
+
+    QDataStream stream(&recorder->mFile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << (quint32)RECORD_MAGIC << (quint32)RECORD_VERSION;
+
+    recorder->mTimer.start();
+    recorder->start();
+
+    {
+        QMutexLocker locker(&mInstanceMutex);
+        mInstance = recorder;
+    }
+
+    RecordFrame(frame);
+
+    return true;
+}
+
+void CoaXpressRecorder::Close()
+{
+    CoaXpressRecorder* recorder = NULL;
+
+    {
+        QMutexLocker locker(&mInstanceMutex);
+        recorder = mInstance.exchange(NULL);
+    }
+
+    if(recorder != NULL)
+    {
+        recorder->mQueueMutex.lock();
+        recorder->mStopRequest = true;
+        recorder->mQueueCondition.wakeAll();
+        recorder->mQueueMutex.unlock();
+
+        recorder->wait();
+
+        delete recorder;
+    }
+}
+
+bool CoaXpressRecorder::IsOpen()
+{
+    return (mInstance.load() != NULL) ? true : false;
+}
+
+void CoaXpressRecorder::RecordFrame(const ImageFeature& frame)
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    CoaXpressRecorder* recorder = mInstance;
+
+    if(recorder != NULL)
+    {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+
+        recorder->_WriteHeader(stream, CoaXpressRecord_Frame);
+        _WriteFeature(stream, frame);
+
+        recorder->_Enqueue(record);
+    }
+}
+
+void CoaXpressRecorder::RecordFeature(const std::string& feature, const QString& value)
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    CoaXpressRecorder* recorder = mInstance;
+
+    if(recorder != NULL)
+    {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+
+        recorder->_WriteHeader(stream, CoaXpressRecord_Feature);
+        stream << QByteArray::fromStdString(feature) << value.toUtf8();
+
+        recorder->_Enqueue(record);
+    }
+}
+
+void CoaXpressRecorder::RecordStart(int imageNumber)
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    CoaXpressRecorder* recorder = mInstance;
+
+    if(recorder != NULL)
+    {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+
+        recorder->_WriteHeader(stream, CoaXpressRecord_Start);
+        stream << (qint32)imageNumber;
+
+        recorder->_Enqueue(record);
+    }
+}
+
+void CoaXpressRecorder::RecordStop()
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    CoaXpressRecorder* recorder = mInstance;
+
+    if(recorder != NULL)
+    {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+
+        recorder->_WriteHeader(stream, CoaXpressRecord_Stop);
+
+        recorder->_Enqueue(record);
+    }
+}
+
+void CoaXpressRecorder::RecordBuffer(const ImageBuffer& imageBuffer, uint64_t deviceTimeStampUs)
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    CoaXpressRecorder* recorder = mInstance;
+
+    if(recorder == NULL)
+    {
+        return;
+    }
+
+    int lineBytes = (imageBuffer.height > 0) ? (int)(imageBuffer.bufSize / imageBuffer.height) : 0;
+    int lineStep  = recorder->mLineStep;
+
+    QByteArray data;
+
+    if((lineStep > 0) && (lineBytes > 0))
+    {
+        int lineCount = (imageBuffer.height + lineStep - 1) / lineStep;
+
+        recorder->mQueueMutex.lock();
+        bool bFull = (recorder->mQueueBytes + (qint64)lineCount * lineBytes > RECORD_QUEUE_MAX_BYTES) ? true : false;
+        recorder->mQueueMutex.unlock();
+
+        if(bFull == false)
+        {
+            data.resize(lineCount * lineBytes);
+
+            const char* pSrc = (const char*)imageBuffer.ptr;
+            char*       pDst = data.data();
+
+            for(int lineIndex = 0; lineIndex < imageBuffer.height; lineIndex += lineStep)
+            {
+                memcpy(pDst, &pSrc[(size_t)lineIndex * lineBytes], lineBytes);
+                pDst += lineBytes;
+            }
+        }
+        else
+        {
+            // the disk does not follow, only the arrival is recorded
+            lineStep = 0;
+        }
+    }
+    else
+    {
+        lineStep = 0;
+    }
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+
+    recorder->_WriteHeader(stream, CoaXpressRecord_Buffer);
+
+    stream << (quint64)deviceTimeStampUs
+           << (qint32)imageBuffer.width
+           << (qint32)imageBuffer.height
+           << (qint32)lineStep
+           << (qint32)lineBytes
+           << data;
+
+    recorder->_Enqueue(record);
+}
+
+void CoaXpressRecorder::_WriteHeader(QDataStream& stream, CoaXpressRecord_t eType)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << (quint8)eType << (qint64)(mTimer.nsecsElapsed() / 1000);
+}
+
+void CoaXpressRecorder::_Enqueue(const QByteArray& record)
+{
+    QMutexLocker locker(&mQueueMutex);
+
+    mQueue.enqueue(record);
+    mQueueBytes += record.size();
+
+    mQueueCondition.wakeAll();
+}
+
+void CoaXpressRecorder::run()
+{
+    forever
+    {
+        mQueueMutex.lock();
+
+        while((mQueue.isEmpty() == true) && (mStopRequest == false))
+        {
+            mQueueCondition.wait(&mQueueMutex);
+        }
+
+        if(mQueue.isEmpty() == true)
+        {
+            // stop requested and everything is written
+            mQueueMutex.unlock();
+            break;
+        }
+
+        QByteArray record = mQueue.dequeue();
+
+        mQueueMutex.unlock();
+
+        mFile.write(record);
+
+        mQueueMutex.lock();
+        mQueueBytes -= record.size();
+        mQueueMutex.unlock();
+    }
+
+    mFile.flush();
+}
+
+CoaXpressReplay::CoaXpressReplay()
+{
+    mDataPosition = 0;
+}
+
+CoaXpressReplay::~CoaXpressReplay()
+{
+    Close();
+}
+
+bool CoaXpressReplay::Open(QString filePath)
+{
+    Close();
+
+    mFile.setFileName(filePath);
+
+    if(mFile.open(QIODevice::ReadOnly) == false)
+    {
+        return false;
+    }
+
+    mStream.setDevice(&mFile);
+    mStream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic   = 0;
+    quint32 version = 0;
+
+    mStream >> magic >> version;
+
+    if((magic != RECORD_MAGIC) || (version != RECORD_VERSION))
+    {
+        Close();
+        return false;
+    }
+
+    mDataPosition = mFile.pos();
+
+    // the recording starts with the size of the frames
+    CoaXpressRecord_t eType;
+    qint64 timeUs;
+
+    if((_ReadHeader(eType, timeUs) == false) || (eType != CoaXpressRecord_Frame))
+    {
+        Close();
+        return false;
+    }
+
+    _ReadFrame(mFrameFeature);
+
+    return true;
+}
+
+void CoaXpressReplay::Close()
+{
+    mStream.setDevice(NULL);
+
+    if(mFile.isOpen() == true)
+    {
+        mFile.close();
+    }
+}
+
+bool CoaXpressReplay::IsOpen()
+{
+    return mFile.isOpen();
+}
+
+const ImageFeature& CoaXpressReplay::GetFrameFeature()
+{
+    return mFrameFeature;
+}
+
+bool CoaXpressReplay::NextStart(int& imageNumber, qint64& timeUs, QStringList& features)
+{
+    CoaXpressRecord_t eType;
+    bool bRewound = false;
+
+    features.clear();
+
+    forever
+    {
+        if(_ReadHeader(eType, timeUs) == false)
+        {
+            // no acquisition in the whole recording
+            if(bRewound == true)
+            {
+                return false;
+            }
+
+            // the recording is replayed again
+            mFile.seek(mDataPosition);
+            mStream.resetStatus();
+            bRewound = true;
+            continue;
+        }
+
+        if(eType == CoaXpressRecord_Start)
+        {
+            qint32 value;
+            mStream >> value;
+
+            imageNumber = value;
+            return true;
+        }
+        else if(eType == CoaXpressRecord_Feature)
+        {
+            QByteArray name;
+            QByteArray value;
+
+            mStream >> name >> value;
+
+            features.append(QString("%1 = %2").arg(QString::fromUtf8(name)).arg(QString::fromUtf8(value)));
+        }
+        else
+        {
+            _Skip(eType);
+        }
+    }
+}
+
+bool CoaXpressReplay::NextBuffer(CoaXpressRecordBuffer_t& buffer)
+{
+    CoaXpressRecord_t eType;
+    qint64 timeUs;
+
+    forever
+    {
+        if(_ReadHeader(eType, timeUs) == false)
+        {
+            return false;
+        }
+
+        if(eType == CoaXpressRecord_Buffer)
+        {
+            buffer.timeUs = timeUs;
+            _ReadBuffer(buffer);
+            return true;
+        }
+        else if((eType == CoaXpressRecord_Stop) || (eType == CoaXpressRecord_Start))
+        {
+            // NextStart reads the next acquisition
+            if(eType == CoaXpressRecord_Start)
+            {
+                mFile.seek(mFile.pos() - sizeof(quint8) - sizeof(qint64));
+            }
+            return false;
+        }
+        else
+        {
+            // features written while streaming
+            _Skip(eType);
+        }
+    }
+}
+
+bool CoaXpressReplay::_ReadHeader(CoaXpressRecord_t& eType, qint64& timeUs)
+{
+    if(mFile.atEnd() == true)
+    {
+        return false;
+    }
+
+    quint8 type;
+
+    mStream >> type >> timeUs;
+
+    eType = (CoaXpressRecord_t)type;
+
+    return (mStream.status() == QDataStream::Ok) ? true : false;
+}
+
+void CoaXpressReplay::_ReadFrame(ImageFeature& frame)
+{
+    qint32 width, height, offsetX, offsetY, eFormat, eCameraManufacturer;
+
+    mStream >> width >> height >> offsetX >> offsetY >> eFormat >> eCameraManufacturer;
+
+    frame.width               = width;
+    frame.height              = height;
+    frame.offsetX             = offsetX;
+    frame.offsetY             = offsetY;
+    frame.eFormat             = (PixelFormat_t)eFormat;
+    frame.eCameraManufacturer = (CameraManufacturer_t)eCameraManufacturer;
+}
+
+void CoaXpressReplay::_ReadBuffer(CoaXpressRecordBuffer_t& buffer)
+{
+    quint64 deviceTimeStampUs;
+    qint32 width, height, lineStep, lineBytes;
+
+    mStream >> deviceTimeStampUs >> width >> height >> lineStep >> lineBytes >> buffer.data;
+
+    buffer.deviceTimeStampUs = deviceTimeStampUs;
+    buffer.width             = width;
+    buffer.height            = height;
+    buffer.lineStep          = lineStep;
+    buffer.lineBytes         = lineBytes;
+}
+
+void CoaXpressReplay::_Skip(CoaXpressRecord_t eType)
+{
+    switch(eType)
+    {
+    case CoaXpressRecord_Frame:
+    {
+        ImageFeature frame;
+        _ReadFrame(frame);
+        break;
+    }
+
+    case CoaXpressRecord_Feature:
+    {
+        QByteArray name;
+        QByteArray value;
+        mStream >> name >> value;
+        break;
+    }
+
+    case CoaXpressRecord_Start:
+    {
+        qint32 value;
+        mStream >> value;
+        break;
+    }
+
+    case CoaXpressRecord_Stop:
+        break;
+
+    case CoaXpressRecord_Buffer:
+    {
+        CoaXpressRecordBuffer_t buffer;
+        _ReadBuffer(buffer);
+        break;
+    }
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef COAXPRESSRECORD_H
+#define COAXPRESSRECORD_H
+
+#include "CoaXpressTypes.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDataStream>
+#include <QByteArray>
+#include <QQueue>
+#include <QStringList>
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+// extension of the recordings (selects the replay in the emulated camera)
+#define RECORD_EXTENSION "cxprec"
+
+// the contents of the images are not recorded anymore while more than this is waiting to be written
+// (the arrival of the buffers is still recorded)
+#define RECORD_QUEUE_MAX_BYTES (256 * 1024 * 1024)
+
+typedef enum
+{
+    CoaXpressRecord_Frame,   // size and format of the frames
+    CoaXpressRecord_Feature, // GenICam feature written
+    CoaXpressRecord_Start,   // acquisition started (number of images, 0 for a stream)
+    CoaXpressRecord_Stop,    // acquisition stopped
+    CoaXpressRecord_Buffer   // buffer delivered by the grabber
+} CoaXpressRecord_t;
+
+typedef struct
+{
+    qint64   timeUs;            // time of arrival since the recording started
+    uint64_t deviceTimeStampUs; // time stamp of the grabber
+    int      width;
+    int      height;
+    int      lineStep;          // one line every lineStep lines is in data (0: no contents)
+    int      lineBytes;         // size of a line of the buffer
+    QByteArray data;
+} CoaXpressRecordBuffer_t;
+
+/* Class CoaXpressRecorder
+ * record of the grabber activity in a file
+ *
+ * the arrival time of the buffers, their contents (one line every lineStep lines)
+ * and the features written are recorded so a production trace can be replayed
+ * (CoaXpressReplay). The grabber only copies the data, the file is written by a
+ * thread. All the methods do nothing when no recording is open.
+ */
+class CoaXpressRecorder : public QThread
+{
+    Q_OBJECT
+
+private:
+    static QMutex mInstanceMutex;
+    static std::atomic<CoaXpressRecorder*> mInstance;
+
+    CoaXpressRecorder(QString filePath, int lineStep);
+
+    ~CoaXpressRecorder();
+
+    QFile         mFile;
+    int           mLineStep;
+    QElapsedTimer mTimer;
+
+    QMutex          mQueueMutex;
+    QWaitCondition  mQueueCondition;
+    QQueue<QByteArray> mQueue;
+    qint64          mQueueBytes;
+    bool            mStopRequest;
+
+    // type and time of a record
+    void _WriteHeader(QDataStream& stream, CoaXpressRecord_t eType);
+
+    // queue a record for the writing thread
+    void _Enqueue(const QByteArray& record);
+
+protected:
+    void run() override;
+
+public:
+    // frame is the size of the frames when the recording starts
+    static bool Open(QString filePath, int lineStep, const ImageFeature& frame);
+
+    // the records waiting are written before the file is closed
+    static void Close();
+
+    static bool IsOpen();
+
+    static void RecordFrame(const ImageFeature& frame);
+
+    static void RecordFeature(const std::string& feature, const QString& value);
+
+    static void RecordStart(int imageNumber);
+
+    static void RecordStop();
+
+    static void RecordBuffer(const ImageBuffer& imageBuffer, uint64_t deviceTimeStampUs);
+};
+
+/* Class CoaXpressReplay
+ * read a recording of CoaXpressRecorder
+ *
+ * the acquisitions are read one after the other, the recording is read again
+ * from the beginning when its end is reached.
+ */
+class CoaXpressReplay
+{
+public:
+    CoaXpressReplay();
+
+    ~CoaXpressReplay();
+
+    // the first frame record gives the size of the frames
+    bool Open(QString filePath);
+
+    void Close();
+
+    bool IsOpen();
+
+    const ImageFeature& GetFrameFeature();
+
+    // go to the next acquisition, features lists the features written before it
+    // timeUs is the time the acquisition started
+    bool NextStart(int& imageNumber, qint64& timeUs, QStringList& features);
+
+    // next buffer of the acquisition (false when the acquisition is stopped)
+    bool NextBuffer(CoaXpressRecordBuffer_t& buffer);
+
+private:
+    QFile        mFile;
+    QDataStream  mStream;
+    qint64       mDataPosition; // first record
+    ImageFeature mFrameFeature;
+
+    // type and time of the next record (false at the end of the file)
+    bool _ReadHeader(CoaXpressRecord_t& eType, qint64& timeUs);
+
+    void _ReadFrame(ImageFeature& frame);
+
+    void _ReadBuffer(CoaXpressRecordBuffer_t& buffer);
+
+    // payload of a record that is not used
+    void _Skip(CoaXpressRecord_t eType);
+};
+
+#endif // COAXPRESSRECORD_H
@@ -6,6 +6,7 @@ typedef enum
     PixelFormat_Mono8,
     PixelFormat_Mono10,
     PixelFormat_Mono12,
+    PixelFormat_Mono12p,    // 2 pixels in 3 bytes (not unpacked by the grabber)
     PixelFormat_Unknown,
 } PixelFormat_t;
 
@@ -172,6 +172,7 @@ ClassCommon::Error Conoscope::ChangeState(State eState, void* parameter)
     SetupConfig_t*      pSetupConfig = (SetupConfig_t*)parameter;
     MeasureConfigWithCropFactor_t*    pMeasureConfig = (MeasureConfigWithCropFactor_t*)parameter;
     ProcessingConfig_t* pProcessingConfig = (ProcessingConfig_t*)parameter;
+    StreamConfig_t*     pStreamConfig = (StreamConfig_t*)parameter;
 
     ConoscopeDebugSettings_t debugConfig;
     mConfig->GetConfig(debugConfig);
@@ -317,6 +318,39 @@ ClassCommon::Error Conoscope::ChangeState(State eState, void* parameter)
         SendRequest(ConoscopeWorker::Request::CmdCfgFileReadProcessing);
         break;
 
+    case State::CmdStreamStartProcessing:
+        eError = ConoscopeProcess::CmdStreamStart(*pStreamConfig);
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            _SetState(State::Streaming);
+        }
+        else if((eError == ClassCommon::Error::InvalidParameter) ||
+                (eError == ClassCommon::Error::InvalidConfiguration))
+        {
+            RESOURCE->SendWarning();
+
+            _SetState(State::Ready);
+        }
+        else
+        {
+            _SetState(State::Error);
+        }
+        break;
+
+    case State::CmdStreamStopProcessing:
+        eError = ConoscopeProcess::CmdStreamStop();
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            _SetState(State::Ready);
+        }
+        else
+        {
+            _SetState(State::Error);
+        }
+        break;
+
     default:
         // keep that line to explicitelly define all transitions
         // event if there is no actions
@@ -396,6 +430,10 @@ ClassCommon::Error Conoscope::ProcessStateMachine(Event eEvent, void* parameter)
         {
             eError = ChangeState(State::CmdMeasureProcessing, parameter);
         }
+        else if(eEvent == Event::CmdStreamStart)
+        {
+            eError = ChangeState(State::CmdStreamStartProcessing, parameter);
+        }
         else if(eEvent == Event::CmdClose)
         {
             eError = ChangeState(State::CmdCloseProcessing);
@@ -431,6 +469,10 @@ ClassCommon::Error Conoscope::ProcessStateMachine(Event eEvent, void* parameter)
         {
             eError = ChangeState(State::CmdExportProcessedProcessing, parameter);
         }
+        else if(eEvent == Event::CmdStreamStart)
+        {
+            eError = ChangeState(State::CmdStreamStartProcessing, parameter);
+        }
         else if(eEvent == Event::CmdClose)
         {
             eError = ChangeState(State::CmdCloseProcessing);
@@ -441,6 +483,18 @@ ClassCommon::Error Conoscope::ProcessStateMachine(Event eEvent, void* parameter)
         }
         break;
 
+    case State::Streaming:
+        if(eEvent == Event::CmdStreamStop)
+        {
+            eError = ChangeState(State::CmdStreamStopProcessing);
+        }
+        else if(eEvent == Event::CmdClose)
+        {
+            // the stream is stopped before closing
+            eError = ChangeState(State::CmdCloseProcessing);
+        }
+        break;
+
 #ifdef MULTITHREAD_CAPTURE_SEQUENCE
     case State::CmdExportRawProcessing:
     case State::CmdExportProcessedProcessing:
@@ -1034,6 +1088,106 @@ ClassCommon::Error Conoscope::CmdConvertRaw(ConvertRaw_t &param)
     return eError;
 }
 
+ClassCommon::Error Conoscope::CmdExportFlush()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    // this API does not go into the state machine, it only waits for the files
+    LogInFile("> CmdExportFlush");
+
+    eError = ConoscopeProcess::CmdExportFlush();
+
+    LogInFile(QString("< CmdExportFlush - %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error Conoscope::CmdStreamStart(StreamConfig_t &config)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LogInFile("> CmdStreamStart");
+
+    if(config.exposureTimeUs < 10)
+    {
+        LogInFile(QString("CmdStreamStart invalid parameter: exposureTime %1").arg(config.exposureTimeUs));
+        eError = ClassCommon::Error::InvalidParameter;
+    }
+
+    if((config.nbAcquisition < 1) || (config.nbAcquisition > 30))
+    {
+        LogInFile(QString("CmdStreamStart invalid parameter: nbAcquisition %1").arg(config.nbAcquisition));
+        eError = ClassCommon::Error::InvalidParameter;
+    }
+
+    if(config.queueSize < 1)
+    {
+        LogInFile(QString("CmdStreamStart invalid parameter: queueSize %1").arg(config.queueSize));
+        eError = ClassCommon::Error::InvalidParameter;
+    }
+
+    if(eError == ClassCommon::Error::Ok)
+    {
+        eError = ProcessStateMachine(Event::CmdStreamStart, &config);
+    }
+
+    LogInFile(QString("< CmdStreamStart - %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error Conoscope::CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    // this API does not go into the state machine, it is called for each frame
+    if(mState == State::Streaming)
+    {
+        eError = ConoscopeProcess::CmdStreamRead(buffer, info, timeoutMs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error Conoscope::CmdStreamSetExposure(int exposureTimeUs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LogInFile("> CmdStreamSetExposure");
+
+    if(exposureTimeUs < 10)
+    {
+        eError = ClassCommon::Error::InvalidParameter;
+    }
+    else if(mState == State::Streaming)
+    {
+        eError = ConoscopeProcess::CmdStreamSetExposure(exposureTimeUs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error Conoscope::CmdStreamStop()
+{
+    ClassCommon::Error eError;
+
+    LogInFile("> CmdStreamStop");
+
+    eError = ProcessStateMachine(Event::CmdStreamStop);
+
+    LogInFile(QString("< CmdStreamStop - %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
 void Conoscope::GetSomeInfo(SomeInfo_t& info)
 {
     ConoscopeProcess::GetSomeInfo(info);
@@ -29,6 +29,9 @@ public:
         CmdCfgFileRead,
         CmdCfgFileStatus,
 
+        CmdStreamStart,
+        CmdStreamStop,
+
         Error,
     };
     Q_ENUM(Event)
@@ -40,6 +43,7 @@ public:
         Opened,
         Ready,
         CaptureDone,
+        Streaming,
 
         CmdOpenProcessing,
         CmdSetupProcessing,
@@ -52,6 +56,9 @@ public:
         CmdCfgFileWriteProcessing,
         CmdCfgFileReadProcessing,
 
+        CmdStreamStartProcessing,
+        CmdStreamStopProcessing,
+
         Error,
     };
     Q_ENUM(State)
@@ -182,6 +189,13 @@ public:
 
     ClassCommon::Error CmdConvertRaw(ConvertRaw_t &param);
 
+    ClassCommon::Error CmdStreamStart(StreamConfig_t &config);
+    ClassCommon::Error CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs);
+    ClassCommon::Error CmdStreamSetExposure(int exposureTimeUs);
+    ClassCommon::Error CmdStreamStop();
+
+    ClassCommon::Error CmdExportFlush();
+
     void GetSomeInfo(SomeInfo_t &info);
 
 private:
@@ -198,6 +198,12 @@ void ConoscopeConfig::_Default()
     mConoscopeSettingsI.cfgFileName = "Cfg.zip";
     mConoscopeSettingsI.cfgFileIsZip = true;
     mConoscopeSettingsI.AEMaxNbPixel  = 5000;
+    mConoscopeSettingsI.telemetryPeriodMs = 1000;
+    mConoscopeSettingsI.grabberRecordPath = "";
+    mConoscopeSettingsI.grabberRecordLineStep = 8;
+    mConoscopeSettingsI.rawCompression = false;
+    mConoscopeSettingsI.captureSequenceContainerMB = 0;
+    mConoscopeSettingsI.previewThumbnailScale = 0;
 
     mCaptureSequenceConfig.sensorTemperature = 25;
     mCaptureSequenceConfig.bWaitForSensorTemperature = false;
@@ -257,7 +263,7 @@ bool ConoscopeConfig::_Load()
         count += conoscopeSettingsIObject.count();
         count += captureSequenceConfigObject.count();
 
-        int itemCountCheck = 53;
+        int itemCountCheck = 59;
 
         if(count != itemCountCheck)
         {
@@ -355,6 +361,12 @@ bool ConoscopeConfig::_Load()
             mConoscopeSettingsI.cfgFileName            = CONVERT_TO_STRING(conoscopeSettingsIObject["cfgFileName"].toString());
             mConoscopeSettingsI.cfgFileIsZip           = conoscopeSettingsIObject["cfgFileIsZip"].toBool();
             mConoscopeSettingsI.AEMaxNbPixel           = conoscopeSettingsIObject["captureSequenceMaxNbPixel"].toInt();
+            mConoscopeSettingsI.telemetryPeriodMs      = conoscopeSettingsIObject["telemetryPeriodMs"].toInt();
+            mConoscopeSettingsI.grabberRecordPath      = CONVERT_TO_STRING(conoscopeSettingsIObject["grabberRecordPath"].toString());
+            mConoscopeSettingsI.grabberRecordLineStep  = conoscopeSettingsIObject["grabberRecordLineStep"].toInt();
+            mConoscopeSettingsI.rawCompression         = conoscopeSettingsIObject["rawCompression"].toBool();
+            mConoscopeSettingsI.captureSequenceContainerMB = conoscopeSettingsIObject["captureSequenceContainerMB"].toInt();
+            mConoscopeSettingsI.previewThumbnailScale  = conoscopeSettingsIObject["previewThumbnailScale"].toInt();
 
             mCaptureSequenceConfig.sensorTemperature         = captureSequenceConfigObject["sensorTemperature"].toDouble();
             mCaptureSequenceConfig.bWaitForSensorTemperature = captureSequenceConfigObject["bWaitForSensorTemperature"].toBool();
@@ -445,6 +457,12 @@ void ConoscopeConfig::_Save()
     JSON_INSERT_STR(ConoscopeSettingsI, cfgFileName);
     JSON_INSERT(ConoscopeSettingsI, cfgFileIsZip);
     JSON_INSERT(ConoscopeSettingsI, AEMaxNbPixel);
+    JSON_INSERT(ConoscopeSettingsI, telemetryPeriodMs);
+    JSON_INSERT_STR(ConoscopeSettingsI, grabberRecordPath);
+    JSON_INSERT(ConoscopeSettingsI, grabberRecordLineStep);
+    JSON_INSERT(ConoscopeSettingsI, rawCompression);
+    JSON_INSERT(ConoscopeSettingsI, captureSequenceContainerMB);
+    JSON_INSERT(ConoscopeSettingsI, previewThumbnailScale);
 
     QJsonObject objectCaptureSequenceConfig;
 
@@ -21,8 +21,12 @@
 
 #include "toolString.h"
 #include "toolReturnCode.h"
+#include "toolFileWriter.h"
+#include "toolRawCodec.h"
+#include "toolPreview.h"
 
 #include <QElapsedTimer>
+#include <QCryptographicHash>
 
 #define RAW_FILE_NAME "%1_raw"
 #define PROCESSED_FILE_NAME "%1_proc"
@@ -38,6 +42,8 @@
 #define SLEEP_TIME_MS   100
 #define TIME_QUANTA_MS  10
 
+#define MEASUREMENT_TIMEOUT_MS (MAX_ATTEMPTS * SLEEP_TIME_MS)
+
 #define CONVERT_TO_QSTRING(a) QString::fromUtf8(a.c_str())
 #define CONVERT_TO_STRING(a) a.toUtf8().constData();
 
@@ -51,6 +57,7 @@
 
 #define IMAGE_INFO_EXTENSION ".json"
 #define IMAGE_JPG_EXTENSION ".jpg"
+#define IMAGE_THUMBNAIL_SUFFIX "_thumb"
 
 ConoscopeProcess* ConoscopeProcess::mInstance = NULL;
 
@@ -79,6 +86,11 @@ ConoscopeProcess::ConoscopeProcess(QObject *parent) : ClassCommon(parent)
     mCamera = nullptr;
     mDevices = nullptr;
     mTempMonitor = nullptr;
+    mStream = nullptr;
+
+    // the exported files are written in background
+    connect(FileWriter::Instance(), &FileWriter::Written,
+            this, &ConoscopeProcess::OnFileWritten);
 
 #ifndef CREATE_CAMERA_DURING_OPEN
     // create the camera and all the devices
@@ -152,6 +164,12 @@ void ConoscopeProcess::_CreateCamera()
         connect(mCamera, &Camera::LogInFile,
                 this, &ConoscopeProcess::OnCameraLogInFile);
 
+        // temperatures are read in background, not at each capture
+        mCamera->SetTelemetryPeriod(mSettingsI.telemetryPeriodMs);
+
+        // the production traces can be replayed by the emulated camera
+        mCamera->SetRecording(CONVERT_TO_QSTRING(mSettingsI.grabberRecordPath), mSettingsI.grabberRecordLineStep);
+
         mDevices = new CDevices (this,mCamera);
 
         // temperature monitoring is asynchronous
@@ -288,6 +306,31 @@ ClassCommon::Error ConoscopeProcess::CmdConvertRaw(ConvertRaw_t &param)
     INSTANCE->_CmdConvertRaw(param);
 }
 
+ClassCommon::Error ConoscopeProcess::CmdStreamStart(StreamConfig_t &config)
+{
+    INSTANCE->_CmdStreamStart(config);
+}
+
+ClassCommon::Error ConoscopeProcess::CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs)
+{
+    INSTANCE->_CmdStreamRead(buffer, info, timeoutMs);
+}
+
+ClassCommon::Error ConoscopeProcess::CmdStreamSetExposure(int exposureTimeUs)
+{
+    INSTANCE->_CmdStreamSetExposure(exposureTimeUs);
+}
+
+ClassCommon::Error ConoscopeProcess::CmdStreamStop()
+{
+    INSTANCE->_CmdStreamStop();
+}
+
+ClassCommon::Error ConoscopeProcess::CmdExportFlush()
+{
+    INSTANCE->_CmdExportFlush();
+}
+
 void ConoscopeProcess::GetSomeInfo(SomeInfo_t& info)
 {
     INSTANCE->_GetSomeInfo(info);
@@ -715,8 +758,9 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
     LogInFile(message);
 
     ClassCommon::Error eError = ClassCommon::Error::Ok;
-    bool bDone = false;
-    int numAttempts = 0;
+
+    // the configuration and the date come from the replayed capture
+    bool bCaptureSettings = false;
 
     if(mDebugSettings.emulateCamera == true)
     {
@@ -729,12 +773,14 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
 
         ERROR_DESCRIPTION("ERROR can not load data");
 
+        bCaptureSettings = cameraDummy->HasCaptureSettings();
+
         if(eError == ClassCommon::Error::Ok)
         {
             _GetCameraInfo();
         }
 
-        if(eError == ClassCommon::Error::Ok)
+        if((eError == ClassCommon::Error::Ok) && (bCaptureSettings == true))
         {
             // retrieve the configuration of the capture
             config.exposureTimeUs = settings["exposureTimeUs"].toInt();
@@ -747,12 +793,15 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
             _setupConfig.eFilter           = (Filter_t)settings["setupFilter"].toInt();
             _setupConfig.eNd               = (Nd_t)settings["setupNd"].toInt();
             _setupConfig.eIris             = (IrisIndex_t)settings["setupIris"].toInt();
+        }
 
+        if(eError == ClassCommon::Error::Ok)
+        {
             // retrieve information from camera
             _OpeningInfo();
         }
 
-        if(eError == ClassCommon::Error::Ok)
+        if((eError == ClassCommon::Error::Ok) && (bCaptureSettings == true))
         {
             _captureInfo.timeStampString = settings["timeStampString"].toString();
             _timeStampString_test = settings["timeStampString"].toString();
@@ -777,7 +826,6 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
     mAdditionalInfo.AEMeasAreaX      = config.AEMeasAreaX;
     mAdditionalInfo.AEMeasAreaY      = config.AEMeasAreaY;
 
-    Camera::Status eStatus;
     Camera::CaptureConfig cameraConfig;
 
     ImageConfiguration* imageConfiguration = ImageConfiguration::Get();
@@ -800,6 +848,10 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
     }
 #else
     cameraConfig.mcDimensions  = QRect(0, 0, imageConfiguration->image_width, imageConfiguration->image_height);
+
+    // only the crop area is read after the capture (AE measurement area)
+    // the processed data (even with bUseRoi) needs the whole frame for the dark offset and bias
+    cameraConfig.mcAccumulationArea = config.cropArea;
 #endif
 
     cameraConfig.mbExtTrig         = false;                   // not used
@@ -852,41 +904,15 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
     // wait for the end of the measurement
     if(eError == ClassCommon::Error::Ok)
     {
-        do {
-            mCamera->GetStatus(eStatus);
-
-            if(eError == ClassCommon::Error::Ok)
-            {
-                if(eStatus == Camera::Status::MeasurementPending)
-                {
-                    bDone = false;
+        // the camera wakes up this thread when the frame is captured (or on failure)
+        eError = mCamera->WaitForMeasurement(MEASUREMENT_TIMEOUT_MS);
 
-                    if(numAttempts++ >= MAX_ATTEMPTS)
-                    {
-                         // Log("", "GetStatus FAILED after retry");
-                         eError = ClassCommon::Error::FailedMaxRetry;
-
-                         ERROR_DESCRIPTION("ERROR measurement timeout");
-                    }
-                    else
-                    {
-                        QThread::msleep(SLEEP_TIME_MS);
-                        int timeMs = SLEEP_TIME_MS;
+        if(eError == ClassCommon::Error::Timeout)
+        {
+            eError = ClassCommon::Error::FailedMaxRetry;
 
-                        do
-                        {
-                            QThread::msleep(TIME_QUANTA_MS);
-                            QApplication::processEvents(QEventLoop::AllEvents, TIME_QUANTA_MS);
-                            timeMs -= TIME_QUANTA_MS;
-                        } while(timeMs > 0);
-                    }
-                }
-                else
-                {
-                    bDone = true;
-                }
-            }
-        } while((eError == ClassCommon::Error::Ok) && (bDone == false)) ;
+            ERROR_DESCRIPTION("ERROR measurement timeout");
+        }
 
         if(eError == ClassCommon::Error::Ok)
         {
@@ -927,7 +953,7 @@ ClassCommon::Error ConoscopeProcess::_CmdMeasure(MeasureConfigWithCropFactor_t &
         _captureInfo.temperatureSensor      = rawDataInfo.settings.GetValue("Cpu");
 
         // store information about the capture
-        if(mDebugSettings.emulateCamera == false)
+        if(bCaptureSettings == false)
         {
             if(updateCaptureDate == true)
             {
@@ -1037,7 +1063,9 @@ ClassCommon::Error ConoscopeProcess::_CmdExportRaw()
     uint16_t saturationValue = 4095;
     int nbPixels = mInfo.height * mInfo.width;
 
-    _GetSaturationFlag(saturationValue, nbPixels, (uint16_t*)_rawData.data(), mInfo.saturationFlag, mInfo.saturationLevel);
+    FrameBuffer saturationData = _rawData.IsContiguous() ? _rawData : _rawData.Clone();
+
+    _GetSaturationFlag(saturationValue, nbPixels, saturationData.GetData(), mInfo.saturationFlag, mInfo.saturationLevel);
 
     settings["Measure"]["SaturationFlag"] = mInfo.saturationFlag;
     settings["Measure"]["SaturationLevel"] = mInfo.saturationLevel;
@@ -1048,21 +1076,28 @@ ClassCommon::Error ConoscopeProcess::_CmdExportRaw()
         settings["Measure"]["AeExposureTimeGranularityUs"] = mInfo.AeExpoTimeGranularityUs;
     }
 
-    // save captured image
-    if(_rawData.length() != 0)
+    // the readers recognise the container, the information is only for the user
+    FileWriterEncoding_t eEncoding = FileWriterEncoding_None;
+
+    if(ConoscopeProcess::mSettingsI.rawCompression == true)
     {
-        char* pImage = (char*)_rawData.data();
+        eEncoding = FileWriterEncoding_Raw12;
+        settings["Export"]["RawEncoding"] = QString("CRAW%1").arg(RAW_CODEC_VERSION);
+    }
 
+    // save captured image
+    if(_rawData.IsNull() == false)
+    {
         if((ConoscopeProcess::mSettings.exportFormat == ExportFormat_t::ExportFormat_bin) ||
            (ConoscopeProcess::mSettings.exportFormat == ExportFormat_t::ExportFormat_bin_jpg) )
         {
-            eError = _WriteImageFile(fileName, pImage, _rawData.size(), _captureInfo, settings);
+            eError = _WriteImageFile(fileName, _rawData, _captureInfo, settings, eEncoding);
             _Log(QString("  store image in %1  %2").arg(fileName).arg(ClassCommon::ErrorToString(eError)));
         }
 
         if(ConoscopeProcess::mSettings.exportFormat == ExportFormat_t::ExportFormat_bin_jpg)
         {
-            _SaveImage<uint16_t>(fileName_2, (uint16_t*)pImage, mInfo.height, mInfo.width);
+            _SaveImage(fileName_2, _rawData.GetData(), _rawData.GetHeight(), _rawData.GetWidth(), _rawData.GetStride(), false);
         }
     }
     else
@@ -1085,9 +1120,9 @@ ClassCommon::Error ConoscopeProcess::_CmdExportRaw(std::vector<uint16_t> &buffer
     _FillInfo(_measurementConfig);
 
     // copy the data into the buffer
-    int size = _rawData.size();
+    int size = _rawData.GetSize();
     buffer.resize(size / sizeof(uint16_t));
-    memcpy(buffer.data(), _rawData.data(), size);
+    _rawData.CopyTo(buffer.data());
 
     if(eError == ClassCommon::Error::Ok)
     {
@@ -1327,11 +1362,12 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
 
     if(eError == ClassCommon::Error::Ok)
     {
-        // make a copy of rawdata
-        _inputData.resize(_rawData.size());
-        memcpy(_inputData.data(), _rawData.data(), _rawData.size());
+        // make a packed copy of rawdata (the crop is done at the same time)
+        // the previous one is released first so its buffer is reused
+        _inputData.Release();
+        _inputData = _rawData.Clone();
 
-        inputData = (int16*) _inputData.data();
+        inputData = (int16*) _inputData.GetData();
 
         Pipeline_RawDataParam param;
 
@@ -1392,6 +1428,15 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
         // convert PRNU data
         param.prnuData = &cfgContent.cameraPipeline.sensorPrnu.data;
 
+        // PRNU gain map only depends on the camera and its calibration files
+        param.gainMapId = _GetGainMapId(QString("%1|%2|%3|%4|%5|%6")
+                                        .arg(_captureInfo.cameraBoardSerialNumber)
+                                        .arg(mInfo.cfgPath)
+                                        .arg(mInfo.cameraCfgFileName.data)
+                                        .arg(_GetFileStamp(mInfo.cameraCfgFileName.data))
+                                        .arg(_GetFileStamp(CAMERA_PRNU_PATH(QString(mInfo.cameraCfgFileName.data))))
+                                        .arg(param.prnuData->size()));
+
         // param.prnuData              = cfgContent.cameraPipeline.sensorPrnu.data;
     /*
         float                            prnuScaleFactor;
@@ -1401,7 +1446,7 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
 
         Pipeline_ResultRawDataParam resultParam;
 
-        eError = mPipelineLib->CmdComputeRawData(inputData, &param, resultParam);
+        eError = mPipelineLib->CmdComputeRawData(_inputData, &param, resultParam);
 
         _Log("  CmdComputeRawData");
         _Log(QString("    imageSize                    %1x%2").arg(resultParam.imageSize.width).arg(resultParam.imageSize.height));
@@ -1602,6 +1647,17 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
 
             calibration.flatField = &cfgContent.opticalColumnCalibration.flatField.data;
 
+            // flat field gain map depends on the camera, the setup and the flat field file
+            calibration.gainMapId = _GetGainMapId(QString("%1|%2|%3|%4|%5|%6|%7|%8")
+                                                  .arg(_captureInfo.cameraBoardSerialNumber)
+                                                  .arg(setupConfig.eIris)
+                                                  .arg(setupConfig.eFilter)
+                                                  .arg(setupConfig.eNd)
+                                                  .arg(mInfo.cfgPath)
+                                                  .arg(mInfo.flatFieldFileName.data)
+                                                  .arg(_GetFileStamp(mInfo.flatFieldFileName.data))
+                                                  .arg(calibration.flatField->size()));
+
             calibration.conversionFactor_Value = 1 / imgInfo.exposureUs;
 
             calibration.conversionFactor_SensorTemperature.die.averaged = imgInfo.temperatureSensor;
@@ -1672,7 +1728,7 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
             imgInfo.imageHeight = 0;
             imgInfo.imageWidth  = 0;
 
-            eError = mPipelineLib->CmdComputeKLibData(inputData, param, &calibration, klibData);
+            eError = mPipelineLib->CmdComputeKLibData(_inputData, param, &calibration, klibData);
 
 #ifdef FILE_NAME_FORMAT
             // don't know the size of the image before processing
@@ -1760,7 +1816,7 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
                     jpgFileName.replace(".bin", IMAGE_JPG_EXTENSION);
 
                     // _SaveImage<int16_t>(jpgFileName, (int16_t*)pKlibData, mInfo.height, mInfo.width);
-                    _SaveImage<int16_t>(jpgFileName, (int16_t*)pKlibData, cropHeight, cropWidth);
+                    _SaveImage(jpgFileName, (uint16_t*)pKlibData, cropHeight, cropWidth, 0, true);
                 }
 
                 if(ConoscopeProcess::mSettings.bUseRoi == true)
@@ -1780,9 +1836,6 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
         }
         else
         {
-            char* pSaveData = _inputData.data();
-            int saveDataSize = _inputData.size();
-
             imgInfo.imageHeight = 0;
             imgInfo.imageWidth  = 0;
 
@@ -1804,8 +1857,7 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
             {
                 eError = _WriteImageFile(
                             fileName,
-                            pSaveData,
-                            saveDataSize,
+                            _inputData,
                             imgInfo,
                             settings);
 
@@ -1817,7 +1869,7 @@ ClassCommon::Error ConoscopeProcess::_Processed(SetupConfig_t &setupConfig, Proc
                 QString jpgFileName = fileName;
                 jpgFileName.replace(".bin", IMAGE_JPG_EXTENSION);
 
-                _SaveImage<int16>(jpgFileName, (int16_t*)pSaveData, mInfo.height, mInfo.width);
+                _SaveImage(jpgFileName, _inputData.GetData(), mInfo.height, mInfo.width, 0, true);
             }
         }
     }
@@ -1838,9 +1890,31 @@ ClassCommon::Error ConoscopeProcess::_CmdClose()
     mTempMonitor->CmdReset();
 #endif
 
+    if(mStream != nullptr)
+    {
+        _CmdStreamStop();
+    }
+
+    QString writeError;
+
+    // the exported files are written before the camera is released
+    bool bWritten = FileWriter::Stop(writeError);
+
+    if(bWritten == false)
+    {
+        _Log(QString("  %1").arg(writeError));
+    }
+
     _Log("  Disconnect");
     eError = mCamera->Disconnect();
 
+    if((eError == ClassCommon::Error::Ok) && (bWritten == false))
+    {
+        eError = ClassCommon::Error::Failed;
+
+        ERROR_DESCRIPTION(writeError);
+    }
+
     LogInFile(QString("_CmdClose %1").arg(ClassCommon::ErrorToString(eError)));
 
     return eError;
@@ -1904,6 +1978,170 @@ ClassCommon::Error ConoscopeProcess::_CmdReset()
     return eError;
 }
 
+ClassCommon::Error ConoscopeProcess::_CmdStreamStart(StreamConfig_t &config)
+{
+    QString message;
+
+    message.append("_CmdStreamStart\n");
+
+    message.append(QString("    exposureTimeUs %1\n").arg(config.exposureTimeUs));
+    message.append(QString("    nbAcquisition  %1\n").arg(config.nbAcquisition));
+    message.append(QString("    queueSize      %1").arg(config.queueSize));
+
+    LogInFile(message);
+
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mStream != nullptr)
+    {
+        eError = ClassCommon::Error::InvalidState;
+        ERROR_DESCRIPTION("ERROR stream already started");
+    }
+
+    if((eError == ClassCommon::Error::Ok) &&
+       (mDebugSettings.emulateCamera == true))
+    {
+        CameraDummy* cameraDummy = (CameraDummy*) mCamera;
+
+        QMap<QString, QVariant> settings;
+
+        QString dummyRawImagePath = CONVERT_TO_QSTRING(mDebugSettings.dummyRawImagePath);
+        eError = cameraDummy->LoadRawImage(dummyRawImagePath, settings);
+
+        ERROR_DESCRIPTION("ERROR can not load data");
+
+        cameraDummy->SetStreamFrameRate(config.emulatedFrameRate);
+    }
+
+    Camera::CaptureConfig cameraConfig;
+
+    ImageConfiguration* imageConfiguration = ImageConfiguration::Get();
+
+    cameraConfig.mnExposureMicros  = config.exposureTimeUs;
+    cameraConfig.mnNumImages       = config.nbAcquisition;
+    cameraConfig.mnVBin            = 1;                       // not used
+    cameraConfig.mcDimensions      = QRect(0, 0, imageConfiguration->image_width, imageConfiguration->image_height);
+    cameraConfig.mbExtTrig         = false;                   // not used
+    cameraConfig.mbTestPattern     = false;
+    cameraConfig.mnTrigDelayMicros = 0;                       // not used
+    cameraConfig.bStoreStdDev      = false;
+
+    if(eError == ClassCommon::Error::Ok)
+    {
+        LogInFile("mCamera->Configure");
+        eError = mCamera->Configure(&cameraConfig);
+
+        // update exposure time with the time set (due to exposure time granularity of the camera)
+        config.exposureTimeUs = cameraConfig.mnExposureMicros;
+
+        ERROR_DESCRIPTION("ERROR configure");
+    }
+
+    if(eError == ClassCommon::Error::Ok)
+    {
+        LogInFile("mCamera->StreamStart");
+        eError = mCamera->StreamStart(config.nbAcquisition);
+
+        ERROR_DESCRIPTION("ERROR stream start");
+    }
+
+    if(eError == ClassCommon::Error::Ok)
+    {
+        // the whole frame is streamed
+        mStream = new ConoscopeStream(mCamera, config, QRect());
+        mStream->start();
+    }
+
+    LogInFile(QString("_CmdStreamStart %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeProcess::_CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mStream != nullptr)
+    {
+        eError = mStream->Read(buffer, info, timeoutMs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeProcess::_CmdStreamSetExposure(int exposureTimeUs)
+{
+    LogInFile(QString("_CmdStreamSetExposure %1").arg(exposureTimeUs));
+
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mStream != nullptr)
+    {
+        // applied by the stream thread before the next frame
+        mStream->SetExposureTime(exposureTimeUs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeProcess::_CmdStreamStop()
+{
+    LogInFile("_CmdStreamStop");
+
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    if(mStream != nullptr)
+    {
+        // the thread must not read the camera anymore when the stream is stopped
+        mStream->RequestStop();
+        mStream->wait();
+
+        eError = mCamera->StreamStop();
+
+        delete mStream;
+        mStream = nullptr;
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    LogInFile(QString("_CmdStreamStop %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeProcess::_CmdExportFlush()
+{
+    LogInFile("_CmdExportFlush");
+
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    QString writeError;
+
+    // wait until the exported files are written
+    if(FileWriter::Flush(writeError) == false)
+    {
+        eError = ClassCommon::Error::Failed;
+
+        _Log(QString("  %1").arg(writeError));
+    }
+
+    ERROR_DESCRIPTION(writeError);
+
+    LogInFile(QString("_CmdExportFlush %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
 ClassCommon::Error ConoscopeProcess::_CmdSetupDebug(SetupConfig_t &config)
 {
     LogInFile("_CmdSetupDebug");
@@ -2253,9 +2491,12 @@ ClassCommon::Error ConoscopeProcess::_CmdConvertRaw(ConvertRaw_t &param)
 
     // read back the file (and associated json)
     QString fileName = CONVERT_TO_QSTRING(param.fileName);
-    QByteArray imgData;
+    FrameBuffer imgData;
     ImageInfoRead_t info;
 
+    // the file may still be waiting to be written
+    FileWriter::Wait();
+
     eError = _ReadImageFile(fileName, imgData, info);
 
     if(eError != ClassCommon::Error::Ok)
@@ -2312,13 +2553,21 @@ ClassCommon::Error ConoscopeProcess::_CmdConvertRaw(ConvertRaw_t &param)
 
         _CleanFileName(fileName);
 
-        if(info.bProcessed == false)
-        {
-            eError = _SaveImage<uint16_t>(outputFileName, (uint16_t*)imgData.data(), imageHeight, imageWidth);
-        }
-        else
+        // same preview as the jpg export (the processed data is signed)
+        eError = _SaveImage(outputFileName, imgData.GetData(), imageHeight, imageWidth, 0, info.bProcessed);
+
+        // the file exists when the command returns (not on the measurement path)
+        if(eError == ClassCommon::Error::Ok)
         {
-            eError = _SaveImage<int16_t>(outputFileName, (int16_t*)imgData.data(), imageHeight, imageWidth);
+            QString writeError;
+
+            if(FileWriter::Flush(writeError) == false)
+            {
+                eError = ClassCommon::Error::Failed;
+
+                _Log(QString("  %1").arg(writeError));
+                ERROR_DESCRIPTION(writeError);
+            }
         }
 
         if(eError != ClassCommon::Error::Ok)
@@ -2438,22 +2687,10 @@ ClassCommon::Error ConoscopeProcess::_WriteImageFile(
 
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    qint64 writtenBytesCount = 0;
-    qint64 bytesToCopy = 0;
-
     int bytesPerPixel = 0;
     int lineLength = 0;
     int lineOffset = 0;
 
-    QString path = QFileInfo(filename).absolutePath();
-
-    // create dir if it does not exists
-    QDir dir(path);
-    if (!dir.exists())
-    {
-        dir.mkpath(path);
-    }
-
     // check parameters image size
     int fullImageSize = fullImage.height() * fullImage.width() * PIXEL_SIZE;
 
@@ -2474,68 +2711,77 @@ ClassCommon::Error ConoscopeProcess::_WriteImageFile(
 
     if(eError == ClassCommon::Error::Ok)
     {
-        QFile filePointer(filename);
+        // the buffer of the caller is reused, the data is copied for the writer
+        QByteArray data;
+        QSize dataSize = zoneToSave.size();
 
-        if(!filePointer.open(QFile::WriteOnly))
+        if(zoneToSave == QRect(0, 0, 0, 0))
         {
-            _Log(QString("Failed to open file: %1").arg(filename));
-            eError = ClassCommon::Error::Failed;
+            // save the full image
+            data = QByteArray(pImage, imageSize);
+            dataSize = fullImage.size();
         }
         else
         {
-            if(zoneToSave == QRect(0, 0, 0, 0))
-            {
-                // save the full image
-                writtenBytesCount = filePointer.write(pImage, imageSize);
-                bytesToCopy = imageSize;
-            }
-            else
-            {
-                // save a part of the image
-                qint16* px = (qint16*)pImage;
+            // save a part of the image
+            qint16* px = (qint16*)pImage;
 
-                bytesPerPixel = sizeof(qint16);
-                lineLength = zoneToSave.width() * bytesPerPixel;
+            bytesPerPixel = sizeof(qint16);
+            lineLength = zoneToSave.width() * bytesPerPixel;
 
-                // offset of the first pixel
-                lineOffset = zoneToSave.y() * fullImage.width() + zoneToSave.x();
+            data.resize(lineLength * zoneToSave.height());
 
-                // copy each line
-                for(int line = 0; line < zoneToSave.height(); line ++)
-                {
-                    writtenBytesCount += filePointer.write((char*)(&px[lineOffset]), lineLength);
-
-                    lineOffset += fullImage.width();
-                }
-
-                bytesToCopy = zoneToSave.width() * zoneToSave.height() * bytesPerPixel;
-            }
+            // offset of the first pixel
+            lineOffset = zoneToSave.y() * fullImage.width() + zoneToSave.x();
 
-            filePointer.close();
-
-            if (writtenBytesCount != bytesToCopy)
+            // copy each line
+            for(int line = 0; line < zoneToSave.height(); line ++)
             {
-                _Log(QString("Error writing file: %1").arg(filename));
-                eError = ClassCommon::Error::Failed;
+                memcpy(data.data() + line * lineLength, &px[lineOffset], lineLength);
+
+                lineOffset += fullImage.width();
             }
         }
+
+        // the file is written in background (see CmdExportFlush)
+        FileWriter::Write(filename, data, ChunkFileType_Pixel16, dataSize.width(), dataSize.height());
     }
 
     return eError;
 }
 
+ClassCommon::Error ConoscopeProcess::_WriteImageFile(
+        QString filename,
+        const FrameBuffer& frame,
+        CaptureInfo_t& captureInfo,
+        QMap<QString, QMap<QString, QVariant> > &settings,
+        FileWriterEncoding_t eEncoding)
+{
+    LogInFile("_WriteImageFile");
+
+    if((filename.isEmpty()) ||
+       (frame.IsNull() == true))
+    {
+        _Log("_WriteImageFile invalid parameters");
+        return ClassCommon::Error::InvalidParameter;
+    }
+
+    // the writer keeps a reference on the frame, the pixels are not copied
+    // (the lines of a view are packed when the file is written)
+    FileWriter::Write(filename, frame, eEncoding);
+
+    _WriteImageInfo(filename, captureInfo, settings);
+
+    return ClassCommon::Error::Ok;
+}
+
 void ConoscopeProcess::_WriteImageInfo(QString filePath,
                                        CaptureInfo_t &captureInfo,
                                        QMap<QString, QMap<QString, QVariant> > &settings)
 {
     LogInFile("_WriteImageInfo");
 
-    // should check is file exists
-    if(!QFile(filePath).exists())
-    {
-        return;
-    }
-
+    // the image may still be waiting in the writer, the sidecar is queued after it
     // retrieve path and name
     QString path = QFileInfo(filePath).absolutePath();
     QString name = QFileInfo(filePath).fileName().section(".",0,0);
@@ -2623,33 +2869,97 @@ void ConoscopeProcess::_WriteImageInfo(QString filePath,
 
     QString jsonFileName = path + "/"+ name + IMAGE_INFO_EXTENSION;
 
-    QFile jsonFile(jsonFileName);
-    if(jsonFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    FileWriter::Write(jsonFileName, doc.toJson(), ChunkFileType_Json);
+}
+
+ClassCommon::Error ConoscopeProcess::_SaveImage(QString fileName, const uint16_t* pData, int imageHeight, int imageWidth, int imageStride, bool bSigned)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    QImage image = Preview::Convert(pData, imageWidth, imageHeight, imageStride, bSigned);
+
+    if(image.isNull() == true)
     {
-        QTextStream out(&jsonFile);
-        out.setCodec("UTF-8");
-        out << doc.toJson();
-        jsonFile.close();
+        _Log("_SaveImage invalid image");
+        return ClassCommon::Error::InvalidParameter;
     }
+
+#ifdef CAPTURE_SETTINGS_DEBUG
+
+#define TEXT_LEFT     50
+#define TEXT_TOP     100
+#define TEXT_WIDTH   1000
+#define TEXT_HEIGHT  100
+
+    QRect textRect (TEXT_LEFT, TEXT_TOP, TEXT_WIDTH, TEXT_HEIGHT);
+    QImage textImage(TEXT_WIDTH, TEXT_HEIGHT, QImage::Format_RGBX8888);
+
+    QPainter textPainter;
+
+    if(textPainter.begin(&textImage))
+    {
+        textPainter.setPen(QPen(Qt::red));
+        textPainter.setFont(QFont("Times", 50, QFont::Bold));
+
+
+        QString imageMessage = QString("setup %1 - measure %1").arg(debugSetupIndex).arg(debugExportIndex);
+
+        textPainter.drawText(textImage.rect(), Qt::AlignCenter, imageMessage);
+        textPainter.end();
+    }
+
+    // QPainter::CompositionMode mode = currentMode();
+
+    QImage resultImage(image.width(), image.height(), QImage::Format_RGBX8888);
+    QPainter painter(&resultImage);
+
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(resultImage.rect(), Qt::red);
+
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.drawImage(0, 0, image);
+
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.drawImage(0, 0, textImage);
+
+    painter.end();
+
+    image = resultImage;
+#endif
+
+    // the file is written in background (see CmdExportFlush)
+    FileWriter::Write(fileName, image);
+
+    int thumbnailScale = ConoscopeProcess::mSettingsI.previewThumbnailScale;
+
+    if(thumbnailScale > 1)
+    {
+        QFileInfo fileInfo(fileName);
+
+        QString thumbnailFileName = QString("%1/%2%3.%4").arg(fileInfo.path())
+                                                         .arg(fileInfo.completeBaseName())
+                                                         .arg(IMAGE_THUMBNAIL_SUFFIX)
+                                                         .arg(fileInfo.suffix());
+
+        FileWriter::Write(thumbnailFileName, Preview::Convert(pData, imageWidth, imageHeight, imageStride, bSigned, thumbnailScale));
+    }
+
+    return eError;
 }
 
 ClassCommon::Error ConoscopeProcess::_ReadImageFile(
         QString acFilename,
-        QByteArray& imgData,
+        FrameBuffer& imgData,
         ImageInfoRead_t& info)
 {
     LogInFile("_ReadImageFile");
 
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    QFile ff(QString("%1").arg(acFilename));
+    // a 16 bits file is mapped (the pixels are loaded when they are used), a container is decoded
+    imgData = RawCodec::ReadFile(acFilename, 0);
 
-    if(ff.exists() && ff.open(QFile::ReadOnly))
-    {
-        imgData = ff.readAll();
-        ff.close();
-    }
-    else
+    if(imgData.IsNull() == true)
     {
         //writeInfo(QString("Image does not exist or couldn't be open: %1").arg(acFilename));
         eError = ClassCommon::Error::Failed;
@@ -2689,6 +2999,15 @@ ClassCommon::Error ConoscopeProcess::_ReadImageFile(
         }
     }
 
+    // the pixels past the end of the file are not mapped
+    if((eError == ClassCommon::Error::Ok) &&
+       ((qint64)imgData.GetSize() < (qint64)info.imageWidth * info.imageHeight * PIXEL_SIZE))
+    {
+        eError = ClassCommon::Error::Failed;
+
+        LogInApp(QString("    ERROR Image is smaller than %1 x %2: %3").arg(info.imageWidth).arg(info.imageHeight).arg(acFilename));
+    }
+
     return eError;
 }
 
@@ -2905,6 +3224,31 @@ ClassCommon::Error ConoscopeProcess::_ReadCfgCameraPipeline(QString sn)
     return eError;
 }
 
+uint64 ConoscopeProcess::_GetGainMapId(QString description)
+{
+    // identifier used by the pipeline to reuse its gain maps
+    QByteArray hash = QCryptographicHash::hash(description.toUtf8(), QCryptographicHash::Md5);
+
+    uint64 id = 0;
+    memcpy(&id, hash.constData(), sizeof(id));
+
+    return id;
+}
+
+QString ConoscopeProcess::_GetFileStamp(QString fileName)
+{
+    // the data is not hashed (up to several tens of MB for each capture),
+    // a calibration file written again changes its size or its date
+    QFileInfo fileInfo(fileName);
+
+    if(fileInfo.exists() == false)
+    {
+        return QString();
+    }
+
+    return QString("%1:%2").arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
 bool ConoscopeProcess::_HasSetupChanged(float sensorTemperature)
 {
     bool hasChanged = true;
@@ -3365,3 +3709,14 @@ void ConoscopeProcess::OnCameraLogInFile(QString header, QString message)
 {
     RESOURCE->AppendLog(QString("%1 | ").arg("header", -20), message);
 }
+
+void ConoscopeProcess::OnFileWritten(QString filePath, bool bSuccess)
+{
+    if(bSuccess == false)
+    {
+        // the command that queued the file has already returned
+        LogInFile(QString("Error writing file: %1").arg(filePath));
+
+        RESOURCE->SendWarning(QString("Export\nError writing file: %1").arg(filePath));
+    }
+}
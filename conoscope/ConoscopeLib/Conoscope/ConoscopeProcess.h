@@ -11,6 +11,8 @@
 #include "PipelineLib.h"
 
 #include "TempMonitoring.h"
+#include "ConoscopeStream.h"
+#include "toolFileWriter.h"
 
 #include "CDevices.h"
 
@@ -172,6 +174,13 @@ public:
 
     static ClassCommon::Error CmdConvertRaw(ConvertRaw_t &param);
 
+    static ClassCommon::Error CmdStreamStart(StreamConfig_t &config);
+    static ClassCommon::Error CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs);
+    static ClassCommon::Error CmdStreamSetExposure(int exposureTimeUs);
+    static ClassCommon::Error CmdStreamStop();
+
+    static ClassCommon::Error CmdExportFlush();
+
     static void GetSomeInfo(SomeInfo_t &info);
 
     static ConoscopeProcess* GetInstance();
@@ -275,6 +284,13 @@ private:
 
     ClassCommon::Error _CmdConvertRaw(ConvertRaw_t &param);
 
+    ClassCommon::Error _CmdStreamStart(StreamConfig_t &config);
+    ClassCommon::Error _CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs);
+    ClassCommon::Error _CmdStreamSetExposure(int exposureTimeUs);
+    ClassCommon::Error _CmdStreamStop();
+
+    ClassCommon::Error _CmdExportFlush();
+
     CameraInfo_t _OpeningInfo();
 
     Error _WriteImageFile(QString filename,
@@ -291,115 +307,20 @@ private:
                           const QRect& fullImage = QRect(),
                           const QRect& zoneToSave = QRect());
 
+    // write a frame (packed or view), the encoding is done by the writer
+    Error _WriteImageFile(QString filename,
+                          const FrameBuffer& frame,
+                          CaptureInfo_t &captureInfo,
+                          QMap<QString, QMap<QString, QVariant>> &settings,
+                          FileWriterEncoding_t eEncoding = FileWriterEncoding_None);
+
     void _WriteImageInfo(QString filePath,
                          CaptureInfo_t& captureInfo,
                          QMap<QString, QMap<QString, QVariant> > &settings);
 
-    template<typename T>
-    Error _SaveImage(QString fileName, T* pRawData, int imageHeight, int imageWidth)
-    {
-        ClassCommon::Error eError = ClassCommon::Error::Ok;
-
-        int imageSize = imageHeight * imageWidth;
-
-        QByteArray bmpArray;
-        bmpArray.resize(imageSize * 4);
-
-        unsigned char   *bmpData;
-        bmpData = (unsigned char*)&(bmpArray.data()[0]);
-
-        int pixIndex = 0;
-
-        unsigned char   ucCurrentValue ;
-        T currentValue;
-
-/*
-        int nbBits = 12;
-        int minPixelValue = 0;
-        int maxPixelValue = pow(2, nbBits) - 1;
-        int shift = 16 - nbBits;
-*/
-        int minPixelValue = 0;
-        int maxPixelValue = 4095;
-        int shift = 4;
-
-#pragma omp parallel num_threads(4)
-        for (int index = 0 ; index < imageSize ; index ++)
-        {
-            // ucCurrentValue = ((long)mQVSubSamplingData.at(lIndex)*255)/(MAX_DATA_VALUE) ;
-            // ucCurrentValue = ((long)mQVSubSamplingData.at(lIndex)*255)/(mWhiteLevel);
-            //ucCurrentValue = (unsigned char)(_rawData.at(index) >> 4);
-            currentValue = pRawData[index];
-
-            // clamp value to 12 bits
-            if(currentValue < minPixelValue)
-            {
-                currentValue = minPixelValue;
-            } else if(currentValue > maxPixelValue)
-            {
-                currentValue = maxPixelValue;
-            }
-
-            // convert the pixel to 8 bits by removing less significant part
-            currentValue = currentValue >> shift;
-
-            ucCurrentValue = (unsigned char) currentValue;
-
-            bmpData[pixIndex++] = ucCurrentValue;
-            bmpData[pixIndex++] = ucCurrentValue;
-            bmpData[pixIndex++] = ucCurrentValue;
-            bmpData[pixIndex++] = 0;
-        }
-
-        QImage image(bmpData, imageWidth, imageHeight, QImage::Format_RGBX8888);
-
-#ifdef CAPTURE_SETTINGS_DEBUG
-
-#define TEXT_LEFT     50
-#define TEXT_TOP     100
-#define TEXT_WIDTH   1000
-#define TEXT_HEIGHT  100
-
-        QRect textRect (TEXT_LEFT, TEXT_TOP, TEXT_WIDTH, TEXT_HEIGHT);
-        QImage textImage(TEXT_WIDTH, TEXT_HEIGHT, QImage::Format_RGBX8888);
-
-        QPainter textPainter;
-
-        if(textPainter.begin(&textImage))
-        {
-            textPainter.setPen(QPen(Qt::red));
-            textPainter.setFont(QFont("Times", 50, QFont::Bold));
-
-
-            QString imageMessage = QString("setup %1 - measure %1").arg(debugSetupIndex).arg(debugExportIndex);
-
-            textPainter.drawText(textImage.rect(), Qt::AlignCenter, imageMessage);
-            textPainter.end();
-        }
-
-        // QPainter::CompositionMode mode = currentMode();
-
-        QImage resultImage(image.width(), image.height(), QImage::Format_RGBX8888);
-        QPainter painter(&resultImage);
-
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-        painter.fillRect(resultImage.rect(), Qt::red);
-
-        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        painter.drawImage(0, 0, image);
-
-        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        painter.drawImage(0, 0, textImage);
-
-        painter.end();
-
-        resultImage.save(fileName, "JPG");
-#else
-        image.save(fileName, "JPG");
-#endif
-
-        return eError;
-    }
+    // jpg preview (and thumbnail) of the 12 bits pixels, the encoding is done by the FileWriter
+    // bSigned: processed data (int16)
+    Error _SaveImage(QString fileName, const uint16_t* pData, int imageHeight, int imageWidth, int imageStride, bool bSigned);
 
 #define AVERAGE_ANALYSE
 
@@ -496,7 +417,7 @@ private:
         float saturationLevel;
     } ImageInfoRead_t;
 
-    Error _ReadImageFile(QString acFilename, QByteArray& imgData, ImageInfoRead_t& info);
+    Error _ReadImageFile(QString acFilename, FrameBuffer& imgData, ImageInfoRead_t& info);
 
     Error _ReadImageInfo(QString filePath, ImageInfoRead_t& info);
 
@@ -508,6 +429,11 @@ private:
 
     ClassCommon::Error _ReadCfgCameraPipeline(QString sn);
 
+    static uint64 _GetGainMapId(QString description);
+
+    // size and modification time of the file the calibration data comes from
+    static QString _GetFileStamp(QString fileName);
+
     bool _HasSetupChanged(float sensorTemperature);
 
     void _WaitForSetupIsDone();
@@ -521,14 +447,14 @@ private:
     SetupConfig_t _measurementConfig;
 
     // RawData
-    QByteArray                 _rawData;           /* raw data captured */
+    FrameBuffer                _rawData;           /* raw data captured (view on the grabber frame) */
     QByteArray                 _rawDataStdDev;     /* raw data captured standard dev (not used) */
 
     CaptureInfo_t _captureInfo;
     QString _timeStampString_test;
 
     // ProcessedData
-    QByteArray                 _inputData; /* copy of raw data used in process function */
+    FrameBuffer                _inputData; /* packed copy of raw data, the pipeline works in place */
     std::vector<char>          _klibData;
     std::vector<char>          _klibDataCrop;
 
@@ -561,6 +487,9 @@ private:
 
     TempMonitoring* mTempMonitor;
 
+    // continuous acquisition (NULL when not streaming)
+    ConoscopeStream* mStream;
+
     QString _CreateFolder(std::string path, QString cameraSerialNumber = "");
 
     QString _GetFileName(QString name, QString path, QString extension);
@@ -578,6 +507,8 @@ private:
 
 public slots:
     void OnCameraLogInFile(QString header, QString message);
+
+    void OnFileWritten(QString filePath, bool bSuccess);
 };
 
 #endif // CONOSCOPEWORKER_H
@@ -0,0 +1,186 @@
+#include "ConoscopeStream.h"
+
+#include <QMutexLocker>
+
+// maximum time the thread waits for a frame before checking the stop request
+#define STREAM_READ_TIMEOUT_MS 100
+
+#define STREAM_QUEUE_SIZE_DEFAULT 4
+
+ConoscopeStream::ConoscopeStream(Camera* camera, StreamConfig_t& config, QRect cropArea, QObject *parent)
+    : QThread(parent)
+{
+    mCamera = camera;
+
+    mQueueSize     = (config.queueSize > 0) ? config.queueSize : STREAM_QUEUE_SIZE_DEFAULT;
+    mNbAcquisition = config.nbAcquisition;
+    mCropArea      = cropArea;
+
+    mStopRequest           = false;
+    meError                = ClassCommon::Error::Ok;
+    mExposureTimeUs        = config.exposureTimeUs;
+    mPendingExposureTimeUs = 0;
+    mDroppedFrames         = 0;
+
+    mFrameCount = 0;
+}
+
+ConoscopeStream::~ConoscopeStream()
+{
+    RequestStop();
+    wait();
+}
+
+void ConoscopeStream::RequestStop()
+{
+    QMutexLocker locker(&mMutex);
+
+    mStopRequest = true;
+
+    // wake up the reader
+    mFrameAvailable.wakeAll();
+}
+
+ClassCommon::Error ConoscopeStream::Read(std::vector<uint16_t>& buffer, StreamFrameInfo_t& info, int timeoutMs)
+{
+    StreamItem_t item;
+
+    {
+        QMutexLocker locker(&mMutex);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while(mQueue.isEmpty() &&
+              (mStopRequest == false) &&
+              (meError == ClassCommon::Error::Ok))
+        {
+            qint64 remainingMs = timeoutMs - timer.elapsed();
+
+            if(remainingMs <= 0)
+            {
+                break;
+            }
+
+            mFrameAvailable.wait(&mMutex, (unsigned long)remainingMs);
+        }
+
+        if(mQueue.isEmpty())
+        {
+            if(meError != ClassCommon::Error::Ok)
+            {
+                return meError;
+            }
+
+            return (mStopRequest == true) ? ClassCommon::Error::InvalidState : ClassCommon::Error::Timeout;
+        }
+
+        item = mQueue.dequeue();
+    }
+
+    // the copy is done without blocking the stream
+    buffer.resize(item.frame.GetSize() / sizeof(uint16_t));
+    item.frame.CopyTo(buffer.data());
+
+    info = item.info;
+
+    return ClassCommon::Error::Ok;
+}
+
+void ConoscopeStream::SetExposureTime(int exposureTimeUs)
+{
+    QMutexLocker locker(&mMutex);
+
+    mPendingExposureTimeUs = exposureTimeUs;
+}
+
+ClassCommon::Error ConoscopeStream::GetError()
+{
+    QMutexLocker locker(&mMutex);
+
+    return meError;
+}
+
+void ConoscopeStream::_ApplyExposureTime()
+{
+    int exposureTimeUs;
+
+    {
+        QMutexLocker locker(&mMutex);
+
+        exposureTimeUs = mPendingExposureTimeUs;
+        mPendingExposureTimeUs = 0;
+    }
+
+    if(exposureTimeUs != 0)
+    {
+        // the camera updates the value with the time set
+        if(mCamera->SetExposureTime(exposureTimeUs) == ClassCommon::Error::Ok)
+        {
+            QMutexLocker locker(&mMutex);
+
+            mExposureTimeUs = exposureTimeUs;
+        }
+    }
+}
+
+void ConoscopeStream::run()
+{
+    mTimer.start();
+
+    bool bStop = false;
+
+    while(bStop == false)
+    {
+        _ApplyExposureTime();
+
+        struct Camera::RawDataInfo rawDataInfo;
+
+        rawDataInfo.miLines  = 0;
+        rawDataInfo.miCols   = 0;
+        rawDataInfo.cropArea = mCropArea;
+
+        FrameBuffer frame;
+
+        ClassCommon::Error eError = mCamera->StreamRead(rawDataInfo, frame, STREAM_READ_TIMEOUT_MS);
+
+        QMutexLocker locker(&mMutex);
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            StreamItem_t item;
+
+            item.frame = frame;
+
+            item.info.frameIndex     = mFrameCount ++;
+            item.info.exposureTimeUs = mExposureTimeUs;
+            item.info.nbAcquisition  = mNbAcquisition;
+            item.info.width          = frame.GetWidth();
+            item.info.height         = frame.GetHeight();
+            item.info.timeStampMs    = mTimer.elapsed();
+
+            if(mQueue.count() >= mQueueSize)
+            {
+                // the reader is too slow
+                mQueue.dequeue();
+                mDroppedFrames ++;
+            }
+
+            item.info.droppedFrames = mDroppedFrames;
+
+            mQueue.enqueue(item);
+
+            mFrameAvailable.wakeAll();
+        }
+        else if(eError != ClassCommon::Error::Timeout)
+        {
+            meError = eError;
+
+            // the reader gets the error once the queue is empty
+            mFrameAvailable.wakeAll();
+            break;
+        }
+
+        bStop = mStopRequest;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef CONOSCOPESTREAM_H
+#define CONOSCOPESTREAM_H
+
+#include <QThread>
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QQueue>
+
+#include <vector>
+
+#include "classcommon.h"
+#include "camera.h"
+#include "conoscopeTypes.h"
+
+/* Class ConoscopeStream
+ * read the frames of a camera stream and keep the last ones in a bounded queue
+ *
+ * the camera stream must be started before the thread, and stopped after it.
+ * When the queue is full the oldest frame is dropped (the reader gets the most recent frames).
+ * An exposure time change is applied by the thread between two frames.
+ */
+
+class ConoscopeStream : public QThread
+{
+    Q_OBJECT
+
+public:
+    ConoscopeStream(Camera* camera, StreamConfig_t& config, QRect cropArea, QObject *parent = nullptr);
+
+    ~ConoscopeStream();
+
+    // the thread ends after the frame being read
+    void RequestStop();
+
+    // wait for the oldest frame of the queue (Timeout if there is none after timeoutMs)
+    ClassCommon::Error Read(std::vector<uint16_t>& buffer, StreamFrameInfo_t& info, int timeoutMs);
+
+    void SetExposureTime(int exposureTimeUs);
+
+    ClassCommon::Error GetError();
+
+protected:
+    void run() override;
+
+private:
+    typedef struct
+    {
+        FrameBuffer       frame;
+        StreamFrameInfo_t info;
+    } StreamItem_t;
+
+    Camera* mCamera;
+
+    int   mQueueSize;
+    int   mNbAcquisition;
+    QRect mCropArea;
+
+    // shared with the reader
+    QMutex                mMutex;
+    QWaitCondition        mFrameAvailable;
+    QQueue<StreamItem_t>  mQueue;
+    bool                  mStopRequest;
+    ClassCommon::Error    meError;
+    int                   mExposureTimeUs;        // current exposure time
+    int                   mPendingExposureTimeUs; // 0 when there is no change requested
+    int                   mDroppedFrames;
+
+    int           mFrameCount;
+    QElapsedTimer mTimer;
+
+    void _ApplyExposureTime();
+};
+
+#endif // CONOSCOPESTREAM_H
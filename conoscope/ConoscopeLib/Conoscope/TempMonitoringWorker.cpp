@@ -133,11 +133,11 @@ ClassCommon::Error TempMonitoringWorker::_SetupTemperature(float targetTemp, int
 
         // check if the device is correctly connected
 #ifndef MONITOR_PID_TEMP
-        fCurrentTempHot  = mCamera->GetHw("TEC", "HotTemperature");
-        fCurrentTempCold = mCamera->GetHw("Sensor", "ColdTemperature");
-        fCurrentTempCMOS = mCamera->GetHw("Sensor", "CmosTemperature");
+        fCurrentTempHot  = mCamera->GetHw(HwFeature_TecHotTemperature);
+        fCurrentTempCold = mCamera->GetHw(HwFeature_SensorColdTemperature);
+        fCurrentTempCMOS = mCamera->GetHw(HwFeature_SensorCmosTemperature);
 
-        float ITec = mCamera->GetHw("TEC", "AdcITec");
+        float ITec = mCamera->GetHw(HwFeature_TecAdcITec);
 
         if((fCurrentTempHot == -255.0) ||
            (fCurrentTempCold == -255) ||
@@ -155,9 +155,9 @@ ClassCommon::Error TempMonitoringWorker::_SetupTemperature(float targetTemp, int
     if(eError == ClassCommon::Error::Ok)
     {
 #ifndef QUIET_MODE
-        mCamera->SetHw("Fan", "Speed", FAN_SPEED, FAN_INDEX);
+        mCamera->SetHw(HwFeature_FanSpeed, FAN_SPEED, FAN_INDEX);
 #else
-        mCamera->SetHw("Fan", "Speed", FAN_SPEED_LOW, FAN_INDEX);
+        mCamera->SetHw(HwFeature_FanSpeed, FAN_SPEED_LOW, FAN_INDEX);
 #endif
         mCamera->SetFloatValue("PIDTarget", targetTemp);
     }
@@ -195,7 +195,7 @@ ClassCommon::Error TempMonitoringWorker::_SetupTemperature(float targetTemp, int
         do
         {
 #ifndef MONITOR_PID_TEMP
-            fCurrentTempCold = mCamera->GetHw("Sensor", "ColdTemperature");
+            fCurrentTempCold = mCamera->GetHw(HwFeature_SensorColdTemperature);
             fCurrentTempCMOS = fGetTrueCMOSTemperature() ;
 #endif
 
@@ -340,12 +340,12 @@ float TempMonitoringWorker::fGetTrueCMOSTemperature()
     bool  blnOk  ;
     int intWatchDog = 5 ;
 
-    static float fLastValue = mCamera->GetHw("Sensor", "ColdTemperature");
+    static float fLastValue = mCamera->GetHw(HwFeature_SensorColdTemperature);
 
     do
     {
         blnOk = true;
-        result = mCamera->GetHw("Sensor", "CmosTemperature");
+        result = mCamera->GetHw(HwFeature_SensorCmosTemperature);
 
         if(result > 100)
         {
@@ -381,7 +381,15 @@ float TempMonitoringWorker::GetTemperature()
     // LogInFile("GetTemperature");
 
 #ifndef MONITOR_PID_TEMP
-    float fCurrentTempCold = mCamera->GetHw("Sensor", "ColdTemperature");
+    CameraTelemetry_t telemetry;
+
+    // the value refreshed in background avoids an access to the control channel
+    if((mCamera->GetTelemetry(telemetry) == true) && (telemetry.hw.contains(HwFeature_SensorColdTemperature)))
+    {
+        return telemetry.hw[HwFeature_SensorColdTemperature];
+    }
+
+    float fCurrentTempCold = mCamera->GetHw(HwFeature_SensorColdTemperature);
     return fCurrentTempCold;
 #else
     return mCamera->GetFloatValue("PIDTemp");
@@ -47,6 +47,10 @@
 #define RETURN_ITEM_MIN              "Min"
 #define RETURN_ITEM_MAX              "Max"
 
+#define RETURN_ITEM_STREAM_FRAME_INDEX    "FrameIndex"
+#define RETURN_ITEM_STREAM_TIME_STAMP_MS  "TimeStampMs"
+#define RETURN_ITEM_STREAM_DROPPED_FRAMES "DroppedFrames"
+
 #define RETURN_ITEM_AE_ROI_WIDTH     "AeRoiWidth"
 #define RETURN_ITEM_AE_ROI_HEIGHT    "AeRoiHeight"
 #define RETURN_ITEM_AE_ROI_X         "AeRoiX"
@@ -351,6 +355,17 @@ typedef struct
     bool        cfgFileIsZip;  // indicate if the file is zipped
 
     int         AEMaxNbPixel;  // indicate the number of max pixels not taken into account (apply only to raw data)
+
+    int         telemetryPeriodMs; // period of the camera temperatures refresh (0: read at each capture)
+
+    std::string grabberRecordPath;     // file where the grabber activity is recorded (empty: no record)
+    int         grabberRecordLineStep; // one line every grabberRecordLineStep lines of the images is recorded (0: none)
+
+    bool        rawCompression; // raw captures are written in the lossless 12 bits container (RawCodec)
+
+    int         captureSequenceContainerMB; // files of a capture sequence written in a single file preallocated to this size (0: one file each)
+
+    int         previewThumbnailScale; // a jpg thumbnail reduced by this factor is written with each jpg preview (0: none)
 } ConoscopeSettingsI_t;
 
 typedef enum
@@ -437,6 +452,25 @@ typedef struct
     std::string fileName; // input file name
 } ConvertRaw_t;
 
+typedef struct
+{
+    int   exposureTimeUs;        // exposure time in micro seconds (can be changed while streaming)
+    int   nbAcquisition;         // number of frames averaged for each streamed frame
+    int   queueSize;             // number of frames kept, the oldest one is dropped when the queue is full
+    float emulatedFrameRate;     // emulated camera only: number of frames per second
+} StreamConfig_t;
+
+typedef struct
+{
+    int    frameIndex;           // index of the frame since the start of the stream
+    int    exposureTimeUs;       // exposure time of the frame
+    int    nbAcquisition;        // number of frames averaged
+    int    width;
+    int    height;
+    qint64 timeStampMs;          // capture time since the start of the stream
+    int    droppedFrames;        // number of frames dropped since the start (queue full)
+} StreamFrameInfo_t;
+
 typedef struct
 {
     QString cameraBoardSerialNumber;
@@ -142,6 +142,8 @@ ClassCommon::Error ConoscopeApp::ChangeState(State eState, void* parameter)
 
     ProcessingConfig_t* pProcessingConfig = (ProcessingConfig_t*)parameter;
 
+    StreamConfig_t* pStreamConfig = (StreamConfig_t*)parameter;
+
     mStatePrevious = mState;
 
     _SetState(eState);
@@ -297,6 +299,41 @@ ClassCommon::Error ConoscopeApp::ChangeState(State eState, void* parameter)
         SendRequest(ConoscopeAppWorker::Request::CmdMeasureAE);
         break;
 
+    case State::CmdStreamStartProcessing:
+        eError = ConoscopeAppProcess::CmdStreamStart(*pStreamConfig);
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            _SetState(State::CmdStreaming);
+        }
+        else if((eError == ClassCommon::Error::InvalidParameter) ||
+                (eError == ClassCommon::Error::InvalidConfiguration))
+        {
+            _SetState(State::Ready);
+        }
+        else
+        {
+            _SetState(State::Error);
+        }
+        break;
+
+    case State::CmdStreamStopProcessing:
+        eError = ConoscopeAppProcess::CmdStreamStop();
+
+        if(eError == ClassCommon::Error::Ok)
+        {
+            _SetState(State::Ready);
+        }
+        else
+        {
+            _SetState(State::Error);
+        }
+        break;
+
+    case State::CmdStreaming:
+        // nothing to do
+        break;
+
     case State::CaptureDone:
         // nothing to do
         break;
@@ -412,6 +449,10 @@ ClassCommon::Error ConoscopeApp::ProcessStateMachine(Event eEvent, void* paramet
         {
             eError = ChangeState(State::CmdMeasuringAE);
         }
+        else if(eEvent == Event::CmdStreamStart)
+        {
+            eError = ChangeState(State::CmdStreamStartProcessing, parameter);
+        }
         break;
 
     case State::CaptureDone:
@@ -447,6 +488,10 @@ ClassCommon::Error ConoscopeApp::ProcessStateMachine(Event eEvent, void* paramet
         {
             eError = ChangeState(State::CmdMeasuringAE);
         }
+        else if(eEvent == Event::CmdStreamStart)
+        {
+            eError = ChangeState(State::CmdStreamStartProcessing, parameter);
+        }
         break;
 
     case State::CmdCapturingSequence:
@@ -472,6 +517,18 @@ ClassCommon::Error ConoscopeApp::ProcessStateMachine(Event eEvent, void* paramet
         }
         break;
 
+    case State::CmdStreaming:
+        if(eEvent == Event::CmdStreamStop)
+        {
+            eError = ChangeState(State::CmdStreamStopProcessing);
+        }
+        else if(eEvent == Event::CmdClose)
+        {
+            // the stream is stopped before closing
+            eError = ChangeState(State::CmdCloseProcessing);
+        }
+        break;
+
     case State::CmdMeasuringAE:
         if(eEvent == Event::CmdMeasureAECancel)
         {
@@ -1158,3 +1215,75 @@ ClassCommon::Error ConoscopeApp::CmdConvertRaw(ConvertRaw_t& param)
     return eError;
 }
 
+ClassCommon::Error ConoscopeApp::CmdStreamStart(StreamConfig_t& config)
+{
+    QString message;
+
+    message.append("> CmdStreamStart\n");
+    message.append(QString("    exposureTimeUs %1\n").arg(config.exposureTimeUs));
+    message.append(QString("    nbAcquisition  %1\n").arg(config.nbAcquisition));
+    message.append(QString("    queueSize      %1").arg(config.queueSize));
+
+    LogInFile(message);
+
+    ClassCommon::Error eError = ProcessStateMachine(Event::CmdStreamStart, &config);
+
+    LogInFile(QString("< CmdStreamStart - %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeApp::CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t& info, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    // this API does not go into the state machine, it is called for each frame
+    if(mState == State::CmdStreaming)
+    {
+        eError = ConoscopeAppProcess::CmdStreamRead(buffer, info, timeoutMs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeApp::CmdStreamSetExposure(int exposureTimeUs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LogInFile(QString("> CmdStreamSetExposure %1").arg(exposureTimeUs));
+
+    if(mState == State::CmdStreaming)
+    {
+        eError = ConoscopeAppProcess::CmdStreamSetExposure(exposureTimeUs);
+    }
+    else
+    {
+        eError = ClassCommon::Error::InvalidState;
+    }
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeApp::CmdStreamStop()
+{
+    LogInFile("> CmdStreamStop");
+
+    ClassCommon::Error eError = ProcessStateMachine(Event::CmdStreamStop);
+
+    LogInFile(QString("< CmdStreamStop - %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeApp::CmdExportFlush()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    eError = mConoscope->CmdExportFlush();
+
+    return eError;
+}
@@ -36,6 +36,9 @@ public:
         CmdMeasureAECancel,
         CmdMeasureAEDone,
 
+        CmdStreamStart,
+        CmdStreamStop,
+
         Error,
     };
     Q_ENUM(Event)
@@ -63,6 +66,10 @@ public:
 
         CmdMeasuringAE,
 
+        CmdStreamStartProcessing,
+        CmdStreamStopProcessing,
+        CmdStreaming,
+
         Error,
     };
     Q_ENUM(State)
@@ -137,6 +144,13 @@ public:
 
     ClassCommon::Error CmdConvertRaw(ConvertRaw_t& param);
 
+    ClassCommon::Error CmdStreamStart(StreamConfig_t& config);
+    ClassCommon::Error CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t& info, int timeoutMs);
+    ClassCommon::Error CmdStreamSetExposure(int exposureTimeUs);
+    ClassCommon::Error CmdStreamStop();
+
+    ClassCommon::Error CmdExportFlush();
+
 public:
 
 private:
@@ -150,6 +150,26 @@ ClassCommon::Error ConoscopeAppProcess::CmdCfgFileStatus(CfgFileStatus_t& status
     INSTANCE->_CmdCfgFileStatus(status);
 }
 
+ClassCommon::Error ConoscopeAppProcess::CmdStreamStart(StreamConfig_t &config)
+{
+    INSTANCE->_CmdStreamStart(config);
+}
+
+ClassCommon::Error ConoscopeAppProcess::CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs)
+{
+    INSTANCE->_CmdStreamRead(buffer, info, timeoutMs);
+}
+
+ClassCommon::Error ConoscopeAppProcess::CmdStreamSetExposure(int exposureTimeUs)
+{
+    INSTANCE->_CmdStreamSetExposure(exposureTimeUs);
+}
+
+ClassCommon::Error ConoscopeAppProcess::CmdStreamStop()
+{
+    INSTANCE->_CmdStreamStop();
+}
+
 ClassCommon::Error ConoscopeAppProcess::SetConfig(CaptureSequenceConfig_t& config)
 {
     INSTANCE->_SetConfig(config);
@@ -351,6 +371,46 @@ ClassCommon::Error ConoscopeAppProcess::_CmdCfgFileStatus(CfgFileStatus_t &statu
     return eError;
 }
 
+ClassCommon::Error ConoscopeAppProcess::_CmdStreamStart(StreamConfig_t &config)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    eError = CONOSCOPE->CmdStreamStart(config);
+
+    LogInFile(QString("_CmdStreamStart %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeAppProcess::_CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    eError = CONOSCOPE->CmdStreamRead(buffer, info, timeoutMs);
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeAppProcess::_CmdStreamSetExposure(int exposureTimeUs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    eError = CONOSCOPE->CmdStreamSetExposure(exposureTimeUs);
+
+    return eError;
+}
+
+ClassCommon::Error ConoscopeAppProcess::_CmdStreamStop()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    eError = CONOSCOPE->CmdStreamStop();
+
+    LogInFile(QString("_CmdStreamStop %1").arg(ClassCommon::ErrorToString(eError)));
+
+    return eError;
+}
+
 ClassCommon::Error ConoscopeAppProcess::_SetConfig(CaptureSequenceConfig_t& config)
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
@@ -47,6 +47,11 @@ public:
     static ClassCommon::Error CmdCfgFileRead();
     static ClassCommon::Error CmdCfgFileStatus(CfgFileStatus_t &status);
 
+    static ClassCommon::Error CmdStreamStart(StreamConfig_t &config);
+    static ClassCommon::Error CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs);
+    static ClassCommon::Error CmdStreamSetExposure(int exposureTimeUs);
+    static ClassCommon::Error CmdStreamStop();
+
     static ClassCommon::Error SetConfig(CaptureSequenceConfig_t& config);
 
     static ClassCommon::Error SetBehaviorConfig(ConoscopeBehavior_t& config);
@@ -129,6 +134,11 @@ private:
     ClassCommon::Error _CmdCfgFileRead();
     ClassCommon::Error _CmdCfgFileStatus(CfgFileStatus_t& status);
 
+    ClassCommon::Error _CmdStreamStart(StreamConfig_t &config);
+    ClassCommon::Error _CmdStreamRead(std::vector<uint16_t> &buffer, StreamFrameInfo_t &info, int timeoutMs);
+    ClassCommon::Error _CmdStreamSetExposure(int exposureTimeUs);
+    ClassCommon::Error _CmdStreamStop();
+
     ClassCommon::Error _SetConfig(CaptureSequenceConfig_t& config);
     ClassCommon::Error _SetConfig(ConoscopeBehavior_t& config);
 
@@ -14,6 +14,7 @@
 #include <QJsonDocument>
 
 #include <QDir>
+#include <QtEndian>
 
 #ifdef MULTITHREAD_CAPTURE_SEQUENCE
 #include "CaptureSequenceThread.h"
@@ -21,13 +22,17 @@
 #endif
 
 #include "toolString.h"
+#include "toolFileWriter.h"
+#include "toolRawCodec.h"
 
 #define LOG_CW(x) Log("              Worker", x)
 
 #define FILE_NAME "%1_nd_%2_iris_%3"
 #define FLOAT_FILE_NAME "%1_%2%3_float"
+#define SEQUENCE_FILE_NAME "%1_%2sequence"
 
 #define CAPTURE_EXTENSION "bin"
+#define SEQUENCE_EXTENSION "cseq"
 
 #define CONVERT_TO_QSTRING(a) QString::fromUtf8(a.c_str())
 #define CONVERT_TO_STRING(a) a.toUtf8().constData();
@@ -277,6 +282,18 @@ ClassCommon::Error ConoscopeAppWorker::_CmdCapturingSequence()
     // read the export configuration (if any file present)
     _ReadExposureExportOption(mCaptureSequenceExportConfig, captureSequenceOption);
 
+    // the files of the sequence are written in a single file, its name is known when the sequence is done
+    bool bContainer = (ConoscopeProcess::mSettingsI.captureSequenceContainerMB > 0);
+
+    if(bContainer == true)
+    {
+        QString containerFileName = QString("%1.%2.part").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"))
+                                                         .arg(SEQUENCE_EXTENSION);
+
+        FileWriter::OpenContainer(QDir::cleanPath(CONVERT_TO_QSTRING(ConoscopeProcess::mSettings.capturePath) + QDir::separator() + containerFileName),
+                                  (qint64)ConoscopeProcess::mSettingsI.captureSequenceContainerMB * 1024 * 1024);
+    }
+
 #ifdef MULTITHREAD_CAPTURE_SEQUENCE
     // create the thread instances
     CaptureSequenceThread thread1(this);
@@ -336,21 +353,27 @@ ClassCommon::Error ConoscopeAppWorker::_CmdCapturingSequence()
     if((eError == ClassCommon::Error::Ok) &&
        (mCancelRequest == false))
     {
-        if(captureSequenceOption.bGenerateXYZ == true)
-        {
-            SomeInfo_t info;
-            ConoscopeAppProcess::GetSomeInfo(info);
+        SomeInfo_t info;
+        ConoscopeAppProcess::GetSomeInfo(info);
 
-            QString fileName;
-            QString appendPart;
+        QString fileName;
+        QString appendPart;
 
-            _CapturingSequenceFileName(config, info, fileName, appendPart);
+        _CapturingSequenceFileName(config, info, fileName, appendPart);
 
+        if(captureSequenceOption.bGenerateXYZ == true)
+        {
             _ComposeComponents(fileName, bufferList, appendPart);
 
             _WriteCaptureSequenceInfo(fileName, exposureTimeList, info);
         }
 
+        if(bContainer == true)
+        {
+            _CloseSequenceContainer(fileName, appendPart, exposureTimeList);
+            bContainer = false;
+        }
+
         // Send a message to indicate saturation happened
         CaptureSequenceResult_t sequenceThreadResult = CaptureSequenceThread::GetResult();
         if(sequenceThreadResult.bSaturatedCapture == true)
@@ -359,6 +382,22 @@ ClassCommon::Error ConoscopeAppWorker::_CmdCapturingSequence()
         }
     }
 
+    // an incomplete sequence keeps the temporary name
+    if(bContainer == true)
+    {
+        FileWriter::CloseContainer();
+    }
+
+    // the sequence is done when its files are written
+    QString writeError;
+
+    if((FileWriter::Flush(writeError) == false) &&
+       (eError == ClassCommon::Error::Ok))
+    {
+        LogInApp(QString(" Capture | %1").arg(writeError));
+        eError = ClassCommon::Error::Failed;
+    }
+
     if(mCancelRequest == true)
     {
         ConoscopeAppWorker::mCaptureSequenceStatus.state = CaptureSequenceStatus_t::State_t::State_Cancel;
@@ -528,7 +567,30 @@ ClassCommon::Error ConoscopeAppWorker::_CmdCapturingSequenceEmulate()
 
         _CapturingSequenceFileName(config, info, fileName, appendPart);
 
-        _ComposeComponents(fileName, bufferList, appendPart);
+        if(ConoscopeProcess::mSettingsI.captureSequenceContainerMB > 0)
+        {
+            FileWriter::OpenContainer(QDir::cleanPath(QString("%1.%2").arg(QString(SEQUENCE_FILE_NAME).arg(fileName).arg(appendPart))
+                                                                      .arg(SEQUENCE_EXTENSION).replace("__", "_")),
+                                      (qint64)ConoscopeProcess::mSettingsI.captureSequenceContainerMB * 1024 * 1024);
+
+            _ComposeComponents(fileName, bufferList, appendPart);
+
+            FileWriter::CloseContainer();
+        }
+        else
+        {
+            _ComposeComponents(fileName, bufferList, appendPart);
+        }
+    }
+
+    // the sequence is done when its files are written
+    QString writeError;
+
+    if((FileWriter::Flush(writeError) == false) &&
+       (eError == ClassCommon::Error::Ok))
+    {
+        LogInApp(QString("%1").arg(writeError));
+        eError = ClassCommon::Error::Failed;
     }
 
     if(mCancelRequest == true)
@@ -721,17 +783,13 @@ ClassCommon::Error ConoscopeAppWorker::_ReadCapture(QString fileName, CaptureSeq
 {
     ClassCommon::Error eError = ClassCommon::Error::Ok;
 
-    // read binary file
-    QFile ff(QString("%1").arg(fileName));
+    // the file may still be waiting to be written
+    FileWriter::Wait();
 
-    QByteArray imgData;
+    // map binary file (it is copied once in the buffer), a raw container is decoded
+    FrameBuffer imgData = RawCodec::ReadFile(fileName, 0);
 
-    if(ff.exists() && ff.open(QFile::ReadOnly))
-    {
-        imgData = ff.readAll();
-        ff.close();
-    }
-    else
+    if(imgData.IsNull() == true)
     {
         //writeInfo(QString("Image does not exist or couldn't be open: %1").arg(acFilename));
         eError = ClassCommon::Error::Failed;
@@ -740,12 +798,9 @@ ClassCommon::Error ConoscopeAppWorker::_ReadCapture(QString fileName, CaptureSeq
     if(eError == ClassCommon::Error::Ok)
     {
         // copy data into the buffer
-        buffer.data->resize(imgData.length() / 2);
-
-        char* ptrSrc = (char*)imgData.data();
-        char* ptrDst = (char*)buffer.data->data();
+        buffer.data->resize(imgData.GetWidth());
 
-        memcpy(ptrDst, ptrSrc, imgData.length());
+        imgData.CopyTo(buffer.data->data());
     }
 
     if(eError == ClassCommon::Error::Ok)
@@ -956,49 +1011,41 @@ ClassCommon::Error ConoscopeAppWorker::_Compose(
         fileName = QString("%1.%2").arg(fileName).arg(CAPTURE_EXTENSION);
         fileName.replace("__", "_");
 
-        QFile filePointer(fileName);
-
-        if(!filePointer.open(QFile::WriteOnly))
-        {
-            LogInApp(QString("Failed to open file: %1").arg(fileName));
-            eError = ClassCommon::Error::Failed;
-        }
-        else
-        {
 #ifndef PROCESS_ROI
-            if(ConoscopeAppWorker::mSettings.bUseRoi == true)
-            {
-                // crop image according to settings
-                // int cropHeight = ConoscopeProcess::mSettings.RoiYBottom - ConoscopeProcess::mSettings.RoiYTop;
-                // int cropWidth  = ConoscopeProcess::mSettings.RoiXRight - ConoscopeProcess::mSettings.RoiXLeft;
+        if(ConoscopeAppWorker::mSettings.bUseRoi == true)
+        {
+            // crop image according to settings
+            // int cropHeight = ConoscopeProcess::mSettings.RoiYBottom - ConoscopeProcess::mSettings.RoiYTop;
+            // int cropWidth  = ConoscopeProcess::mSettings.RoiXRight - ConoscopeProcess::mSettings.RoiXLeft;
 
-                // int cropOffsetX = ConoscopeProcess::mSettings.RoiXLeft;
-                // int cropOffsetY = ConoscopeProcess::mSettings.RoiYTop;
+            // int cropOffsetX = ConoscopeProcess::mSettings.RoiXLeft;
+            // int cropOffsetY = ConoscopeProcess::mSettings.RoiYTop;
 
-                // int lineLenght = ConoscopeAppProcess::cmdExportProcessedOutput.width;
+            // int lineLenght = ConoscopeAppProcess::cmdExportProcessedOutput.width;
 
-                // allocate memory for crop buffer
-                bufferSize = cropHeight * cropWidth;
-                cropBuffer.resize(bufferSize);
-                float* pCropData = (float*)cropBuffer.data();
+            // allocate memory for crop buffer
+            bufferSize = cropHeight * cropWidth;
+            cropBuffer.resize(bufferSize);
+            float* pCropData = (float*)cropBuffer.data();
 
-                // copy into crop buffer
-                for(int lineIndex = 0; lineIndex < cropHeight; lineIndex ++)
+            // copy into crop buffer
+            for(int lineIndex = 0; lineIndex < cropHeight; lineIndex ++)
+            {
+                for(int rowIndex = 0; rowIndex < cropWidth; rowIndex ++)
                 {
-                    for(int rowIndex = 0; rowIndex < cropWidth; rowIndex ++)
-                    {
-                        pCropData[(lineIndex * cropWidth + rowIndex)] = pCompose[(cropOffsetY + lineIndex) * lineLenght + cropOffsetX + rowIndex];
-                    }
+                    pCropData[(lineIndex * cropWidth + rowIndex)] = pCompose[(cropOffsetY + lineIndex) * lineLenght + cropOffsetX + rowIndex];
                 }
-
-                // set the data to save
-                pCompose = pCropData;
             }
-#endif
-            // save the buffer
-            filePointer.write((char*)pCompose, bufferSize * sizeof(float));
-            filePointer.close();
+
+            // set the data to save
+            pCompose = pCropData;
         }
+#endif
+        int composeWidth = (ConoscopeAppWorker::mSettings.bUseRoi == true) ? cropWidth : lineLenght;
+
+        // the compose buffer is reused for the next component, the data is copied for the writer
+        FileWriter::Write(fileName, QByteArray((const char*)pCompose, bufferSize * sizeof(float)),
+                          ChunkFileType_Float32, composeWidth, (composeWidth > 0) ? bufferSize / composeWidth : 0);
     }
 
     return eError;
@@ -1349,12 +1396,24 @@ void ConoscopeAppWorker::_WriteCaptureSequenceInfo(QString fileName, QMap<Filter
     // QString jsonFileName = path + "/"+ name + IMAGE_INFO_EXTENSION;
     QString jsonFileName = fileName + IMAGE_INFO_EXTENSION;
 
-    QFile jsonFile(jsonFileName);
-    if(jsonFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    FileWriter::Write(jsonFileName, doc.toJson(), ChunkFileType_Json);
+}
+
+void ConoscopeAppWorker::_CloseSequenceContainer(QString fileName, QString appendPart, QMap<Filter_t, int>& exposureTimeList)
+{
+    // exposure time of each filter (X, Xz, Ya, Yb, Z)
+    QList<Filter_t> filterList = {Filter_X, Filter_Xz, Filter_Ya, Filter_Yb, Filter_Z};
+
+    QByteArray exposureTimes(filterList.count() * (int)sizeof(int32_t), 0);
+
+    for(int index = 0; index < filterList.count(); index ++)
     {
-        QTextStream out(&jsonFile);
-        out.setCodec("UTF-8");
-        out << doc.toJson();
-        jsonFile.close();
+        qToLittleEndian<int32_t>(exposureTimeList[filterList[index]], (uchar*)exposureTimes.data() + index * sizeof(int32_t));
     }
+
+    FileWriter::Write(QString("%1_%2exposureTimeUs").arg(fileName).arg(appendPart).replace("__", "_"),
+                      exposureTimes, ChunkFileType_Int32, filterList.count(), 1);
+
+    FileWriter::CloseContainer(QString("%1.%2").arg(QString(SEQUENCE_FILE_NAME).arg(fileName).arg(appendPart))
+                                               .arg(SEQUENCE_EXTENSION).replace("__", "_"));
 }
@@ -121,6 +121,8 @@ private:
 
     void _WriteCaptureSequenceInfo(QString fileName, QMap<Filter_t, int> &exposureTimeList, SomeInfo_t& info);
 
+    void _CloseSequenceContainer(QString fileName, QString appendPart, QMap<Filter_t, int> &exposureTimeList);
+
 public slots:
     void OnWorkRequest(int value);
 
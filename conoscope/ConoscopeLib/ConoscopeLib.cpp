@@ -7,6 +7,7 @@
 #include "toolReturnCode.h"
 
 #include "ConoscopeResource.h"
+#include "toolFileWriter.h"
 
 #define _Log(a)
 
@@ -21,7 +22,7 @@ static void _QuitApplication();
 
 static ConoscopeApp* _GetInstance();
 
-static void _DeleteInstance();
+static ClassCommon::Error _DeleteInstance();
 
 #define CONOSCOPE(instance) ConoscopeApp* instance = _GetInstance()
 
@@ -99,8 +100,22 @@ ConoscopeApp * _GetInstance()
     return _instance;
 }
 
-void _DeleteInstance()
+ClassCommon::Error _DeleteInstance()
 {
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    QString writeError;
+
+    // the exported files are written before the dll is terminated
+    if(FileWriter::Stop(writeError) == false)
+    {
+        eError = ClassCommon::Error::Failed;
+
+        LogInApp(QString("write error %1").arg(writeError));
+    }
+
+    ERROR_DESCRIPTION(writeError);
+
     if(_instance != NULL)
     {
         _instance->Stop();
@@ -108,6 +123,8 @@ void _DeleteInstance()
         delete _instance;
         _instance = NULL;
     }
+
+    return eError;
 }
 
 #ifdef USE_QCORE
@@ -847,6 +864,103 @@ const char *CmdConvertRaw(ConvertRaw_t& param)
     RETURN_ERROR(eError);
 }
 
+const char *CmdStreamStart(StreamConfig_t& config)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LOG_HEADER();
+
+    RESOURCE->TaktTimeStart();
+    CONOSCOPE(instance);
+
+    eError = instance->CmdStreamStart(config);
+
+    ERROR_DEBUG(CmdStreamStart);
+
+    LOG_TRAILER();
+
+    ToolReturnCode jsonError = ToolReturnCode(eError);
+
+    // exposure time set (due to exposure time granularity of the camera)
+    jsonError.SetOption(RETURN_ITEM_EXPOSURE_TIME_US, config.exposureTimeUs);
+
+    RETURN(jsonError.GetJsonCode());
+}
+
+const char *CmdStreamRead(std::vector<uint16_t>& buffer, StreamFrameInfo_t& info, int timeoutMs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    CONOSCOPE(instance);
+
+    eError = instance->CmdStreamRead(buffer, info, timeoutMs);
+
+    ToolReturnCode jsonError = ToolReturnCode(eError);
+
+    if(eError == ClassCommon::Error::Ok)
+    {
+        jsonError.SetOption(RETURN_ITEM_STREAM_FRAME_INDEX,    info.frameIndex);
+        jsonError.SetOption(RETURN_ITEM_EXPOSURE_TIME_US,      info.exposureTimeUs);
+        jsonError.SetOption(RETURN_ITEM_NB_ACQUISITION,        info.nbAcquisition);
+        jsonError.SetOption(RETURN_ITEM_HEIGHT,                info.height);
+        jsonError.SetOption(RETURN_ITEM_WIDTH,                 info.width);
+        jsonError.SetOption(RETURN_ITEM_STREAM_TIME_STAMP_MS,  info.timeStampMs);
+        jsonError.SetOption(RETURN_ITEM_STREAM_DROPPED_FRAMES, info.droppedFrames);
+    }
+
+    RETURN_NO_TAKT(jsonError.GetJsonCode());
+}
+
+const char *CmdStreamSetExposure(int exposureTimeUs)
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LOG_HEADER();
+
+    CONOSCOPE(instance);
+    eError = instance->CmdStreamSetExposure(exposureTimeUs);
+
+    ERROR_DEBUG(CmdStreamSetExposure);
+
+    LOG_TRAILER();
+
+    RETURN_ERROR(eError);
+}
+
+const char *CmdStreamStop()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LOG_HEADER();
+
+    RESOURCE->TaktTimeStart();
+    CONOSCOPE(instance);
+
+    eError = instance->CmdStreamStop();
+
+    ERROR_DEBUG(CmdStreamStop);
+
+    LOG_TRAILER();
+
+    RETURN_ERROR(eError);
+}
+
+const char *CmdExportFlush()
+{
+    ClassCommon::Error eError = ClassCommon::Error::Ok;
+
+    LOG_HEADER();
+
+    CONOSCOPE(instance);
+    eError = instance->CmdExportFlush();
+
+    ERROR_DEBUG(CmdExportFlush);
+
+    LOG_TRAILER();
+
+    RETURN_ERROR(eError);
+}
+
 // terminate the dll
 const char *CmdTerminate()
 {
@@ -854,7 +968,7 @@ const char *CmdTerminate()
 
     LOG_HEADER();
 
-    _DeleteInstance();
+    eError = _DeleteInstance();
 
     LOG_TRAILER();
 
@@ -46,17 +46,28 @@ SOURCES += \
         ConoscopeLib.cpp \
     Camera/cameraCmvCxp.cpp \
     Camera/camera.cpp \
+    Camera/cameraTelemetry.cpp \
+    Camera/cameraHwFeature.cpp \
     CoaXPress/CoaXpressController.cpp \
     CoaXPress/CoaXpressFrame.cpp \
+    CoaXPress/CoaXpressKernels.cpp \
+    CoaXPress/CoaXpressKernelsAvx2.cpp \
     CoaXPress/CoaXpressGrabber.cpp \
+    CoaXPress/CoaXpressRecord.cpp \
     CoaXPress/CoaXpressTypes.cpp \
     Shared/imageConfiguration.cpp \
     Tools/classcommon.cpp \
     Tools/toolString.cpp \
     Tools/toolTypes.cpp \
+    Tools/toolFrameBuffer.cpp \
+    Tools/toolFileWriter.cpp \
+    Tools/toolRawCodec.cpp \
+    Tools/toolChunkFile.cpp \
+    Tools/toolPreview.cpp \
     Conoscope/Conoscope.cpp \
     Conoscope/ConoscopeWorker.cpp \
     Conoscope/ConoscopeProcess.cpp \
+    Conoscope/ConoscopeStream.cpp \
     Conoscope/ConoscopeConfig.cpp \
     Cfg/CfgHelper.cpp \
     Pipeline/PipelineLib.cpp \
@@ -68,6 +79,7 @@ SOURCES += \
     Conoscope/TempMonitoring.cpp \
     Tools/toolReturnCode.cpp \
     Camera/cameraDummy.cpp \
+    Camera/syntheticFrame.cpp \
     Conoscope/ConoscopeResource.cpp \
     ConoscopeApp/ConoscopeApp.cpp \
     ConoscopeApp/ConoscopeAppProcess.cpp \
@@ -79,24 +91,34 @@ HEADERS += \
         ConoscopeLib.h \
         ConoscopeLib_global.h \ 
     Camera/camera.h \
+    Camera/cameraTelemetry.h \
+    Camera/cameraHwFeature.h \
     Camera/cameraCmvCxp.h \
     Camera/cameraCmvCxpHw.h \
     Camera/HwTool.h \
     CoaXPress/CoaXpressConfiguration.h \
     CoaXPress/CoaXpressController.h \
     CoaXPress/CoaXpressFrame.h \
+    CoaXPress/CoaXpressKernels.h \
     CoaXPress/CoaXpressGrabber.h \
+    CoaXPress/CoaXpressRecord.h \
     CoaXPress/CoaXpressTypes.h \
     Shared/imageConfiguration.h \
     Shared/imageConfigurationConst.h \
     Tools/classcommon.h \
     Tools/toolString.h \
     Tools/toolTypes.h \
+    Tools/toolFrameBuffer.h \
+    Tools/toolFileWriter.h \
+    Tools/toolRawCodec.h \
+    Tools/toolChunkFile.h \
+    Tools/toolPreview.h \
     Conoscope/Conoscope.h \
     configuration.h \
     Conoscope/ConoscopeWorker.h \
     Conoscope/ConoscopeWorker.h \
     Conoscope/ConoscopeProcess.h \
+    Conoscope/ConoscopeStream.h \
     Conoscope/conoscopeTypes.h \
     Conoscope/ConoscopeConfig.h \
     Cfg/CfgHelper.h \
@@ -112,6 +134,7 @@ HEADERS += \
     Conoscope/TempMonitoring.h \
     Tools/toolReturnCode.h \
     Camera/cameraDummy.h \
+    Camera/syntheticFrame.h \
     Conoscope/ConoscopeResource.h \
     Tools/logger.h \
     ConoscopeApp/ConoscopeApp.h \
@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# ConoscopeLib tests
+# only the sources under test are built in the executable (no camera is needed)
+#
+#-------------------------------------------------
+
+# QImage of the previews written by the FileWriter
+QT       += core gui
+
+TARGET = ConoscopeLibTest
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    Test/main.cpp \
+    Test/testRawCodec.cpp \
+    Test/testCoaXpressKernels.cpp \
+    Test/testCoaXpressFrame.cpp \
+    Test/testChunkFile.cpp \
+    Test/testFileWriter.cpp \
+    Tools/toolFrameBuffer.cpp \
+    Tools/toolRawCodec.cpp \
+    Tools/toolChunkFile.cpp \
+    Tools/toolFileWriter.cpp \
+    CoaXPress/CoaXpressKernels.cpp \
+    CoaXPress/CoaXpressKernelsAvx2.cpp \
+    CoaXPress/CoaXpressFrame.cpp \
+    CoaXPress/CoaXpressTypes.cpp
+
+HEADERS += \
+    Test/test.h \
+    Tools/toolFrameBuffer.h \
+    Tools/toolRawCodec.h \
+    Tools/toolChunkFile.h \
+    Tools/toolFileWriter.h \
+    CoaXPress/CoaXpressKernels.h \
+    CoaXPress/CoaXpressFrame.h \
+    CoaXPress/CoaXpressTypes.h \
+    CoaXPress/CoaXpressConfiguration.h
+
+INCLUDEPATH += './Tools'
+INCLUDEPATH += './CoaXPress'
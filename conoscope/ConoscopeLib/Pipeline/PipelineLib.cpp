@@ -6,6 +6,7 @@
 #define ErrorMessage_AlreadyInstanciated "Error: Already instanciated"
 #define ErrorMessage_LoadingDll          "Error: Loading Dll"
 #define ErrorMessage_ResolvingApi        "Error: Resolving Api"
+#define ErrorMessage_FrameNotPacked      "Error: frame is not packed"
 
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
@@ -59,6 +60,78 @@ ClassCommon::Error PipelineLib::CmdComputeKLibData(
     return returnCode.GetError();
 }
 
+ClassCommon::Error PipelineLib::CmdComputeRawData(
+        FrameBuffer& input,
+        Pipeline_RawDataParam* param,
+        Pipeline_ResultRawDataParam &resultParam)
+{
+    // the pipeline does not support the stride of a view
+    if((input.IsNull() == true) || (input.IsContiguous() == false))
+    {
+        mErrorDescription = ErrorMessage_FrameNotPacked;
+        return ClassCommon::Error::InvalidParameter;
+    }
+
+    return CmdComputeRawData((int16*)input.GetData(), param, resultParam);
+}
+
+ClassCommon::Error PipelineLib::CmdComputeKLibData(
+        FrameBuffer& input,
+        Pipeline_KLibDataParam &param,
+        Pipeline_CalibrationParam *calibration,
+        int16* klibData)
+{
+    if((input.IsNull() == true) || (input.IsContiguous() == false))
+    {
+        mErrorDescription = ErrorMessage_FrameNotPacked;
+        ToolReturnCode::SetErrorDescription(mErrorDescription);
+        return ClassCommon::Error::InvalidParameter;
+    }
+
+    return CmdComputeKLibData((int16*)input.GetData(), param, calibration, klibData);
+}
+
+PipelineContext_t PipelineLib::CreateContext()
+{
+    return LibPipelineCreateContext();
+}
+
+void PipelineLib::DestroyContext(PipelineContext_t context)
+{
+    LibPipelineDestroyContext(context);
+}
+
+ClassCommon::Error PipelineLib::CmdComputeRawData(
+        PipelineContext_t context,
+        int16* inputData,
+        Pipeline_RawDataParam* param,
+        Pipeline_ResultRawDataParam &resultParam)
+{
+    QString error = LIB_EXECUTE(LibCmdComputeRawDataContext(context, inputData, param, resultParam));
+
+    ToolReturnCode returnCode = ToolReturnCode(error);
+    mErrorDescription = returnCode.GetOption("ErrorDescription").toString();
+
+    return returnCode.GetError();
+}
+
+ClassCommon::Error PipelineLib::CmdComputeKLibData(
+        PipelineContext_t context,
+        int16* inputData,
+        Pipeline_KLibDataParam &param,
+        Pipeline_CalibrationParam *calibration,
+        int16* klibData)
+{
+    QString error = LIB_EXECUTE(LibCmdComputeKLibDataContext(context, inputData, param, calibration, klibData));
+
+    ToolReturnCode returnCode = ToolReturnCode(error);
+    mErrorDescription = returnCode.GetOption("ErrorDescription").toString();
+
+    ToolReturnCode::SetErrorDescription(mErrorDescription);
+
+    return returnCode.GetError();
+}
+
 void PipelineLib::_Load()
 {
     Log("loading DLL...");
@@ -75,6 +148,10 @@ void PipelineLib::_Load()
     RESOLVE(CmdGetVersion);
     RESOLVE(CmdComputeRawData);
     RESOLVE(CmdComputeKLibData);
+    RESOLVE(PipelineCreateContext);
+    RESOLVE(PipelineDestroyContext);
+    RESOLVE(CmdComputeRawDataContext);
+    RESOLVE(CmdComputeKLibDataContext);
 
     Log("API resolved");
 }
@@ -7,6 +7,7 @@
 
 #include "classcommon.h"
 #include "Types.h"
+#include "toolFrameBuffer.h"
 
 class PipelineLib : public ClassCommon
 {
@@ -29,6 +30,36 @@ public:
             Pipeline_CalibrationParam *calibration,
             int16 *klibData);
 
+    // frame buffer API (the pipeline works in place on a packed frame)
+    Error CmdComputeRawData(
+            FrameBuffer& input,
+            Pipeline_RawDataParam *param,
+            Pipeline_ResultRawDataParam &resultParam);
+
+    Error CmdComputeKLibData(
+            FrameBuffer& input,
+            Pipeline_KLibDataParam &param,
+            Pipeline_CalibrationParam *calibration,
+            int16 *klibData);
+
+    // reentrant API (several frames can be processed at the same time with different contexts)
+    PipelineContext_t CreateContext();
+
+    void DestroyContext(PipelineContext_t context);
+
+    Error CmdComputeRawData(
+            PipelineContext_t context,
+            int16 *inputData,
+            Pipeline_RawDataParam *param,
+            Pipeline_ResultRawDataParam &resultParam);
+
+    Error CmdComputeKLibData(
+            PipelineContext_t context,
+            int16 *inputData,
+            Pipeline_KLibDataParam &param,
+            Pipeline_CalibrationParam *calibration,
+            int16 *klibData);
+
     QString GetErrorDescription()
     {
         return mErrorDescription;
@@ -50,6 +81,27 @@ public:
             int16* klibData);
     CMD(CmdComputeKLibData);
 
+    typedef PipelineContext_t (*f_PipelineCreateContext)();
+    CMD(PipelineCreateContext);
+
+    typedef void (*f_PipelineDestroyContext)(PipelineContext_t context);
+    CMD(PipelineDestroyContext);
+
+    typedef char* (*f_CmdComputeRawDataContext)(
+            PipelineContext_t context,
+            int16* inputData,
+            Pipeline_RawDataParam* param,
+            Pipeline_ResultRawDataParam &resultParam);
+    CMD(CmdComputeRawDataContext);
+
+    typedef char* (*f_CmdComputeKLibDataContext)(
+            PipelineContext_t context,
+            int16* inputData,
+            Pipeline_KLibDataParam &param,
+            Pipeline_CalibrationParam *calibration,
+            int16* klibData);
+    CMD(CmdComputeKLibDataContext);
+
 private:
     void _Load();
 
@@ -10,6 +10,9 @@
 
 #define SQUARE(Value) ((Value)*(Value))
 
+// handle of a pipeline context (see PipelineCreateContext)
+typedef void* PipelineContext_t;
+
 class ImageSize
 {
 public:
@@ -366,9 +369,13 @@ public:
     float                         conversionFactor_Value;
     SensorTemperature             conversionFactor_SensorTemperature;
 
+    // identify the flat field (camera, iris, filter, nd) so its gain map can be reused
+    // 0 means the gain map is computed for each call
+    uint64                        gainMapId;
+
     Pipeline_CalibrationParam()
     {
-
+        gainMapId = 0;
     }
 
     Pipeline_CalibrationParam(const Pipeline_CalibrationParam& calib)
@@ -386,6 +393,8 @@ public:
 
         conversionFactor_Value              = calib.conversionFactor_Value;
         conversionFactor_SensorTemperature  = calib.conversionFactor_SensorTemperature;
+
+        gainMapId                           = calib.gainMapId;
     }
 };
 
@@ -420,6 +429,9 @@ public:
     float                            prnuScaleFactor;
     bool                             prnuCorrectionEnabled;
     std::vector<char>*               prnuData;
+    // identify the PRNU calibration (camera) so its gain map can be reused
+    // 0 means the gain map is computed for each call
+    uint64                           gainMapId;
 
     Pipeline_RawDataParam()
     {
@@ -433,6 +445,7 @@ public:
         prnuEnable = false;
         prnuScaleFactor = 0;
         prnuCorrectionEnabled = false;
+        gainMapId = 0;
     }
 };
 
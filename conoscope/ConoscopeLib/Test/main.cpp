@@ -0,0 +1,55 @@
+#include <QCoreApplication>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+
+typedef struct
+{
+    const char* name;
+    bool (*function)();
+} Test_t;
+
+static const Test_t tests[] =
+{
+    {"RawCodec",         TestRawCodec},
+    {"CoaXpressKernels", TestCoaXpressKernels},
+    {"CoaXpressFrame",   TestCoaXpressFrame},
+    {"ChunkFile",        TestChunkFile},
+    {"FileWriter",       TestFileWriter},
+};
+
+// run all the tests, or the ones whose name is given
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int failCount = 0;
+
+    for(size_t index = 0; index < sizeof(tests) / sizeof(tests[0]); index ++)
+    {
+        bool bSelected = (argc < 2);
+
+        for(int arg = 1; arg < argc; arg ++)
+        {
+            bSelected |= (strcmp(argv[arg], tests[index].name) == 0);
+        }
+
+        if(bSelected == false)
+        {
+            continue;
+        }
+
+        bool bSuccess = tests[index].function();
+
+        printf("%s %s\n", (bSuccess == true) ? "PASS" : "FAIL", tests[index].name);
+
+        if(bSuccess == false)
+        {
+            failCount ++;
+        }
+    }
+
+    return (failCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+#include "test.h"
+
+#include "toolChunkFile.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <string.h>
+
+static FrameBuffer _Generate(int width, int height, int seed)
+{
+    FrameBuffer frame(width, height);
+
+    for(int line = 0; line < height; line ++)
+    {
+        for(int index = 0; index < width; index ++)
+        {
+            frame.GetLine(line)[index] = (uint16_t)((line * width + index) * 7 + seed) & 0xFFF;
+        }
+    }
+
+    return frame;
+}
+
+static bool _Equal(const FrameBuffer& a, const FrameBuffer& b)
+{
+    if((a.IsNull() == true) || (b.IsNull() == true) ||
+       (a.GetWidth() != b.GetWidth()) || (a.GetHeight() != b.GetHeight()))
+    {
+        return false;
+    }
+
+    for(int line = 0; line < a.GetHeight(); line ++)
+    {
+        if(memcmp(a.GetLine(line), b.GetLine(line), a.GetWidth() * sizeof(uint16_t)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool _WriteChunk(ChunkFile& container, const QString& name, ChunkFileType_t eType, const QByteArray& data, int width = 0, int height = 0)
+{
+    QFile* pFile = container.BeginChunk(name, eType, width, height);
+
+    TEST_CHECK(pFile != NULL);
+    TEST_CHECK(pFile->write(data) == data.size());
+    TEST_CHECK(container.EndChunk() == true);
+
+    return true;
+}
+
+static QByteArray _Bytes(const FrameBuffer& frame)
+{
+    QByteArray data(frame.GetSize(), 0);
+    frame.CopyTo(data.data());
+
+    return data;
+}
+
+// Create, chunks (one replaced), Close with a rename, Open and read back
+static bool _TestRoundTrip(const QString& partPath, const QString& filePath)
+{
+    FrameBuffer first  = _Generate(33, 17, 1);
+    FrameBuffer second = _Generate(64, 8, 2);
+    QByteArray  json("{\"exposureTimeUs\": 1000}");
+    QByteArray  odd(4097, 'x');
+
+    ChunkFile writer;
+
+    // the reservation is smaller than the chunks, the file grows after it
+    TEST_CHECK(writer.Create(partPath, 8192) == true);
+    TEST_CHECK(writer.IsCreated() == true);
+
+    // the header is written when the file is closed
+    TEST_CHECK(ChunkFile::IsChunkFile(partPath) == false);
+
+    if((_WriteChunk(writer, "image.bin",  ChunkFileType_Pixel16, _Bytes(first), first.GetWidth(), first.GetHeight()) == false) ||
+       (_WriteChunk(writer, "info.json",  ChunkFileType_Json,    json) == false) ||
+       (_WriteChunk(writer, "odd.bin",    ChunkFileType_Bytes,   odd) == false) ||
+       (_WriteChunk(writer, "image.bin",  ChunkFileType_Pixel16, _Bytes(second), second.GetWidth(), second.GetHeight()) == false))
+    {
+        return false;
+    }
+
+    TEST_CHECK(writer.Close(filePath) == true);
+    TEST_CHECK(writer.IsCreated() == false);
+
+    TEST_CHECK(QFile::exists(partPath) == false);
+    TEST_CHECK(ChunkFile::IsChunkFile(filePath) == true);
+
+    ChunkFile reader;
+
+    TEST_CHECK(reader.Open(filePath) == true);
+
+    // the chunk with the name of a previous one replaces it
+    QList<ChunkFileEntry_t> entries = reader.GetEntries();
+
+    TEST_CHECK(entries.count() == 3);
+
+    for(const ChunkFileEntry_t& entry : entries)
+    {
+        TEST_CHECK((entry.offset % CHUNK_FILE_ALIGNMENT) == 0);
+    }
+
+    ChunkFileEntry_t entry;
+
+    TEST_CHECK(reader.Find("image.bin", entry) == true);
+    TEST_CHECK(entry.eType == ChunkFileType_Pixel16);
+    TEST_CHECK((entry.width == second.GetWidth()) && (entry.height == second.GetHeight()));
+    TEST_CHECK(entry.size == second.GetSize());
+    TEST_CHECK(reader.Read(entry) == _Bytes(second));
+    TEST_CHECK(_Equal(reader.MapFrame(entry), second) == true);
+
+    TEST_CHECK(reader.Find("info.json", entry) == true);
+    TEST_CHECK(entry.eType == ChunkFileType_Json);
+    TEST_CHECK(reader.Read(entry) == json);
+
+    // only the pixel chunks are mapped
+    TEST_CHECK(reader.MapFrame(entry).IsNull() == true);
+
+    TEST_CHECK(reader.Find("odd.bin", entry) == true);
+    TEST_CHECK(reader.Read(entry) == odd);
+
+    TEST_CHECK(reader.Find("missing.bin", entry) == false);
+
+    return true;
+}
+
+// the index is full: a new name is refused, a name already in it is still replaced
+static bool _TestCapacity(const QString& filePath)
+{
+    ChunkFile writer;
+
+    TEST_CHECK(writer.Create(filePath, 0) == true);
+
+    // the name is stored in CHUNK_FILE_NAME_SIZE bytes (with its end)
+    TEST_CHECK(writer.BeginChunk(QString(CHUNK_FILE_NAME_SIZE, 'n'), ChunkFileType_Bytes, 0, 0) == NULL);
+
+    for(int index = 0; index < CHUNK_FILE_CAPACITY; index ++)
+    {
+        if(_WriteChunk(writer, QString("chunk%1.bin").arg(index), ChunkFileType_Bytes, QByteArray(index + 1, (char)index)) == false)
+        {
+            return false;
+        }
+    }
+
+    TEST_CHECK(writer.BeginChunk("overflow.bin", ChunkFileType_Bytes, 0, 0) == NULL);
+
+    if(_WriteChunk(writer, "chunk0.bin", ChunkFileType_Bytes, QByteArray("replaced")) == false)
+    {
+        return false;
+    }
+
+    TEST_CHECK(writer.Close() == true);
+
+    ChunkFile reader;
+    ChunkFileEntry_t entry;
+
+    TEST_CHECK(reader.Open(filePath) == true);
+    TEST_CHECK(reader.GetEntries().count() == CHUNK_FILE_CAPACITY);
+    TEST_CHECK(reader.Find("overflow.bin", entry) == false);
+
+    TEST_CHECK(reader.Find("chunk0.bin", entry) == true);
+    TEST_CHECK(reader.Read(entry) == QByteArray("replaced"));
+
+    TEST_CHECK(reader.Find(QString("chunk%1.bin").arg(CHUNK_FILE_CAPACITY - 1), entry) == true);
+    TEST_CHECK(reader.Read(entry) == QByteArray(CHUNK_FILE_CAPACITY, (char)(CHUNK_FILE_CAPACITY - 1)));
+
+    return true;
+}
+
+// a container closed without a name keeps its temporary name
+static bool _TestPartFile(const QString& partPath)
+{
+    ChunkFile writer;
+
+    TEST_CHECK(writer.Create(partPath, 1024 * 1024) == true);
+
+    if(_WriteChunk(writer, "info.json", ChunkFileType_Json, QByteArray("{}")) == false)
+    {
+        return false;
+    }
+
+    TEST_CHECK(writer.Close() == true);
+
+    // the reservation which is not used is released
+    TEST_CHECK(QFile(partPath).size() < 1024 * 1024);
+
+    {
+        ChunkFile reader;
+        ChunkFileEntry_t entry;
+
+        TEST_CHECK(reader.Open(partPath) == true);
+        TEST_CHECK(reader.Find("info.json", entry) == true);
+        TEST_CHECK(reader.Read(entry) == QByteArray("{}"));
+    }
+
+    // not a container
+    QFile file(partPath);
+    TEST_CHECK(file.open(QIODevice::WriteOnly | QIODevice::Truncate) == true);
+    TEST_CHECK(file.write(QByteArray(CHUNK_FILE_HEADER_SIZE, 0)) == CHUNK_FILE_HEADER_SIZE);
+    file.close();
+
+    ChunkFile invalid;
+
+    TEST_CHECK(ChunkFile::IsChunkFile(partPath) == false);
+    TEST_CHECK(invalid.Open(partPath) == false);
+
+    return true;
+}
+
+bool TestChunkFile()
+{
+    QString partPath = QDir::temp().filePath("ConoscopeLibTest_ChunkFile.part");
+    QString filePath = QDir::temp().filePath("ConoscopeLibTest_ChunkFile.chunk");
+
+    bool bSuccess = (_TestRoundTrip(partPath, filePath) == true) &&
+                    (_TestCapacity(filePath) == true) &&
+                    (_TestPartFile(partPath) == true);
+
+    QFile::remove(partPath);
+    QFile::remove(filePath);
+
+    return bSuccess;
+}
@@ -0,0 +1,231 @@
+#include "test.h"
+
+#include "CoaXpressFrame.h"
+
+#include <vector>
+
+#define FRAME_WIDTH  8
+#define FRAME_HEIGHT 4
+
+static_assert(NUMBER_OF_FRAME == 2, "the test expects a ring of 2 frames");
+
+// every pixel of the image is value
+static void _Append(int imageIndex, std::vector<uint16_t>& pixels, uint16_t value)
+{
+    pixels.assign(FRAME_WIDTH * FRAME_HEIGHT, value);
+
+    ImageBuffer imageBuffer;
+
+    imageBuffer.width   = FRAME_WIDTH;
+    imageBuffer.height  = FRAME_HEIGHT;
+    imageBuffer.bufSize = pixels.size() * sizeof(uint16_t);
+    imageBuffer.ptr     = pixels.data();
+
+    CoaXpressFrame::AppendImage(imageIndex, imageBuffer);
+}
+
+// all the pixels of the frame read are value
+static bool _CheckAverage(int imageIndex, uint16_t value)
+{
+    FrameBuffer image;
+
+    TEST_CHECK(CoaXpressFrame::ReadImage(imageIndex, QRect(0, 0, FRAME_WIDTH, FRAME_HEIGHT), image) == true);
+    TEST_CHECK((image.GetWidth() == FRAME_WIDTH) && (image.GetHeight() == FRAME_HEIGHT));
+
+    for(int line = 0; line < FRAME_HEIGHT; line ++)
+    {
+        for(int index = 0; index < FRAME_WIDTH; index ++)
+        {
+            TEST_CHECK(image.GetLine(line)[index] == value);
+        }
+    }
+
+    return true;
+}
+
+// all the slots are free
+static void _Reset(FrameOverwritePolicy_t ePolicy)
+{
+    ImageFeature feature;
+
+    feature.width   = FRAME_WIDTH;
+    feature.height  = FRAME_HEIGHT;
+    feature.eFormat = PixelFormat_Mono12;
+
+    CoaXpressFrame::SetFrameSize(feature);
+    CoaXpressFrame::SetOverwritePolicy(ePolicy);
+    CoaXpressFrame::SetAccumulationArea(QRect());
+}
+
+static bool _TestStates()
+{
+    std::vector<uint16_t> pixels;
+
+    _Reset(FrameOverwrite_Block);
+
+    // Free -> Filling: the frame can not be read
+    int first = CoaXpressFrame::GetImageIndex();
+
+    TEST_CHECK(first == 0);
+    TEST_CHECK(CoaXpressFrame::GetImage(first) == NULL);
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == INVALID_FRAME_INDEX);
+
+    _Append(first, pixels, 100);
+    _Append(first, pixels, 200);
+
+    // Filling -> Ready
+    CoaXpressFrame::SetImageReady(first);
+
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == first);
+
+    // the image is read only after GetImage
+    FrameBuffer image;
+    TEST_CHECK(CoaXpressFrame::ReadImage(first, QRect(0, 0, FRAME_WIDTH, FRAME_HEIGHT), image) == false);
+
+    // Ready -> Reading
+    ImageFrame* pFrame = CoaXpressFrame::GetImage(first);
+
+    TEST_CHECK(pFrame != NULL);
+    TEST_CHECK(pFrame->mState == FrameSlot_Reading);
+    TEST_CHECK(pFrame->mAccumulatedCount == 2);
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == INVALID_FRAME_INDEX);
+
+    if(_CheckAverage(first, 150) == false)
+    {
+        return false;
+    }
+
+    // the next capture is done in the other slot while the frame is read
+    int second = CoaXpressFrame::GetImageIndex();
+
+    TEST_CHECK(second == 1);
+    TEST_CHECK(pFrame->mState == FrameSlot_Reading);
+
+    // Reading -> Free
+    CoaXpressFrame::ReleaseImage(first);
+
+    TEST_CHECK(CoaXpressFrame::GetImage(first) == NULL);
+    TEST_CHECK(CoaXpressFrame::ReadImage(first, QRect(0, 0, FRAME_WIDTH, FRAME_HEIGHT), image) == false);
+
+    // invalid indexes
+    TEST_CHECK(CoaXpressFrame::GetImage(INVALID_FRAME_INDEX) == NULL);
+    TEST_CHECK(CoaXpressFrame::GetImage(NUMBER_OF_FRAME) == NULL);
+
+    return true;
+}
+
+static bool _TestOverwrite()
+{
+    std::vector<uint16_t> pixels;
+
+    // Block: no capture while all the frames are used
+    _Reset(FrameOverwrite_Block);
+
+    int first = CoaXpressFrame::GetImageIndex();
+    _Append(first, pixels, 10);
+    CoaXpressFrame::SetImageReady(first);
+
+    int second = CoaXpressFrame::GetImageIndex();
+    _Append(second, pixels, 20);
+    CoaXpressFrame::SetImageReady(second);
+
+    TEST_CHECK((first != INVALID_FRAME_INDEX) && (second != INVALID_FRAME_INDEX) && (first != second));
+    TEST_CHECK(CoaXpressFrame::GetImageIndex() == INVALID_FRAME_INDEX);
+
+    // the oldest frame is read first
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == first);
+
+    // Oldest: the oldest frame not read is used, a frame being read is kept
+    CoaXpressFrame::SetOverwritePolicy(FrameOverwrite_Oldest);
+
+    TEST_CHECK(CoaXpressFrame::GetImage(first) != NULL);
+    TEST_CHECK(CoaXpressFrame::GetImageIndex() == second);
+    TEST_CHECK(CoaXpressFrame::GetImage(second) == NULL);
+
+    // the overwritten slot starts a new average
+    _Append(second, pixels, 30);
+    CoaXpressFrame::SetImageReady(second);
+
+    TEST_CHECK(CoaXpressFrame::GetImage(second) != NULL);
+
+    if((_CheckAverage(first, 10) == false) || (_CheckAverage(second, 30) == false))
+    {
+        return false;
+    }
+
+    // both frames are read, none can be overwritten
+    TEST_CHECK(CoaXpressFrame::GetImageIndex() == INVALID_FRAME_INDEX);
+
+    CoaXpressFrame::ReleaseImage(first);
+    CoaXpressFrame::ReleaseImage(second);
+
+    // Oldest with ready frames of several captures
+    int third = CoaXpressFrame::GetImageIndex();
+    _Append(third, pixels, 40);
+    CoaXpressFrame::SetImageReady(third);
+
+    int fourth = CoaXpressFrame::GetImageIndex();
+    _Append(fourth, pixels, 50);
+    CoaXpressFrame::SetImageReady(fourth);
+
+    TEST_CHECK(CoaXpressFrame::GetImageIndex() == third);
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == fourth);
+
+    return true;
+}
+
+static bool _TestAbort()
+{
+    std::vector<uint16_t> pixels;
+
+    _Reset(FrameOverwrite_Block);
+
+    // capture aborted: the slot being filled is given back (CoaXpressGrabber::Stop)
+    int aborted = CoaXpressFrame::GetImageIndex();
+    _Append(aborted, pixels, 70);
+
+    CoaXpressFrame::ReleaseImage(aborted);
+
+    TEST_CHECK(CoaXpressFrame::GetImage(aborted) == NULL);
+    TEST_CHECK(CoaXpressFrame::GetReadyImageIndex() == INVALID_FRAME_INDEX);
+
+    // a late buffer of the aborted capture is not appended to any slot
+    _Append(INVALID_FRAME_INDEX, pixels, 1000);
+
+    // all the slots can be used again, the average starts with the new capture
+    int first = CoaXpressFrame::GetImageIndex();
+    int second = CoaXpressFrame::GetImageIndex();
+
+    TEST_CHECK((first != INVALID_FRAME_INDEX) && (second != INVALID_FRAME_INDEX) && (first != second));
+    TEST_CHECK((first == aborted) || (second == aborted));
+
+    _Append(aborted, pixels, 80);
+    CoaXpressFrame::SetImageReady(aborted);
+
+    ImageFrame* pFrame = CoaXpressFrame::GetImage(aborted);
+
+    TEST_CHECK(pFrame != NULL);
+    TEST_CHECK(pFrame->mAccumulatedCount == 1);
+
+    if(_CheckAverage(aborted, 80) == false)
+    {
+        return false;
+    }
+
+    // a frame released before being ready can not be handed over
+    int other = (first == aborted) ? second : first;
+
+    CoaXpressFrame::ReleaseImage(other);
+    CoaXpressFrame::SetImageReady(other);
+
+    TEST_CHECK(CoaXpressFrame::GetImage(other) == NULL);
+
+    return true;
+}
+
+bool TestCoaXpressFrame()
+{
+    return (_TestStates() == true) &&
+           (_TestOverwrite() == true) &&
+           (_TestAbort() == true);
+}
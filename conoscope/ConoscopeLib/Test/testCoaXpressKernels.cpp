@@ -0,0 +1,240 @@
+#include "test.h"
+
+#include "CoaXpressKernels.h"
+
+#include <vector>
+#include <random>
+#include <string.h>
+
+// odd and even pixel counts, tails shorter than a vector and a thread block
+static const int counts[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 1001, FRAME_KERNEL_BLOCK_SIZE, FRAME_KERNEL_BLOCK_SIZE + 3};
+
+// power of 2, reciprocal (log2 <= 14) and division (log2 > 14)
+static const int averages[] = {1, 2, 3, 5, 7, 16, 100, 1000, 16383, 16385, 32768, 32769, 65537};
+
+typedef enum
+{
+    Pattern_Ramp,
+    Pattern_Extremes,  // 0 and 4095 alternated
+    Pattern_Bits,      // 0xAAA and 0x555 alternated
+    Pattern_Random,
+    Pattern_Count
+} Pattern_t;
+
+static void _Generate(std::vector<uint16_t>& pixels, int count, Pattern_t ePattern, std::mt19937& random)
+{
+    pixels.resize(count);
+
+    for(int index = 0; index < count; index ++)
+    {
+        switch(ePattern)
+        {
+        case Pattern_Ramp:     pixels[index] = (uint16_t)(index & 0xFFF); break;
+        case Pattern_Extremes: pixels[index] = (index & 1) ? 4095 : 0; break;
+        case Pattern_Bits:     pixels[index] = (index & 1) ? 0x555 : 0xAAA; break;
+        default:               pixels[index] = (uint16_t)(random() & 0xFFF); break;
+        }
+    }
+}
+
+// Mono12p: pixel 2n in byte 3n and the low nibble of byte 3n+1, pixel 2n+1 in the high nibble and byte 3n+2
+static std::vector<uint8_t> _Pack(const std::vector<uint16_t>& pixels)
+{
+    int count = (int)pixels.size();
+
+    std::vector<uint8_t> packed(PACKED_12P_BYTES(count), 0);
+
+    for(int index = 0; index < count; index ++)
+    {
+        uint8_t* pPair = &packed[(index / 2) * 3];
+        uint16_t value = pixels[index];
+
+        if((index % 2) == 0)
+        {
+            pPair[0]  = (uint8_t)(value & 0xFF);
+            pPair[1] |= (uint8_t)(value >> 8);
+        }
+        else
+        {
+            pPair[1] |= (uint8_t)((value & 0x0F) << 4);
+            pPair[2]  = (uint8_t)(value >> 4);
+        }
+    }
+
+    return packed;
+}
+
+static bool _CheckUnpack(const FrameKernels_t& kernels, const std::vector<uint16_t>& pixels)
+{
+    int count = (int)pixels.size();
+
+    // the packed buffer has its exact size, nothing is read after it
+    std::vector<uint8_t> packed = _Pack(pixels);
+
+    std::vector<uint16_t> unpacked(count, 0xFFFF);
+    kernels.Unpack12p(unpacked.data(), packed.data(), count);
+
+    TEST_CHECK(unpacked == pixels);
+
+    std::vector<uint32_t> sum(count, 0xFFFFFFFF);
+    kernels.Widen12p(sum.data(), packed.data(), count);
+
+    for(int index = 0; index < count; index ++)
+    {
+        TEST_CHECK(sum[index] == pixels[index]);
+    }
+
+    kernels.Accumulate12p(sum.data(), packed.data(), count);
+
+    for(int index = 0; index < count; index ++)
+    {
+        TEST_CHECK(sum[index] == 2u * pixels[index]);
+    }
+
+    // a block of a frame starts on an even pixel
+    if(count > 2)
+    {
+        std::vector<uint32_t> block(count - 2, 7);
+        kernels.Accumulate12p(block.data(), &packed[3], count - 2);
+
+        for(int index = 0; index < count - 2; index ++)
+        {
+            TEST_CHECK(block[index] == 7u + pixels[index + 2]);
+        }
+    }
+
+    return true;
+}
+
+// nbAcquisition frames accumulated then averaged
+static bool _CheckAverage(const FrameKernels_t& kernels, int nbAcquisition, std::mt19937& random)
+{
+    FrameReciprocal_t reciprocal = CoaXpressKernels::GetReciprocal(nbAcquisition);
+
+    int log2 = 0;
+
+    while((nbAcquisition >> (log2 + 1)) != 0)
+    {
+        log2 ++;
+    }
+
+    bool bPowerOf2 = ((nbAcquisition & (nbAcquisition - 1)) == 0);
+
+    // the reciprocal is only used up to 2^14, then the sum is divided
+    TEST_CHECK((reciprocal.multiplier == 0) == ((bPowerOf2 == false) && (log2 > 14)));
+
+    // sums of nbAcquisition 16 bits values: limits, multiples of the count and random
+    uint32_t maxSum = (uint32_t)nbAcquisition * 65535u;
+
+    std::vector<uint32_t> sums;
+    sums.push_back(0);
+    sums.push_back(maxSum);
+    sums.push_back(maxSum - 1);
+
+    for(int index = 0; index < 61; index ++)
+    {
+        uint32_t multiple = (uint32_t)(random() % 65536) * (uint32_t)nbAcquisition;
+
+        sums.push_back(multiple);
+        sums.push_back((multiple > 0) ? multiple - 1 : 1);
+        sums.push_back((uint32_t)(((uint64_t)random() * (maxSum + 1ull)) >> 32));
+    }
+
+    int count = (int)sums.size();
+
+    std::vector<uint16_t> average(count + 1, 0xA5A5);
+    kernels.Average(average.data(), sums.data(), reciprocal, count);
+
+    for(int index = 0; index < count; index ++)
+    {
+        TEST_CHECK(average[index] == (uint16_t)(sums[index] / (uint32_t)nbAcquisition));
+    }
+
+    TEST_CHECK(average[count] == 0xA5A5);
+
+    return true;
+}
+
+bool TestCoaXpressKernels()
+{
+    std::mt19937 random(3);
+
+    for(int isa = FrameKernelIsa_Scalar; isa < FrameKernelIsa_Count; isa ++)
+    {
+        FrameKernelIsa_t eDefaultIsa = CoaXpressKernels::GetIsa();
+
+        // only to know if the cpu supports it
+        if(CoaXpressKernels::Select((FrameKernelIsa_t)isa) == false)
+        {
+            printf("  frame kernels %d not supported by this cpu\n", isa);
+            continue;
+        }
+
+        CoaXpressKernels::Select(eDefaultIsa);
+
+        const FrameKernels_t& kernels = CoaXpressKernels::Get((FrameKernelIsa_t)isa);
+
+        for(int count : counts)
+        {
+            for(int ePattern = 0; ePattern < Pattern_Count; ePattern ++)
+            {
+                std::vector<uint16_t> pixels;
+
+                _Generate(pixels, count, (Pattern_t)ePattern, random);
+
+                if(_CheckUnpack(kernels, pixels) == false)
+                {
+                    fprintf(stderr, "frame kernels %d count %d pattern %d\n", isa, count, ePattern);
+                    return false;
+                }
+            }
+        }
+
+        for(int nbAcquisition : averages)
+        {
+            if(_CheckAverage(kernels, nbAcquisition, random) == false)
+            {
+                fprintf(stderr, "frame kernels %d nbAcquisition %d\n", isa, nbAcquisition);
+                return false;
+            }
+        }
+
+        // frames accumulated from Mono12p buffers
+        std::vector<uint16_t> pixels;
+        std::vector<uint32_t> sum(1001);
+
+        for(int frame = 0; frame < 5; frame ++)
+        {
+            std::vector<uint16_t> image;
+            _Generate(image, 1001, Pattern_Random, random);
+
+            std::vector<uint8_t> packed = _Pack(image);
+
+            if(frame == 0)
+            {
+                kernels.Widen12p(sum.data(), packed.data(), 1001);
+                pixels.assign(1001, 0);
+            }
+            else
+            {
+                kernels.Accumulate12p(sum.data(), packed.data(), 1001);
+            }
+
+            for(int index = 0; index < 1001; index ++)
+            {
+                pixels[index] += image[index];
+            }
+        }
+
+        std::vector<uint16_t> average(1001);
+        kernels.Average(average.data(), sum.data(), CoaXpressKernels::GetReciprocal(5), 1001);
+
+        for(int index = 0; index < 1001; index ++)
+        {
+            TEST_CHECK(sum[index] == pixels[index]);
+            TEST_CHECK(average[index] == pixels[index] / 5);
+        }
+    }
+
+    return true;
+}
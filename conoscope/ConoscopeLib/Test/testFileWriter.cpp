@@ -0,0 +1,199 @@
+#include "test.h"
+
+#include "toolFileWriter.h"
+#include "toolRawCodec.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRect>
+
+#include <string.h>
+
+static FrameBuffer _Generate(int width, int height, int seed)
+{
+    FrameBuffer frame(width, height);
+
+    for(int line = 0; line < height; line ++)
+    {
+        for(int index = 0; index < width; index ++)
+        {
+            frame.GetLine(line)[index] = (uint16_t)((line * 31 + index * 5 + seed) & 0xFFF);
+        }
+    }
+
+    return frame;
+}
+
+static bool _Equal(const FrameBuffer& a, const FrameBuffer& b)
+{
+    if((a.IsNull() == true) || (b.IsNull() == true) ||
+       (a.GetWidth() != b.GetWidth()) || (a.GetHeight() != b.GetHeight()))
+    {
+        return false;
+    }
+
+    for(int line = 0; line < a.GetHeight(); line ++)
+    {
+        if(memcmp(a.GetLine(line), b.GetLine(line), a.GetWidth() * sizeof(uint16_t)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static QByteArray _ReadFile(const QString& filePath)
+{
+    QFile file(filePath);
+
+    return (file.open(QIODevice::ReadOnly) == true) ? file.readAll() : QByteArray();
+}
+
+// files written as the chunks of a container, the ones which do not fit in its index on their own
+static bool _TestContainer(const QDir& dir)
+{
+    QString partPath = dir.filePath("capture.part");
+    QString filePath = dir.filePath("capture.chunk");
+
+    FrameBuffer frame = _Generate(40, 30, 1);
+    FrameBuffer view  = frame.Crop(QRect(3, 2, 17, 11));
+    FrameBuffer raw   = _Generate(64, 16, 2);
+    QByteArray  json("{\"exposureTimeUs\": 1000}");
+
+    // more files than the index can take
+    const int extraCount = CHUNK_FILE_CAPACITY;
+    const int fileCount  = 4 + extraCount;
+
+    FileWriter::OpenContainer(partPath, 64 * 1024);
+
+    FileWriter::Write(dir.filePath("image.bin"), frame);
+    FileWriter::Write(dir.filePath("view.bin"),  view);
+    FileWriter::Write(dir.filePath("raw.bin"),   raw, FileWriterEncoding_Raw12);
+    FileWriter::Write(dir.filePath("info.json"), json, ChunkFileType_Json);
+
+    for(int index = 0; index < extraCount; index ++)
+    {
+        FileWriter::Write(dir.filePath(QString("extra%1.bin").arg(index)), QByteArray(index + 1, (char)index));
+    }
+
+    FileWriter::CloseContainer(filePath);
+
+    // written after the container is closed
+    FileWriter::Write(dir.filePath("after.json"), json, ChunkFileType_Json);
+
+    QString error;
+
+    TEST_CHECK(FileWriter::Flush(error) == true);
+    TEST_CHECK(error.isEmpty() == true);
+
+    TEST_CHECK(QFile::exists(partPath) == false);
+    TEST_CHECK(ChunkFile::IsChunkFile(filePath) == true);
+
+    ChunkFile container;
+    ChunkFileEntry_t entry;
+
+    TEST_CHECK(container.Open(filePath) == true);
+    TEST_CHECK(container.GetEntries().count() == CHUNK_FILE_CAPACITY);
+
+    TEST_CHECK(container.Find("image.bin", entry) == true);
+    TEST_CHECK((entry.eType == ChunkFileType_Pixel16) && (entry.width == 40) && (entry.height == 30));
+    TEST_CHECK(_Equal(container.MapFrame(entry), frame) == true);
+
+    // the lines of the view are packed
+    TEST_CHECK(container.Find("view.bin", entry) == true);
+    TEST_CHECK(_Equal(container.MapFrame(entry), view) == true);
+
+    // encoded by the thread
+    TEST_CHECK(container.Find("raw.bin", entry) == true);
+    TEST_CHECK(entry.eType == ChunkFileType_Raw12);
+
+    QByteArray encoded = container.Read(entry);
+    TEST_CHECK(_Equal(RawCodec::Decode(encoded.constData(), encoded.size()), raw) == true);
+
+    TEST_CHECK(container.Find("info.json", entry) == true);
+    TEST_CHECK((entry.eType == ChunkFileType_Json) && (container.Read(entry) == json));
+
+    TEST_CHECK(QFile::exists(dir.filePath("image.bin")) == false);
+
+    // the files after the capacity of the index are written on their own
+    for(int index = 0; index < extraCount; index ++)
+    {
+        QString name = QString("extra%1.bin").arg(index);
+        QByteArray data(index + 1, (char)index);
+
+        if(index < CHUNK_FILE_CAPACITY - (fileCount - extraCount))
+        {
+            TEST_CHECK(container.Find(name, entry) == true);
+            TEST_CHECK(container.Read(entry) == data);
+            TEST_CHECK(QFile::exists(dir.filePath(name)) == false);
+        }
+        else
+        {
+            TEST_CHECK(container.Find(name, entry) == false);
+            TEST_CHECK(_ReadFile(dir.filePath(name)) == data);
+        }
+    }
+
+    TEST_CHECK(container.Find("after.json", entry) == false);
+    TEST_CHECK(_ReadFile(dir.filePath("after.json")) == json);
+
+    return true;
+}
+
+// a container closed without a name, or left open when the writer stops, keeps its temporary name
+static bool _TestPartFile(const QDir& dir)
+{
+    QString closedPath  = dir.filePath("closed.part");
+    QString stoppedPath = dir.filePath("stopped.part");
+
+    QByteArray json("{}");
+
+    FileWriter::OpenContainer(closedPath, 0);
+    FileWriter::Write(dir.filePath("closed.json"), json, ChunkFileType_Json);
+    FileWriter::CloseContainer();
+
+    FileWriter::OpenContainer(stoppedPath, 0);
+    FileWriter::Write(dir.filePath("stopped.json"), json, ChunkFileType_Json);
+
+    QString error;
+
+    TEST_CHECK(FileWriter::Stop(error) == true);
+
+    const QString paths[][2] = {{closedPath, "closed.json"}, {stoppedPath, "stopped.json"}};
+
+    for(const auto& path : paths)
+    {
+        ChunkFile container;
+        ChunkFileEntry_t entry;
+
+        TEST_CHECK(container.Open(path[0]) == true);
+        TEST_CHECK(container.Find(path[1], entry) == true);
+        TEST_CHECK(container.Read(entry) == json);
+    }
+
+    // the thread is started again by the next file
+    FileWriter::Write(dir.filePath("restarted.json"), json, ChunkFileType_Json);
+
+    TEST_CHECK(FileWriter::Flush(error) == true);
+    TEST_CHECK(_ReadFile(dir.filePath("restarted.json")) == json);
+
+    return true;
+}
+
+bool TestFileWriter()
+{
+    QDir dir(QDir::temp().filePath("ConoscopeLibTest_FileWriter"));
+
+    dir.removeRecursively();
+
+    bool bSuccess = (_TestContainer(dir) == true) &&
+                    (_TestPartFile(dir) == true);
+
+    QString error;
+    FileWriter::Stop(error);
+
+    dir.removeRecursively();
+
+    return bSuccess;
+}
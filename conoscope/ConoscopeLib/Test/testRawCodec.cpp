@@ -0,0 +1,148 @@
+#include "test.h"
+
+#include "toolRawCodec.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <random>
+#include <string.h>
+
+typedef enum
+{
+    Pattern_Smooth,    // disc on a dark background (Rice bands)
+    Pattern_Noise,     // 12 bits noise (Packed12 bands)
+    Pattern_Overflow   // values above 12 bits (Raw16 bands)
+} Pattern_t;
+
+static FrameBuffer _Generate(int width, int height, Pattern_t ePattern, unsigned int seed)
+{
+    FrameBuffer frame(width, height);
+    std::mt19937 random(seed);
+
+    for(int line = 0; line < height; line ++)
+    {
+        uint16_t* pLine = frame.GetLine(line);
+
+        for(int index = 0; index < width; index ++)
+        {
+            float dx = (index - width / 2.0f) / (width / 2.0f + 1);
+            float dy = (line - height / 2.0f) / (height / 2.0f + 1);
+            float r2 = dx * dx + dy * dy;
+
+            switch(ePattern)
+            {
+            case Pattern_Smooth:
+                pLine[index] = (uint16_t)(40 + ((r2 < 1) ? 2000 * (1 - 0.6f * r2) : 0) + random() % 9);
+                break;
+
+            case Pattern_Noise:
+                pLine[index] = (uint16_t)(random() & 0xFFF);
+                break;
+
+            case Pattern_Overflow:
+                pLine[index] = (uint16_t)(random() & 0xFFFF);
+                break;
+            }
+        }
+    }
+
+    return frame;
+}
+
+static bool _Equal(const FrameBuffer& a, const FrameBuffer& b)
+{
+    if((a.IsNull() == true) || (b.IsNull() == true) ||
+       (a.GetWidth() != b.GetWidth()) || (a.GetHeight() != b.GetHeight()))
+    {
+        return false;
+    }
+
+    for(int line = 0; line < a.GetHeight(); line ++)
+    {
+        if(memcmp(a.GetLine(line), b.GetLine(line), a.GetWidth() * sizeof(uint16_t)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool _WriteFile(const QString& filePath, const char* pData, qint64 size)
+{
+    QFile file(filePath);
+
+    return (file.open(QIODevice::WriteOnly) == true) &&
+           (file.write(pData, size) == size);
+}
+
+// encode, write and read back with ReadFile
+static bool _RoundTrip(const FrameBuffer& frame, const QString& filePath, qint64& encodedSize)
+{
+    QByteArray encoded = RawCodec::Encode(frame);
+
+    encodedSize = encoded.size();
+
+    TEST_CHECK(encoded.isEmpty() == false);
+    TEST_CHECK(RawCodec::IsEncoded(encoded.constData(), encoded.size()) == true);
+    TEST_CHECK(_Equal(RawCodec::Decode(encoded.constData(), encoded.size()), frame) == true);
+
+    TEST_CHECK(_WriteFile(filePath, encoded.constData(), encoded.size()) == true);
+    TEST_CHECK(_Equal(RawCodec::ReadFile(filePath, 0), frame) == true);
+
+    // a truncated container is not decoded
+    TEST_CHECK(RawCodec::Decode(encoded.constData(), encoded.size() - 1).IsNull() == true);
+
+    return true;
+}
+
+bool TestRawCodec()
+{
+    QString filePath = QDir::temp().filePath("ConoscopeLibTest_RawCodec.bin");
+
+    const int sizes[][2] = {{1, 1}, {3, 5}, {17, 130}, {401, 67}, {640, 480}};
+    const Pattern_t patterns[] = {Pattern_Smooth, Pattern_Noise, Pattern_Overflow};
+
+    bool bOddLength  = false;
+    bool bEvenLength = false;
+
+    for(const auto& size : sizes)
+    {
+        for(Pattern_t ePattern : patterns)
+        {
+            // several seeds so both odd and even container lengths are read
+            for(unsigned int seed = 1; seed <= 4; seed ++)
+            {
+                FrameBuffer frame = _Generate(size[0], size[1], ePattern, seed);
+                qint64 encodedSize = 0;
+
+                if(_RoundTrip(frame, filePath, encodedSize) == false)
+                {
+                    fprintf(stderr, "%dx%d pattern %d seed %u (%lld bytes)\n", size[0], size[1], (int)ePattern, seed, encodedSize);
+                    QFile::remove(filePath);
+                    return false;
+                }
+
+                bOddLength  |= ((encodedSize % 2) == 1);
+                bEvenLength |= ((encodedSize % 2) == 0);
+            }
+        }
+    }
+
+    // a 16 bits file is still read as an image of the width given
+    FrameBuffer frame = _Generate(33, 7, Pattern_Overflow, 5);
+    QByteArray raw(frame.GetSize(), 0);
+    frame.CopyTo(raw.data());
+
+    bool bRaw16 = (_WriteFile(filePath, raw.constData(), raw.size()) == true) &&
+                  (_Equal(RawCodec::ReadFile(filePath, 33), frame) == true);
+
+    QFile::remove(filePath);
+
+    TEST_CHECK(bOddLength == true);
+    TEST_CHECK(bEvenLength == true);
+    TEST_CHECK(bRaw16 == true);
+
+    return true;
+}
@@ -0,0 +1,330 @@
+#include "toolChunkFile.h"
+
+#include <QtEndian>
+#include <QFileInfo>
+#include <QDir>
+
+#include <string.h>
+
+#define CHUNK_FILE_DATA_OFFSET ((CHUNK_FILE_HEADER_SIZE + CHUNK_FILE_CAPACITY * CHUNK_FILE_ENTRY_SIZE + CHUNK_FILE_ALIGNMENT - 1) / CHUNK_FILE_ALIGNMENT * CHUNK_FILE_ALIGNMENT)
+
+ChunkFile::ChunkFile()
+{
+    mWriting  = false;
+    mDataEnd  = 0;
+    mReserved = 0;
+}
+
+ChunkFile::~ChunkFile()
+{
+    if(mWriting == true)
+    {
+        Close();
+    }
+}
+
+bool ChunkFile::Create(const QString& filePath, qint64 reserveBytes)
+{
+    if(mFile.isOpen() == true)
+    {
+        return false;
+    }
+
+    QString path = QFileInfo(filePath).absolutePath();
+
+    // create dir if it does not exists
+    QDir dir(path);
+    if (!dir.exists())
+    {
+        dir.mkpath(path);
+    }
+
+    mFilePath = filePath;
+    mFile.setFileName(filePath);
+
+    // the chunks are already in large blocks, they do not go through the buffer of QFile
+    if(mFile.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Unbuffered) == false)
+    {
+        return false;
+    }
+
+    mEntries.clear();
+    mDataEnd  = CHUNK_FILE_DATA_OFFSET;
+    mReserved = CHUNK_FILE_DATA_OFFSET + reserveBytes;
+
+    // the space is allocated once instead of each time the file grows
+    // (the header stays null until the file is closed so an incomplete file is not recognised)
+    mFile.resize(mReserved);
+
+    mWriting = true;
+
+    return true;
+}
+
+bool ChunkFile::IsCreated() const
+{
+    return mWriting;
+}
+
+QFile* ChunkFile::BeginChunk(const QString& name, ChunkFileType_t eType, int width, int height)
+{
+    if(mWriting == false)
+    {
+        return NULL;
+    }
+
+    // the chunk replaces the previous one with the same name (its space is not reused)
+    for(int index = 0; index < mEntries.count(); index ++)
+    {
+        if(mEntries[index].name == name)
+        {
+            mEntries.removeAt(index);
+            break;
+        }
+    }
+
+    if((mEntries.count() >= CHUNK_FILE_CAPACITY) ||
+       (name.toUtf8().size() >= CHUNK_FILE_NAME_SIZE))
+    {
+        return NULL;
+    }
+
+    mChunk.name   = name;
+    mChunk.eType  = eType;
+    mChunk.width  = width;
+    mChunk.height = height;
+    mChunk.offset = _Align(mDataEnd);
+    mChunk.size   = 0;
+
+    if(mFile.seek(mChunk.offset) == false)
+    {
+        return NULL;
+    }
+
+    return &mFile;
+}
+
+bool ChunkFile::EndChunk()
+{
+    if(mWriting == false)
+    {
+        return false;
+    }
+
+    mChunk.size = mFile.pos() - mChunk.offset;
+
+    mEntries.append(mChunk);
+    mDataEnd = mChunk.offset + mChunk.size;
+
+    return true;
+}
+
+bool ChunkFile::Close(const QString& filePath)
+{
+    if(mWriting == false)
+    {
+        return false;
+    }
+
+    mWriting = false;
+
+    QByteArray index = _EncodeIndex();
+
+    bool bSuccess = (mFile.seek(0) == true) &&
+                    (mFile.write(index) == index.size());
+
+    // the part of the reservation which is not used is released
+    if(mDataEnd != mReserved)
+    {
+        bSuccess &= mFile.resize(mDataEnd);
+    }
+
+    mFile.close();
+
+    if((bSuccess == true) &&
+       (filePath.isEmpty() == false) &&
+       (filePath != mFilePath))
+    {
+        QFile::remove(filePath);
+        bSuccess = QFile::rename(mFilePath, filePath);
+
+        if(bSuccess == true)
+        {
+            mFilePath = filePath;
+        }
+    }
+
+    return bSuccess;
+}
+
+bool ChunkFile::Open(const QString& filePath)
+{
+    if(mFile.isOpen() == true)
+    {
+        return false;
+    }
+
+    mFilePath = filePath;
+    mFile.setFileName(filePath);
+
+    if(mFile.open(QIODevice::ReadOnly) == false)
+    {
+        return false;
+    }
+
+    qint64 size = qMin(mFile.size(), (qint64)CHUNK_FILE_DATA_OFFSET);
+
+    uchar* pMap = (size >= CHUNK_FILE_HEADER_SIZE) ? mFile.map(0, size) : NULL;
+
+    bool bSuccess = (pMap != NULL) && (_DecodeIndex(pMap, size) == true);
+
+    if(pMap != NULL)
+    {
+        mFile.unmap(pMap);
+    }
+
+    if(bSuccess == false)
+    {
+        mFile.close();
+    }
+
+    return bSuccess;
+}
+
+QList<ChunkFileEntry_t> ChunkFile::GetEntries() const
+{
+    return mEntries;
+}
+
+bool ChunkFile::Find(const QString& name, ChunkFileEntry_t& entry) const
+{
+    for(int index = 0; index < mEntries.count(); index ++)
+    {
+        if(mEntries[index].name == name)
+        {
+            entry = mEntries[index];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QByteArray ChunkFile::Read(const ChunkFileEntry_t& entry) const
+{
+    QFile file(mFilePath);
+    QByteArray data;
+
+    if((file.open(QIODevice::ReadOnly) == true) &&
+       (file.seek(entry.offset) == true))
+    {
+        data = file.read(entry.size);
+    }
+
+    return data;
+}
+
+FrameBuffer ChunkFile::MapFrame(const ChunkFileEntry_t& entry) const
+{
+    if((entry.eType != ChunkFileType_Pixel16) ||
+       ((qint64)entry.width * entry.height * (qint64)sizeof(uint16_t) > entry.size))
+    {
+        return FrameBuffer();
+    }
+
+    return FrameBuffer::MapFile(mFilePath, entry.width, entry.offset, entry.height);
+}
+
+bool ChunkFile::IsChunkFile(const QString& filePath)
+{
+    QFile file(filePath);
+    uint32_t magic = 0;
+
+    if((file.open(QIODevice::ReadOnly) == true) &&
+       (file.read((char*)&magic, sizeof(magic)) == sizeof(magic)))
+    {
+        return (qFromLittleEndian(magic) == CHUNK_FILE_MAGIC);
+    }
+
+    return false;
+}
+
+qint64 ChunkFile::_Align(qint64 offset)
+{
+    return (offset + CHUNK_FILE_ALIGNMENT - 1) / CHUNK_FILE_ALIGNMENT * CHUNK_FILE_ALIGNMENT;
+}
+
+QByteArray ChunkFile::_EncodeIndex() const
+{
+    QByteArray index(CHUNK_FILE_DATA_OFFSET, 0);
+    uchar* pData = (uchar*)index.data();
+
+    qToLittleEndian<uint32_t>(CHUNK_FILE_MAGIC,            &pData[0]);
+    qToLittleEndian<uint16_t>(CHUNK_FILE_VERSION,          &pData[4]);
+    qToLittleEndian<uint16_t>(CHUNK_FILE_ENTRY_SIZE,       &pData[6]);
+    qToLittleEndian<uint32_t>(CHUNK_FILE_CAPACITY,         &pData[8]);
+    qToLittleEndian<uint32_t>((uint32_t)mEntries.count(),  &pData[12]);
+    qToLittleEndian<uint64_t>(CHUNK_FILE_DATA_OFFSET,      &pData[16]);
+    qToLittleEndian<uint64_t>((uint64_t)mDataEnd,          &pData[24]);
+
+    for(int index = 0; index < mEntries.count(); index ++)
+    {
+        const ChunkFileEntry_t& entry = mEntries[index];
+        uchar* pEntry = &pData[CHUNK_FILE_HEADER_SIZE + index * CHUNK_FILE_ENTRY_SIZE];
+
+        QByteArray name = entry.name.toUtf8();
+        memcpy(pEntry, name.constData(), name.size());
+
+        qToLittleEndian<uint32_t>((uint32_t)entry.eType,  &pEntry[128]);
+        qToLittleEndian<uint32_t>((uint32_t)entry.width,  &pEntry[132]);
+        qToLittleEndian<uint32_t>((uint32_t)entry.height, &pEntry[136]);
+        qToLittleEndian<uint64_t>((uint64_t)entry.offset, &pEntry[144]);
+        qToLittleEndian<uint64_t>((uint64_t)entry.size,   &pEntry[152]);
+    }
+
+    return index;
+}
+
+bool ChunkFile::_DecodeIndex(const uchar* pData, qint64 size)
+{
+    mEntries.clear();
+
+    if((qFromLittleEndian<uint32_t>(&pData[0]) != CHUNK_FILE_MAGIC) ||
+       (qFromLittleEndian<uint16_t>(&pData[4]) != CHUNK_FILE_VERSION) ||
+       (qFromLittleEndian<uint16_t>(&pData[6]) != CHUNK_FILE_ENTRY_SIZE))
+    {
+        return false;
+    }
+
+    qint64 count = qFromLittleEndian<uint32_t>(&pData[12]);
+
+    mDataEnd = (qint64)qFromLittleEndian<uint64_t>(&pData[24]);
+
+    if(CHUNK_FILE_HEADER_SIZE + count * CHUNK_FILE_ENTRY_SIZE > size)
+    {
+        return false;
+    }
+
+    for(int index = 0; index < count; index ++)
+    {
+        const uchar* pEntry = &pData[CHUNK_FILE_HEADER_SIZE + index * CHUNK_FILE_ENTRY_SIZE];
+        ChunkFileEntry_t entry;
+
+        entry.name   = QString::fromUtf8((const char*)pEntry, qstrnlen((const char*)pEntry, CHUNK_FILE_NAME_SIZE));
+        entry.eType  = (ChunkFileType_t)qFromLittleEndian<uint32_t>(&pEntry[128]);
+        entry.width  = (int)qFromLittleEndian<uint32_t>(&pEntry[132]);
+        entry.height = (int)qFromLittleEndian<uint32_t>(&pEntry[136]);
+        entry.offset = (qint64)qFromLittleEndian<uint64_t>(&pEntry[144]);
+        entry.size   = (qint64)qFromLittleEndian<uint64_t>(&pEntry[152]);
+
+        if((entry.offset < 0) || (entry.size < 0) || (entry.offset + entry.size > mFile.size()))
+        {
+            mEntries.clear();
+            return false;
+        }
+
+        mEntries.append(entry);
+    }
+
+    return true;
+}
@@ -0,0 +1,118 @@
+#ifndef TOOL_CHUNK_FILE_H
+#define TOOL_CHUNK_FILE_H
+
+#include "toolFrameBuffer.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <QList>
+
+#include <stdint.h>
+
+// "CHNK"
+#define CHUNK_FILE_MAGIC   0x4B4E4843
+#define CHUNK_FILE_VERSION 1
+
+#define CHUNK_FILE_HEADER_SIZE 32
+#define CHUNK_FILE_ENTRY_SIZE  160
+#define CHUNK_FILE_NAME_SIZE   128
+
+// entries of the index (the index is reserved when the file is created)
+#define CHUNK_FILE_CAPACITY 64
+
+// offset of the chunks in the file (a chunk can be mapped on its own)
+#define CHUNK_FILE_ALIGNMENT 4096
+
+typedef enum
+{
+    ChunkFileType_Bytes,   // not typed
+    ChunkFileType_Pixel16, // 16 bits pixels (raw or processed image)
+    ChunkFileType_Raw12,   // lossless 12 bits container (RawCodec)
+    ChunkFileType_Float32, // float plane (XYZ components)
+    ChunkFileType_Int32,   // int array (exposure times)
+    ChunkFileType_Json,    // meta data
+    ChunkFileType_Jpg      // preview
+} ChunkFileType_t;
+
+typedef struct
+{
+    QString         name;
+    ChunkFileType_t eType;
+    int             width;  // elements of a line (0 when not an array)
+    int             height; // lines
+    qint64          offset; // from the beginning of the file
+    qint64          size;   // bytes
+} ChunkFileEntry_t;
+
+/* Class ChunkFile
+ * several files stored in a single one
+ *
+ * layout (little endian)
+ *   header   magic, version (16 bits), entry size (16 bits), capacity,
+ *            entry count, data offset (64 bits), data end (64 bits)    32 bytes
+ *   index    name (128 bytes utf8), type, width, height, reserved,
+ *            offset (64 bits), size (64 bits)                         160 bytes per entry
+ *   chunks   CHUNK_FILE_ALIGNMENT aligned
+ *
+ * the writer preallocates the file and appends the chunks one after the other,
+ * the index is written and the file is cut to its size when it is closed.
+ * A chunk with the name of a previous one replaces it.
+ * The reader maps the index, an image chunk is returned as a mapped frame.
+ */
+class ChunkFile
+{
+public:
+    ChunkFile();
+    ~ChunkFile();
+
+    // writer
+
+    // the file is preallocated to reserveBytes of chunks
+    bool Create(const QString& filePath, qint64 reserveBytes);
+
+    bool IsCreated() const;
+
+    // the data of the chunk is written in the file returned
+    QFile* BeginChunk(const QString& name, ChunkFileType_t eType, int width, int height);
+
+    bool EndChunk();
+
+    // write the index, the file is renamed when a path is given
+    bool Close(const QString& filePath = QString());
+
+    // reader
+
+    bool Open(const QString& filePath);
+
+    QList<ChunkFileEntry_t> GetEntries() const;
+
+    bool Find(const QString& name, ChunkFileEntry_t& entry) const;
+
+    QByteArray Read(const ChunkFileEntry_t& entry) const;
+
+    // mapped image of a ChunkFileType_Pixel16 chunk
+    FrameBuffer MapFrame(const ChunkFileEntry_t& entry) const;
+
+    static bool IsChunkFile(const QString& filePath);
+
+private:
+    QString mFilePath;
+    QFile   mFile;
+    bool    mWriting;
+
+    QList<ChunkFileEntry_t> mEntries;
+
+    qint64 mDataEnd;
+    qint64 mReserved;
+
+    ChunkFileEntry_t mChunk; // chunk being written
+
+    static qint64 _Align(qint64 offset);
+
+    QByteArray _EncodeIndex() const;
+
+    bool _DecodeIndex(const uchar* pData, qint64 size);
+};
+
+#endif // TOOL_CHUNK_FILE_H
@@ -0,0 +1,410 @@
+#include "toolFileWriter.h"
+#include "toolRawCodec.h"
+
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QDir>
+
+#include <algorithm>
+#include <string.h>
+
+FileWriter* FileWriter::mInstance = NULL;
+QMutex      FileWriter::mInstanceMutex;
+
+FileWriter* FileWriter::Instance()
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    if(mInstance == NULL)
+    {
+        mInstance = new FileWriter();
+    }
+
+    // started again after Stop
+    if(mInstance->isRunning() == false)
+    {
+        mInstance->mStopRequest = false;
+        mInstance->start();
+    }
+
+    return mInstance;
+}
+
+FileWriter::FileWriter() : QThread()
+{
+    mQueueBytes  = 0;
+    mBusy        = false;
+    mStopRequest = false;
+}
+
+void FileWriter::Write(const QString& filePath, const FrameBuffer& frame, FileWriterEncoding_t eEncoding)
+{
+    FileWriterJob_t job;
+
+    job.eJob      = FileWriterJob_File;
+    job.filePath  = filePath;
+    job.frame     = frame;
+    job.eEncoding = eEncoding;
+    job.eType     = (eEncoding == FileWriterEncoding_Raw12) ? ChunkFileType_Raw12 : ChunkFileType_Pixel16;
+    job.width     = frame.GetWidth();
+    job.height    = frame.GetHeight();
+    job.reserveBytes = 0;
+
+    Instance()->_Enqueue(job, frame.GetSize());
+}
+
+void FileWriter::Write(const QString& filePath, const QByteArray& data, ChunkFileType_t eType, int width, int height)
+{
+    FileWriterJob_t job;
+
+    job.eJob      = FileWriterJob_File;
+    job.filePath  = filePath;
+    job.data      = data;
+    job.eEncoding = FileWriterEncoding_None;
+    job.eType     = eType;
+    job.width     = width;
+    job.height    = height;
+    job.reserveBytes = 0;
+
+    Instance()->_Enqueue(job, data.size());
+}
+
+void FileWriter::Write(const QString& filePath, const QImage& image)
+{
+    FileWriterJob_t job;
+
+    job.eJob      = FileWriterJob_File;
+    job.filePath  = filePath;
+    job.image     = image;
+    job.eEncoding = FileWriterEncoding_None;
+    job.eType     = ChunkFileType_Jpg;
+    job.width     = image.width();
+    job.height    = image.height();
+    job.reserveBytes = 0;
+
+    Instance()->_Enqueue(job, image.sizeInBytes());
+}
+
+void FileWriter::OpenContainer(const QString& filePath, qint64 reserveBytes)
+{
+    FileWriterJob_t job;
+
+    job.eJob      = FileWriterJob_OpenContainer;
+    job.filePath  = filePath;
+    job.eEncoding = FileWriterEncoding_None;
+    job.eType     = ChunkFileType_Bytes;
+    job.width     = 0;
+    job.height    = 0;
+    job.reserveBytes = reserveBytes;
+
+    Instance()->_Enqueue(job, 0);
+}
+
+void FileWriter::CloseContainer(const QString& filePath)
+{
+    FileWriterJob_t job;
+
+    job.eJob      = FileWriterJob_CloseContainer;
+    job.filePath  = filePath;
+    job.eEncoding = FileWriterEncoding_None;
+    job.eType     = ChunkFileType_Bytes;
+    job.width     = 0;
+    job.height    = 0;
+    job.reserveBytes = 0;
+
+    Instance()->_Enqueue(job, 0);
+}
+
+void FileWriter::Wait()
+{
+    FileWriter* writer = Instance();
+
+    QMutexLocker locker(&writer->mQueueMutex);
+
+    while((writer->mQueue.isEmpty() == false) || (writer->mBusy == true))
+    {
+        writer->mDoneCondition.wait(&writer->mQueueMutex);
+    }
+}
+
+bool FileWriter::Flush(QString& error)
+{
+    FileWriter* writer = Instance();
+
+    Wait();
+
+    QMutexLocker locker(&writer->mQueueMutex);
+
+    error = writer->mFirstError;
+    writer->mFirstError.clear();
+
+    return error.isEmpty();
+}
+
+bool FileWriter::Stop(QString& error)
+{
+    QMutexLocker locker(&mInstanceMutex);
+
+    error.clear();
+
+    if((mInstance == NULL) || (mInstance->isRunning() == false))
+    {
+        return true;
+    }
+
+    FileWriter* writer = mInstance;
+
+    {
+        QMutexLocker queueLocker(&writer->mQueueMutex);
+
+        // the files already queued are written before the thread ends
+        writer->mStopRequest = true;
+        writer->mQueueCondition.wakeAll();
+    }
+
+    writer->wait();
+
+    QMutexLocker queueLocker(&writer->mQueueMutex);
+
+    // a container left open is closed with its temporary name
+    if(writer->mContainer.IsCreated() == true)
+    {
+        writer->mContainer.Close();
+    }
+
+    error = writer->mFirstError;
+    writer->mFirstError.clear();
+
+    return error.isEmpty();
+}
+
+int FileWriter::Pending()
+{
+    FileWriter* writer = Instance();
+
+    QMutexLocker locker(&writer->mQueueMutex);
+
+    return writer->mQueue.count() + ((writer->mBusy == true) ? 1 : 0);
+}
+
+void FileWriter::_Enqueue(const FileWriterJob_t& job, qint64 size)
+{
+    QMutexLocker locker(&mQueueMutex);
+
+    // the disk does not follow, wait (a file bigger than the limit is accepted when the queue is empty)
+    while((mQueue.isEmpty() == false) &&
+          (mQueueBytes + size > FILE_WRITER_QUEUE_MAX_BYTES))
+    {
+        mDoneCondition.wait(&mQueueMutex);
+    }
+
+    mQueue.enqueue(job);
+    mQueueBytes += size;
+
+    mQueueCondition.wakeAll();
+}
+
+void FileWriter::run()
+{
+    mChunk.resize(FILE_WRITER_CHUNK_BYTES);
+
+    forever
+    {
+        mQueueMutex.lock();
+
+        while((mQueue.isEmpty() == true) && (mStopRequest == false))
+        {
+            mQueueCondition.wait(&mQueueMutex);
+        }
+
+        if(mQueue.isEmpty() == true)
+        {
+            // stop requested and everything is written
+            mQueueMutex.unlock();
+            break;
+        }
+
+        FileWriterJob_t job = mQueue.dequeue();
+        mBusy = true;
+
+        mQueueMutex.unlock();
+
+        QString error;
+        bool bSuccess = _WriteJob(job, error);
+
+        qint64 size = (job.frame.IsNull() == false) ? job.frame.GetSize() :
+                      (job.image.isNull() == false) ? job.image.sizeInBytes() : job.data.size();
+
+        // the frame goes back to the pool before the writers are woken up
+        job.frame.Release();
+        job.image = QImage();
+
+        mQueueMutex.lock();
+
+        mQueueBytes -= size;
+        mBusy = false;
+
+        if((bSuccess == false) && (mFirstError.isEmpty() == true))
+        {
+            mFirstError = error;
+        }
+
+        mDoneCondition.wakeAll();
+        mQueueMutex.unlock();
+
+        emit Written(job.filePath, bSuccess);
+    }
+}
+
+bool FileWriter::_WriteJob(const FileWriterJob_t& job, QString& error)
+{
+    if(job.eJob == FileWriterJob_OpenContainer)
+    {
+        if(mContainer.IsCreated() == true)
+        {
+            mContainer.Close();
+        }
+
+        if(mContainer.Create(job.filePath, job.reserveBytes) == false)
+        {
+            error = QString("Failed to open file: %1").arg(job.filePath);
+            return false;
+        }
+
+        return true;
+    }
+
+    if(job.eJob == FileWriterJob_CloseContainer)
+    {
+        // nothing to do when the container could not be created
+        if((mContainer.IsCreated() == true) &&
+           (mContainer.Close(job.filePath) == false))
+        {
+            error = QString("Error writing file: %1").arg(job.filePath);
+            return false;
+        }
+
+        return true;
+    }
+
+    if(mContainer.IsCreated() == true)
+    {
+        QFile* pFile = mContainer.BeginChunk(QFileInfo(job.filePath).fileName(), job.eType, job.width, job.height);
+
+        // a file which does not fit in the index of the container is written on its own
+        if(pFile != NULL)
+        {
+            return _WriteChunk(*pFile, job, error);
+        }
+    }
+
+    QString path = QFileInfo(job.filePath).absolutePath();
+
+    // create dir if it does not exists
+    QDir dir(path);
+    if (!dir.exists())
+    {
+        dir.mkpath(path);
+    }
+
+    QFile file(job.filePath);
+
+    // the data is already in large blocks, it does not go through the buffer of QFile
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered) == false)
+    {
+        error = QString("Failed to open file: %1").arg(job.filePath);
+        return false;
+    }
+
+    bool bSuccess = _WriteContent(file, job);
+
+    file.close();
+
+    if(bSuccess == false)
+    {
+        error = QString("Error writing file: %1").arg(job.filePath);
+    }
+
+    return bSuccess;
+}
+
+bool FileWriter::_WriteChunk(QFile& file, const FileWriterJob_t& job, QString& error)
+{
+    bool bSuccess = (_WriteContent(file, job) == true) &&
+                    (mContainer.EndChunk() == true);
+
+    if(bSuccess == false)
+    {
+        error = QString("Error writing %1 in file: %2").arg(QFileInfo(job.filePath).fileName()).arg(file.fileName());
+    }
+
+    return bSuccess;
+}
+
+bool FileWriter::_WriteContent(QFile& file, const FileWriterJob_t& job)
+{
+    bool bSuccess = true;
+
+    if(job.image.isNull() == false)
+    {
+        bSuccess = job.image.save(&file, "JPG");
+    }
+    else if(job.frame.IsNull() == true)
+    {
+        bSuccess = _WriteData(file, job.data.constData(), job.data.size());
+    }
+    else if(job.eEncoding == FileWriterEncoding_Raw12)
+    {
+        QByteArray data = RawCodec::Encode(job.frame);
+
+        bSuccess = _WriteData(file, data.constData(), data.size());
+    }
+    else if(job.frame.IsContiguous() == true)
+    {
+        bSuccess = _WriteData(file, (const char*)job.frame.GetData(), job.frame.GetSize());
+    }
+    else
+    {
+        // the lines of the view are packed in the chunk
+        int lineBytes   = job.frame.GetWidth() * (int)sizeof(uint16_t);
+        int chunkLines  = std::max(FILE_WRITER_CHUNK_BYTES / std::max(lineBytes, 1), 1);
+
+        if((size_t)chunkLines * lineBytes > mChunk.size())
+        {
+            mChunk.resize((size_t)chunkLines * lineBytes);
+        }
+
+        for(int line = 0; (line < job.frame.GetHeight()) && (bSuccess == true); line += chunkLines)
+        {
+            int lineCount = std::min(chunkLines, job.frame.GetHeight() - line);
+
+            for(int index = 0; index < lineCount; index ++)
+            {
+                memcpy(&mChunk[(size_t)index * lineBytes], job.frame.GetLine(line + index), lineBytes);
+            }
+
+            bSuccess = _WriteData(file, mChunk.data(), (qint64)lineCount * lineBytes);
+        }
+    }
+
+    return bSuccess;
+}
+
+bool FileWriter::_WriteData(QFile& file, const char* pData, qint64 size)
+{
+    qint64 offset = 0;
+
+    while(offset < size)
+    {
+        qint64 written = file.write(&pData[offset], std::min(size - offset, (qint64)FILE_WRITER_CHUNK_BYTES));
+
+        if(written <= 0)
+        {
+            return false;
+        }
+
+        offset += written;
+    }
+
+    return true;
+}
@@ -0,0 +1,143 @@
+#ifndef TOOL_FILE_WRITER_H
+#define TOOL_FILE_WRITER_H
+
+#include "toolFrameBuffer.h"
+#include "toolChunkFile.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <QImage>
+
+#include <vector>
+
+// the writers wait while more than this is waiting to be written
+#define FILE_WRITER_QUEUE_MAX_BYTES (512 * 1024 * 1024)
+
+// size of the writes (multiple of the page size so the writes stay aligned in the file)
+#define FILE_WRITER_CHUNK_BYTES (8 * 1024 * 1024)
+
+typedef enum
+{
+    FileWriterEncoding_None,  // pixels written as they are
+    FileWriterEncoding_Raw12  // lossless 12 bits container (RawCodec)
+} FileWriterEncoding_t;
+
+typedef enum
+{
+    FileWriterJob_File,
+    FileWriterJob_OpenContainer,
+    FileWriterJob_CloseContainer
+} FileWriterJobType_t;
+
+typedef struct
+{
+    FileWriterJobType_t eJob;
+    QString     filePath;
+    FrameBuffer frame; // image (packed or view)
+    QByteArray  data;  // or bytes (sidecar files)
+    QImage      image; // or preview (encoded in jpg)
+    FileWriterEncoding_t eEncoding;
+    ChunkFileType_t eType; // type of the bytes in a container
+    int         width;
+    int         height;
+    qint64      reserveBytes; // size of the container
+} FileWriterJob_t;
+
+/* Class FileWriter
+ * write-behind of the exported files
+ *
+ * the files are written by a thread in the order they are queued, so a sidecar
+ * queued after its image is written after it. The queue keeps a reference on
+ * the frame, the caller can reuse its own buffers as soon as Write returns.
+ * Write waits when FILE_WRITER_QUEUE_MAX_BYTES are already waiting.
+ * Each file is written in FILE_WRITER_CHUNK_BYTES unbuffered writes, the lines
+ * of a view are packed in the chunk before being written. An image can also
+ * be encoded (RawCodec) by the thread instead of the caller, the previews are
+ * also encoded in jpg by the thread.
+ * Between OpenContainer and CloseContainer the files are written as the chunks
+ * of a single file (ChunkFile) named after their file name.
+ * Written is emitted (from the thread) for each file, Flush waits until
+ * everything is written and returns the first error since the previous Flush.
+ * The files are closed when they are written, they are not synchronised to the disk.
+ * Stop writes what is queued and ends the thread before the library is closed.
+ */
+class FileWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    static FileWriter* Instance();
+
+    // the image is encoded by the thread
+    static void Write(const QString& filePath, const FrameBuffer& frame, FileWriterEncoding_t eEncoding = FileWriterEncoding_None);
+
+    // the type and the size of the data are only used by the containers
+    static void Write(const QString& filePath, const QByteArray& data, ChunkFileType_t eType = ChunkFileType_Bytes, int width = 0, int height = 0);
+
+    // the files queued until CloseContainer are written in filePath (preallocated to reserveBytes)
+    static void OpenContainer(const QString& filePath, qint64 reserveBytes);
+
+    // the container is renamed when a path is given
+    static void CloseContainer(const QString& filePath = QString());
+
+    // the image is encoded in jpg by the thread
+    static void Write(const QString& filePath, const QImage& image);
+
+    // wait until the files queued are written (the errors are kept for Flush)
+    static void Wait();
+
+    // true when all the files queued since the previous flush are written
+    // error is the description of the first failure
+    static bool Flush(QString& error);
+
+    // files waiting to be written
+    static int Pending();
+
+    // write the files queued and end the thread (started again by the next file)
+    // same result as Flush
+    static bool Stop(QString& error);
+
+signals:
+    void Written(QString filePath, bool bSuccess);
+
+protected:
+    void run() override;
+
+private:
+    // created with the first file and kept until the library is unloaded
+    FileWriter();
+
+    static FileWriter* mInstance;
+    static QMutex      mInstanceMutex;
+
+    QMutex          mQueueMutex;
+    QWaitCondition  mQueueCondition; // something queued
+    QWaitCondition  mDoneCondition;  // something written
+    QQueue<FileWriterJob_t> mQueue;
+    qint64          mQueueBytes;
+    bool            mBusy;           // a job is being written
+    bool            mStopRequest;    // the thread ends once the queue is empty
+
+    QString mFirstError;
+
+    std::vector<char> mChunk;
+
+    ChunkFile mContainer;
+
+    void _Enqueue(const FileWriterJob_t& job, qint64 size);
+
+    bool _WriteJob(const FileWriterJob_t& job, QString& error);
+
+    bool _WriteChunk(QFile& file, const FileWriterJob_t& job, QString& error);
+
+    bool _WriteContent(QFile& file, const FileWriterJob_t& job);
+
+    bool _WriteData(QFile& file, const char* pData, qint64 size);
+};
+
+#endif // TOOL_FILE_WRITER_H
@@ -0,0 +1,269 @@
+#include "toolFrameBuffer.h"
+
+#include <QMutex>
+#include <QMultiMap>
+#include <QFile>
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// free blocks sorted by size
+static QMutex& _PoolMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+static QMultiMap<int, uint16_t*>& _Pool()
+{
+    static QMultiMap<int, uint16_t*> pool;
+    return pool;
+}
+
+FrameBuffer::FrameBuffer()
+{
+    mData   = NULL;
+    mWidth  = 0;
+    mHeight = 0;
+    mStride = 0;
+}
+
+FrameBuffer::FrameBuffer(int width, int height)
+{
+    mData   = NULL;
+    mWidth  = 0;
+    mHeight = 0;
+    mStride = 0;
+
+    if((width > 0) && (height > 0))
+    {
+        int size = width * height * (int)sizeof(uint16_t);
+
+        uint16_t* pBlock = _Allocate(size);
+
+        if(pBlock != NULL)
+        {
+            mBlock = QSharedPointer<uint16_t>(pBlock, [size](uint16_t* pFree) { _Free(pFree, size); });
+
+            mData   = pBlock;
+            mWidth  = width;
+            mHeight = height;
+            mStride = width;
+        }
+    }
+}
+
+FrameBuffer FrameBuffer::MapFile(const QString& filePath, int width, qint64 offset, int height)
+{
+    FrameBuffer view;
+
+    QFile* pFile = new QFile(filePath);
+
+    qint64 size = (pFile->open(QIODevice::ReadOnly) == true) ? pFile->size() - offset : 0;
+
+    if(width <= 0)
+    {
+        width = (int)(size / (qint64)sizeof(uint16_t));
+    }
+
+    int lineCount = (width > 0) ? (int)(size / ((qint64)width * (qint64)sizeof(uint16_t))) : 0;
+
+    height = ((height > 0) && (height < lineCount)) ? height : lineCount;
+
+    size = (qint64)width * height * (qint64)sizeof(uint16_t);
+
+    uchar* pMap = NULL;
+
+    if((size > 0) && ((offset % sizeof(uint16_t)) == 0))
+    {
+        pMap = pFile->map(offset, size, QFileDevice::MapPrivateOption);
+    }
+
+    if(pMap == NULL)
+    {
+        delete pFile;
+        return view;
+    }
+
+#ifdef __linux__
+    // the file is read once from the beginning to the end
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uchar* pPage  = (uchar*)((uintptr_t)pMap & ~(uintptr_t)(pageSize - 1));
+    size_t length = (size_t)(pMap - pPage) + (size_t)size;
+
+    madvise(pPage, length, MADV_SEQUENTIAL);
+    madvise(pPage, length, MADV_WILLNEED);
+#endif
+
+    // the file stays mapped while the view is used
+    view.mBlock  = QSharedPointer<uint16_t>((uint16_t*)pMap, [pFile, pMap](uint16_t*) { pFile->unmap(pMap); delete pFile; });
+    view.mData   = (uint16_t*)pMap;
+    view.mWidth  = width;
+    view.mHeight = height;
+    view.mStride = width;
+
+    return view;
+}
+
+bool FrameBuffer::IsNull() const
+{
+    return (mData == NULL);
+}
+
+bool FrameBuffer::IsContiguous() const
+{
+    return (mStride == mWidth) || (mHeight <= 1);
+}
+
+int FrameBuffer::GetWidth() const
+{
+    return mWidth;
+}
+
+int FrameBuffer::GetHeight() const
+{
+    return mHeight;
+}
+
+int FrameBuffer::GetStride() const
+{
+    return mStride;
+}
+
+int FrameBuffer::GetSize() const
+{
+    return mWidth * mHeight * (int)sizeof(uint16_t);
+}
+
+uint16_t* FrameBuffer::GetData() const
+{
+    return mData;
+}
+
+uint16_t* FrameBuffer::GetLine(int line) const
+{
+    return &mData[line * mStride];
+}
+
+FrameBuffer FrameBuffer::Crop(const QRect& area) const
+{
+    FrameBuffer view;
+
+    QRect cropArea = area.intersected(QRect(0, 0, mWidth, mHeight));
+
+    if((IsNull() == false) && (cropArea.isEmpty() == false))
+    {
+        view.mBlock  = mBlock;
+        view.mData   = &mData[cropArea.y() * mStride + cropArea.x()];
+        view.mWidth  = cropArea.width();
+        view.mHeight = cropArea.height();
+        view.mStride = mStride;
+    }
+
+    return view;
+}
+
+FrameBuffer FrameBuffer::Clone() const
+{
+    FrameBuffer copy(mWidth, mHeight);
+
+    if(copy.IsNull() == false)
+    {
+        CopyTo(copy.mData);
+    }
+
+    return copy;
+}
+
+void FrameBuffer::CopyTo(void* pDst) const
+{
+    if(IsNull() == true)
+    {
+        return;
+    }
+
+    if(IsContiguous() == true)
+    {
+        memcpy(pDst, mData, GetSize());
+    }
+    else
+    {
+        char* ptrDst = (char*)pDst;
+        int lineSize = mWidth * (int)sizeof(uint16_t);
+
+#pragma omp parallel for num_threads(4)
+        for(int lineIndex = 0; lineIndex < mHeight; lineIndex ++)
+        {
+            memcpy(&ptrDst[lineIndex * lineSize], GetLine(lineIndex), lineSize);
+        }
+    }
+}
+
+void FrameBuffer::Release()
+{
+    mBlock.clear();
+
+    mData   = NULL;
+    mWidth  = 0;
+    mHeight = 0;
+    mStride = 0;
+}
+
+uint16_t* FrameBuffer::_Allocate(int size)
+{
+    {
+        QMutexLocker locker(&_PoolMutex());
+
+        QMultiMap<int, uint16_t*>::iterator it = _Pool().find(size);
+
+        if(it != _Pool().end())
+        {
+            uint16_t* pBlock = it.value();
+            _Pool().erase(it);
+
+            return pBlock;
+        }
+    }
+
+    // the size is rounded up to the alignment
+    size_t allocSize = ((size + FRAME_BUFFER_ALIGNMENT - 1) / FRAME_BUFFER_ALIGNMENT) * FRAME_BUFFER_ALIGNMENT;
+
+#ifdef _WIN32
+    return (uint16_t*)_aligned_malloc(allocSize, FRAME_BUFFER_ALIGNMENT);
+#else
+    return (uint16_t*)aligned_alloc(FRAME_BUFFER_ALIGNMENT, allocSize);
+#endif
+}
+
+void FrameBuffer::_Free(uint16_t* pBlock, int size)
+{
+    {
+        QMutexLocker locker(&_PoolMutex());
+
+        // the last released block is kept, the smallest one is freed when the pool is full
+        _Pool().insert(size, pBlock);
+
+        if(_Pool().size() <= FRAME_BUFFER_POOL_SIZE)
+        {
+            return;
+        }
+
+        pBlock = _Pool().begin().value();
+        _Pool().erase(_Pool().begin());
+    }
+
+#ifdef _WIN32
+    _aligned_free(pBlock);
+#else
+    free(pBlock);
+#endif
+}
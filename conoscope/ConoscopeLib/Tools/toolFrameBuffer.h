@@ -0,0 +1,80 @@
+#ifndef TOOL_FRAME_BUFFER_H
+#define TOOL_FRAME_BUFFER_H
+
+#include <QSharedPointer>
+#include <QRect>
+#include <QString>
+
+#include <stdint.h>
+
+#define FRAME_BUFFER_ALIGNMENT 64  // bytes
+#define FRAME_BUFFER_POOL_SIZE 4   // free blocks kept for the next frames
+
+/* Class FrameBuffer
+ * reference counted 16 bits image
+ *
+ * the pixels are stored in a 64 bytes aligned block taken from a pool, the block
+ * goes back to the pool when the last FrameBuffer using it is released.
+ * Copying a FrameBuffer only copies the reference and Crop returns a view
+ * (offset and stride) on the same pixels, so the frame is not copied between
+ * the grabber and the export.
+ * MapFile returns a view on a file mapped in memory, the pixels are loaded from
+ * the file when they are accessed instead of being read and copied.
+ */
+class FrameBuffer
+{
+public:
+    FrameBuffer();
+
+    // allocate a packed image (the pixels are not initialised)
+    FrameBuffer(int width, int height);
+
+    // image of the 16 bits pixels of a file from offset (a single line if width is 0)
+    // up to height lines (0: up to the end of the file)
+    // the file is mapped copy on write: the pixels can be modified, the file is not
+    static FrameBuffer MapFile(const QString& filePath, int width, qint64 offset = 0, int height = 0);
+
+    bool IsNull() const;
+
+    // true when the lines follow each other in memory
+    bool IsContiguous() const;
+
+    int GetWidth() const;
+
+    int GetHeight() const;
+
+    // distance between 2 lines in pixels
+    int GetStride() const;
+
+    // size of the view in bytes once packed
+    int GetSize() const;
+
+    uint16_t* GetData() const;
+
+    uint16_t* GetLine(int line) const;
+
+    // view on a part of the image, the pixels are shared
+    FrameBuffer Crop(const QRect& area) const;
+
+    // packed copy of the view in a new block
+    FrameBuffer Clone() const;
+
+    // copy the view in a packed buffer of GetSize() bytes
+    void CopyTo(void* pDst) const;
+
+    void Release();
+
+private:
+    QSharedPointer<uint16_t> mBlock;
+
+    uint16_t* mData; // first pixel of the view
+    int mWidth;
+    int mHeight;
+    int mStride;
+
+    static uint16_t* _Allocate(int size);
+
+    static void _Free(uint16_t* pBlock, int size);
+};
+
+#endif // TOOL_FRAME_BUFFER_H
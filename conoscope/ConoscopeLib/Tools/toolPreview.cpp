@@ -0,0 +1,127 @@
+#include "toolPreview.h"
+
+#include <algorithm>
+#include <string.h>
+
+QImage Preview::Convert(const uint16_t* pData, int width, int height, int stride, bool bSigned, int scale)
+{
+    scale = std::max(scale, 1);
+
+    // distance between 2 lines (view on a frame buffer)
+    if(stride == 0)
+    {
+        stride = width;
+    }
+
+    int outputWidth  = width  / scale;
+    int outputHeight = height / scale;
+
+    if((pData == NULL) || (outputWidth <= 0) || (outputHeight <= 0))
+    {
+        return QImage();
+    }
+
+    QImage image(outputWidth, outputHeight, QImage::Format_RGBX8888);
+
+    if(image.isNull() == true)
+    {
+        return image;
+    }
+
+    int tileCount = (outputHeight + PREVIEW_TILE_HEIGHT - 1) / PREVIEW_TILE_HEIGHT;
+
+    // the image is detached once, the threads only write their lines
+    uchar* pImage    = image.bits();
+    int bytesPerLine = image.bytesPerLine();
+
+    // the palette is built before the threads use it
+    _Palette();
+
+#pragma omp parallel for num_threads(4)
+    for(int tile = 0; tile < tileCount; tile ++)
+    {
+        int firstLine = tile * PREVIEW_TILE_HEIGHT;
+        int lineCount = std::min(PREVIEW_TILE_HEIGHT, outputHeight - firstLine);
+
+        if(bSigned == true)
+        {
+            _ConvertTile<int16_t>((const int16_t*)pData, outputWidth, stride, scale, firstLine, lineCount, pImage, bytesPerLine);
+        }
+        else
+        {
+            _ConvertTile<uint16_t>(pData, outputWidth, stride, scale, firstLine, lineCount, pImage, bytesPerLine);
+        }
+    }
+
+    return image;
+}
+
+QImage Preview::Convert(const FrameBuffer& frame, bool bSigned, int scale)
+{
+    return Convert(frame.GetData(), frame.GetWidth(), frame.GetHeight(), frame.GetStride(), bSigned, scale);
+}
+
+const uint32_t* Preview::_Palette()
+{
+    static uint32_t palette[PREVIEW_LEVELS];
+    static bool bReady = [] ()
+    {
+        // grey level of the 8 most significant bits
+        for(int value = 0; value < PREVIEW_LEVELS; value ++)
+        {
+            uchar grey = (uchar)(value >> 4);
+            uchar color[4] = {grey, grey, grey, 0xFF};
+
+            memcpy(&palette[value], color, sizeof(color));
+        }
+
+        return true;
+    } ();
+
+    Q_UNUSED(bReady);
+
+    return palette;
+}
+
+template<typename T>
+void Preview::_ConvertTile(const T* pData, int width, int stride, int scale, int firstLine, int lineCount, uchar* pImage, int bytesPerLine)
+{
+    const uint32_t* pPalette = _Palette();
+
+    int blockSize = scale * scale;
+
+    for(int line = firstLine; line < firstLine + lineCount; line ++)
+    {
+        uint32_t* pOutput = (uint32_t*)&pImage[(size_t)line * bytesPerLine];
+        const T*  pInput  = &pData[(size_t)line * scale * stride];
+
+        if(scale == 1)
+        {
+            for(int index = 0; index < width; index ++)
+            {
+                int value = std::min(std::max((int)pInput[index], 0), PREVIEW_LEVELS - 1);
+
+                pOutput[index] = pPalette[value];
+            }
+        }
+        else
+        {
+            for(int index = 0; index < width; index ++)
+            {
+                int sum = 0;
+
+                for(int blockLine = 0; blockLine < scale; blockLine ++)
+                {
+                    const T* pBlock = &pInput[(size_t)blockLine * stride + (size_t)index * scale];
+
+                    for(int blockIndex = 0; blockIndex < scale; blockIndex ++)
+                    {
+                        sum += std::min(std::max((int)pBlock[blockIndex], 0), PREVIEW_LEVELS - 1);
+                    }
+                }
+
+                pOutput[index] = pPalette[sum / blockSize];
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TOOL_PREVIEW_H
+#define TOOL_PREVIEW_H
+
+#include "toolFrameBuffer.h"
+
+#include <QImage>
+
+#include <stdint.h>
+
+// values of the palette (the sensor is 12 bits)
+#define PREVIEW_LEVELS 4096
+
+// lines converted by a thread at a time
+#define PREVIEW_TILE_HEIGHT 64
+
+/* Class Preview
+ * 8 bits image of the 12 bits pixels (jpg export)
+ *
+ * the pixels are clamped to 12 bits and converted through a palette of
+ * PREVIEW_LEVELS RGBX colors computed once, the image is converted by tiles
+ * of PREVIEW_TILE_HEIGHT lines in parallel. A thumbnail is the palette color
+ * of the mean of scale x scale pixels.
+ * The image is not encoded, it is given to the FileWriter.
+ */
+class Preview
+{
+public:
+    // bSigned: the pixels are int16 (processed data), the negative values are black
+    // scale:   1 pixel of the image for scale x scale pixels
+    static QImage Convert(const uint16_t* pData, int width, int height, int stride, bool bSigned, int scale = 1);
+
+    static QImage Convert(const FrameBuffer& frame, bool bSigned, int scale = 1);
+
+private:
+    static const uint32_t* _Palette();
+
+    template<typename T>
+    static void _ConvertTile(const T* pData, int width, int stride, int scale, int firstLine, int lineCount, uchar* pImage, int bytesPerLine);
+};
+
+#endif // TOOL_PREVIEW_H
@@ -0,0 +1,643 @@
+#include "toolRawCodec.h"
+
+#include <QtEndian>
+#include <QFile>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#define RAW_CODEC_HEADER_SIZE     32
+#define RAW_CODEC_BAND_ENTRY_SIZE 16
+
+#define RAW_CODEC_MAX_VALUE  ((1 << RAW_CODEC_BITS) - 1)
+#define RAW_CODEC_HALF_RANGE (1 << (RAW_CODEC_BITS - 1))
+
+// the residuals are coded as is when the unary part reaches this length
+#define RAW_CODEC_RICE_LIMIT 24
+
+// the statistics of the residuals are halved after this number of pixels
+#define RAW_CODEC_RICE_RESET 64
+
+// bits written from the most significant bit of each byte
+class _BitWriter
+{
+public:
+    // pData must have 8 bytes more than the data written
+    _BitWriter(uint8_t* pData)
+    {
+        mData = pData;
+        mPosition = 0;
+        mAccumulator = 0;
+        mCount = 0;
+    }
+
+    // bits <= 32
+    inline void Write(uint32_t value, int bits)
+    {
+        mAccumulator = (mAccumulator << bits) | value;
+        mCount += bits;
+
+        if(mCount >= 32)
+        {
+            mCount -= 32;
+            qToBigEndian<quint32>((quint32)(mAccumulator >> mCount), &mData[mPosition]);
+            mPosition += 4;
+        }
+    }
+
+    // size of the data written
+    size_t Flush()
+    {
+        while(mCount > 0)
+        {
+            int bits = std::min(mCount, 8);
+
+            mData[mPosition ++] = (uint8_t)((mAccumulator >> (mCount - bits)) << (8 - bits));
+            mCount -= bits;
+        }
+
+        return mPosition;
+    }
+
+    size_t GetSize() const
+    {
+        return mPosition + (size_t)((mCount + 7) / 8);
+    }
+
+private:
+    uint8_t* mData;
+    size_t   mPosition;
+    uint64_t mAccumulator;
+    int      mCount;
+};
+
+class _BitReader
+{
+public:
+    _BitReader(const uint8_t* pData, size_t size)
+    {
+        mData = pData;
+        mSize = size;
+        mPosition = 0;
+        mAccumulator = 0;
+        mCount = 0;
+    }
+
+    // number of ones before a zero (the zero is read), limit when the limit is reached (limit <= 32)
+    inline int ReadUnary(int limit)
+    {
+        _Refill();
+
+        quint32 window = (quint32)(mAccumulator >> (mCount - 32));
+        int ones = qCountLeadingZeroBits((quint32)~window);
+
+        if(ones >= limit)
+        {
+            mCount -= limit;
+            return limit;
+        }
+
+        mCount -= ones + 1;
+        return ones;
+    }
+
+    // bits <= 32
+    inline uint32_t Read(int bits)
+    {
+        _Refill();
+
+        mCount -= bits;
+
+        return (uint32_t)((mAccumulator >> mCount) & ((1ULL << bits) - 1));
+    }
+
+    // false when more bits than the size of the data have been read
+    bool IsValid() const
+    {
+        return (mPosition <= mSize) || ((mPosition - mSize) * 8 <= (size_t)mCount);
+    }
+
+private:
+    const uint8_t* mData;
+    size_t   mSize;
+    size_t   mPosition;
+    uint64_t mAccumulator;
+    int      mCount;
+
+    // at least 32 bits in the accumulator
+    inline void _Refill()
+    {
+        while(mCount <= 56)
+        {
+            mAccumulator = (mAccumulator << 8) | ((mPosition < mSize) ? mData[mPosition] : 0);
+            mPosition ++;
+            mCount += 8;
+        }
+    }
+};
+
+// median edge detector (left, above, above left)
+static inline int _Predict(const uint16_t* pLine, const uint16_t* pAbove, int colIndex)
+{
+    if(pAbove == NULL)
+    {
+        return (colIndex > 0) ? pLine[colIndex - 1] : 0;
+    }
+
+    if(colIndex == 0)
+    {
+        return pAbove[0];
+    }
+
+    int a = pLine[colIndex - 1];
+    int b = pAbove[colIndex];
+    int c = pAbove[colIndex - 1];
+
+    // written without branches, the noise makes them unpredictable
+    int low  = std::min(a, b);
+    int high = std::max(a, b);
+
+    int prediction = a + b - c;
+
+    prediction = (c >= high) ? low  : prediction;
+    prediction = (c <= low)  ? high : prediction;
+
+    return prediction;
+}
+
+// Rice parameter of the mean of the residuals
+static inline int _RiceParameter(int sum, int count)
+{
+    int k = 0;
+
+    while((count << k) < sum)
+    {
+        k ++;
+    }
+
+    return k;
+}
+
+static inline void _UpdateStatistics(int& sum, int& count, uint32_t mapped)
+{
+    sum += mapped;
+    count ++;
+
+    if(count >= RAW_CODEC_RICE_RESET)
+    {
+        sum   >>= 1;
+        count >>= 1;
+    }
+}
+
+static inline void _Write32(uint8_t* pDst, uint32_t value)
+{
+    qToLittleEndian<quint32>(value, pDst);
+}
+
+static inline uint32_t _Read32(const uint8_t* pSrc)
+{
+    return qFromLittleEndian<quint32>(pSrc);
+}
+
+bool RawCodec::IsEncoded(const void* pData, qint64 size)
+{
+    if((pData == NULL) || (size < RAW_CODEC_HEADER_SIZE))
+    {
+        return false;
+    }
+
+    return (_Read32((const uint8_t*)pData) == RAW_CODEC_MAGIC);
+}
+
+QByteArray RawCodec::Encode(const FrameBuffer& frame)
+{
+    QByteArray output;
+
+    if(frame.IsNull() == true)
+    {
+        return output;
+    }
+
+    int width     = frame.GetWidth();
+    int height    = frame.GetHeight();
+    int bandCount = (height + RAW_CODEC_BAND_HEIGHT - 1) / RAW_CODEC_BAND_HEIGHT;
+
+    std::vector<std::vector<uint8_t>> bands(bandCount);
+    std::vector<int> modes(bandCount);
+
+#pragma omp parallel for num_threads(4)
+    for(int bandIndex = 0; bandIndex < bandCount; bandIndex ++)
+    {
+        int firstLine = bandIndex * RAW_CODEC_BAND_HEIGHT;
+        int lineCount = std::min(RAW_CODEC_BAND_HEIGHT, height - firstLine);
+
+        bool bFits = true;
+
+        for(int line = firstLine; (line < firstLine + lineCount) && (bFits == true); line ++)
+        {
+            const uint16_t* pLine = frame.GetLine(line);
+
+            for(int colIndex = 0; colIndex < width; colIndex ++)
+            {
+                if(pLine[colIndex] > RAW_CODEC_MAX_VALUE)
+                {
+                    bFits = false;
+                    break;
+                }
+            }
+        }
+
+        // the band is packed when the coding does not make it smaller
+        size_t packedSize = (((size_t)width * lineCount + 1) / 2) * 3;
+
+        if(bFits == false)
+        {
+            modes[bandIndex] = RawCodecBand_Raw16;
+            _EncodeRaw16(frame, firstLine, lineCount, bands[bandIndex]);
+        }
+        else if(_EncodeRice(frame, firstLine, lineCount, bands[bandIndex], packedSize) == true)
+        {
+            modes[bandIndex] = RawCodecBand_Rice;
+        }
+        else
+        {
+            modes[bandIndex] = RawCodecBand_Packed12;
+            _EncodePacked12(frame, firstLine, lineCount, bands[bandIndex]);
+        }
+    }
+
+    qint64 size = RAW_CODEC_HEADER_SIZE + (qint64)bandCount * RAW_CODEC_BAND_ENTRY_SIZE;
+
+    for(int bandIndex = 0; bandIndex < bandCount; bandIndex ++)
+    {
+        size += bands[bandIndex].size();
+    }
+
+    output.resize((int)size);
+    memset(output.data(), 0, RAW_CODEC_HEADER_SIZE);
+
+    uint8_t* pOutput = (uint8_t*)output.data();
+
+    _Write32(&pOutput[0], RAW_CODEC_MAGIC);
+    qToLittleEndian<quint16>(RAW_CODEC_VERSION, &pOutput[4]);
+    qToLittleEndian<quint16>(RAW_CODEC_BITS, &pOutput[6]);
+    _Write32(&pOutput[8],  width);
+    _Write32(&pOutput[12], height);
+    _Write32(&pOutput[16], RAW_CODEC_BAND_HEIGHT);
+    _Write32(&pOutput[20], bandCount);
+
+    quint64 offset = RAW_CODEC_HEADER_SIZE + (quint64)bandCount * RAW_CODEC_BAND_ENTRY_SIZE;
+
+    for(int bandIndex = 0; bandIndex < bandCount; bandIndex ++)
+    {
+        uint8_t* pEntry = &pOutput[RAW_CODEC_HEADER_SIZE + bandIndex * RAW_CODEC_BAND_ENTRY_SIZE];
+
+        qToLittleEndian<quint64>(offset, pEntry);
+        _Write32(&pEntry[8],  (uint32_t)bands[bandIndex].size());
+        _Write32(&pEntry[12], modes[bandIndex]);
+
+        memcpy(&pOutput[offset], bands[bandIndex].data(), bands[bandIndex].size());
+
+        offset += bands[bandIndex].size();
+    }
+
+    return output;
+}
+
+FrameBuffer RawCodec::Decode(const void* pData, qint64 size)
+{
+    FrameBuffer frame;
+
+    if(IsEncoded(pData, size) == false)
+    {
+        return frame;
+    }
+
+    const uint8_t* pInput = (const uint8_t*)pData;
+
+    int version    = qFromLittleEndian<quint16>(&pInput[4]);
+    int bits       = qFromLittleEndian<quint16>(&pInput[6]);
+    int width      = (int)_Read32(&pInput[8]);
+    int height     = (int)_Read32(&pInput[12]);
+    int bandHeight = (int)_Read32(&pInput[16]);
+    int bandCount  = (int)_Read32(&pInput[20]);
+
+    if((version != RAW_CODEC_VERSION) ||
+       (bits != RAW_CODEC_BITS) ||
+       (width <= 0) || (height <= 0) || (bandHeight <= 0) ||
+       (bandCount != (height + bandHeight - 1) / bandHeight) ||
+       (RAW_CODEC_HEADER_SIZE + (qint64)bandCount * RAW_CODEC_BAND_ENTRY_SIZE > size))
+    {
+        return frame;
+    }
+
+    frame = FrameBuffer(width, height);
+
+    if(frame.IsNull() == true)
+    {
+        return frame;
+    }
+
+    std::atomic<bool> bSuccess(true);
+
+#pragma omp parallel for num_threads(4)
+    for(int bandIndex = 0; bandIndex < bandCount; bandIndex ++)
+    {
+        const uint8_t* pEntry = &pInput[RAW_CODEC_HEADER_SIZE + bandIndex * RAW_CODEC_BAND_ENTRY_SIZE];
+
+        quint64 offset   = qFromLittleEndian<quint64>(pEntry);
+        quint64 bandSize = _Read32(&pEntry[8]);
+        int     mode     = (int)_Read32(&pEntry[12]);
+
+        int firstLine = bandIndex * bandHeight;
+        int lineCount = std::min(bandHeight, height - firstLine);
+
+        bool bBand = false;
+
+        if((offset <= (quint64)size) && (bandSize <= (quint64)size - offset))
+        {
+            switch(mode)
+            {
+            case RawCodecBand_Rice:
+                bBand = _DecodeRice(&pInput[offset], bandSize, frame, firstLine, lineCount);
+                break;
+
+            case RawCodecBand_Packed12:
+                bBand = _DecodePacked12(&pInput[offset], bandSize, frame, firstLine, lineCount);
+                break;
+
+            case RawCodecBand_Raw16:
+                bBand = _DecodeRaw16(&pInput[offset], bandSize, frame, firstLine, lineCount);
+                break;
+            }
+        }
+
+        if(bBand == false)
+        {
+            bSuccess = false;
+        }
+    }
+
+    if(bSuccess == false)
+    {
+        frame.Release();
+    }
+
+    return frame;
+}
+
+FrameBuffer RawCodec::ReadFile(const QString& filePath, int width)
+{
+    QFile file(filePath);
+
+    if(file.open(QIODevice::ReadOnly) == false)
+    {
+        return FrameBuffer();
+    }
+
+    // the container has any length (FrameBuffer::MapFile only maps whole pixels)
+    qint64 size = file.size();
+
+    uchar* pMap = (size >= RAW_CODEC_HEADER_SIZE) ? file.map(0, size) : NULL;
+
+    if(pMap != NULL)
+    {
+        if(IsEncoded(pMap, size) == true)
+        {
+            FrameBuffer frame = Decode(pMap, size);
+
+            file.unmap(pMap);
+            return frame;
+        }
+
+        file.unmap(pMap);
+    }
+
+    file.close();
+
+    return FrameBuffer::MapFile(filePath, width);
+}
+
+bool RawCodec::_EncodeRice(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band, size_t maxSize)
+{
+    // a pixel takes at most RAW_CODEC_RICE_LIMIT + RAW_CODEC_BITS bits
+    band.resize(maxSize + (RAW_CODEC_RICE_LIMIT + RAW_CODEC_BITS) * (size_t)frame.GetWidth() / 8 + 8);
+
+    _BitWriter writer(band.data());
+
+    int width = frame.GetWidth();
+
+    int sum   = 64;
+    int count = 1;
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        const uint16_t* pLine  = frame.GetLine(firstLine + lineIndex);
+        const uint16_t* pAbove = (lineIndex > 0) ? frame.GetLine(firstLine + lineIndex - 1) : NULL;
+
+        for(int colIndex = 0; colIndex < width; colIndex ++)
+        {
+            // residual modulo 2^12 centered on 0, mapped to 0, -1, 1, -2, 2...
+            int error = (((int)pLine[colIndex] - _Predict(pLine, pAbove, colIndex) + RAW_CODEC_HALF_RANGE) & RAW_CODEC_MAX_VALUE) - RAW_CODEC_HALF_RANGE;
+
+            uint32_t mapped = (uint32_t)((error << 1) ^ (error >> 31));
+
+            int k = _RiceParameter(sum, count);
+            uint32_t quotient = mapped >> k;
+
+            if(quotient < RAW_CODEC_RICE_LIMIT)
+            {
+                // quotient in unary (ones ended by a zero) then the k low bits
+                writer.Write((1U << (quotient + 1)) - 2, quotient + 1);
+                writer.Write(mapped & ((1U << k) - 1), k);
+            }
+            else
+            {
+                writer.Write((1U << RAW_CODEC_RICE_LIMIT) - 1, RAW_CODEC_RICE_LIMIT);
+                writer.Write(mapped, RAW_CODEC_BITS);
+            }
+
+            _UpdateStatistics(sum, count, mapped);
+        }
+
+        if(writer.GetSize() > maxSize)
+        {
+            band.clear();
+            return false;
+        }
+    }
+
+    band.resize(writer.Flush());
+
+    return true;
+}
+
+void RawCodec::_EncodePacked12(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band)
+{
+    int width = frame.GetWidth();
+
+    band.clear();
+    band.resize((((size_t)width * lineCount + 1) / 2) * 3);
+
+    uint8_t* pDst = band.data();
+
+    // the pixels of the band are packed one after the other (a pair can be on 2 lines)
+    uint16_t pending = 0;
+    bool     bPending = false;
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        const uint16_t* pLine = frame.GetLine(firstLine + lineIndex);
+
+        for(int colIndex = 0; colIndex < width; colIndex ++)
+        {
+            if(bPending == false)
+            {
+                pending  = pLine[colIndex];
+                bPending = true;
+            }
+            else
+            {
+                uint16_t value = pLine[colIndex];
+
+                *pDst++ = (uint8_t)(pending & 0xFF);
+                *pDst++ = (uint8_t)((pending >> 8) | ((value & 0x0F) << 4));
+                *pDst++ = (uint8_t)(value >> 4);
+
+                bPending = false;
+            }
+        }
+    }
+
+    if(bPending == true)
+    {
+        *pDst++ = (uint8_t)(pending & 0xFF);
+        *pDst++ = (uint8_t)(pending >> 8);
+        *pDst++ = 0;
+    }
+}
+
+void RawCodec::_EncodeRaw16(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band)
+{
+    size_t lineBytes = (size_t)frame.GetWidth() * sizeof(uint16_t);
+
+    band.clear();
+    band.resize(lineBytes * lineCount);
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        const uint16_t* pLine = frame.GetLine(firstLine + lineIndex);
+        uint8_t*        pDst  = &band[lineBytes * lineIndex];
+
+        for(int colIndex = 0; colIndex < frame.GetWidth(); colIndex ++)
+        {
+            qToLittleEndian<quint16>(pLine[colIndex], &pDst[colIndex * sizeof(uint16_t)]);
+        }
+    }
+}
+
+bool RawCodec::_DecodeRice(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount)
+{
+    _BitReader reader(pBand, size);
+
+    int width = frame.GetWidth();
+
+    int sum   = 64;
+    int count = 1;
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        uint16_t*       pLine  = frame.GetLine(firstLine + lineIndex);
+        const uint16_t* pAbove = (lineIndex > 0) ? frame.GetLine(firstLine + lineIndex - 1) : NULL;
+
+        for(int colIndex = 0; colIndex < width; colIndex ++)
+        {
+            int k = _RiceParameter(sum, count);
+
+            uint32_t quotient = (uint32_t)reader.ReadUnary(RAW_CODEC_RICE_LIMIT);
+
+            uint32_t mapped = 0;
+
+            if(quotient < RAW_CODEC_RICE_LIMIT)
+            {
+                mapped = (quotient << k) | reader.Read(k);
+            }
+            else
+            {
+                mapped = reader.Read(RAW_CODEC_BITS);
+            }
+
+            int error = (int)(mapped >> 1) ^ -(int)(mapped & 1);
+
+            pLine[colIndex] = (uint16_t)((_Predict(pLine, pAbove, colIndex) + error) & RAW_CODEC_MAX_VALUE);
+
+            _UpdateStatistics(sum, count, mapped);
+        }
+
+        if(reader.IsValid() == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RawCodec::_DecodePacked12(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount)
+{
+    int width = frame.GetWidth();
+
+    if(size < (((size_t)width * lineCount + 1) / 2) * 3)
+    {
+        return false;
+    }
+
+    size_t pixelIndex = 0;
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        uint16_t* pLine = frame.GetLine(firstLine + lineIndex);
+
+        for(int colIndex = 0; colIndex < width; colIndex ++, pixelIndex ++)
+        {
+            const uint8_t* pPair = &pBand[(pixelIndex / 2) * 3];
+
+            if((pixelIndex & 1) == 0)
+            {
+                pLine[colIndex] = (uint16_t)(pPair[0] | ((pPair[1] & 0x0F) << 8));
+            }
+            else
+            {
+                pLine[colIndex] = (uint16_t)((pPair[1] >> 4) | (pPair[2] << 4));
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RawCodec::_DecodeRaw16(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount)
+{
+    size_t lineBytes = (size_t)frame.GetWidth() * sizeof(uint16_t);
+
+    if(size < lineBytes * lineCount)
+    {
+        return false;
+    }
+
+    for(int lineIndex = 0; lineIndex < lineCount; lineIndex ++)
+    {
+        uint16_t*      pLine = frame.GetLine(firstLine + lineIndex);
+        const uint8_t* pSrc  = &pBand[lineBytes * lineIndex];
+
+        for(int colIndex = 0; colIndex < frame.GetWidth(); colIndex ++)
+        {
+            pLine[colIndex] = qFromLittleEndian<quint16>(&pSrc[colIndex * sizeof(uint16_t)]);
+        }
+    }
+
+    return true;
+}
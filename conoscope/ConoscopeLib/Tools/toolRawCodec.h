@@ -0,0 +1,72 @@
+#ifndef TOOL_RAW_CODEC_H
+#define TOOL_RAW_CODEC_H
+
+#include "toolFrameBuffer.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+#include <stdint.h>
+
+// "CRAW"
+#define RAW_CODEC_MAGIC   0x57415243
+#define RAW_CODEC_VERSION 1
+
+// bits of the pixels (the sensor is 12 bits)
+#define RAW_CODEC_BITS 12
+
+// lines coded together (the bands are independent, they are coded and decoded in parallel)
+#define RAW_CODEC_BAND_HEIGHT 64
+
+typedef enum
+{
+    RawCodecBand_Rice,     // LOCO-I prediction, residuals coded with adaptive Rice codes
+    RawCodecBand_Packed12, // 2 pixels in 3 bytes (the coding does not reduce the size)
+    RawCodecBand_Raw16     // 16 bits pixels (a pixel does not fit in 12 bits)
+} RawCodecBand_t;
+
+/* Class RawCodec
+ * lossless container of the 12 bits raw images
+ *
+ * layout (little endian)
+ *   header     magic, version (16 bits), bits (16 bits), width, height,
+ *              band height, band count, reserved (64 bits)    32 bytes
+ *   band table offset (64 bits), size, mode                   16 bytes per band
+ *   bands      data of each band
+ *
+ * each pixel is predicted from its left, upper and upper left neighbours
+ * (median edge detector of LOCO-I / JPEG-LS), the residual (modulo 2^12) is
+ * coded with a Rice code whose parameter follows the mean of the previous
+ * residuals of the band. The first line of a band only uses its left
+ * neighbour so the bands do not depend on each other.
+ * The raw files (16 bits) and the container are both read by ReadFile.
+ */
+class RawCodec
+{
+public:
+    static bool IsEncoded(const void* pData, qint64 size);
+
+    static QByteArray Encode(const FrameBuffer& frame);
+
+    // null frame if the data is not a valid container
+    static FrameBuffer Decode(const void* pData, qint64 size);
+
+    // image of a raw file (width is only used by the 16 bits files, 0: single line)
+    static FrameBuffer ReadFile(const QString& filePath, int width);
+
+private:
+    static bool _EncodeRice(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band, size_t maxSize);
+
+    static void _EncodePacked12(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band);
+
+    static void _EncodeRaw16(const FrameBuffer& frame, int firstLine, int lineCount, std::vector<uint8_t>& band);
+
+    static bool _DecodeRice(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount);
+
+    static bool _DecodePacked12(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount);
+
+    static bool _DecodeRaw16(const uint8_t* pBand, size_t size, const FrameBuffer& frame, int firstLine, int lineCount);
+};
+
+#endif // TOOL_RAW_CODEC_H
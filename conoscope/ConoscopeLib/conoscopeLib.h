@@ -58,6 +58,16 @@ extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdMeasureAEStatus(MeasureStatu
 
 extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdConvertRaw(ConvertRaw_t& param);
 
+// continuous acquisition (the frames are read while the camera keeps capturing)
+extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdStreamStart(StreamConfig_t& config);
+extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdStreamRead(std::vector<uint16_t>& buffer, StreamFrameInfo_t& info, int timeoutMs);
+extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdStreamSetExposure(int exposureTimeUs);
+extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdStreamStop();
+
+// the exported files are written in background, wait until they are written
+// (returns the first write error since the previous call)
+extern "C" CONOSCOPELIBSHARED_EXPORT const char *CmdExportFlush();
+
 // terminate the dll
 extern "C" CONOSCOPELIBSHARED_EXPORT const char* CmdTerminate();
 
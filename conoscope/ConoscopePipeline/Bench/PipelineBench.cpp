@@ -0,0 +1,552 @@
+#include "PipelineBench.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <math.h>
+#include <string.h>
+
+#include "PipelineLib.h"
+#include "Compute.h"
+#include "PipelineCompute.h"
+#include "PipelineKernels.h"
+#include "toolErrorCode.h"
+
+#define SENSOR_SATURATION    4095
+
+#define DARK_LEVEL           20
+#define DARK_NOISE           2
+
+#define PRNU_NOISE           100
+#define PRNU_SCALE_FACTOR    0.0001f
+
+#define FLAT_FIELD_LEVEL     10000
+#define FLAT_FIELD_VIGNETTING 0.3f
+
+#define EXPOSURE_TIME_US     10000
+
+// the optical axis is in the middle of the frame and the sensor radius uses 90% of the frame
+#define SENSOR_RADIUS_RATIO  0.45f
+
+// identifiers of the gain maps so they are cached like in the conoscope
+#define BENCH_GAIN_MAP_ID    1
+
+#define IMAGE_INFO_EXTENSION ".json"
+
+#define NSEC_PER_MSEC        1000000.0
+
+PipelineBench::PipelineBench()
+{
+    SetDefault(mConfig);
+
+    mWidth = 0;
+    mHeight = 0;
+    mExposureTimeUs = EXPOSURE_TIME_US;
+    mCalibratedDataRadius = 0;
+    mLinearizationCoefA1 = 0;
+}
+
+void PipelineBench::SetDefault(BenchConfig_t& config)
+{
+    config.fileName = "";
+
+    config.width           = 7920;
+    config.height          = 6004;
+    config.level           = 1000;
+    config.noise           = 8.0f;
+    config.defectCount     = 1000;
+    config.saturationRatio = 0.001f;
+    config.seed            = 1;
+
+    config.defectCorrection     = true;
+    config.biasCompensation     = true;
+    config.darkImage            = true;
+    config.prnu                 = true;
+    config.linearisation        = Pipeline_Linearisation_MXAndFlatField;
+    config.maximumIncidentAngle = 60;
+    config.calibratedDataRadius = 0;
+
+    config.iterations = 20;
+    config.warmup     = 2;
+    config.threadCounts.clear();
+    config.threadCounts.push_back(1);
+}
+
+QString PipelineBench::GetError()
+{
+    return mError;
+}
+
+bool PipelineBench::Prepare(const BenchConfig_t& config)
+{
+    mConfig = config;
+    mError = "";
+
+    if(mConfig.fileName.isEmpty())
+    {
+        _GenerateFrame();
+    }
+    else if(_LoadFrame(mConfig.fileName) == false)
+    {
+        return false;
+    }
+
+    _GenerateCalibration();
+
+    // check that the pipeline accepts the parameters before measuring
+    return _Check();
+}
+
+QJsonObject PipelineBench::Run()
+{
+    QJsonObject input;
+    input.insert("File",      mConfig.fileName.isEmpty() ? QString("synthetic") : mConfig.fileName);
+    input.insert("Width",     mWidth);
+    input.insert("Height",    mHeight);
+    input.insert("Defects",   (int)mDefects.size());
+    input.insert("KLibWidth", 2 * mCalibratedDataRadius + 1);
+
+    if(mConfig.fileName.isEmpty())
+    {
+        input.insert("Level",           mConfig.level);
+        input.insert("Noise",           mConfig.noise);
+        input.insert("SaturationRatio", mConfig.saturationRatio);
+        input.insert("Seed",            mConfig.seed);
+    }
+
+    QJsonArray runs;
+
+    for(int index = 0; index < (int)mConfig.threadCounts.size(); index ++)
+    {
+        runs.append(_RunThreads(mConfig.threadCounts[index]));
+    }
+
+    QJsonObject result;
+    result.insert("Kernels",    QString(PipelineKernels::GetIsaName(PipelineKernels::GetIsa())));
+    result.insert("Iterations", mConfig.iterations);
+    result.insert("Warmup",     mConfig.warmup);
+    result.insert("Input",      input);
+    result.insert("Runs",       runs);
+
+    return result;
+}
+
+bool PipelineBench::_LoadFrame(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if(!file.open(QFile::ReadOnly))
+    {
+        mError = QString("can not open %1").arg(fileName);
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    mWidth = mConfig.width;
+    mHeight = mConfig.height;
+
+    // information written with the capture (see ConoscopeProcess::_WriteImageInfo)
+    QFileInfo fileInfo(fileName);
+    QFile jsonFile(fileInfo.absolutePath() + "/" + fileInfo.fileName().section(".", 0, 0) + IMAGE_INFO_EXTENSION);
+
+    if(jsonFile.open(QFile::ReadOnly | QFile::Text))
+    {
+        QJsonObject record = QJsonDocument::fromJson(jsonFile.readAll()).object();
+        jsonFile.close();
+
+        QJsonObject camera = record["Camera"].toObject();
+        QJsonObject measure = record["Measure"].toObject();
+
+        mWidth = camera["Width"].toInt(mWidth);
+        mHeight = camera["Height"].toInt(mHeight);
+        mExposureTimeUs = measure["ExposureTimeUs"].toInt(mExposureTimeUs);
+    }
+
+    if(data.size() != mWidth * mHeight * (int)sizeof(int16))
+    {
+        mError = QString("size of %1 (%2 bytes) does not match %3x%4")
+                .arg(fileName).arg(data.size()).arg(mWidth).arg(mHeight);
+        return false;
+    }
+
+    mFrame.resize(mWidth * mHeight);
+    memcpy(mFrame.data(), data.data(), data.size());
+
+    // defect list of the recorded camera is not available, use random positions
+    std::mt19937 random(mConfig.seed);
+
+    mDefects.clear();
+
+    for(int index = 0; index < mConfig.defectCount; index ++)
+    {
+        Defect defect;
+        defect.coord.x = (short)(random() % mWidth);
+        defect.coord.y = (short)(random() % mHeight);
+        defect.type    = DefectType_0;
+
+        mDefects.push_back(defect);
+    }
+
+    return true;
+}
+
+void PipelineBench::_GenerateFrame()
+{
+    mWidth = mConfig.width;
+    mHeight = mConfig.height;
+
+    std::mt19937 random(mConfig.seed);
+    std::normal_distribution<float> noise((float)mConfig.level, mConfig.noise);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    mFrame.resize(mWidth * mHeight);
+
+    for(int index = 0; index < (int)mFrame.size(); index ++)
+    {
+        float value = noise(random);
+
+        if(uniform(random) < mConfig.saturationRatio)
+        {
+            value = SENSOR_SATURATION;
+        }
+
+        mFrame[index] = (int16)std::min(std::max(value, 0.0f), (float)SENSOR_SATURATION);
+    }
+
+    // defective pixels are stuck low or high
+    mDefects.clear();
+
+    for(int index = 0; index < mConfig.defectCount; index ++)
+    {
+        Defect defect;
+        defect.coord.x = (short)(random() % mWidth);
+        defect.coord.y = (short)(random() % mHeight);
+        defect.type    = DefectType_0;
+
+        mFrame[defect.coord.y * mWidth + defect.coord.x] = (random() & 1) ? SENSOR_SATURATION : 0;
+
+        mDefects.push_back(defect);
+    }
+}
+
+void PipelineBench::_GenerateCalibration()
+{
+    std::mt19937 random(mConfig.seed + 1);
+    std::normal_distribution<float> darkNoise(DARK_LEVEL, DARK_NOISE);
+    std::uniform_int_distribution<int> prnuNoise(-PRNU_NOISE, PRNU_NOISE);
+
+    // dark image
+    mDark.resize(mWidth * mHeight);
+
+    for(int index = 0; index < (int)mDark.size(); index ++)
+    {
+        mDark[index] = (int16)std::max(darkNoise(random), 0.0f);
+    }
+
+    // PRNU
+    mPrnu.resize(mWidth * mHeight * sizeof(int16));
+    int16* pPrnu = (int16*)mPrnu.data();
+
+    for(int index = 0; index < mWidth * mHeight; index ++)
+    {
+        pPrnu[index] = (int16)prnuNoise(random);
+    }
+
+    // linearization: only A1 so the sensor radius is A1 * angle / 90
+    float sensorRadius = SENSOR_RADIUS_RATIO * std::min(mWidth, mHeight);
+
+    mLinearizationCoefA1 = sensorRadius * 90.0f / mConfig.maximumIncidentAngle;
+
+    mCalibratedDataRadius = mConfig.calibratedDataRadius;
+
+    if(mCalibratedDataRadius <= 0)
+    {
+        mCalibratedDataRadius = (short)sensorRadius;
+    }
+
+    // flat field with some vignetting, the reference is the center value
+    int size = 2 * mCalibratedDataRadius + 1;
+
+    mFlatField.resize(size * size * sizeof(int16));
+    int16* pFlatField = (int16*)mFlatField.data();
+
+    for(int y = 0; y < size; y ++)
+    {
+        for(int x = 0; x < size; x ++)
+        {
+            float dx = (float)(x - mCalibratedDataRadius) / mCalibratedDataRadius;
+            float dy = (float)(y - mCalibratedDataRadius) / mCalibratedDataRadius;
+
+            pFlatField[y * size + x] = (int16)(FLAT_FIELD_LEVEL * (1.0f - FLAT_FIELD_VIGNETTING * (dx * dx + dy * dy) / 2));
+        }
+    }
+}
+
+void PipelineBench::_FillRawDataParam(Pipeline_RawDataParam& param)
+{
+    param.imageSize.Set(mWidth, mHeight);
+
+    param.sensorDefectEnable              = mConfig.defectCorrection;
+    param.sensorDefects_correctionEnabled = mConfig.defectCorrection;
+    param.sensorDefects_pixels            = mDefects;
+
+    param.bias_compensationEnabled = mConfig.biasCompensation;
+    param.bias_sensorSaturation    = SENSOR_SATURATION;
+
+    param.darkMeasurementEnable                 = mConfig.darkImage;
+    param.darkMeasurement.usExposureTime        = mExposureTimeUs;
+    param.darkMeasurement.timeStamp             = 0;
+    param.darkMeasurement.biasCompensationCount = 0;
+    param.darkMeasurement.pData                 = mDark.data();
+    param.darkMeasurement.dataSize              = (int)(mDark.size() * sizeof(int16));
+
+    param.recipe_usExposureTime = mExposureTimeUs;
+    param.timeStamp             = 0;
+
+    param.prnuEnable            = mConfig.prnu;
+    param.prnuCorrectionEnabled = mConfig.prnu;
+    param.prnuScaleFactor       = PRNU_SCALE_FACTOR;
+    param.prnuData              = &mPrnu;
+    param.gainMapId             = BENCH_GAIN_MAP_ID;
+}
+
+void PipelineBench::_FillKLibDataParam(Pipeline_KLibDataParam& param, Pipeline_CalibrationParam& calibration)
+{
+    param.imageSize.Set(mWidth, mHeight);
+    param.activeArea.Set(mWidth, mHeight, 0, 0);
+
+    param.linearisation              = mConfig.linearisation;
+    param.conversionFactorCorrection = false;
+    param.isCalibrated               = true;
+    param.sensorSaturationValue      = SENSOR_SATURATION;
+    param.applyFlatField             = true;
+
+    calibration.sensorTemperatureDependancy_Enabled = false;
+    calibration.sensorTemperatureDependancy_Slope   = 0;
+
+    calibration.captureArea_OpticalAxis.x = (short)(mWidth / 2);
+    calibration.captureArea_OpticalAxis.y = (short)(mHeight / 2);
+
+    calibration.maximumIncidentAngle = mConfig.maximumIncidentAngle;
+    calibration.calibratedDataRadius = mCalibratedDataRadius;
+
+    calibration.linearizationCoefficients.A1 = mLinearizationCoefA1;
+    calibration.linearizationCoefficients.A3 = 0;
+    calibration.linearizationCoefficients.A5 = 0;
+    calibration.linearizationCoefficients.A7 = 0;
+    calibration.linearizationCoefficients.A9 = 0;
+
+    calibration.flatField = &mFlatField;
+
+    calibration.conversionFactor_Value = 1;
+
+    calibration.gainMapId = BENCH_GAIN_MAP_ID;
+}
+
+bool PipelineBench::_Check()
+{
+    PipelineContext_t context = PipelineCreateContext();
+
+    std::vector<int16> frame(mFrame);
+    std::vector<int16> kLibData((2 * mCalibratedDataRadius + 1) * (2 * mCalibratedDataRadius + 1));
+
+    Pipeline_RawDataParam rawDataParam;
+    Pipeline_ResultRawDataParam rawDataResult;
+    _FillRawDataParam(rawDataParam);
+
+    Pipeline_KLibDataParam kLibDataParam;
+    Pipeline_CalibrationParam calibration;
+    _FillKLibDataParam(kLibDataParam, calibration);
+
+    ToolErrorCode eError(QString(CmdComputeRawDataContext(context, frame.data(), &rawDataParam, rawDataResult)));
+
+    if(eError.GetError() == ClassCommon::Error::Ok)
+    {
+        eError = ToolErrorCode(QString(CmdComputeKLibDataContext(context, frame.data(), kLibDataParam, &calibration, kLibData.data())));
+    }
+
+    PipelineDestroyContext(context);
+
+    if(eError.GetError() != ClassCommon::Error::Ok)
+    {
+        mError = QString("pipeline error %1").arg(eError.GetOption()[RETURN_ITEM_OPTION_ERROR_DESC].toString());
+        return false;
+    }
+
+    return true;
+}
+
+void PipelineBench::_RunContext(std::vector<Sample_t>* pSamples)
+{
+    PipelineContext_t context = PipelineCreateContext();
+
+    Sample_t sample;
+    Compute::SetStageTimes((Compute*)context, &sample.stages);
+
+    std::vector<int16> frame(mFrame.size());
+    std::vector<int16> kLibData((2 * mCalibratedDataRadius + 1) * (2 * mCalibratedDataRadius + 1));
+
+    Pipeline_RawDataParam rawDataParam;
+    Pipeline_ResultRawDataParam rawDataResult;
+    _FillRawDataParam(rawDataParam);
+
+    Pipeline_KLibDataParam kLibDataParam;
+    Pipeline_CalibrationParam calibration;
+    _FillKLibDataParam(kLibDataParam, calibration);
+
+    QElapsedTimer timer;
+
+    for(int iteration = 0; iteration < mConfig.warmup + mConfig.iterations; iteration ++)
+    {
+        // all the contexts start the measurement together
+        if(iteration == mConfig.warmup)
+        {
+            mReadyCount ++;
+
+            while(mStart == false)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // the raw data is corrected in place
+        memcpy(frame.data(), mFrame.data(), mFrame.size() * sizeof(int16));
+
+        memset(&sample.stages, 0, sizeof(sample.stages));
+
+        timer.start();
+        CmdComputeRawDataContext(context, frame.data(), &rawDataParam, rawDataResult);
+        sample.rawData = timer.nsecsElapsed();
+
+        timer.start();
+        CmdComputeKLibDataContext(context, frame.data(), kLibDataParam, &calibration, kLibData.data());
+        sample.kLibData = timer.nsecsElapsed();
+
+        if(iteration >= mConfig.warmup)
+        {
+            pSamples->push_back(sample);
+        }
+    }
+
+    Compute::SetStageTimes((Compute*)context, NULL);
+
+    PipelineDestroyContext(context);
+}
+
+QJsonObject PipelineBench::_RunThreads(int threadCount)
+{
+    std::vector<std::vector<Sample_t>> samples(threadCount);
+    std::vector<std::thread> threads;
+
+    mReadyCount = 0;
+    mStart = false;
+
+    for(int index = 0; index < threadCount; index ++)
+    {
+        threads.push_back(std::thread(&PipelineBench::_RunContext, this, &samples[index]));
+    }
+
+    // wall time once all the contexts are warm
+    while(mReadyCount < threadCount)
+    {
+        std::this_thread::yield();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    mStart = true;
+
+    for(int index = 0; index < threadCount; index ++)
+    {
+        threads[index].join();
+    }
+
+    int64 elapsed = timer.nsecsElapsed();
+
+    // durations of all the contexts
+    int64 rawPixels = (int64)mWidth * mHeight;
+    int64 kLibPixels = (int64)(2 * mCalibratedDataRadius + 1) * (2 * mCalibratedDataRadius + 1);
+
+    std::vector<int64> rawData;
+    std::vector<int64> kLibData;
+    std::vector<int64> stages[PipelineStage_Count];
+
+    for(int index = 0; index < threadCount; index ++)
+    {
+        for(int sampleIndex = 0; sampleIndex < (int)samples[index].size(); sampleIndex ++)
+        {
+            Sample_t& sample = samples[index][sampleIndex];
+
+            rawData.push_back(sample.rawData);
+            kLibData.push_back(sample.kLibData);
+
+            for(int stage = 0; stage < PipelineStage_Count; stage ++)
+            {
+                stages[stage].push_back(sample.stages.nsec[stage]);
+            }
+        }
+    }
+
+    QJsonObject stagesObject;
+
+    for(int stage = 0; stage < PipelineStage_Count; stage ++)
+    {
+        // skip the stages that are not executed
+        if(*std::max_element(stages[stage].begin(), stages[stage].end()) == 0)
+        {
+            continue;
+        }
+
+        bool isKLibStage = (stage >= PipelineStage_FlatFieldGain);
+
+        stagesObject.insert(PipelineCompute::GetStageName((PipelineStage_t)stage),
+                            _GetStatistics(stages[stage], isKLibStage ? kLibPixels : rawPixels));
+    }
+
+    int frameCount = threadCount * mConfig.iterations;
+
+    QJsonObject result;
+    result.insert("Threads",          threadCount);
+    result.insert("FramesPerSecond",  frameCount * 1e9 / elapsed);
+    result.insert("MPixPerSecond",    frameCount * rawPixels * 1e3 / elapsed);
+    result.insert("CmdComputeRawData",  _GetStatistics(rawData, rawPixels));
+    result.insert("CmdComputeKLibData", _GetStatistics(kLibData, kLibPixels));
+    result.insert("Stages",           stagesObject);
+
+    return result;
+}
+
+QJsonObject PipelineBench::_GetStatistics(std::vector<int64>& durations, int64 pixelCount)
+{
+    std::sort(durations.begin(), durations.end());
+
+    int count = (int)durations.size();
+
+    double median = 0;
+    double p95 = 0;
+
+    if(count != 0)
+    {
+        median = (count % 2) ? durations[count / 2] : (durations[count / 2 - 1] + durations[count / 2]) / 2.0;
+
+        // nearest rank
+        int rank = (int)ceil(0.95 * count);
+        p95 = durations[std::max(rank, 1) - 1];
+    }
+
+    QJsonObject statistics;
+    statistics.insert("MedianMs",      median / NSEC_PER_MSEC);
+    statistics.insert("P95Ms",         p95 / NSEC_PER_MSEC);
+    statistics.insert("MPixPerSecond", (median != 0) ? pixelCount * 1e3 / median : 0);
+
+    return statistics;
+}
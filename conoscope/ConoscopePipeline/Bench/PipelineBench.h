@@ -0,0 +1,113 @@
+#ifndef PIPELINEBENCH_H
+#define PIPELINEBENCH_H
+
+#include <QString>
+#include <QJsonObject>
+
+#include <vector>
+#include <atomic>
+
+#include "PipelineTypes.h"
+#include "PipelineComputeTypes.h"
+
+/* Class PipelineBench
+ * measure the speed of CmdComputeRawData and CmdComputeKLibData
+ *
+ * the input is a synthetic 12 bits frame or a .bin/.json pair exported by
+ * the conoscope (_CmdExportRaw). The frame is processed N times by 1 or more
+ * pipeline contexts running at the same time (one thread per context), each
+ * call and each stage is timed and the median, p95 and throughput are reported.
+ */
+
+typedef struct
+{
+    // input (synthetic frame if fileName is empty)
+    QString fileName;
+
+    int   width;
+    int   height;
+    int   level;             // average value of the frame
+    float noise;             // standard deviation of the noise
+    int   defectCount;       // number of defective pixels
+    float saturationRatio;   // ratio of saturated pixels
+    int   seed;
+
+    // pipeline
+    bool  defectCorrection;
+    bool  biasCompensation;
+    bool  darkImage;
+    bool  prnu;
+    Pipeline_Linearisation_t linearisation;
+    float maximumIncidentAngle;
+    short calibratedDataRadius;
+
+    // measurement
+    int              iterations;
+    int              warmup;
+    std::vector<int> threadCounts;
+} BenchConfig_t;
+
+class PipelineBench
+{
+public:
+    PipelineBench();
+
+    static void SetDefault(BenchConfig_t& config);
+
+    // generate or load the frame and the calibration data
+    bool Prepare(const BenchConfig_t& config);
+
+    QJsonObject Run();
+
+    QString GetError();
+
+private:
+    BenchConfig_t mConfig;
+
+    int mWidth;
+    int mHeight;
+    int mExposureTimeUs;
+
+    short mCalibratedDataRadius;
+    float mLinearizationCoefA1;
+
+    std::vector<int16>  mFrame;
+    std::vector<int16>  mDark;
+    std::vector<char>   mPrnu;
+    std::vector<char>   mFlatField;
+    std::vector<Defect> mDefects;
+
+    QString mError;
+
+    // start of the measurement once all the contexts are warm
+    std::atomic<int>  mReadyCount;
+    std::atomic<bool> mStart;
+
+    // durations of one call (nanoseconds)
+    typedef struct
+    {
+        int64 rawData;
+        int64 kLibData;
+        PipelineStageTimes_t stages;
+    } Sample_t;
+
+    bool _LoadFrame(const QString& fileName);
+
+    void _GenerateFrame();
+
+    void _GenerateCalibration();
+
+    bool _Check();
+
+    void _RunContext(std::vector<Sample_t>* pSamples);
+
+    QJsonObject _RunThreads(int threadCount);
+
+    void _FillRawDataParam(Pipeline_RawDataParam& param);
+
+    void _FillKLibDataParam(Pipeline_KLibDataParam& param, Pipeline_CalibrationParam& calibration);
+
+    static QJsonObject _GetStatistics(std::vector<int64>& durations, int64 pixelCount);
+};
+
+#endif // PIPELINEBENCH_H
@@ -0,0 +1,165 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <QTextStream>
+
+#include "PipelineBench.h"
+#include "PipelineKernels.h"
+
+#define OPTION(name, description, value) \
+    QCommandLineOption name(QStringList() << #name, description, value); \
+    parser.addOption(name)
+
+static Pipeline_Linearisation_t _GetLinearisation(QString value)
+{
+    if(value == "none")
+    {
+        return Pipeline_Linearisation_None;
+    }
+    else if(value == "mx")
+    {
+        return Pipeline_Linearisation_MX;
+    }
+
+    return Pipeline_Linearisation_MXAndFlatField;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QTextStream err(stderr);
+
+    BenchConfig_t config;
+    PipelineBench::SetDefault(config);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PipelineLib benchmark, the result is written in json");
+    parser.addHelpOption();
+
+    OPTION(input,      "recorded frame (.bin with its .json), synthetic frame if not set", "file");
+    OPTION(output,     "result file, standard output if not set", "file");
+    OPTION(width,      "width of the synthetic frame", "pixels");
+    OPTION(height,     "height of the synthetic frame", "pixels");
+    OPTION(level,      "average value of the synthetic frame", "value");
+    OPTION(noise,      "noise (standard deviation) of the synthetic frame", "value");
+    OPTION(defects,    "number of defective pixels", "count");
+    OPTION(saturation, "ratio of saturated pixels of the synthetic frame", "ratio");
+    OPTION(seed,       "seed of the synthetic data", "value");
+    OPTION(linearisation, "none, mx or mxff", "mode");
+    OPTION(angle,      "maximum incident angle", "degrees");
+    OPTION(radius,     "calibrated data radius (0 uses the sensor radius)", "pixels");
+    OPTION(iterations, "number of measured iterations", "count");
+    OPTION(warmup,     "number of iterations before the measurement", "count");
+    OPTION(threads,    "comma separated list of the number of contexts running at the same time", "list");
+    OPTION(kernels,    "force the pixel kernels (scalar, sse41, avx2)", "isa");
+
+    QCommandLineOption noDefects(QStringList() << "no-defects", "disable defect correction");
+    QCommandLineOption noBias(QStringList() << "no-bias", "disable bias compensation");
+    QCommandLineOption noDark(QStringList() << "no-dark", "disable dark image subtraction");
+    QCommandLineOption noPrnu(QStringList() << "no-prnu", "disable PRNU correction");
+    parser.addOption(noDefects);
+    parser.addOption(noBias);
+    parser.addOption(noDark);
+    parser.addOption(noPrnu);
+
+    parser.process(app);
+
+    if(parser.isSet(input))         config.fileName        = parser.value(input);
+    if(parser.isSet(width))         config.width           = parser.value(width).toInt();
+    if(parser.isSet(height))        config.height          = parser.value(height).toInt();
+    if(parser.isSet(level))         config.level           = parser.value(level).toInt();
+    if(parser.isSet(noise))         config.noise           = parser.value(noise).toFloat();
+    if(parser.isSet(defects))       config.defectCount     = parser.value(defects).toInt();
+    if(parser.isSet(saturation))    config.saturationRatio = parser.value(saturation).toFloat();
+    if(parser.isSet(seed))          config.seed            = parser.value(seed).toInt();
+    if(parser.isSet(linearisation)) config.linearisation   = _GetLinearisation(parser.value(linearisation));
+    if(parser.isSet(angle))         config.maximumIncidentAngle = parser.value(angle).toFloat();
+    if(parser.isSet(radius))        config.calibratedDataRadius = (short)parser.value(radius).toInt();
+    if(parser.isSet(iterations))    config.iterations      = parser.value(iterations).toInt();
+    if(parser.isSet(warmup))        config.warmup          = parser.value(warmup).toInt();
+
+    config.defectCorrection = !parser.isSet(noDefects);
+    config.biasCompensation = !parser.isSet(noBias);
+    config.darkImage        = !parser.isSet(noDark);
+    config.prnu             = !parser.isSet(noPrnu);
+
+    if(parser.isSet(threads))
+    {
+        config.threadCounts.clear();
+
+        QStringList counts = parser.value(threads).split(",", QString::SkipEmptyParts);
+
+        for(int index = 0; index < counts.size(); index ++)
+        {
+            config.threadCounts.push_back(counts[index].toInt());
+        }
+    }
+
+    for(int index = 0; index < (int)config.threadCounts.size(); index ++)
+    {
+        if(config.threadCounts[index] < 1)
+        {
+            err << "invalid thread count" << endl;
+            return 1;
+        }
+    }
+
+    if((config.iterations < 1) || (config.warmup < 0) || (config.threadCounts.size() == 0))
+    {
+        err << "invalid iterations" << endl;
+        return 1;
+    }
+
+    if(parser.isSet(kernels))
+    {
+        QString isa = parser.value(kernels);
+        KernelIsa_t eIsa = KernelIsa_Scalar;
+
+        if(isa == "sse41")
+        {
+            eIsa = KernelIsa_Sse41;
+        }
+        else if(isa == "avx2")
+        {
+            eIsa = KernelIsa_Avx2;
+        }
+
+        if(PipelineKernels::Select(eIsa) == false)
+        {
+            err << "kernels " << isa << " not supported by this cpu" << endl;
+            return 1;
+        }
+    }
+
+    PipelineBench bench;
+
+    if(bench.Prepare(config) == false)
+    {
+        err << bench.GetError() << endl;
+        return 1;
+    }
+
+    QByteArray result = QJsonDocument(bench.Run()).toJson();
+
+    if(parser.isSet(output))
+    {
+        QFile file(parser.value(output));
+
+        if(!file.open(QFile::WriteOnly | QFile::Text))
+        {
+            err << "can not write " << parser.value(output) << endl;
+            return 1;
+        }
+
+        file.write(result);
+        file.close();
+    }
+    else
+    {
+        QTextStream(stdout) << result;
+    }
+
+    return 0;
+}
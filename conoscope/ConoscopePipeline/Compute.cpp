@@ -1,18 +1,26 @@
 #include "Compute.h"
 
 #include "PipelineCompute.h"
+#include "PipelineKernels.h"
 
-#define INSTANCE(instance) Compute* instance = getInstance()
+#include <QMutex>
 
 Compute* Compute::m_instance = NULL;
+Logger*  Compute::mLogger    = NULL;
+
+// protect the creation of the contexts (shared logger and kernels selection)
+static QMutex contextMutex;
 
 Compute::Compute()
 {
     // create a logger
-    mLogger = new Logger("LogPipeline.txt");
+    if(mLogger == NULL)
+    {
+        mLogger = new Logger("LogPipeline.txt");
+    }
 
     // and assocaite it
-    PipelineCompute::SetLogger(mLogger);
+    mPipeline.SetLogger(mLogger);
 
     // define image dimension
     mImageConfiguration.image_horizontal_offset      = 0;
@@ -33,17 +41,21 @@ Compute::Compute()
 
     mImageConfiguration.UpdateSettings();
 
-    PipelineCompute::SetImageConfiguration(mImageConfiguration);
+    mPipeline.SetImageConfiguration(mImageConfiguration);
+
+    // select the pixel kernels for this cpu
+    PipelineKernels::Initialise();
 }
 
 Compute::~Compute()
 {
-    // it is for development purpose
-    delete mLogger;
+    // the logger is shared by the contexts and kept until the end of the process
 }
 
 Compute* Compute::getInstance()
 {
+    QMutexLocker locker(&contextMutex);
+
     if(m_instance == NULL)
     {
         m_instance = new Compute();
@@ -52,12 +64,67 @@ Compute* Compute::getInstance()
     return m_instance;
 }
 
+Compute* Compute::CreateContext()
+{
+    QMutexLocker locker(&contextMutex);
+    return new Compute();
+}
+
+void Compute::DestroyContext(Compute* context)
+{
+    // the default context is never destroyed
+    if((context != NULL) && (context != m_instance))
+    {
+        delete context;
+    }
+}
+
+Compute* Compute::GetContext(Compute* context)
+{
+    if(context == NULL)
+    {
+        return getInstance();
+    }
+
+    return context;
+}
+
+const char* Compute::SetReturn(std::string message)
+{
+    mReturn = message;
+    return mReturn.c_str();
+}
+
+void Compute::SetStageTimes(Compute* context, PipelineStageTimes_t* pStageTimes)
+{
+    Compute* instance = GetContext(context);
+    instance->mPipeline.SetStageTimes(pStageTimes);
+}
+
+Error_t Compute::ComputeRawData(
+        int16* inputData,
+        Pipeline_RawDataParam* param,
+        Pipeline_ResultRawDataParam& resultParam)
+{
+    return ComputeRawData(NULL, inputData, param, resultParam);
+}
+
+Error_t Compute::ComputeKLibData(
+        int16* inputData,
+        Pipeline_KLibDataParam &param,
+        Pipeline_CalibrationParam *calibration,
+        int16* klibData)
+{
+    return ComputeKLibData(NULL, inputData, param, calibration, klibData);
+}
+
 Error_t Compute::ComputeRawData(
+        Compute* context,
         int16* inputData,
         Pipeline_RawDataParam* param,
         Pipeline_ResultRawDataParam& resultParam)
 {
-    INSTANCE(instance);
+    Compute* instance = GetContext(context);
     return instance->_ComputeRawData(
                 inputData,
                 param,
@@ -65,12 +132,13 @@ Error_t Compute::ComputeRawData(
 }
 
 Error_t Compute::ComputeKLibData(
+        Compute* context,
         int16* inputData,
         Pipeline_KLibDataParam &param,
         Pipeline_CalibrationParam *calibration,
         int16* klibData)
 {
-    INSTANCE(instance);
+    Compute* instance = GetContext(context);
     return instance->_ComputeKLibData(
                 inputData,
                 param,
@@ -89,7 +157,7 @@ Error_t Compute::_ComputeRawData(
     int16* rawData = inputData;
     Histogram* pHistogram = NULL;
 
-    res = PipelineCompute::ComputeRawData(
+    res = mPipeline.ComputeRawData(
                 rawData,
                 param,
                 pHistogram,
@@ -108,16 +176,12 @@ Error_t Compute::_ComputeKLibData(
 
     Pipeline_DataIn   rawData;
     Pipeline_DataOut  calibDataV2Out;
-    std::vector<char> calibratedData;
 
     rawData.pData = inputData;
     rawData.dataSize = param.imageSize.nbPixels * sizeof(int16);
 
-    // Set size of output buffer
-    int calibratedDataSize = (2 * calibration->calibratedDataRadius + 1) * (2 * calibration->calibratedDataRadius + 1);
-    calibratedData.resize(calibratedDataSize * sizeof(int16));
-
-    res = PipelineCompute::ComputeKLibData(
+    // the output buffer (klibData) is allocated by the caller
+    res = mPipeline.ComputeKLibData(
                 param,
                 calibration,
                 &rawData,
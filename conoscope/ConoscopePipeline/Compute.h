@@ -1,12 +1,24 @@
 #ifndef COMPUTE_H
 #define COMPUTE_H
 
+#include <string>
+
 #include "logger.h"
 #include "imageConfiguration.h"
 #include "PipelineTypes.h"
+#include "PipelineCompute.h"
 
 #include "PipelineDefines.h"
 
+/* Class Compute
+ * pipeline context
+ *
+ * a context owns its image configuration, its pipeline (caches and scratch
+ * buffers) and the buffer of the returned message. Contexts are independent
+ * and can be used by different threads at the same time.
+ * the default context is used by the API without context.
+ */
+
 class Compute
 {
 
@@ -18,12 +30,23 @@ private:
 
     ~Compute();
 
+    // the log file is shared by all the contexts
+    static Logger* mLogger;
+
     ImageConfiguration mImageConfiguration;
-    Logger* mLogger;
+    PipelineCompute    mPipeline;
 
-    QByteArray mImgData;
+    std::string mReturn;
 
 public:
+    static Compute* CreateContext();
+
+    static void DestroyContext(Compute* context);
+
+    // return the default context if context is NULL
+    static Compute* GetContext(Compute* context);
+
+    // default context
     static Error_t ComputeRawData(
             int16 *inputData,
             Pipeline_RawDataParam *param,
@@ -34,6 +57,26 @@ public:
             Pipeline_CalibrationParam *calibration,
             int16 *klibData);
 
+    // given context
+    static Error_t ComputeRawData(
+            Compute* context,
+            int16 *inputData,
+            Pipeline_RawDataParam *param,
+            Pipeline_ResultRawDataParam &resultParam);
+
+    static Error_t ComputeKLibData(
+            Compute* context,
+            int16 *inputData,
+            Pipeline_KLibDataParam &param,
+            Pipeline_CalibrationParam *calibration,
+            int16 *klibData);
+
+    // keep the message in the context (valid until the next call)
+    const char* SetReturn(std::string message);
+
+    // accumulate the time of each pipeline stage (NULL to disable)
+    static void SetStageTimes(Compute* context, PipelineStageTimes_t* pStageTimes);
+
 private:
     Error_t _ComputeRawData(
             int16 *inputData,
@@ -1,5 +1,6 @@
 #include "PipelineCompute.h"
 #include "PipelineDefectCorrector.h"
+#include "PipelineKernels.h"
 
 //#define ONE_LOOP
 
@@ -9,6 +10,13 @@
 
 #define OMP_PARAL
 
+// single streaming pass for saturation, bias, dark offset, dark image and PRNU
+#define FUSED_RAW_DATA
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #define MAX_VALUE(a, b) ((a) < (b)) ? (b) : (a)
 #define MIN_VALUE(a, b) ((a) > (b)) ? (b) : (a)
 
@@ -64,49 +72,67 @@
 
 #define debugPrint(text)     DebugLogger::Print(text)
 
-#define INSTANCE(instance) PipelineCompute* instance = getInstance()
-
-PipelineCompute* PipelineCompute::m_instance = NULL;
-
 PipelineCompute::PipelineCompute()
 {
     m_logger = NULL;
+    m_pStageTimes = NULL;
 }
 
 PipelineCompute::~PipelineCompute()
 {
 }
 
-PipelineCompute* PipelineCompute::getInstance()
-{
-    if(m_instance == NULL)
-    {
-        m_instance = new PipelineCompute();
-    }
-
-    return m_instance;
-}
-
 void PipelineCompute::SetLogger(Logger* logger)
 {
-    INSTANCE(instance);
-    instance->m_logger = logger;
+    m_logger = logger;
 }
 
 void PipelineCompute::SetImageConfiguration(
         ImageConfiguration& imageConfiguration)
 {
-    INSTANCE(instance);
-    instance->m_ImageConfiguration = imageConfiguration;
-    instance->m_ImageConfigurationRef = imageConfiguration;
+    m_ImageConfiguration = imageConfiguration;
+    m_ImageConfigurationRef = imageConfiguration;
 
-    PipelineDefectCorrector::SetImageConfiguration(imageConfiguration);
+    m_LinearizationCache.Invalidate();
+
+    m_DefectCorrector.SetImageConfiguration(imageConfiguration);
 }
 
 int PipelineCompute::GetCalibratedDataSize(short calibratedDataRadius)
 {
-    INSTANCE(instance);
-    return instance->_GetCalibratedDataSize(calibratedDataRadius);
+    return _GetCalibratedDataSize(calibratedDataRadius);
+}
+
+void PipelineCompute::SetStageTimes(PipelineStageTimes_t* pStageTimes)
+{
+    m_pStageTimes = pStageTimes;
+}
+
+const char* PipelineCompute::GetStageName(PipelineStage_t eStage)
+{
+    switch(eStage)
+    {
+    case PipelineStage_WrongBands:
+        return "WrongBands";
+    case PipelineStage_DefectCorrection:
+        return "DefectCorrection";
+    case PipelineStage_BiasCompensation:
+        return "BiasCompensation";
+    case PipelineStage_PrnuGain:
+        return "PrnuGain";
+    case PipelineStage_RawCorrection:
+        return "RawCorrection";
+    case PipelineStage_FlatFieldGain:
+        return "FlatFieldGain";
+    case PipelineStage_LinearizationTables:
+        return "LinearizationTables";
+    case PipelineStage_Linearization:
+        return "Linearization";
+    case PipelineStage_ViewingAngle:
+        return "ViewingAngle";
+    default:
+        return "";
+    }
 }
 
 Error_t PipelineCompute::ComputeRawData(
@@ -115,8 +141,7 @@ Error_t PipelineCompute::ComputeRawData(
         Histogram*                     pHistogram,
         Pipeline_ResultRawDataParam&   resultParam)
 {
-    INSTANCE(instance);
-    return instance->_ComputeRawData(
+    return _ComputeRawData(
                 rawData,
                 param,
                 pHistogram,
@@ -130,8 +155,7 @@ Error_t PipelineCompute::ComputeKLibData(
         Pipeline_DataOut*             calibDataOut,
         int16*                        calibratedData)
 {
-    INSTANCE(instance);
-    return instance->_ComputeKLibData(
+    return _ComputeKLibData(
                 param,
                 calibration,
                 rawData,
@@ -176,7 +200,9 @@ Error_t PipelineCompute::_ComputeRawData(
     //first correct defective pixels before any additional process
     if(res == Error_Ok)
     {
+        _StageStart();
         iDefects = ComputeWrongBands(rawData, INACTIVE_AREA_THRESHOLD, &param->imageSize);
+        _StageEnd(PipelineStage_WrongBands);
     }
 
     if(res == Error_Ok)
@@ -185,13 +211,133 @@ Error_t PipelineCompute::_ComputeRawData(
            (param->sensorDefectEnable == true))
         {
             appendLogFile("Defect correction");
-            PipelineDefectCorrector::Correct(rawData, param->imageSize, &param->sensorDefects_pixels);
+
+            _StageStart();
+            m_DefectCorrector.Correct(rawData, param->imageSize, &param->sensorDefects_pixels);
+            _StageEnd(PipelineStage_DefectCorrection);
         }
     }
 
     float saturationLevel = 0.0;
     bool saturationFlag = false;
 
+#ifdef FUSED_RAW_DATA
+    if(res == Error_Ok)
+    {
+        // bias is read in the corners before the image is modified
+        darkCurrentBiasValue = 0;
+
+        int16 iDarkCurrentBiasValue = 0;
+
+        _StageStart();
+
+        if(param->bias_compensationEnabled == true)
+        {
+            appendLogFile("Bias substraction");
+            iDarkCurrentBiasValue = ComputedBiasSubtraction(rawData, param->lastOffSet);
+            darkCurrentBiasValue = iDarkCurrentBiasValue;
+        }
+        else
+        {
+            appendLogFile("Bias substraction disabled");
+            darkCurrentBiasValue = ComputedBiasSubtraction(rawData, param->lastOffSet);
+        }
+
+        _StageEnd(PipelineStage_BiasCompensation);
+
+        // dark image is applied only if exposure time matches (5% tolerance)
+        const int16* darkData = NULL;
+
+        if(param->darkMeasurementEnable == true)
+        {
+            if(param->darkMeasurement.dataSize != 0)
+            {
+                float usExposureTimeUs     = (float)param->recipe_usExposureTime;
+                float usExposureTimeUsDark = (float)param->darkMeasurement.usExposureTime;
+                float fScaling             = usExposureTimeUs / usExposureTimeUsDark;
+
+                if((fScaling <= 1.05) &&
+                   (fScaling >= 0.95))
+                {
+                    darkData = param->darkMeasurement.pData;
+
+                    darkImageInfo.deltaBiasCount = (int16)((float)darkCurrentBiasValue - fScaling * param->darkMeasurement.biasCompensationCount);
+
+                    darkImageInfo.deltaTemp = param->sensorTemperature.die.averaged - param->darkMeasurement.sensorTemperature.die.averaged;
+
+                    darkImageInfo.deltaTime = param->timeStamp - param->darkMeasurement.timeStamp;
+                }
+                else
+                {
+                    darkImageInfo.deltaBiasCount = -1;
+                    darkImageInfo.deltaTemp = -1;
+                    darkImageInfo.deltaTime = -1;
+                }
+            }
+        }
+        else
+        {
+            darkImageInfo.deltaBiasCount = 0;
+            darkImageInfo.deltaTemp = 0;
+            darkImageInfo.deltaTime = 0;
+        }
+
+        const float* pPrnuGain = NULL;
+
+        if(param->prnuEnable == true)
+        {
+            if(param->prnuCorrectionEnabled == true)
+            {
+                appendLogFile("PRNU correction");
+
+                _StageStart();
+
+                pPrnuGain = m_GainMap.GetPrnuGain(
+                            param->gainMapId,
+                            param->prnuData,
+                            param->prnuScaleFactor,
+                            param->imageSize.nbPixels);
+
+                _StageEnd(PipelineStage_PrnuGain);
+            }
+            else
+            {
+                appendLogFile("PRNU correction skipped (no PRNU calibration present)");
+            }
+        }
+        else
+        {
+            appendLogFile("PRNU correction disabled");
+        }
+
+        uint16_t pixelMax = 0;
+        uint16_t saturationValue = param->bias_sensorSaturation;
+
+        _StageStart();
+
+        FusedRawDataCorrection(
+                    rawData,
+                    param->imageSize,
+                    saturationValue,
+                    iDarkCurrentBiasValue,
+                    darkData,
+                    pPrnuGain,
+                    pHistogram,
+                    saturationFlag,
+                    pixelMax,
+                    fullSensor,
+                    darkOffset,
+                    maxBinaryValue);
+
+        _StageEnd(PipelineStage_RawCorrection);
+
+        // calculate the saturation level
+        saturationLevel = (float)pixelMax / (float)saturationValue;
+
+        saturationOccurs = (maxBinaryValue >= param->bias_sensorSaturation);
+        saturationScore  = (float)maxBinaryValue/(float)param->bias_sensorSaturation;
+    }
+#else
     if(res == Error_Ok)
     {
         // check if the capture is saturated
@@ -227,6 +373,8 @@ Error_t PipelineCompute::_ComputeRawData(
 
         int16 iDarkCurrentBiasValue = 0;
 
+        _StageStart();
+
         if(param->bias_compensationEnabled == true)
         {
             appendLogFile("Bias substraction");
@@ -239,6 +387,8 @@ Error_t PipelineCompute::_ComputeRawData(
             darkCurrentBiasValue = ComputedBiasSubtraction(rawData, param->lastOffSet);
         }
 
+        _StageEnd(PipelineStage_BiasCompensation);
+
         ApplyBias(rawData, param->imageSize.nbPixels, iDarkCurrentBiasValue, fullSensor);
 
         DarkOffsetCalculation(rawData, param->imageSize, pHistogram, darkOffset, maxBinaryValue);
@@ -308,10 +458,15 @@ Error_t PipelineCompute::_ComputeRawData(
             {
                 appendLogFile("PRNU correction");
 
+                const float* pPrnuGain = m_GainMap.GetPrnuGain(
+                            param->gainMapId,
+                            param->prnuData,
+                            param->prnuScaleFactor,
+                            param->imageSize.nbPixels);
+
                 SensorPrnuCorrection(rawData,
                                      param->imageSize.nbPixels,
-                                     param->prnuData,
-                                     param->prnuScaleFactor);
+                                     pPrnuGain);
             }
             else
             {
@@ -323,6 +478,7 @@ Error_t PipelineCompute::_ComputeRawData(
             appendLogFile("PRNU correction disabled");
         }
     }
+#endif
     // End Pipeline test
 
     // fill output
@@ -365,8 +521,6 @@ Error_t PipelineCompute::_ComputeKLibData(
     // note: this is no use
     float*  floatCalibratedData;
 #endif
-    bool   mFlatFieldPrecomputed = false;
-
     float  conversionFactor = 0;
     int16* pCalibratedData = NULL;
     int16* rawDataArray = NULL;
@@ -474,6 +628,17 @@ Error_t PipelineCompute::_ComputeKLibData(
 
         if(param.linearisation == Pipeline_Linearisation_MXAndFlatField)
         {
+            _StageStart();
+
+            const float* pFlatFieldGain = m_GainMap.GetFlatFieldGain(
+                calibration->gainMapId,
+                flatFieldbuffer,
+                (int)flatFieldbuffer[(2 * calibration->calibratedDataRadius + 2)*calibration->calibratedDataRadius],
+                (long)(2 * calibration->calibratedDataRadius + 1)*(2 * calibration->calibratedDataRadius + 1),
+                param.applyFlatField);
+
+            _StageEnd(PipelineStage_FlatFieldGain);
+
             MXLinearizeAndFlatField(
                 rawDataArray,
                 param.imageSize.width,
@@ -481,17 +646,15 @@ Error_t PipelineCompute::_ComputeKLibData(
                 calibration->maximumIncidentAngle,
                 calibration->captureArea_OpticalAxis,
                 &calibration->linearizationCoefficients,
-                flatFieldbuffer,
-                (long)(2 * calibration->calibratedDataRadius + 1)*(2 * calibration->calibratedDataRadius + 1),
-                (int)flatFieldbuffer[(2 * calibration->calibratedDataRadius + 2)*calibration->calibratedDataRadius],
-                pCalibratedData,
-                &mFlatFieldPrecomputed,
-                param.applyFlatField);
+                pFlatFieldGain,
+                pCalibratedData);
         }
         else if(param.linearisation == Pipeline_Linearisation_MX)
         {
             // Linearize
             // we have just linearization : apply old function
+            _StageStart();
+
             MXLinearize(
                 rawDataArray,
                 param.imageSize.width,
@@ -501,6 +664,8 @@ Error_t PipelineCompute::_ComputeKLibData(
                 &calibration->linearizationCoefficients,
                 EXCLUDED_VALUE,
                 pCalibratedData);
+
+            _StageEnd(PipelineStage_Linearization);
         }
         // if(param.linearisation == Pipeline_Linearisation_None)
         else
@@ -511,6 +676,8 @@ Error_t PipelineCompute::_ComputeKLibData(
             // int lineLength = (2 * calibration->calibratedDataRadius + 1);
             int lineLength = (2 * dataRadius + 1);
 
+            _StageStart();
+
             if((lineLength <= param.imageSize.height) &&
                (lineLength <= param.imageSize.width))
             {
@@ -537,6 +704,8 @@ Error_t PipelineCompute::_ComputeKLibData(
                 lineLength = MIN_VALUE(param.imageSize.height, param.imageSize.width);
             }
             */
+
+            _StageEnd(PipelineStage_Linearization);
         }
 
         if(param.conversionFactorCorrection == true)
@@ -560,10 +729,14 @@ Error_t PipelineCompute::_ComputeKLibData(
 
         if (calibration->maximumIncidentAngle != MAX_ANGLE)
         {
+            _StageStart();
+
             RestrictToViewingAngle(
                 calibration->maximumIncidentAngle,
                 calibration->calibratedDataRadius,
                 pCalibratedData);
+
+            _StageEnd(PipelineStage_ViewingAngle);
         }
 
         calibDataOut->conversionFactor      = conversionFactor;
@@ -587,25 +760,13 @@ int PipelineCompute::MXLinearizeAndFlatField(
         float   fMaxAngle,
         Point   center,
         const LinearizationCoef*  plinearizationFactor,
-        int16*  pintFlatField,
-        long    lSize2,
-        long    lScaleFactor,
-        int16*  pintTarget,
-        bool*   flatFieldPrecomputed,
-        bool    applyFlatField)
+        const float* pFlatFieldGain,
+        int16*  pintTarget)
 {
-    long    lSourceRow, lSourceColumn;
     long    lTargetHeight, lTargetWidth;
-    long    lTargetRow, lTargetColumn, lTargetAxis, lTargetRadius;
-
-    float   fAlpha, fBeta;
-    float   fRow, fColumn;
-    float   fPixel;
-    double  dPixel;
+    long    lTargetAxis, lTargetRadius;
 
-    int16 * psPixel;
-
-    precomputedData_t* pPrecomputedData = NULL;
+    PipelineRemap* pRemap = NULL;
 
     // Linearization
     // -------------
@@ -614,74 +775,63 @@ int PipelineCompute::MXLinearizeAndFlatField(
     lTargetAxis   = (lTargetWidth - 1) / 2;
     lTargetRadius = lTargetAxis;
 
-    PrecomputeLinearizationTables(
+    // linearization tables only depend on calibration and image geometry
+    uint64 cacheKey = PipelineLinearizationCache::GetKey(
                 lTargetWidth,
                 lTargetHeight,
-                lTargetRadius,
-                lTargetAxis,
-                plinearizationFactor,
                 fMaxAngle,
                 center,
-                &pPrecomputedData);
+                plinearizationFactor,
+                m_ImageConfiguration);
 
-    PrecomputeFlatFieldInverse(
-                pintFlatField,
-                lScaleFactor,
-                lSize2,
-                flatFieldPrecomputed,
-                applyFlatField,
-                pPrecomputedData);
+    pRemap = m_LinearizationCache.Get(cacheKey);
 
-    //---- Linearization computation ----
-    for(lTargetRow = 0; lTargetRow < lTargetHeight; lTargetRow++, pintTarget += lTargetWidth)
+    if(pRemap == NULL)
     {
-        long lRowOffset = lTargetWidth * lTargetRow;
+        appendLogFile("Precompute linearization tables");
 
-        for(lTargetColumn = 0; lTargetColumn < lTargetWidth; lTargetColumn++)
-        {
-            long lPosition = lRowOffset + lTargetColumn;
+        _StageStart();
 
-            if (pPrecomputedData[lPosition].linearizationRadius)
-            {
-                fRow    = pPrecomputedData[lPosition].linearizationTableY;
-                fColumn = pPrecomputedData[lPosition].linearizationTableX;
+        precomputedData_t* pPrecomputedData = NULL;
 
-                lSourceRow    = (long)(fRow);
-                lSourceColumn = (long)(fColumn);
-                fAlpha = fRow    - lSourceRow;
-                fBeta  = fColumn - lSourceColumn;
+        if(PrecomputeLinearizationTables(
+                    lTargetWidth,
+                    lTargetHeight,
+                    lTargetRadius,
+                    lTargetAxis,
+                    plinearizationFactor,
+                    fMaxAngle,
+                    center,
+                    &pPrecomputedData) != Error_Ok)
+        {
+            delete[] pPrecomputedData;
+            return -1;
+        }
 
-                psPixel = pintSource + lSourceWidth * lSourceRow + lSourceColumn;
-                fPixel = (1 - fBeta) * psPixel[0] + fBeta * psPixel[1];
-                psPixel = psPixel + lSourceWidth;
-                fPixel = (1 - fAlpha) * fPixel + fAlpha * ((1 - fBeta) * psPixel[0] + fBeta * psPixel[1]);
+        // keep the fixed point tables only
+        pRemap = new PipelineRemap();
+        pRemap->Build(pPrecomputedData, lTargetWidth, lTargetHeight);
 
-                dPixel = (double)fPixel * pPrecomputedData[lPosition].flatFieldInverse;
+        delete[] pPrecomputedData;
 
-                if (dPixel < SHORT_MAXIMUM)
-                {
-                    pintTarget[lTargetColumn] = (short)dPixel;
-                }
-                else
-                {
-                    pintTarget[lTargetColumn] = SHORT_MAXIMUM;
-                }
-            }
-            else
-            {
-                // "Outside" pixels are zeroed
-                pintTarget[lTargetColumn] = 0;
-            }
-        }
-    }
+        // the cache owns the tables
+        m_LinearizationCache.Add(cacheKey, pRemap);
 
-    // delete allocated data
-    if(pPrecomputedData != NULL)
-    {
-        delete (pPrecomputedData);
-        pPrecomputedData = NULL;
+        _StageEnd(PipelineStage_LinearizationTables);
     }
 
+    //---- Linearization computation ----
+    // bilinear interpolation (16.16 coordinates), flat field and limitation to SHORT_MAXIMUM
+    _StageStart();
+
+    pRemap->Apply(pintSource,
+                  lSourceWidth,
+                  pFlatFieldGain,
+                  SHORT_MAXIMUM,
+                  pintTarget);
+
+    _StageEnd(PipelineStage_Linearization);
+
     return 0;
 }
 
@@ -709,11 +859,9 @@ Error_t PipelineCompute::PrecomputeLinearizationTables(
         Point center,
         precomputedData_t** ppPrecomputedData)
 {
-    float   fReductionFactor, fB0, fB2, fB4, fB6, fB8, fCorrection;
-    long    lRadiusSquare, lMaximumRadiusSquare;
-    double  dRadiusSquare;
+    float   fReductionFactor, fB0, fB2, fB4, fB6, fB8;
+    long    lMaximumRadiusSquare;
     long    lTargetRow, lTargetColumn;
-    float   fRow, fColumn;
     Error_t eError = Error_Ok;
 
     precomputedData_t* pPrecomputedData = new precomputedData_t[lTargetHeight*lTargetWidth]();
@@ -741,38 +889,33 @@ Error_t PipelineCompute::PrecomputeLinearizationTables(
             // lTargetColumn = index % lTargetWidth;
             lTargetColumn = index - (lTargetRow * lTargetWidth);
 */
-        int index = 0;
-
         for (lTargetRow = 0; lTargetRow < lTargetHeight; lTargetRow++)
         {
             #pragma omp parallel for num_threads(4)
             for (lTargetColumn = 0; lTargetColumn < lTargetWidth; lTargetColumn++)
             {
-                index = lTargetWidth*lTargetRow + lTargetColumn;
-
 #else
-        int index = 0;
-
         for (lTargetRow = 0; lTargetRow < lTargetHeight; lTargetRow++)
         {
             for (lTargetColumn = 0; lTargetColumn < lTargetWidth; lTargetColumn++)
             {
-                index = lTargetWidth*lTargetRow + lTargetColumn;
 #endif
+                // declared in the loop so each thread has its own
+                long index = lTargetWidth*lTargetRow + lTargetColumn;
 
-                lRadiusSquare = SQUARE(lTargetRow - lTargetAxis) + SQUARE(lTargetColumn - lTargetAxis);
+                long lRadiusSquare = SQUARE(lTargetRow - lTargetAxis) + SQUARE(lTargetColumn - lTargetAxis);
                 pPrecomputedData[index].linearizationRadius = (lRadiusSquare <= (lMaximumRadiusSquare + 1));
 
                 if (pPrecomputedData[index].linearizationRadius)
                 {
-                    dRadiusSquare = (double)lRadiusSquare;
-                    fCorrection = fB0 + dRadiusSquare * (fB2
+                    double dRadiusSquare = (double)lRadiusSquare;
+                    float  fCorrection = fB0 + dRadiusSquare * (fB2
                         + dRadiusSquare * (fB4
                             + dRadiusSquare * (fB6
                                 + dRadiusSquare * (fB8))));
 
-                    fRow    = center.y + fCorrection * (lTargetRow    - lTargetAxis);
-                    fColumn = center.x + fCorrection * (lTargetColumn - lTargetAxis);
+                    float fRow    = center.y + fCorrection * (lTargetRow    - lTargetAxis);
+                    float fColumn = center.x + fCorrection * (lTargetColumn - lTargetAxis);
 
                     pPrecomputedData[index].linearizationTableY = fRow;
                     pPrecomputedData[index].linearizationTableX = fColumn;
@@ -792,52 +935,6 @@ Error_t PipelineCompute::PrecomputeLinearizationTables(
     return eError;
 }
 
-Error_t PipelineCompute::PrecomputeFlatFieldInverse(
-        int16*   pint16Denominator,
-        long     lScaleFactor,
-        long     lSize,
-        bool*    flatFieldPrecomputed,
-        bool     applyFlatField,
-        precomputedData_t *pPrecomputedData)
-{
-    long lIndex;
-
-    if(!*flatFieldPrecomputed)
-    {
-        if(applyFlatField == true)
-        {
-#ifdef OMP_PARAL
-#pragma omp parallel for num_threads(4)
-#endif
-            for (lIndex = 0; lIndex < lSize; lIndex++)
-            {
-                if (pint16Denominator[lIndex] != 0)
-                {
-                    pPrecomputedData[lIndex].flatFieldInverse = (double)lScaleFactor / ((double)pint16Denominator[lIndex]);
-                }
-                else
-                {
-                    pPrecomputedData[lIndex].flatFieldInverse = 0;
-                }
-            }
-        }
-        else
-        {
-#ifdef OMP_PARAL
-#pragma omp parallel for num_threads(4)
-#endif
-            for (lIndex = 0; lIndex < lSize; lIndex++)
-            {
-                pPrecomputedData[lIndex].flatFieldInverse = 1;
-            }
-        }
-
-        *flatFieldPrecomputed = true;
-    }
-
-    return Error_Ok;
-}
-
 Error_t PipelineCompute::MXLinearize(
     int16* pintSource,
     long lSourceWidth,
@@ -1041,6 +1138,36 @@ void PipelineCompute::RestrictToViewingAngle(
 #endif
 }
 
+static int32 CountAboveThreshold(
+        const int16* line,
+        int   start,
+        int   end,
+        int16 threshold,
+        int   excludedStart,
+        int   excludedEnd,
+        int   excludedStart2,
+        int   excludedEnd2)
+{
+    int32 count = 0;
+
+    for(int pixelIndex = start; pixelIndex < end; pixelIndex ++)
+    {
+        // pixel already counted in another area
+        if(((pixelIndex >= excludedStart)  && (pixelIndex < excludedEnd)) ||
+           ((pixelIndex >= excludedStart2) && (pixelIndex < excludedEnd2)))
+        {
+            continue;
+        }
+
+        if(line[pixelIndex] > threshold)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
 int PipelineCompute::ComputeWrongBands(
         int16* rawData,
         int16 threshold,
@@ -1049,9 +1176,6 @@ int PipelineCompute::ComputeWrongBands(
     // return the number of pixels above threshold in the inactiva area
     int32 iDefects = 0;
 
-    int maxPixel = 0;
-    int minPixel = rawData[0];
-
     // TODO since the inactive area is fixed and set according to a defined image size
     // the image size must match
 
@@ -1062,49 +1186,42 @@ int PipelineCompute::ComputeWrongBands(
         return 0;
     }
 
+    // only the inactive areas are read (top, then left, then right)
+    // a pixel is counted only once even if areas overlap
     for(int lineIndex = 0; lineIndex < _IMAGE_HEIGHT; lineIndex ++)
     {
         // pointer on the first pixel of the line
         int16* line = &rawData[lineIndex * pSize->width];
 
-        for(int pixelIndex = 0; pixelIndex < _IMAGE_WIDTH; pixelIndex ++)
+        int topStart   = 0, topEnd   = 0;
+        int leftStart  = 0, leftEnd  = 0;
+        int rightStart = 0, rightEnd = 0;
+
+        // top inactive part
+        if((lineIndex >= _TOP_VERTICAL_OFFSET) && (lineIndex < _TOP_VERTICAL_OFFSET + _TOP_HEIGHT))
         {
-            // top inactive part
-            if((lineIndex  >= _TOP_VERTICAL_OFFSET)   && (lineIndex  < _TOP_VERTICAL_OFFSET + _TOP_HEIGHT) &&
-               (pixelIndex >= _TOP_HORIZONTAL_OFFSET) && (pixelIndex < _TOP_HORIZONTAL_OFFSET + _TOP_WIDTH))
-            {
-                if(line[pixelIndex] > threshold)
-                {
-                    iDefects++;
-                }
+            topStart = MAX_VALUE(_TOP_HORIZONTAL_OFFSET, 0);
+            topEnd   = MIN_VALUE(_TOP_HORIZONTAL_OFFSET + _TOP_WIDTH, _IMAGE_WIDTH);
 
-                maxPixel = MAX_VALUE(maxPixel, line[pixelIndex]);
-                minPixel = MIN_VALUE(minPixel, line[pixelIndex]);
-            }
-            // left inactive
-            else if((lineIndex  >= _LEFT_VERTICAL_OFFSET)   && (lineIndex  < _LEFT_VERTICAL_OFFSET + _LEFT_HEIGHT) &&
-                    (pixelIndex >= _LEFT_HORIZONTAL_OFFSET) && (pixelIndex < _LEFT_HORIZONTAL_OFFSET + _LEFT_WIDTH))
-            {
-                if(line[pixelIndex] > threshold)
-                {
-                    iDefects++;
-                }
+            iDefects += CountAboveThreshold(line, topStart, topEnd, threshold, 0, 0, 0, 0);
+        }
 
-                maxPixel = MAX_VALUE(maxPixel, line[pixelIndex]);
-                minPixel = MIN_VALUE(minPixel, line[pixelIndex]);
-            }
-            // right inactive
-            else if((lineIndex  >= _RIGHT_VERTICAL_OFFSET)   && (lineIndex  < _RIGHT_VERTICAL_OFFSET + _RIGHT_HEIGHT) &&
-                    (pixelIndex >= _RIGHT_HORIZONTAL_OFFSET) && (pixelIndex < _RIGHT_HORIZONTAL_OFFSET + _RIGHT_WIDTH))
-            {
-                if(line[pixelIndex] > threshold)
-                {
-                    iDefects++;
-                }
+        // left inactive
+        if((lineIndex >= _LEFT_VERTICAL_OFFSET) && (lineIndex < _LEFT_VERTICAL_OFFSET + _LEFT_HEIGHT))
+        {
+            leftStart = MAX_VALUE(_LEFT_HORIZONTAL_OFFSET, 0);
+            leftEnd   = MIN_VALUE(_LEFT_HORIZONTAL_OFFSET + _LEFT_WIDTH, _IMAGE_WIDTH);
 
-                maxPixel = MAX_VALUE(maxPixel, line[pixelIndex]);
-                minPixel = MIN_VALUE(minPixel, line[pixelIndex]);
-            }
+            iDefects += CountAboveThreshold(line, leftStart, leftEnd, threshold, topStart, topEnd, 0, 0);
+        }
+
+        // right inactive
+        if((lineIndex >= _RIGHT_VERTICAL_OFFSET) && (lineIndex < _RIGHT_VERTICAL_OFFSET + _RIGHT_HEIGHT))
+        {
+            rightStart = MAX_VALUE(_RIGHT_HORIZONTAL_OFFSET, 0);
+            rightEnd   = MIN_VALUE(_RIGHT_HORIZONTAL_OFFSET + _RIGHT_WIDTH, _IMAGE_WIDTH);
+
+            iDefects += CountAboveThreshold(line, rightStart, rightEnd, threshold, topStart, topEnd, leftStart, leftEnd);
         }
     }
 
@@ -1332,35 +1449,235 @@ void PipelineCompute::DarkOffsetCalculation(
     }
 }
 
+int PipelineCompute::_GetDarkOffsetAreas(
+        int  lineIndex,
+        const ImageSize& imageSize,
+        int  areaStart[DARK_OFFSET_AREA_COUNT],
+        int  areaEnd[DARK_OFFSET_AREA_COUNT],
+        bool areaIsBias[DARK_OFFSET_AREA_COUNT])
+{
+    // same areas and same order than DarkOffsetCalculation
+    int areaCount = 0;
+
+    if(lineIndex < _ACTIVE_VERTICAL_OFFSET)
+    {
+        return areaCount;
+    }
+
+    // bias corners (test for TOP and BOTTOM)
+    if((lineIndex < (_ACTIVE_VERTICAL_OFFSET + _BIAS_CORNER_AREA_HEIGHT)) ||
+       (lineIndex >= (imageSize.height - _BIAS_CORNER_AREA_HEIGHT)))
+    {
+        // LEFT area
+        areaStart[areaCount]  = _ACTIVE_HORIZONTAL_OFFSET;
+        areaEnd[areaCount]    = _ACTIVE_HORIZONTAL_OFFSET + _BIAS_CORNER_AREA_WIDTH;
+        areaIsBias[areaCount] = true;
+        areaCount ++;
+
+        // RIGHT area
+        areaStart[areaCount]  = imageSize.width - _ACTIVE_HORIZONTAL_OFFSET - _BIAS_CORNER_AREA_WIDTH;
+        areaEnd[areaCount]    = imageSize.width - _ACTIVE_HORIZONTAL_OFFSET;
+        areaIsBias[areaCount] = true;
+        areaCount ++;
+    }
+
+    // Active central area
+    areaStart[areaCount]  = _ACTIVE_CENTRAL_AREA_HORIZONTAL_OFFSET;
+    areaEnd[areaCount]    = _ACTIVE_CENTRAL_AREA_WIDTH + _ACTIVE_CENTRAL_AREA_HORIZONTAL_OFFSET;
+    areaIsBias[areaCount] = false;
+    areaCount ++;
+
+    return areaCount;
+}
+
+static int _GetThreadIndex()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+void PipelineCompute::FusedRawDataCorrection(
+        int16*           rawData,
+        const ImageSize& imageSize,
+        uint16           saturationValue,
+        int              iDarkCurrentBiasValue,
+        const int16*     darkData,
+        const float*     pPrnuGain,
+        Histogram*       histogram,
+        bool&            saturationFlag,
+        uint16&          pixelMax,
+        MeasurementValue<float> &fullSensor,
+        DarkOffset&      darkOffset,
+        int16&           maxBinaryValue)
+{
+    // the image is processed by tiles of lines: each line is read once from memory
+    // and all the steps are done while it is in cache.
+    // integer results are reduced per thread and merged at the end,
+    // float statistics are accumulated in the genuine pixel order so the result is unchanged
+    int width     = imageSize.width;
+    int height    = imageSize.height;
+    int tileCount = (height + RAW_TILE_HEIGHT - 1) / RAW_TILE_HEIGHT;
+
+    const Kernels_t& kernels = PipelineKernels::Get();
+
+    // the partial results are kept between frames (no allocation)
+    std::vector<rawDataPartial_t>& partials = m_RawDataPartials;
+    partials.resize(RAW_THREAD_COUNT);
+
+    for(int index = 0; index < (int)partials.size(); index ++)
+    {
+        partials[index].saturationFlag = false;
+        partials[index].pixelMax       = 0;
+        partials[index].maxBinaryValue = maxBinaryValue;
+        memset(partials[index].histogram, 0, sizeof(partials[index].histogram));
+        partials[index].biasedTile.resize(RAW_TILE_HEIGHT * width);
+    }
+
+    HISTOGRAM->Reset();
+
+    fullSensor.Reset();
+    darkOffset.fActive.Reset();
+    darkOffset.fBias.Reset();
+
+#ifdef OMP_PARAL
+#pragma omp parallel for ordered schedule(static, 1) num_threads(RAW_THREAD_COUNT)
+#endif
+    for(int tileIndex = 0; tileIndex < tileCount; tileIndex ++)
+    {
+        rawDataPartial_t& partial = partials[_GetThreadIndex()];
+
+        int firstLine = tileIndex * RAW_TILE_HEIGHT;
+        int lastLine  = MIN_VALUE(firstLine + RAW_TILE_HEIGHT, height);
+
+        int  areaStart[DARK_OFFSET_AREA_COUNT];
+        int  areaEnd[DARK_OFFSET_AREA_COUNT];
+        bool areaIsBias[DARK_OFFSET_AREA_COUNT];
+
+        for(int lineIndex = firstLine; lineIndex < lastLine; lineIndex ++)
+        {
+            int16* line       = &rawData[lineIndex * width];
+            int16* biasedLine = &partial.biasedTile[(lineIndex - firstLine) * width];
+
+            // saturation (before bias): the line is saturated when its maximum is
+            uint16 lineMax = kernels.MaxUnsigned(line, width);
+
+            if(lineMax >= saturationValue)
+            {
+                partial.saturationFlag = true;
+            }
+
+            partial.pixelMax = MAX_VALUE(partial.pixelMax, lineMax);
+
+            // bias
+            kernels.SubtractValue(biasedLine, line, iDarkCurrentBiasValue, width);
+
+            // dark image
+            if(darkData != NULL)
+            {
+                kernels.Subtract(line, biasedLine, &darkData[lineIndex * width], width);
+            }
+            else
+            {
+                memcpy(line, biasedLine, width * sizeof(int16));
+            }
+
+            // PRNU
+            if(pPrnuGain != NULL)
+            {
+                kernels.ScaleRound(line, line, &pPrnuGain[lineIndex * width], width);
+            }
+
+            // dark offset max value and histogram (after bias)
+            int areaCount = _GetDarkOffsetAreas(lineIndex, imageSize, areaStart, areaEnd, areaIsBias);
+
+            for(int area = 0; area < areaCount; area ++)
+            {
+                int16 areaMin, areaMax;
+                kernels.MinMax(&biasedLine[areaStart[area]], areaEnd[area] - areaStart[area], &areaMin, &areaMax);
+
+                partial.maxBinaryValue = MAX_VALUE(partial.maxBinaryValue, areaMax);
+
+                if(histogram != NULL)
+                {
+                    for(int i = areaStart[area]; i < areaEnd[area]; i ++)
+                    {
+                        partial.histogram[Histogram::Index(biasedLine[i])] ++;
+                    }
+                }
+            }
+        }
+
+#ifdef OMP_PARAL
+#pragma omp ordered
+#endif
+        {
+            for(int lineIndex = firstLine; lineIndex < lastLine; lineIndex ++)
+            {
+                const int16* biasedLine = &partial.biasedTile[(lineIndex - firstLine) * width];
+
+                for(int i = 0; i < width; i ++)
+                {
+                    fullSensor.Push(biasedLine[i]);
+                }
+
+                int areaCount = _GetDarkOffsetAreas(lineIndex, imageSize, areaStart, areaEnd, areaIsBias);
+
+                for(int area = 0; area < areaCount; area ++)
+                {
+                    MeasurementValue<float>& measurement = areaIsBias[area] ? darkOffset.fBias : darkOffset.fActive;
+
+                    for(int i = areaStart[area]; i < areaEnd[area]; i ++)
+                    {
+                        measurement.Push((float)biasedLine[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // merge thread results
+    for(int index = 0; index < (int)partials.size(); index ++)
+    {
+        saturationFlag = saturationFlag || partials[index].saturationFlag;
+        pixelMax       = MAX_VALUE(pixelMax, partials[index].pixelMax);
+        maxBinaryValue = MAX_VALUE(maxBinaryValue, partials[index].maxBinaryValue);
+
+        if(histogram != NULL)
+        {
+            for(int bin = 0; bin < HISTOGRAM_COUNT; bin ++)
+            {
+                histogram->count[bin] += partials[index].histogram[bin];
+            }
+        }
+    }
+}
+
 void PipelineCompute::SensorPrnuCorrection(
         int16* rawData,
         unsigned int rawDataSize,
-        std::vector<char>* gainArr,
-        float scaleFactor)
+        const float* pPrnuGain)
 {
     // Implement New PRNU correction here.
-    if((gainArr != NULL) &&
-       (gainArr->size() >= rawDataSize * sizeof(int16)))
+    if(pPrnuGain != NULL)
     {
         appendLogFile("Apply New PRNU Correction");
 
-        int16* pGainArr = (int16*)&gainArr->at(0);
-
-#pragma omp parallel for num_threads(4)
-        for(int Index=0; Index < (int)rawDataSize; Index++)
-        {
-            // rawData[Index] = (int16)round(rawData[Index] * (1 + ((float)(pGainArr[Index]) * scaleFactor)));
-            float tmp = (float)(pGainArr[Index]) * scaleFactor;
-            rawData[Index] = (int16)round(rawData[Index] * (1 + tmp));
-        }
+        // gain is 1 + prnu * scaleFactor (see PipelineGainMap)
+        PipelineKernels::Get().ScaleRound(rawData, rawData, pPrnuGain, (int)rawDataSize);
     }
 }
 
 void PipelineCompute::_SetImageConfiguration(const ImageSize& imageSize)
 {
+    ImageConfiguration previousConfiguration = m_ImageConfiguration;
+
     // check if the image size is not typical
-    if((imageSize.width   != _IMAGE_WIDTH) ||
-       (imageSize.height  != _IMAGE_HEIGHT) ||
+    // (compare with the reference, the current configuration may already be resized)
+    if((imageSize.width   != m_ImageConfigurationRef.image_width) ||
+       (imageSize.height  != m_ImageConfigurationRef.image_height) ||
        (imageSize.offsetX != 0) ||
        (imageSize.offsetY != 0))
     {
@@ -1405,7 +1722,26 @@ void PipelineCompute::_SetImageConfiguration(const ImageSize& imageSize)
         m_ImageConfiguration = m_ImageConfigurationRef;
     }
 
-    PipelineDefectCorrector::SetImageConfiguration(m_ImageConfiguration);
+    // linearization tables and compiled defect list depend on the geometry
+    // (a change of the defect list is detected by the key of the corrector)
+    if(_IsGeometryChanged(previousConfiguration, m_ImageConfiguration))
+    {
+        m_LinearizationCache.Invalidate();
+
+        m_DefectCorrector.SetImageConfiguration(m_ImageConfiguration);
+    }
+}
+
+bool PipelineCompute::_IsGeometryChanged(
+        const ImageConfiguration& previous,
+        const ImageConfiguration& current)
+{
+    return ((previous.image_width              != current.image_width) ||
+            (previous.image_height             != current.image_height) ||
+            (previous.active_horizontal_offset != current.active_horizontal_offset) ||
+            (previous.active_vertical_offset   != current.active_vertical_offset) ||
+            (previous.active_width             != current.active_width) ||
+            (previous.active_height            != current.active_height));
 }
 
 float PipelineCompute::_GetRadius(float fMaxAngle, const LinearizationCoef* pLinearizationFactor)
@@ -1429,3 +1765,18 @@ float PipelineCompute::_GetRadius(float fMaxAngle, const LinearizationCoef* pLin
     return sensorRadius;
 }
 
+void PipelineCompute::_StageStart()
+{
+    if(m_pStageTimes != NULL)
+    {
+        m_StageTimer.start();
+    }
+}
+
+void PipelineCompute::_StageEnd(PipelineStage_t eStage)
+{
+    if(m_pStageTimes != NULL)
+    {
+        m_pStageTimes->nsec[eStage] += m_StageTimer.nsecsElapsed();
+    }
+}
@@ -8,20 +8,46 @@
 #include "PipelineTypes.h"
 #include "PipelineComputeTypes.h"
 #include "imageConfiguration.h"
+#include "PipelineLinearizationCache.h"
+#include "PipelineGainMap.h"
+#include "PipelineDefectCorrector.h"
 
 #include "logger.h"
 
+#include <QElapsedTimer>
+
+/* Class PipelineCompute
+ * raw data and KLib data processing
+ *
+ * an instance holds all the state of the processing (image configuration,
+ * caches and scratch buffers), there is one instance per pipeline context
+ * so several frames can be processed at the same time with different instances
+ */
+
 class PipelineCompute
 {
-private:
-    static PipelineCompute* m_instance;
-    static PipelineCompute* getInstance();
+    // the image configuration is checked by PipelineTest
+    friend class PipelineComputeTest;
+
+public:
     PipelineCompute();
     ~PipelineCompute();
 
+private:
     ImageConfiguration m_ImageConfigurationRef;
     ImageConfiguration m_ImageConfiguration;
 
+    PipelineLinearizationCache m_LinearizationCache;
+    PipelineGainMap            m_GainMap;
+    PipelineDefectCorrector    m_DefectCorrector;
+
+    // per thread results of the fused raw data pass
+    std::vector<rawDataPartial_t> m_RawDataPartials;
+
+    // stage timing, disabled when m_pStageTimes is NULL
+    PipelineStageTimes_t* m_pStageTimes;
+    QElapsedTimer         m_StageTimer;
+
     Logger* m_logger;
 
     void appendLogFile(QString text){
@@ -29,19 +55,24 @@ private:
     }
 
 public:
-    static void SetLogger(Logger *logger);
+    void SetLogger(Logger *logger);
 
-    static void SetImageConfiguration(ImageConfiguration &imageConfiguration);
+    void SetImageConfiguration(ImageConfiguration &imageConfiguration);
 
-    static int GetCalibratedDataSize(short calibratedDataRadius);
+    int GetCalibratedDataSize(short calibratedDataRadius);
 
-    static Error_t ComputeRawData(
+    // accumulate the time of each stage in pStageTimes (NULL to disable)
+    void SetStageTimes(PipelineStageTimes_t* pStageTimes);
+
+    static const char* GetStageName(PipelineStage_t eStage);
+
+    Error_t ComputeRawData(
             int16*                              rawData,
             const Pipeline_RawDataParam *param,
             Histogram*                          pHistogram,
             Pipeline_ResultRawDataParam &resultParam);
 
-    static Error_t ComputeKLibData(const Pipeline_KLibDataParam &param,
+    Error_t ComputeKLibData(const Pipeline_KLibDataParam &param,
             Pipeline_CalibrationParam *calibration,
             const Pipeline_DataIn *rawData,
             Pipeline_DataOut *calibDataOut,
@@ -62,18 +93,14 @@ private:
             int16* calibratedData);
 
 private:
-    static int MXLinearizeAndFlatField(int16*  pintSource,
+    int MXLinearizeAndFlatField(int16*  pintSource,
             long    lSourceWidth,
             long    lSize,
             float   fMaxAngle,
             Point center,
             const LinearizationCoef *plinearizationFactor,
-            int16*  pintFlatField,
-            long    lSize2,
-            long    lScaleFactor,
-            int16*  pintTarget,
-            bool*   flatFieldPrecomputed,
-            bool    applyFlatField);
+            const float* pFlatFieldGain,
+            int16*  pintTarget);
 
     static Error_t PrecomputeLinearizationTables(long    lTargetWidth,
             long    lTargetHeight,
@@ -84,14 +111,6 @@ private:
             Point center,
             precomputedData_t** ppPrecomputedData);
 
-    static Error_t PrecomputeFlatFieldInverse(
-            int16*  pint16Denominator,
-            long    lScaleFactor,
-            long    lSize,
-            bool*   flatFieldPrecomputed,
-            bool    applyFlatField,
-            precomputedData_t* pPrecomputedData);
-
     static Error_t MXLinearize(int16* pintSource,
             long    lSourceWidth,
             long    lSize,
@@ -129,15 +148,43 @@ private:
             DarkOffset &darkOffset,
             int16& maxBinaryValue);
 
+    void FusedRawDataCorrection(
+            int16* rawData,
+            const ImageSize &imageSize,
+            uint16 saturationValue,
+            int iDarkCurrentBiasValue,
+            const int16* darkData,
+            const float* pPrnuGain,
+            Histogram* histogram,
+            bool &saturationFlag,
+            uint16 &pixelMax,
+            MeasurementValue<float> &fullSensor,
+            DarkOffset &darkOffset,
+            int16 &maxBinaryValue);
+
+    int _GetDarkOffsetAreas(
+            int lineIndex,
+            const ImageSize &imageSize,
+            int areaStart[DARK_OFFSET_AREA_COUNT],
+            int areaEnd[DARK_OFFSET_AREA_COUNT],
+            bool areaIsBias[DARK_OFFSET_AREA_COUNT]);
+
     void SensorPrnuCorrection(
             int16* rawData,
             unsigned int rawDataSize,
-            std::vector<char> *gainArr,
-            float scaleFactor);
+            const float* pPrnuGain);
 
     void _SetImageConfiguration(const ImageSize &imageSize);
 
+    static bool _IsGeometryChanged(
+            const ImageConfiguration& previous,
+            const ImageConfiguration& current);
+
     float _GetRadius(float fMaxAngle, const LinearizationCoef *pLinearizationFactor);
+
+    void _StageStart();
+
+    void _StageEnd(PipelineStage_t eStage);
 };
 
 #endif PIPELINECOMPUTE_H
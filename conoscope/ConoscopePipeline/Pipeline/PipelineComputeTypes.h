@@ -4,14 +4,41 @@
 #define COMPUTE_PARAM
 
 #include <stdlib.h>
+#include <vector>
 #include "PipelineHistogram.h"
 #include "PipelineDefines.h"
 
 typedef struct {
     float linearizationTableX;
     float linearizationTableY;
-    FLAT_FIELD_INVERSE_TYPE flatFieldInverse;
     bool linearizationRadius;
 } precomputedData_t;
 
+typedef struct {
+    bool   saturationFlag;
+    uint16 pixelMax;
+    int16  maxBinaryValue;
+    int32  histogram[HISTOGRAM_COUNT];
+    std::vector<int16> biasedTile;
+} rawDataPartial_t;
+
+// stages timed by PipelineCompute (see PipelineCompute::SetStageTimes)
+typedef enum {
+    PipelineStage_WrongBands,
+    PipelineStage_DefectCorrection,
+    PipelineStage_BiasCompensation,
+    PipelineStage_PrnuGain,
+    PipelineStage_RawCorrection,
+    PipelineStage_FlatFieldGain,
+    PipelineStage_LinearizationTables,
+    PipelineStage_Linearization,
+    PipelineStage_ViewingAngle,
+    PipelineStage_Count
+} PipelineStage_t;
+
+// time spent in each stage (nanoseconds), accumulated over the calls
+typedef struct {
+    int64 nsec[PipelineStage_Count];
+} PipelineStageTimes_t;
+
 #endif PIPELINECOMPUTETYPES_H
@@ -1,9 +1,14 @@
 #include "PipelineDefectCorrector.h"
+#include "PipelineHash.h"
 
 #define OMP_PARAL
 
 #define NEIGHBOR_DISTANCE 1
 #define NEIGHBOR_ARRAY_SIZE(x) (x*2+1)*(x*2+1)
+#define NEIGHBOR_BIT(index) (1 << (index))
+
+#define DEFECT_MAP_SHIFT 5
+#define DEFECT_MAP_MASK  31
 
 #define _ACTIVE_WIDTH                  m_ImageConfiguration.active_width
 #define _ACTIVE_HEIGHT                 m_ImageConfiguration.active_height
@@ -15,32 +20,34 @@
 
 #define appendLogFile(text) if(mLogger) mLogger->Append(text)
 
-PipelineDefectCorrector* PipelineDefectCorrector::m_instance = NULL;
-
 PipelineDefectCorrector::PipelineDefectCorrector()
 {
     mLogger = NULL;
+    mCompiledKey = 0;
 }
 
-#define INSTANCE(instance) PipelineDefectCorrector* instance = PipelineDefectCorrector::getInstance()
-
 void PipelineDefectCorrector::SetImageConfiguration(
        ImageConfiguration& imageConfiguration)
 {
-    INSTANCE(instance);
-    instance->m_ImageConfiguration = imageConfiguration;
+    m_ImageConfiguration = imageConfiguration;
+
+    // the compiled defect list depends on the image dimensions
+    mCompiledKey = 0;
 }
 
 void PipelineDefectCorrector::SetLogger(Logger* logger)
 {
-    INSTANCE(instance);
-    instance->mLogger = logger;
+    mLogger = logger;
 }
 
 bool PipelineDefectCorrector::Correct(int16* rawData, const ImageSize &size, const std::vector<Defect>* defectPixels)
 {
-    INSTANCE(instance);
-    return instance->_Correct(rawData, size, defectPixels);
+    return _Correct(rawData, size, defectPixels);
+}
+
+bool PipelineDefectCorrector::IsCompiled() const
+{
+    return (mCompiledKey != 0);
 }
 
 bool PipelineDefectCorrector::_Correct(
@@ -48,32 +55,127 @@ bool PipelineDefectCorrector::_Correct(
         const ImageSize& size,
         const std::vector<Defect>* defectPixels)
 {
-    mSize.Set(size);
-    mSensorDefects_pixels = defectPixels;
-
     appendLogFile("Apply Defects Correction");
     //Check list of defective pixels and correct value with neighbourhood
-    //To be Done: Need to think about cluster of several pixels
 
-    // get pointer to defectpixels
+    // the defect list is compiled once (defect map and neighbors to use)
+    // and reused as long as the list and the image size do not change
+    uint64 key = _GetKey(size, defectPixels);
+
+    if((key != mCompiledKey) || (mCompiledKey == 0))
+    {
+        _Compile(size, defectPixels);
+        mCompiledKey = key;
+    }
+
+    int correctionCount = (int)mCorrections.size();
+
+    // a defective pixel is never used as a neighbor so each correction only reads
+    // pixels that are not modified: all the values are computed from the genuine
+    // image then written, the result does not depend on the order of the defects
 #ifdef OMP_PARAL
 #pragma omp parallel for num_threads(4)
 #endif
+    for(int i = 0; i < correctionCount; i++)
+    {
+        const DefectCorrection_t& correction = mCorrections[i];
+
+        int32 iSum = 0;
+        int   nbGoodValues = 0;
+
+        for(int neighbor = 0; neighbor < NEIGHBOR_ARRAY_SIZE(NEIGHBOR_DISTANCE); neighbor++)
+        {
+            // If this pixel is good
+            if(correction.validMask & NEIGHBOR_BIT(neighbor))
+            {
+                iSum += rawData[correction.readPosition + mNeighborOffset[neighbor]];
+                nbGoodValues++;
+            }
+        }
+
+        // Average of good values (corrections without good value are not compiled)
+        mCorrectedValues[i] = (int16)(iSum / nbGoodValues);
+    }
+
+    for(int i = 0; i < correctionCount; i++)
+    {
+        rawData[mCorrections[i].writePosition] = mCorrectedValues[i];
+    }
+
+    return true;
+}
+
+uint64 PipelineDefectCorrector::_GetKey(
+        const ImageSize& size,
+        const std::vector<Defect>* defectPixels)
+{
+    uint64 key = HASH_INIT;
+
+    HASH(key, size.width);
+    HASH(key, size.height);
+    HASH(key, size.offsetX);
+    HASH(key, size.offsetY);
+
+    for(int i = 0; i < (int)defectPixels->size(); i++)
+    {
+        HASH(key, defectPixels->at(i).coord.x);
+        HASH(key, defectPixels->at(i).coord.y);
+    }
+
+    return key;
+}
+
+void PipelineDefectCorrector::_Compile(
+        const ImageSize& size,
+        const std::vector<Defect>* defectPixels)
+{
+    appendLogFile("Compile Defects List");
+
+    mSize.Set(size);
+
+    // defect map
+    int imageSize = _IMAGE_WIDTH * _IMAGE_HEIGHT;
+
+    mDefectMap.assign((imageSize >> DEFECT_MAP_SHIFT) + 1, 0);
+
+    for(int i = 0; i < (int)defectPixels->size(); i++)
+    {
+        const Point& coord = defectPixels->at(i).coord;
+
+        if((coord.x >= 0) && (coord.x < _IMAGE_WIDTH) &&
+           (coord.y >= 0) && (coord.y < _IMAGE_HEIGHT))
+        {
+            int position = (int)coord.y * _IMAGE_WIDTH + (int)coord.x;
+            mDefectMap[position >> DEFECT_MAP_SHIFT] |= (1u << (position & DEFECT_MAP_MASK));
+        }
+    }
+
+    // position of the neighbors
+    int index = 0;
+
+    for(int yIndex = -NEIGHBOR_DISTANCE; yIndex <= NEIGHBOR_DISTANCE; yIndex ++)
+    {
+        for(int xIndex = -NEIGHBOR_DISTANCE; xIndex <= NEIGHBOR_DISTANCE; xIndex ++)
+        {
+            mNeighborOffset[index] = yIndex * _IMAGE_WIDTH + xIndex;
+            index ++;
+        }
+    }
 
+    // corrections
     int minX = size.offsetX;
     int maxX = size.offsetX + size.width;
     int minY = size.offsetY;
     int maxY = size.offsetY + size.height;
 
-    for(int i=0; i < (int)mSensorDefects_pixels->size(); i++)
-    {
-        // int iPosition = mSensorDefects->pixels[i].x + (mSensorDefects->pixels[i].y * size.width);
-        // debugPrint("Before correction : " + rawData[iPosition]);
+    mCorrections.clear();
+    mCorrections.reserve(defectPixels->size());
 
-        Defect defectPixel = mSensorDefects_pixels->at(i);
+    for(int i = 0; i < (int)defectPixels->size(); i++)
+    {
+        Defect defectPixel = defectPixels->at(i);
 
         // check whether pixel is in the rawData
-
         if((defectPixel.coord.x >= minX) && (defectPixel.coord.x < maxX) &&
            (defectPixel.coord.y >= minY) && (defectPixel.coord.y < maxY))
         {
@@ -81,44 +183,33 @@ bool PipelineDefectCorrector::_Correct(
             defectPixel.coord.x -= size.offsetX;
             defectPixel.coord.y -= size.offsetY;
 
-            int* crashPointer = 0;
-            if(defectPixel.coord.x < 0)
-            {
-                *crashPointer = 0;
-            }
-            if(defectPixel.coord.y < 0)
-            {
-                *crashPointer = 0;
-            }
+            DefectCorrection_t correction;
 
-            correctDefectivePixel(rawData, defectPixel.coord);
+            correction.readPosition  = (int)defectPixel.coord.y * _IMAGE_WIDTH + (int)defectPixel.coord.x;
+            correction.writePosition = (int)defectPixel.coord.y * mSize.width + (int)defectPixel.coord.x;
+            correction.validMask     = getNeighborMask(defectPixel.coord);
 
-            // debugPrint("After correction : " + rawData[iPosition]);
+            // To avoid division by zero
+            if(correction.validMask != 0)
+            {
+                mCorrections.push_back(correction);
+            }
         }
     }
 
-    return true;
+    mCorrectedValues.resize(mCorrections.size());
 }
 
-void PipelineDefectCorrector::correctDefectivePixel(int16* rawData, Point pixel)
+uint16 PipelineDefectCorrector::getNeighborMask(Point pixel)
 {
-    mRawData = rawData;
-
-    int32 iSum = 0.0;
-    int   nbGoodValues = 0;
-
-    int16 iNeighborPixelValue[NEIGHBOR_ARRAY_SIZE(NEIGHBOR_DISTANCE)] = {0};
-    bool  bNeighborPixelValid[NEIGHBOR_ARRAY_SIZE(NEIGHBOR_DISTANCE)] = {false};
-
-    // Get value and validity of each neighboor pixels
-    getNeighborPixels(NEIGHBOR_DISTANCE, iNeighborPixelValue, bNeighborPixelValid, pixel);
+    uint16 validMask = 0;
 
     // [0][1][2]
     // [3][4][5]
     // [6][7][8]
     //
-    // false = invalid
-    // true  = valid
+    // bit cleared = invalid
+    // bit set     = valid
     //
     // +---------------------------+
     // |                           |
@@ -132,20 +223,23 @@ void PipelineDefectCorrector::correctDefectivePixel(int16* rawData, Point pixel)
     // |   |                   |   |
     // +---+-------------------+---+
 
-    /*
-    debugPrint("x=" + x + ";y=" + y);
-    debugPrint("Initial value");
-    debugPrint("---------");
-    debugPrint("[" + iNeighboorPixelValue[0] + "][" + iNeighboorPixelValue[1] + "][" + iNeighboorPixelValue[2] + "]");
-    debugPrint("[" + iNeighboorPixelValue[3] + "][" + iNeighboorPixelValue[4] + "][" + iNeighboorPixelValue[5] + "]");
-    debugPrint("[" + iNeighboorPixelValue[6] + "][" + iNeighboorPixelValue[7] + "][" + iNeighboorPixelValue[8] + "]");
-    debugPrint("---------");
-    debugPrint("Before");
-    debugPrint("[" + bNeighboorPixelValid[0] ? "o" : "#" + "][" + bNeighboorPixelValid[1] ? "o" : "#" + "][" + bNeighboorPixelValid[2] ? "o" : "#" + "]");
-    debugPrint("[" + bNeighboorPixelValid[3] ? "o" : "#" + "][" + bNeighboorPixelValid[4] ? "o" : "#" + "][" + bNeighboorPixelValid[5] ? "o" : "#" + "]");
-    debugPrint("[" + bNeighboorPixelValid[6] ? "o" : "#" + "][" + bNeighboorPixelValid[7] ? "o" : "#" + "][" + bNeighboorPixelValid[8] ? "o" : "#" + "]");
-    debugPrint("---------");
-    */
+    int index = 0;
+
+    for(int yIndex = pixel.y - NEIGHBOR_DISTANCE; yIndex <= pixel.y + NEIGHBOR_DISTANCE; yIndex ++)
+    {
+        for(int xIndex = pixel.x - NEIGHBOR_DISTANCE; xIndex <= pixel.x + NEIGHBOR_DISTANCE; xIndex ++)
+        {
+            // the pixel must exist and not be defective
+            if((xIndex >= 0) && (xIndex < _IMAGE_WIDTH) &&
+               (yIndex >= 0) && (yIndex < _IMAGE_HEIGHT) &&
+               (isDefective(xIndex, yIndex) == false))
+            {
+                validMask |= NEIGHBOR_BIT(index);
+            }
+
+            index ++;
+        }
+    }
 
 #ifdef DEFECT_ON_ACTIVE_AREA
     // desactive some pixels depending on the location of the pixel
@@ -154,26 +248,20 @@ void PipelineDefectCorrector::correctDefectivePixel(int16* rawData, Point pixel)
        (pixel.x < _ACTIVE_HORIZONTAL_OFFSET + _ACTIVE_WIDTH))
     {
         // A segment
-        bNeighborPixelValid[0] = false;
-        bNeighborPixelValid[1] = false;
-        bNeighborPixelValid[2] = false;
+        validMask &= ~(NEIGHBOR_BIT(0) | NEIGHBOR_BIT(1) | NEIGHBOR_BIT(2));
     }
 
     if((pixel.x == _ACTIVE_HORIZONTAL_OFFSET) &&
        (pixel.y >= _ACTIVE_VERTICAL_OFFSET))
     {
         // B segment
-        bNeighborPixelValid[0] = false;
-        bNeighborPixelValid[3] = false;
-        bNeighborPixelValid[6] = false;
+        validMask &= ~(NEIGHBOR_BIT(0) | NEIGHBOR_BIT(3) | NEIGHBOR_BIT(6));
     }
     else if((pixel.x == _ACTIVE_HORIZONTAL_OFFSET + _ACTIVE_WIDTH - 1) &&
             (pixel.y >= _ACTIVE_VERTICAL_OFFSET))
     {
         // C segment
-        bNeighborPixelValid[2] = false;
-        bNeighborPixelValid[5] = false;
-        bNeighborPixelValid[8] = false;
+        validMask &= ~(NEIGHBOR_BIT(2) | NEIGHBOR_BIT(5) | NEIGHBOR_BIT(8));
     }
 #else
     // desactive some pixels depending on the location of the pixel
@@ -182,139 +270,35 @@ void PipelineDefectCorrector::correctDefectivePixel(int16* rawData, Point pixel)
        (pixel.x < _IMAGE_WIDTH))
     {
         // A segment
-        bNeighborPixelValid[0] = false;
-        bNeighborPixelValid[1] = false;
-        bNeighborPixelValid[2] = false;
+        validMask &= ~(NEIGHBOR_BIT(0) | NEIGHBOR_BIT(1) | NEIGHBOR_BIT(2));
     }
 
     if((pixel.x == 0) &&
        (pixel.y >= 0))
     {
         // B segment
-        bNeighborPixelValid[0] = false;
-        bNeighborPixelValid[3] = false;
-        bNeighborPixelValid[6] = false;
+        validMask &= ~(NEIGHBOR_BIT(0) | NEIGHBOR_BIT(3) | NEIGHBOR_BIT(6));
     }
     else if((pixel.x == _IMAGE_WIDTH - 1) &&
             (pixel.y >= 0))
     {
         // C segment
-        bNeighborPixelValid[2] = false;
-        bNeighborPixelValid[5] = false;
-        bNeighborPixelValid[8] = false;
+        validMask &= ~(NEIGHBOR_BIT(2) | NEIGHBOR_BIT(5) | NEIGHBOR_BIT(8));
     }
 #endif
 
-    /*
-    debugPrint("---------");
-    debugPrint("After");
-    debugPrint("[" + bNeighboorPixelValid[0] ? "o" : "#" + "][" + bNeighboorPixelValid[1] ? "o" : "#" + "][" + bNeighboorPixelValid[2] ? "o" : "#" + "]");
-    debugPrint("[" + bNeighboorPixelValid[3] ? "o" : "#" + "][" + bNeighboorPixelValid[4] ? "o" : "#" + "][" + bNeighboorPixelValid[5] ? "o" : "#" + "]");
-    debugPrint("[" + bNeighboorPixelValid[6] ? "o" : "#" + "][" + bNeighboorPixelValid[7] ? "o" : "#" + "][" + bNeighboorPixelValid[8] ? "o" : "#" + "]");
-    debugPrint("---------");
-    */
-
-    // For each neighbor pixels
-    for(int i = 0; i < NEIGHBOR_ARRAY_SIZE(NEIGHBOR_DISTANCE); i++)
-    {
-        // If this pixel is good
-        if (bNeighborPixelValid[i] == true)
-        {
-            iSum += iNeighborPixelValue[i];
-            nbGoodValues++;
-        }
-    }
-
-    // To avoid division by zero
-    if (nbGoodValues > 0)
-    {
-        // Average of good values
-        int iPosition = (int)pixel.y * mSize.width + (int)pixel.x;
-
-        mRawData[iPosition] = (int16)(iSum / nbGoodValues);
-
-        /*
-        debugPrint("Sum :" + iSum  + "| Good values :" + nbGoodValues);
-        debugPrint("Final result");
-        debugPrint("---------");
-        debugPrint("[" + iNeighboorPixelValue[0] + "][" + iNeighboorPixelValue[1] + "][" + iNeighboorPixelValue[2] + "]");
-        debugPrint("[" + iNeighboorPixelValue[3] + "][" + iNeighboorPixelValue[4] + "][" + iNeighboorPixelValue[5] + "]");
-        debugPrint("[" + iNeighboorPixelValue[6] + "][" + iNeighboorPixelValue[7] + "][" + iNeighboorPixelValue[8] + "]");
-        debugPrint("---------");
-        */
-    }
+    return validMask;
 }
 
-bool PipelineDefectCorrector::getNeighborPixels(
-        int    neighborDistance,
-        int16* iPixelValue,
-        bool*  bPixelValid,
-        Point  pixel)
-{
-    // Set all pixels to zero and invalid
-    std::memset(iPixelValue, 0, NEIGHBOR_ARRAY_SIZE(neighborDistance) * sizeof(int16));
-    std::memset(bPixelValid, 0, NEIGHBOR_ARRAY_SIZE(neighborDistance) * sizeof(bool));
-
-    int xMin = pixel.x - neighborDistance;
-    int xMax = pixel.x + neighborDistance;
-
-    int yMin = pixel.y - neighborDistance;
-    int yMax = pixel.y + neighborDistance;
-
-    int index = 0;
-
-    for(int yIndex = yMin; yIndex <= yMax; yIndex ++)
-    {
-        for(int xIndex = xMin; xIndex <= xMax; xIndex ++)
-        {
-            bPixelValid[index] = getPixelValue(xIndex, yIndex, &iPixelValue[index]);
-            index ++;
-        }
-    }
-
-    return true;
-}
-
-bool PipelineDefectCorrector::getPixelValue(short x, short y, int16* value)
+bool PipelineDefectCorrector::isDefective(short x, short y)
 {
-    bool res = true;
-
-    // If this pixel does not exist
     if((x < 0) || (x >= _IMAGE_WIDTH) ||
        (y < 0) || (y >= _IMAGE_HEIGHT))
     {
-        *value = 0;
-        res = false;
-    }
-    else
-    {
-        // Get the value of this pixel
-        int iPosition = (int)y * _IMAGE_WIDTH + (int)x;
-
-        *value = mRawData[iPosition];
-
-        res = !this->isDefective(x, y);
+        return false;
     }
 
-    return res;
-}
-
-bool PipelineDefectCorrector::isDefective(short x, short y)
-{
-    Defect defectPixel;
-
-    // For each defective pixel
-    for(int i = 0; i < (int)mSensorDefects_pixels->size(); i++)
-    {
-        defectPixel = mSensorDefects_pixels->at(i);
-
-        // If it is the requested pixel
-        if((defectPixel.coord.x == x) &&
-           (defectPixel.coord.y == y))
-        {
-            return true;
-        }
-    }
+    int position = (int)y * _IMAGE_WIDTH + (int)x;
 
-    return false;
+    return ((mDefectMap[position >> DEFECT_MAP_SHIFT] >> (position & DEFECT_MAP_MASK)) & 1) != 0;
 }
@@ -1,62 +1,70 @@
 #ifndef STORMHOLDDEFECTCORRECTOR_H
 #define STORMHOLDDEFECTCORRECTOR_H
 
+#include <vector>
+
 #include "logger.h"
 #include "imageConfiguration.h"
 
 #include "PipelineTypes.h"
 #include "PipelineHistogram.h"
 
+/* Class PipelineDefectCorrector
+ * correct the defective pixels with the average of their valid neighbors
+ *
+ * there is one instance per pipeline context (see PipelineCompute)
+ */
+
 class PipelineDefectCorrector
 {
-private:
-    static PipelineDefectCorrector* m_instance;
-
+public:
     PipelineDefectCorrector();
 
-    static PipelineDefectCorrector* PipelineDefectCorrector::getInstance()
-    {
-        if(m_instance == NULL)
-        {
-            m_instance = new PipelineDefectCorrector();
-        }
-
-        return m_instance;
-    }
+    void SetImageConfiguration(ImageConfiguration &imageConfiguration);
 
-    ImageConfiguration m_ImageConfiguration;
+    void SetLogger(Logger* logger);
 
-public:
-    static void SetImageConfiguration(ImageConfiguration &imageConfiguration);
+    bool Correct(int16* rawData, const ImageSize &size, const std::vector<Defect> *defectPixels);
 
-    static void SetLogger(Logger* logger);
+    // the defect list is compiled (not done again until the list or the geometry change)
+    bool IsCompiled() const;
 
-    static bool Correct(int16* rawData, const ImageSize &size, const std::vector<Defect> *defectPixels);
+private:
+    ImageConfiguration m_ImageConfiguration;
 
 // protected:
 private:
+    // correction of one defective pixel, built once per defect list
+    typedef struct {
+        int    readPosition;    // position in the image, neighbors are read around it
+        int    writePosition;   // position in rawData
+        uint16 validMask;       // bit i is set if neighbor i is used
+    } DefectCorrection_t;
+
     Logger*             mLogger;
-    int16*              mRawData;
     ImageSize           mSize;
-    const std::vector<Defect>*   mSensorDefects_pixels;
+
+    // compiled defect list
+    uint64                          mCompiledKey;
+    std::vector<uint32>             mDefectMap;         // one bit per image pixel
+    std::vector<DefectCorrection_t> mCorrections;
+    std::vector<int16>              mCorrectedValues;
+    int                             mNeighborOffset[9];
 
     bool _Correct(
             int16* rawData,
             const ImageSize &size,
             const std::vector<Defect> *defectPixels);
 
-    void correctDefectivePixel(int16 *rawData, Point pixel);
+    uint64 _GetKey(
+            const ImageSize &size,
+            const std::vector<Defect> *defectPixels);
 
-    bool getNeighborPixels(
-            int neighborDistance,
-            int16 iNeighboorPixelValue[9],
-            bool bNeighboorPixelValid[9],
-            Point pixel);
+    void _Compile(
+            const ImageSize &size,
+            const std::vector<Defect> *defectPixels);
 
-    bool getPixelValue(
-            short x,
-            short y,
-            int16* value);
+    uint16 getNeighborMask(Point pixel);
 
     bool isDefective(short x, short y);
 };
@@ -47,6 +47,26 @@ typedef enum
 
 #define SENSOR_SATURATION 13104
 
+// number of linearization tables kept in memory
+// (one per calibration, i.e. per capture sequence filter)
+#define LINEARIZATION_CACHE_SIZE 4
+
+// number of gain maps kept in memory
+#define PRNU_GAIN_CACHE_SIZE       1
+#define FLAT_FIELD_GAIN_CACHE_SIZE 4
+
+// raw data is processed by tiles of lines (a tile fits in L2 cache)
+#define RAW_TILE_HEIGHT  16
+#define RAW_THREAD_COUNT 4
+
+// linearization output is processed by tiles of REMAP_TILE_WIDTH x REMAP_TILE_HEIGHT pixels
+// (coordinates, gain, output and source pixels of a tile ~ 260 KB, i.e. L2 cache)
+#define REMAP_TILE_WIDTH  1024
+#define REMAP_TILE_HEIGHT 16
+
+// maximum number of dark offset areas in a line (bias left, bias right, central)
+#define DARK_OFFSET_AREA_COUNT 3
+
 // #define SQUARE(Value) ((Value)*(Value))
 
 #define USE_NEW_IMPLEMENTATION
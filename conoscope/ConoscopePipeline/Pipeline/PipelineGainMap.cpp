@@ -0,0 +1,157 @@
+#include "PipelineGainMap.h"
+
+#include <algorithm>
+
+#include "PipelineDefines.h"
+#include "PipelineHash.h"
+
+#define OMP_PARAL
+
+PipelineGainMap::PipelineGainMap()
+{
+    Invalidate();
+}
+
+const float* PipelineGainMap::GetPrnuGain(
+        uint64 id,
+        const std::vector<char>* prnuData,
+        float  scaleFactor,
+        int    nbPixels)
+{
+    if((prnuData == NULL) ||
+       (prnuData->size() < nbPixels * sizeof(int16)))
+    {
+        return NULL;
+    }
+
+    uint64 key = HASH_INIT;
+    HASH(key, id);
+    HASH(key, scaleFactor);
+    HASH(key, nbPixels);
+
+    GainEntry_t* entry = NULL;
+
+    if(id != 0)
+    {
+        entry = _Find(mPrnuGain, key);
+    }
+
+    if(entry == NULL)
+    {
+        entry = _Add(mPrnuGain, (id != 0) ? key : 0, PRNU_GAIN_CACHE_SIZE);
+        entry->gain.resize(nbPixels);
+
+        const int16* pGainArr = (const int16*)prnuData->data();
+        float* pGain = entry->gain.data();
+
+        // same float operations than the genuine correction so result is unchanged
+#ifdef OMP_PARAL
+#pragma omp parallel for num_threads(4)
+#endif
+        for(int index = 0; index < nbPixels; index ++)
+        {
+            float tmp = (float)(pGainArr[index]) * scaleFactor;
+            pGain[index] = 1 + tmp;
+        }
+    }
+
+    return entry->gain.data();
+}
+
+const float* PipelineGainMap::GetFlatFieldGain(
+        uint64 id,
+        const int16* flatField,
+        long   lScaleFactor,
+        long   lSize,
+        bool   applyFlatField)
+{
+    uint64 key = HASH_INIT;
+    HASH(key, id);
+    HASH(key, lScaleFactor);
+    HASH(key, lSize);
+    HASH(key, applyFlatField);
+
+    GainEntry_t* entry = NULL;
+
+    if(id != 0)
+    {
+        entry = _Find(mFlatFieldGain, key);
+    }
+
+    if(entry == NULL)
+    {
+        entry = _Add(mFlatFieldGain, (id != 0) ? key : 0, FLAT_FIELD_GAIN_CACHE_SIZE);
+        entry->gain.resize(lSize);
+
+        float* pGain = entry->gain.data();
+
+        if(applyFlatField == true)
+        {
+#ifdef OMP_PARAL
+#pragma omp parallel for num_threads(4)
+#endif
+            for(long lIndex = 0; lIndex < lSize; lIndex ++)
+            {
+                if (flatField[lIndex] != 0)
+                {
+                    pGain[lIndex] = (float)((double)lScaleFactor / ((double)flatField[lIndex]));
+                }
+                else
+                {
+                    pGain[lIndex] = 0;
+                }
+            }
+        }
+        else
+        {
+            std::fill(entry->gain.begin(), entry->gain.end(), 1.0f);
+        }
+    }
+
+    return entry->gain.data();
+}
+
+void PipelineGainMap::Invalidate()
+{
+    mPrnuGain.clear();
+    mFlatFieldGain.clear();
+}
+
+PipelineGainMap::GainEntry_t* PipelineGainMap::_Find(std::list<GainEntry_t>& entries, uint64 key)
+{
+    for(std::list<GainEntry_t>::iterator it = entries.begin(); it != entries.end(); it ++)
+    {
+        if(it->key == key)
+        {
+            // most recently used entry first
+            entries.splice(entries.begin(), entries, it);
+            return &entries.front();
+        }
+    }
+
+    return NULL;
+}
+
+PipelineGainMap::GainEntry_t* PipelineGainMap::_Add(std::list<GainEntry_t>& entries, uint64 key, int maxCount)
+{
+    // an entry without id is never reused, overwrite the previous one
+    if(key == 0)
+    {
+        GainEntry_t* entry = _Find(entries, 0);
+
+        if(entry != NULL)
+        {
+            return entry;
+        }
+    }
+
+    entries.push_front(GainEntry_t());
+    entries.front().key = key;
+
+    while((int)entries.size() > maxCount)
+    {
+        entries.pop_back();
+    }
+
+    return &entries.front();
+}
@@ -0,0 +1,54 @@
+#ifndef PIPELINEGAINMAP_H
+#define PIPELINEGAINMAP_H
+
+#include <vector>
+#include <list>
+
+#include "Types.h"
+
+/* Class PipelineGainMap
+ * precomputed per pixel multiplicative gains
+ *
+ * - PRNU gain (sensor space)       : 1 + prnu * scaleFactor
+ * - flat field gain (output space) : flatFieldScale / flatField
+ *
+ * gains are stored as float and identified by the calibration id provided
+ * by the caller (camera serial, iris, filter, nd). When the id is 0 the gain
+ * is computed again for each call.
+ */
+
+class PipelineGainMap
+{
+public:
+    PipelineGainMap();
+
+    const float* GetPrnuGain(
+            uint64  id,
+            const std::vector<char>* prnuData,
+            float   scaleFactor,
+            int     nbPixels);
+
+    const float* GetFlatFieldGain(
+            uint64  id,
+            const int16* flatField,
+            long    lScaleFactor,
+            long    lSize,
+            bool    applyFlatField);
+
+    void Invalidate();
+
+private:
+    typedef struct {
+        uint64             key;
+        std::vector<float> gain;
+    } GainEntry_t;
+
+    std::list<GainEntry_t> mPrnuGain;
+    std::list<GainEntry_t> mFlatFieldGain;
+
+    GainEntry_t* _Find(std::list<GainEntry_t>& entries, uint64 key);
+
+    GainEntry_t* _Add(std::list<GainEntry_t>& entries, uint64 key, int maxCount);
+};
+
+#endif // PIPELINEGAINMAP_H
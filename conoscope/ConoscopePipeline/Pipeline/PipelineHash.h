@@ -0,0 +1,27 @@
+#ifndef PIPELINEHASH_H
+#define PIPELINEHASH_H
+
+#include <stddef.h>
+#include "Types.h"
+
+// FNV-1a hash used to build cache keys
+
+#define HASH_INIT        14695981039346656037ULL
+#define HASH_PRIME       1099511628211ULL
+
+#define HASH(hash, value) hash = PipelineHash(hash, &(value), sizeof(value))
+
+inline uint64 PipelineHash(uint64 hash, const void* data, size_t size)
+{
+    const uint8* pData = (const uint8*)data;
+
+    for(size_t index = 0; index < size; index ++)
+    {
+        hash ^= pData[index];
+        hash *= HASH_PRIME;
+    }
+
+    return hash;
+}
+
+#endif // PIPELINEHASH_H
@@ -34,6 +34,11 @@ public:
     }
 
     void Add(int16 value)
+    {
+        count[Index(value)] ++;
+    }
+
+    static int Index(int16 value)
     {
         int index = 0;
 
@@ -50,7 +55,7 @@ public:
             index = (int)floor((double)value / ((double)PIXEL_SATURATION/255))+1;
         }
 
-        count[index] ++;
+        return index;
     }
 };
 
@@ -0,0 +1,147 @@
+#include "PipelineKernels.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+KernelIsa_t PipelineKernels::mIsa     = KernelIsa_Scalar;
+Kernels_t   PipelineKernels::mKernels[KernelIsa_Count];
+
+#define CPUID1_ECX_SSE41   (1 << 19)
+#define CPUID1_ECX_OSXSAVE (1 << 27)
+#define CPUID1_ECX_AVX     (1 << 28)
+#define CPUID7_EBX_AVX2    (1 << 5)
+
+#define XCR0_SSE_AVX_STATE 0x6
+
+static void _Cpuid(int leaf, int subLeaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, leaf, subLeaf);
+
+    for(int index = 0; index < 4; index ++)
+    {
+        regs[index] = (unsigned int)info[index];
+    }
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    __get_cpuid_count(leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+}
+
+static uint64 _Xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64)edx << 32) | eax;
+#endif
+}
+
+void PipelineKernels::Initialise()
+{
+    // filled once, a concurrent first call waits for it
+    static bool bReady = [] ()
+    {
+        PipelineKernels_Scalar(mKernels[KernelIsa_Scalar]);
+        PipelineKernels_Sse41(mKernels[KernelIsa_Sse41]);
+        PipelineKernels_Avx2(mKernels[KernelIsa_Avx2]);
+
+        mIsa = _DetectIsa();
+
+        return true;
+    } ();
+
+    (void)bReady;
+}
+
+const Kernels_t& PipelineKernels::Get()
+{
+    Initialise();
+    return mKernels[mIsa];
+}
+
+const Kernels_t& PipelineKernels::Get(KernelIsa_t eIsa)
+{
+    Initialise();
+    return mKernels[eIsa];
+}
+
+KernelIsa_t PipelineKernels::GetIsa()
+{
+    Initialise();
+    return mIsa;
+}
+
+const char* PipelineKernels::GetIsaName(KernelIsa_t eIsa)
+{
+    switch(eIsa)
+    {
+    case KernelIsa_Sse41:
+        return "SSE4.1";
+    case KernelIsa_Avx2:
+        return "AVX2";
+    default:
+        return "Scalar";
+    }
+}
+
+bool PipelineKernels::IsSupported(KernelIsa_t eIsa)
+{
+    return ((int)eIsa <= (int)_DetectIsa());
+}
+
+bool PipelineKernels::Select(KernelIsa_t eIsa)
+{
+    Initialise();
+
+    if(IsSupported(eIsa) == false)
+    {
+        return false;
+    }
+
+    mIsa = eIsa;
+    return true;
+}
+
+KernelIsa_t PipelineKernels::_DetectIsa()
+{
+    KernelIsa_t eIsa = KernelIsa_Scalar;
+
+    unsigned int regs[4];
+
+    _Cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+
+    if(maxLeaf >= 1)
+    {
+        _Cpuid(1, 0, regs);
+        unsigned int ecx = regs[2];
+
+        if(ecx & CPUID1_ECX_SSE41)
+        {
+            eIsa = KernelIsa_Sse41;
+        }
+
+        // AVX2 also needs the OS to save the ymm registers
+        if((maxLeaf >= 7) &&
+           (ecx & CPUID1_ECX_OSXSAVE) &&
+           (ecx & CPUID1_ECX_AVX) &&
+           ((_Xgetbv() & XCR0_SSE_AVX_STATE) == XCR0_SSE_AVX_STATE))
+        {
+            _Cpuid(7, 0, regs);
+
+            if(regs[1] & CPUID7_EBX_AVX2)
+            {
+                eIsa = KernelIsa_Avx2;
+            }
+        }
+    }
+
+    return eIsa;
+}
@@ -0,0 +1,105 @@
+#ifndef PIPELINEKERNELS_H
+#define PIPELINEKERNELS_H
+
+#include "Types.h"
+
+/* Class PipelineKernels
+ * per pixel primitives used by the pipeline
+ *
+ * each primitive has a scalar, a SSE4.1 and an AVX2 implementation.
+ * the implementation is selected once (cpuid) when the library is initialised.
+ * all the implementations return exactly the same result than the scalar one.
+ */
+
+#if defined(_MSC_VER)
+#define KERNEL_TARGET_SSE41
+#define KERNEL_TARGET_AVX2
+#else
+#define KERNEL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define KERNEL_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+// remap coordinates are 16.16 fixed point, interpolation weights are 1.14
+#define REMAP_FRACTION_BITS 16
+#define REMAP_WEIGHT_BITS   14
+#define REMAP_WEIGHT_ONE    (1 << REMAP_WEIGHT_BITS)
+#define REMAP_WEIGHT_SCALE  (1.0f / REMAP_WEIGHT_ONE)
+
+typedef enum
+{
+    KernelIsa_Scalar,
+    KernelIsa_Sse41,
+    KernelIsa_Avx2,
+    KernelIsa_Count
+} KernelIsa_t;
+
+typedef struct
+{
+    // dst = (int16)(src - value) (wrap around like C arithmetic)
+    void   (*SubtractValue)(int16* dst, const int16* src, int value, int count);
+
+    // dst = (int16)(a - b) (wrap around like C arithmetic)
+    void   (*Subtract)(int16* dst, const int16* a, const int16* b, int count);
+
+    // dst = a - b saturated to int16 range
+    void   (*SubtractSaturate)(int16* dst, const int16* a, const int16* b, int count);
+
+    // dst = (int16)round(src * gain)
+    void   (*ScaleRound)(int16* dst, const int16* src, const float* gain, int count);
+
+    // dst = min(max(src, minValue), maxValue)
+    void   (*Clamp)(int16* dst, const int16* src, int16 minValue, int16 maxValue, int count);
+
+    // minimum and maximum (signed)
+    void   (*MinMax)(const int16* src, int count, int16* minValue, int16* maxValue);
+
+    // maximum of the values read as unsigned
+    uint16 (*MaxUnsigned)(const int16* src, int count);
+
+    // sum of the values
+    int64  (*Sum)(const int16* src, int count);
+
+    // dst = (float)src
+    void   (*Int16ToFloat)(float* dst, const int16* src, int count);
+
+    // dst = (int16)src (truncation)
+    void   (*FloatToInt16)(int16* dst, const float* src, int count);
+
+    // bilinear interpolation of src at the 16.16 coordinates (x, y pairs)
+    // dst = (int16)min(interpolation * gain, maxValue)
+    void   (*RemapBilinear)(int16* dst, const int16* src, int srcWidth, const int32* coordinates, const float* gain, int16 maxValue, int count);
+} Kernels_t;
+
+class PipelineKernels
+{
+public:
+    // detect the cpu and select the implementation
+    static void Initialise();
+
+    static const Kernels_t& Get();
+
+    static KernelIsa_t GetIsa();
+
+    static const char* GetIsaName(KernelIsa_t eIsa);
+
+    // return false if the cpu does not support the implementation
+    static bool IsSupported(KernelIsa_t eIsa);
+
+    // force an implementation (for test purpose)
+    static bool Select(KernelIsa_t eIsa);
+
+    static const Kernels_t& Get(KernelIsa_t eIsa);
+
+private:
+    static KernelIsa_t mIsa;
+    static Kernels_t   mKernels[KernelIsa_Count];
+
+    static KernelIsa_t _DetectIsa();
+};
+
+// implementations
+void PipelineKernels_Scalar(Kernels_t& kernels);
+void PipelineKernels_Sse41(Kernels_t& kernels);
+void PipelineKernels_Avx2(Kernels_t& kernels);
+
+#endif // PIPELINEKERNELS_H
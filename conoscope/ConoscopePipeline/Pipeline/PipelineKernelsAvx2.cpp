@@ -0,0 +1,293 @@
+#include "PipelineKernels.h"
+
+#include <immintrin.h>
+
+// AVX2 implementation, 16 pixels per iteration
+// the tail of each buffer is done by the SSE4.1 implementation
+
+#define AVX_STEP 16
+
+// _mm256_packs_epi32 works per 128 bits lane, this restores the pixel order
+#define PACK_ORDER 0xD8
+
+static Kernels_t sse;
+
+// (int16) cast of int32 values: keep the 16 low bits
+KERNEL_TARGET_AVX2 static inline __m256i _Wrap16(__m256i value)
+{
+    return _mm256_srai_epi32(_mm256_slli_epi32(value, 16), 16);
+}
+
+// roundf() (half away from zero) of float values
+KERNEL_TARGET_AVX2 static inline __m256 _Round(__m256 value)
+{
+    const __m256 half    = _mm256_set1_ps(0.5f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 truncated = _mm256_round_ps(value, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256 fraction  = _mm256_andnot_ps(signBit, _mm256_sub_ps(value, truncated));
+    __m256 one       = _mm256_or_ps(_mm256_set1_ps(1.0f), _mm256_and_ps(signBit, value));
+    __m256 mask      = _mm256_cmp_ps(fraction, half, _CMP_GE_OQ);
+
+    return _mm256_add_ps(truncated, _mm256_and_ps(mask, one));
+}
+
+KERNEL_TARGET_AVX2 static void SubtractValue(int16* dst, const int16* src, int value, int count)
+{
+    __m256i offset = _mm256_set1_epi16((int16)value);
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)&src[index]);
+        _mm256_storeu_si256((__m256i*)&dst[index], _mm256_sub_epi16(data, offset));
+    }
+
+    sse.SubtractValue(&dst[index], &src[index], value, count - index);
+}
+
+KERNEL_TARGET_AVX2 static void Subtract(int16* dst, const int16* a, const int16* b, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i dataA = _mm256_loadu_si256((const __m256i*)&a[index]);
+        __m256i dataB = _mm256_loadu_si256((const __m256i*)&b[index]);
+        _mm256_storeu_si256((__m256i*)&dst[index], _mm256_sub_epi16(dataA, dataB));
+    }
+
+    sse.Subtract(&dst[index], &a[index], &b[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static void SubtractSaturate(int16* dst, const int16* a, const int16* b, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i dataA = _mm256_loadu_si256((const __m256i*)&a[index]);
+        __m256i dataB = _mm256_loadu_si256((const __m256i*)&b[index]);
+        _mm256_storeu_si256((__m256i*)&dst[index], _mm256_subs_epi16(dataA, dataB));
+    }
+
+    sse.SubtractSaturate(&dst[index], &a[index], &b[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static __m256i _ScaleRound8(const int16* src, const float* gain)
+{
+    __m256i data  = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src));
+    __m256  value = _mm256_mul_ps(_mm256_cvtepi32_ps(data), _mm256_loadu_ps(gain));
+
+    return _Wrap16(_mm256_cvttps_epi32(_Round(value)));
+}
+
+KERNEL_TARGET_AVX2 static void ScaleRound(int16* dst, const int16* src, const float* gain, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i low  = _ScaleRound8(&src[index],     &gain[index]);
+        __m256i high = _ScaleRound8(&src[index + 8], &gain[index + 8]);
+        __m256i data = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), PACK_ORDER);
+        _mm256_storeu_si256((__m256i*)&dst[index], data);
+    }
+
+    sse.ScaleRound(&dst[index], &src[index], &gain[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static void Clamp(int16* dst, const int16* src, int16 minValue, int16 maxValue, int count)
+{
+    __m256i minimum = _mm256_set1_epi16(minValue);
+    __m256i maximum = _mm256_set1_epi16(maxValue);
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)&src[index]);
+        data = _mm256_min_epi16(_mm256_max_epi16(data, minimum), maximum);
+        _mm256_storeu_si256((__m256i*)&dst[index], data);
+    }
+
+    sse.Clamp(&dst[index], &src[index], minValue, maxValue, count - index);
+}
+
+KERNEL_TARGET_AVX2 static void MinMax(const int16* src, int count, int16* minValue, int16* maxValue)
+{
+    __m256i minimum = _mm256_set1_epi16(INT16_MAX);
+    __m256i maximum = _mm256_set1_epi16(INT16_MIN);
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)&src[index]);
+        minimum = _mm256_min_epi16(minimum, data);
+        maximum = _mm256_max_epi16(maximum, data);
+    }
+
+    int16 minArray[AVX_STEP];
+    int16 maxArray[AVX_STEP];
+    _mm256_storeu_si256((__m256i*)minArray, minimum);
+    _mm256_storeu_si256((__m256i*)maxArray, maximum);
+
+    int16 minTail, maxTail;
+    sse.MinMax(&src[index], count - index, &minTail, &maxTail);
+
+    for(int lane = 0; lane < AVX_STEP; lane ++)
+    {
+        minTail = (minArray[lane] < minTail) ? minArray[lane] : minTail;
+        maxTail = (maxArray[lane] > maxTail) ? maxArray[lane] : maxTail;
+    }
+
+    *minValue = minTail;
+    *maxValue = maxTail;
+}
+
+KERNEL_TARGET_AVX2 static uint16 MaxUnsigned(const int16* src, int count)
+{
+    __m256i maximum = _mm256_setzero_si256();
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        maximum = _mm256_max_epu16(maximum, _mm256_loadu_si256((const __m256i*)&src[index]));
+    }
+
+    uint16 maxArray[AVX_STEP];
+    _mm256_storeu_si256((__m256i*)maxArray, maximum);
+
+    uint16 result = sse.MaxUnsigned(&src[index], count - index);
+
+    for(int lane = 0; lane < AVX_STEP; lane ++)
+    {
+        result = (maxArray[lane] > result) ? maxArray[lane] : result;
+    }
+
+    return result;
+}
+
+KERNEL_TARGET_AVX2 static int64 Sum(const int16* src, int count)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        // pairs are added as int32 then widened: no overflow whatever the count
+        __m256i pairs = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)&src[index]), ones);
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    }
+
+    int64 sumArray[4];
+    _mm256_storeu_si256((__m256i*)sumArray, sum);
+
+    return sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3] +
+           sse.Sum(&src[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static void Int16ToFloat(float* dst, const int16* src, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m128i low  = _mm_loadu_si128((const __m128i*)&src[index]);
+        __m128i high = _mm_loadu_si128((const __m128i*)&src[index + 8]);
+        _mm256_storeu_ps(&dst[index],     _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(low)));
+        _mm256_storeu_ps(&dst[index + 8], _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(high)));
+    }
+
+    sse.Int16ToFloat(&dst[index], &src[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static void FloatToInt16(int16* dst, const float* src, int count)
+{
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i low  = _Wrap16(_mm256_cvttps_epi32(_mm256_loadu_ps(&src[index])));
+        __m256i high = _Wrap16(_mm256_cvttps_epi32(_mm256_loadu_ps(&src[index + 8])));
+        __m256i data = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), PACK_ORDER);
+        _mm256_storeu_si256((__m256i*)&dst[index], data);
+    }
+
+    sse.FloatToInt16(&dst[index], &src[index], count - index);
+}
+
+KERNEL_TARGET_AVX2 static __m256i _RemapBilinear8(const int16* src, int srcWidth, const int32* coordinates, const float* gain, __m256 maxValue)
+{
+    const __m256i fractionMask = _mm256_set1_epi32(0xFFFF);
+    const __m256i half         = _mm256_set1_epi32(REMAP_WEIGHT_ONE >> 1);
+    const __m256i one          = _mm256_set1_epi32(REMAP_WEIGHT_ONE);
+
+    // x, y pairs: deinterleave then restore the pixel order
+    __m256 low  = _mm256_loadu_ps((const float*)&coordinates[0]);
+    __m256 high = _mm256_loadu_ps((const float*)&coordinates[8]);
+    __m256i x = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m256i y = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+    x = _mm256_permute4x64_epi64(x, PACK_ORDER);
+    y = _mm256_permute4x64_epi64(y, PACK_ORDER);
+
+    __m256i beta  = _mm256_srli_epi32(_mm256_and_si256(x, fractionMask), REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+    __m256i alpha = _mm256_srli_epi32(_mm256_and_si256(y, fractionMask), REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+
+    __m256i w11 = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(alpha, beta), half), REMAP_WEIGHT_BITS);
+    __m256i w10 = _mm256_sub_epi32(alpha, w11);
+    __m256i w01 = _mm256_sub_epi32(beta, w11);
+    __m256i w00 = _mm256_add_epi32(_mm256_sub_epi32(_mm256_sub_epi32(one, alpha), beta), w11);
+
+    // weights of the pixel pairs as int16
+    __m256i topWeight    = _mm256_or_si256(w00, _mm256_slli_epi32(w01, 16));
+    __m256i bottomWeight = _mm256_or_si256(w10, _mm256_slli_epi32(w11, 16));
+
+    __m256i position = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srai_epi32(y, REMAP_FRACTION_BITS), _mm256_set1_epi32(srcWidth)),
+                                        _mm256_srai_epi32(x, REMAP_FRACTION_BITS));
+
+    // the gather reads two adjacent pixels (scale is the size of one pixel)
+    __m256i top    = _mm256_i32gather_epi32((const int*)src, position, sizeof(int16));
+    __m256i bottom = _mm256_i32gather_epi32((const int*)&src[srcWidth], position, sizeof(int16));
+
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(top, topWeight), _mm256_madd_epi16(bottom, bottomWeight));
+
+    __m256 value = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(sum), _mm256_set1_ps(REMAP_WEIGHT_SCALE)), _mm256_loadu_ps(gain));
+    value = _mm256_min_ps(value, maxValue);
+
+    return _Wrap16(_mm256_cvttps_epi32(value));
+}
+
+KERNEL_TARGET_AVX2 static void RemapBilinear(int16* dst, const int16* src, int srcWidth, const int32* coordinates, const float* gain, int16 maxValue, int count)
+{
+    __m256 maximum = _mm256_set1_ps((float)maxValue);
+    int index = 0;
+
+    for(; index + AVX_STEP <= count; index += AVX_STEP)
+    {
+        __m256i low  = _RemapBilinear8(src, srcWidth, &coordinates[2 * index],       &gain[index],     maximum);
+        __m256i high = _RemapBilinear8(src, srcWidth, &coordinates[2 * (index + 8)], &gain[index + 8], maximum);
+        __m256i data = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), PACK_ORDER);
+        _mm256_storeu_si256((__m256i*)&dst[index], data);
+    }
+
+    sse.RemapBilinear(&dst[index], src, srcWidth, &coordinates[2 * index], &gain[index], maxValue, count - index);
+}
+
+void PipelineKernels_Avx2(Kernels_t& kernels)
+{
+    PipelineKernels_Sse41(sse);
+
+    kernels.SubtractValue    = SubtractValue;
+    kernels.Subtract         = Subtract;
+    kernels.SubtractSaturate = SubtractSaturate;
+    kernels.ScaleRound       = ScaleRound;
+    kernels.Clamp            = Clamp;
+    kernels.MinMax           = MinMax;
+    kernels.MaxUnsigned      = MaxUnsigned;
+    kernels.Sum              = Sum;
+    kernels.Int16ToFloat     = Int16ToFloat;
+    kernels.FloatToInt16     = FloatToInt16;
+    kernels.RemapBilinear    = RemapBilinear;
+}
@@ -0,0 +1,181 @@
+#include "PipelineKernels.h"
+
+#include <math.h>
+
+// reference implementation
+
+static void SubtractValue(int16* dst, const int16* src, int value, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = (int16)(src[index] - value);
+    }
+}
+
+static void Subtract(int16* dst, const int16* a, const int16* b, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = (int16)(a[index] - b[index]);
+    }
+}
+
+static void SubtractSaturate(int16* dst, const int16* a, const int16* b, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        int value = a[index] - b[index];
+
+        if(value > INT16_MAX)
+        {
+            value = INT16_MAX;
+        }
+        else if(value < INT16_MIN)
+        {
+            value = INT16_MIN;
+        }
+
+        dst[index] = (int16)value;
+    }
+}
+
+static void ScaleRound(int16* dst, const int16* src, const float* gain, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = (int16)(int32)roundf(src[index] * gain[index]);
+    }
+}
+
+static void Clamp(int16* dst, const int16* src, int16 minValue, int16 maxValue, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        int16 value = src[index];
+
+        if(value < minValue)
+        {
+            value = minValue;
+        }
+
+        if(value > maxValue)
+        {
+            value = maxValue;
+        }
+
+        dst[index] = value;
+    }
+}
+
+static void MinMax(const int16* src, int count, int16* minValue, int16* maxValue)
+{
+    int16 minimum = INT16_MAX;
+    int16 maximum = INT16_MIN;
+
+    for(int index = 0; index < count; index ++)
+    {
+        if(src[index] < minimum)
+        {
+            minimum = src[index];
+        }
+
+        if(src[index] > maximum)
+        {
+            maximum = src[index];
+        }
+    }
+
+    *minValue = minimum;
+    *maxValue = maximum;
+}
+
+static uint16 MaxUnsigned(const int16* src, int count)
+{
+    uint16 maximum = 0;
+
+    for(int index = 0; index < count; index ++)
+    {
+        if((uint16)src[index] > maximum)
+        {
+            maximum = (uint16)src[index];
+        }
+    }
+
+    return maximum;
+}
+
+static int64 Sum(const int16* src, int count)
+{
+    int64 sum = 0;
+
+    for(int index = 0; index < count; index ++)
+    {
+        sum += src[index];
+    }
+
+    return sum;
+}
+
+static void Int16ToFloat(float* dst, const int16* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = (float)src[index];
+    }
+}
+
+static void FloatToInt16(int16* dst, const float* src, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        dst[index] = (int16)(int32)src[index];
+    }
+}
+
+static void RemapBilinear(int16* dst, const int16* src, int srcWidth, const int32* coordinates, const float* gain, int16 maxValue, int count)
+{
+    for(int index = 0; index < count; index ++)
+    {
+        int32 x = coordinates[2 * index];
+        int32 y = coordinates[2 * index + 1];
+
+        // fraction reduced to the weight precision
+        int32 beta  = (x & 0xFFFF) >> (REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+        int32 alpha = (y & 0xFFFF) >> (REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+
+        // weights of the 4 pixels, the sum is exactly REMAP_WEIGHT_ONE
+        int32 w11 = (alpha * beta + (REMAP_WEIGHT_ONE >> 1)) >> REMAP_WEIGHT_BITS;
+        int32 w10 = alpha - w11;
+        int32 w01 = beta - w11;
+        int32 w00 = REMAP_WEIGHT_ONE - alpha - beta + w11;
+
+        const int16* pixel = &src[(y >> REMAP_FRACTION_BITS) * srcWidth + (x >> REMAP_FRACTION_BITS)];
+
+        int32 sum = pixel[0]        * w00 + pixel[1]            * w01 +
+                    pixel[srcWidth] * w10 + pixel[srcWidth + 1] * w11;
+
+        float value = ((float)sum * REMAP_WEIGHT_SCALE) * gain[index];
+
+        if(value >= (float)maxValue)
+        {
+            value = (float)maxValue;
+        }
+
+        dst[index] = (int16)(int32)value;
+    }
+}
+
+void PipelineKernels_Scalar(Kernels_t& kernels)
+{
+    kernels.SubtractValue    = SubtractValue;
+    kernels.Subtract         = Subtract;
+    kernels.SubtractSaturate = SubtractSaturate;
+    kernels.ScaleRound       = ScaleRound;
+    kernels.Clamp            = Clamp;
+    kernels.MinMax           = MinMax;
+    kernels.MaxUnsigned      = MaxUnsigned;
+    kernels.Sum              = Sum;
+    kernels.Int16ToFloat     = Int16ToFloat;
+    kernels.FloatToInt16     = FloatToInt16;
+    kernels.RemapBilinear    = RemapBilinear;
+}
@@ -0,0 +1,303 @@
+#include "PipelineKernels.h"
+
+#include <string.h>
+#include <immintrin.h>
+
+// SSE4.1 implementation, 8 pixels per iteration
+// the tail of each buffer is done by the scalar implementation
+
+#define SSE_STEP 8
+
+static Kernels_t scalar;
+
+// (int16) cast of int32 values: keep the 16 low bits
+KERNEL_TARGET_SSE41 static inline __m128i _Wrap16(__m128i value)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+}
+
+// roundf() (half away from zero) of float values
+KERNEL_TARGET_SSE41 static inline __m128 _Round(__m128 value)
+{
+    const __m128 half    = _mm_set1_ps(0.5f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 truncated = _mm_round_ps(value, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128 fraction  = _mm_andnot_ps(signBit, _mm_sub_ps(value, truncated));
+    __m128 one       = _mm_or_ps(_mm_set1_ps(1.0f), _mm_and_ps(signBit, value));
+    __m128 mask      = _mm_cmpge_ps(fraction, half);
+
+    return _mm_add_ps(truncated, _mm_and_ps(mask, one));
+}
+
+KERNEL_TARGET_SSE41 static void SubtractValue(int16* dst, const int16* src, int value, int count)
+{
+    __m128i offset = _mm_set1_epi16((int16)value);
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)&src[index]);
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_sub_epi16(data, offset));
+    }
+
+    scalar.SubtractValue(&dst[index], &src[index], value, count - index);
+}
+
+KERNEL_TARGET_SSE41 static void Subtract(int16* dst, const int16* a, const int16* b, int count)
+{
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i dataA = _mm_loadu_si128((const __m128i*)&a[index]);
+        __m128i dataB = _mm_loadu_si128((const __m128i*)&b[index]);
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_sub_epi16(dataA, dataB));
+    }
+
+    scalar.Subtract(&dst[index], &a[index], &b[index], count - index);
+}
+
+KERNEL_TARGET_SSE41 static void SubtractSaturate(int16* dst, const int16* a, const int16* b, int count)
+{
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i dataA = _mm_loadu_si128((const __m128i*)&a[index]);
+        __m128i dataB = _mm_loadu_si128((const __m128i*)&b[index]);
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_subs_epi16(dataA, dataB));
+    }
+
+    scalar.SubtractSaturate(&dst[index], &a[index], &b[index], count - index);
+}
+
+KERNEL_TARGET_SSE41 static __m128i _ScaleRound4(const int16* src, const float* gain)
+{
+    __m128i data  = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)src));
+    __m128  value = _mm_mul_ps(_mm_cvtepi32_ps(data), _mm_loadu_ps(gain));
+
+    return _Wrap16(_mm_cvttps_epi32(_Round(value)));
+}
+
+KERNEL_TARGET_SSE41 static void ScaleRound(int16* dst, const int16* src, const float* gain, int count)
+{
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i low  = _ScaleRound4(&src[index],     &gain[index]);
+        __m128i high = _ScaleRound4(&src[index + 4], &gain[index + 4]);
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_packs_epi32(low, high));
+    }
+
+    scalar.ScaleRound(&dst[index], &src[index], &gain[index], count - index);
+}
+
+KERNEL_TARGET_SSE41 static void Clamp(int16* dst, const int16* src, int16 minValue, int16 maxValue, int count)
+{
+    __m128i minimum = _mm_set1_epi16(minValue);
+    __m128i maximum = _mm_set1_epi16(maxValue);
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)&src[index]);
+        data = _mm_min_epi16(_mm_max_epi16(data, minimum), maximum);
+        _mm_storeu_si128((__m128i*)&dst[index], data);
+    }
+
+    scalar.Clamp(&dst[index], &src[index], minValue, maxValue, count - index);
+}
+
+KERNEL_TARGET_SSE41 static void MinMax(const int16* src, int count, int16* minValue, int16* maxValue)
+{
+    __m128i minimum = _mm_set1_epi16(INT16_MAX);
+    __m128i maximum = _mm_set1_epi16(INT16_MIN);
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)&src[index]);
+        minimum = _mm_min_epi16(minimum, data);
+        maximum = _mm_max_epi16(maximum, data);
+    }
+
+    int16 minArray[SSE_STEP];
+    int16 maxArray[SSE_STEP];
+    _mm_storeu_si128((__m128i*)minArray, minimum);
+    _mm_storeu_si128((__m128i*)maxArray, maximum);
+
+    int16 minTail, maxTail;
+    scalar.MinMax(&src[index], count - index, &minTail, &maxTail);
+
+    for(int lane = 0; lane < SSE_STEP; lane ++)
+    {
+        minTail = (minArray[lane] < minTail) ? minArray[lane] : minTail;
+        maxTail = (maxArray[lane] > maxTail) ? maxArray[lane] : maxTail;
+    }
+
+    *minValue = minTail;
+    *maxValue = maxTail;
+}
+
+KERNEL_TARGET_SSE41 static uint16 MaxUnsigned(const int16* src, int count)
+{
+    __m128i maximum = _mm_setzero_si128();
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        maximum = _mm_max_epu16(maximum, _mm_loadu_si128((const __m128i*)&src[index]));
+    }
+
+    uint16 maxArray[SSE_STEP];
+    _mm_storeu_si128((__m128i*)maxArray, maximum);
+
+    uint16 result = scalar.MaxUnsigned(&src[index], count - index);
+
+    for(int lane = 0; lane < SSE_STEP; lane ++)
+    {
+        result = (maxArray[lane] > result) ? maxArray[lane] : result;
+    }
+
+    return result;
+}
+
+KERNEL_TARGET_SSE41 static int64 Sum(const int16* src, int count)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        // pairs are added as int32 then widened: no overflow whatever the count
+        __m128i pairs = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)&src[index]), ones);
+        sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(pairs));
+        sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_srli_si128(pairs, 8)));
+    }
+
+    int64 sumArray[2];
+    _mm_storeu_si128((__m128i*)sumArray, sum);
+
+    return sumArray[0] + sumArray[1] + scalar.Sum(&src[index], count - index);
+}
+
+KERNEL_TARGET_SSE41 static void Int16ToFloat(float* dst, const int16* src, int count)
+{
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)&src[index]);
+        _mm_storeu_ps(&dst[index],     _mm_cvtepi32_ps(_mm_cvtepi16_epi32(data)));
+        _mm_storeu_ps(&dst[index + 4], _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(data, 8))));
+    }
+
+    scalar.Int16ToFloat(&dst[index], &src[index], count - index);
+}
+
+KERNEL_TARGET_SSE41 static void FloatToInt16(int16* dst, const float* src, int count)
+{
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i low  = _Wrap16(_mm_cvttps_epi32(_mm_loadu_ps(&src[index])));
+        __m128i high = _Wrap16(_mm_cvttps_epi32(_mm_loadu_ps(&src[index + 4])));
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_packs_epi32(low, high));
+    }
+
+    scalar.FloatToInt16(&dst[index], &src[index], count - index);
+}
+
+// two adjacent pixels as one int32
+static inline int32 _LoadPair(const int16* src)
+{
+    int32 pair;
+    memcpy(&pair, src, sizeof(pair));
+    return pair;
+}
+
+KERNEL_TARGET_SSE41 static __m128i _RemapBilinear4(const int16* src, int srcWidth, const int32* coordinates, const float* gain, __m128 maxValue)
+{
+    const __m128i fractionMask = _mm_set1_epi32(0xFFFF);
+    const __m128i half         = _mm_set1_epi32(REMAP_WEIGHT_ONE >> 1);
+    const __m128i one          = _mm_set1_epi32(REMAP_WEIGHT_ONE);
+
+    // x, y pairs
+    __m128 low  = _mm_loadu_ps((const float*)&coordinates[0]);
+    __m128 high = _mm_loadu_ps((const float*)&coordinates[4]);
+    __m128i x = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i y = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+
+    __m128i beta  = _mm_srli_epi32(_mm_and_si128(x, fractionMask), REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+    __m128i alpha = _mm_srli_epi32(_mm_and_si128(y, fractionMask), REMAP_FRACTION_BITS - REMAP_WEIGHT_BITS);
+
+    __m128i w11 = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(alpha, beta), half), REMAP_WEIGHT_BITS);
+    __m128i w10 = _mm_sub_epi32(alpha, w11);
+    __m128i w01 = _mm_sub_epi32(beta, w11);
+    __m128i w00 = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(one, alpha), beta), w11);
+
+    // weights of the pixel pairs as int16
+    __m128i topWeight    = _mm_or_si128(w00, _mm_slli_epi32(w01, 16));
+    __m128i bottomWeight = _mm_or_si128(w10, _mm_slli_epi32(w11, 16));
+
+    __m128i position = _mm_add_epi32(_mm_mullo_epi32(_mm_srai_epi32(y, REMAP_FRACTION_BITS), _mm_set1_epi32(srcWidth)),
+                                     _mm_srai_epi32(x, REMAP_FRACTION_BITS));
+
+    int32 positionArray[4];
+    _mm_storeu_si128((__m128i*)positionArray, position);
+
+    __m128i top = _mm_setr_epi32(
+                _LoadPair(&src[positionArray[0]]),
+                _LoadPair(&src[positionArray[1]]),
+                _LoadPair(&src[positionArray[2]]),
+                _LoadPair(&src[positionArray[3]]));
+
+    __m128i bottom = _mm_setr_epi32(
+                _LoadPair(&src[positionArray[0] + srcWidth]),
+                _LoadPair(&src[positionArray[1] + srcWidth]),
+                _LoadPair(&src[positionArray[2] + srcWidth]),
+                _LoadPair(&src[positionArray[3] + srcWidth]));
+
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(top, topWeight), _mm_madd_epi16(bottom, bottomWeight));
+
+    __m128 value = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(REMAP_WEIGHT_SCALE)), _mm_loadu_ps(gain));
+    value = _mm_min_ps(value, maxValue);
+
+    return _Wrap16(_mm_cvttps_epi32(value));
+}
+
+KERNEL_TARGET_SSE41 static void RemapBilinear(int16* dst, const int16* src, int srcWidth, const int32* coordinates, const float* gain, int16 maxValue, int count)
+{
+    __m128 maximum = _mm_set1_ps((float)maxValue);
+    int index = 0;
+
+    for(; index + SSE_STEP <= count; index += SSE_STEP)
+    {
+        __m128i low  = _RemapBilinear4(src, srcWidth, &coordinates[2 * index],       &gain[index],     maximum);
+        __m128i high = _RemapBilinear4(src, srcWidth, &coordinates[2 * (index + 4)], &gain[index + 4], maximum);
+        _mm_storeu_si128((__m128i*)&dst[index], _mm_packs_epi32(low, high));
+    }
+
+    scalar.RemapBilinear(&dst[index], src, srcWidth, &coordinates[2 * index], &gain[index], maxValue, count - index);
+}
+
+void PipelineKernels_Sse41(Kernels_t& kernels)
+{
+    PipelineKernels_Scalar(scalar);
+
+    kernels.SubtractValue    = SubtractValue;
+    kernels.Subtract         = Subtract;
+    kernels.SubtractSaturate = SubtractSaturate;
+    kernels.ScaleRound       = ScaleRound;
+    kernels.Clamp            = Clamp;
+    kernels.MinMax           = MinMax;
+    kernels.MaxUnsigned      = MaxUnsigned;
+    kernels.Sum              = Sum;
+    kernels.Int16ToFloat     = Int16ToFloat;
+    kernels.FloatToInt16     = FloatToInt16;
+    kernels.RemapBilinear    = RemapBilinear;
+}
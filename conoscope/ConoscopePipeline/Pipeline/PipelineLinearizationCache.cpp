@@ -0,0 +1,92 @@
+#include "PipelineLinearizationCache.h"
+
+#include "PipelineDefines.h"
+#include "PipelineHash.h"
+
+PipelineLinearizationCache::PipelineLinearizationCache()
+{
+    mEntries.clear();
+}
+
+PipelineLinearizationCache::~PipelineLinearizationCache()
+{
+    Invalidate();
+}
+
+uint64 PipelineLinearizationCache::GetKey(
+        long    lTargetWidth,
+        long    lTargetHeight,
+        float   fMaxAngle,
+        Point   center,
+        const LinearizationCoef* pLinearizationFactor,
+        const ImageConfiguration& imageConfiguration)
+{
+    uint64 hash = HASH_INIT;
+
+    // calibration
+    HASH(hash, lTargetWidth);
+    HASH(hash, lTargetHeight);
+    HASH(hash, fMaxAngle);
+    HASH(hash, center.x);
+    HASH(hash, center.y);
+    HASH(hash, pLinearizationFactor->A1);
+    HASH(hash, pLinearizationFactor->A3);
+    HASH(hash, pLinearizationFactor->A5);
+    HASH(hash, pLinearizationFactor->A7);
+    HASH(hash, pLinearizationFactor->A9);
+
+    // crop geometry
+    HASH(hash, imageConfiguration.image_width);
+    HASH(hash, imageConfiguration.image_height);
+    HASH(hash, imageConfiguration.active_horizontal_offset);
+    HASH(hash, imageConfiguration.active_vertical_offset);
+    HASH(hash, imageConfiguration.active_width);
+    HASH(hash, imageConfiguration.active_height);
+
+    return hash;
+}
+
+PipelineRemap* PipelineLinearizationCache::Get(uint64 key)
+{
+    for(int index = 0; index < (int)mEntries.size(); index ++)
+    {
+        if(mEntries.at(index).key == key)
+        {
+            CacheEntry_t entry = mEntries.at(index);
+
+            // move the entry at the beginning of the list
+            mEntries.erase(mEntries.begin() + index);
+            mEntries.insert(mEntries.begin(), entry);
+
+            return entry.pRemap;
+        }
+    }
+
+    return NULL;
+}
+
+void PipelineLinearizationCache::Add(uint64 key, PipelineRemap* pRemap)
+{
+    CacheEntry_t entry;
+    entry.key    = key;
+    entry.pRemap = pRemap;
+
+    mEntries.insert(mEntries.begin(), entry);
+
+    // remove the least recently used tables
+    while((int)mEntries.size() > LINEARIZATION_CACHE_SIZE)
+    {
+        delete mEntries.back().pRemap;
+        mEntries.pop_back();
+    }
+}
+
+void PipelineLinearizationCache::Invalidate()
+{
+    for(int index = 0; index < (int)mEntries.size(); index ++)
+    {
+        delete mEntries.at(index).pRemap;
+    }
+
+    mEntries.clear();
+}
@@ -0,0 +1,52 @@
+#ifndef PIPELINELINEARIZATIONCACHE_H
+#define PIPELINELINEARIZATIONCACHE_H
+
+#include <vector>
+
+#include "Types.h"
+#include "PipelineTypes.h"
+#include "PipelineComputeTypes.h"
+#include "PipelineRemap.h"
+#include "imageConfiguration.h"
+
+/* Class PipelineLinearizationCache
+ * keep the linearization remap tables (PipelineRemap) between calls
+ *
+ * the tables only depend on the calibration (optical axis, maximum angle,
+ * linearization coefficients, output radius) and on the image geometry,
+ * so they are built once and reused for each frame / capture sequence filter
+ */
+
+class PipelineLinearizationCache
+{
+public:
+    PipelineLinearizationCache();
+    ~PipelineLinearizationCache();
+
+    static uint64 GetKey(
+            long    lTargetWidth,
+            long    lTargetHeight,
+            float   fMaxAngle,
+            Point   center,
+            const LinearizationCoef* pLinearizationFactor,
+            const ImageConfiguration& imageConfiguration);
+
+    // return NULL if the table is not in the cache
+    PipelineRemap* Get(uint64 key);
+
+    // the cache takes the ownership of the table
+    void Add(uint64 key, PipelineRemap* pRemap);
+
+    void Invalidate();
+
+private:
+    typedef struct {
+        uint64             key;
+        PipelineRemap*     pRemap;
+    } CacheEntry_t;
+
+    // most recently used entry first
+    std::vector<CacheEntry_t> mEntries;
+};
+
+#endif // PIPELINELINEARIZATIONCACHE_H
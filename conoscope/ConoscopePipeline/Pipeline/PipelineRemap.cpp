@@ -0,0 +1,132 @@
+#include "PipelineRemap.h"
+
+#include <string.h>
+
+#include "PipelineDefines.h"
+#include "PipelineKernels.h"
+
+#define OMP_PARAL
+
+#define MAX_VALUE(a, b) ((a) < (b)) ? (b) : (a)
+#define MIN_VALUE(a, b) ((a) > (b)) ? (b) : (a)
+
+PipelineRemap::PipelineRemap()
+{
+    mWidth  = 0;
+    mHeight = 0;
+}
+
+void PipelineRemap::Build(
+        const precomputedData_t* pPrecomputedData,
+        long lWidth,
+        long lHeight)
+{
+    mWidth  = lWidth;
+    mHeight = lHeight;
+
+    mCoordinates.assign(2 * lWidth * lHeight, 0);
+    mFirstColumn.assign(lHeight, 0);
+    mLastColumn.assign(lHeight, 0);
+
+#ifdef OMP_PARAL
+#pragma omp parallel for num_threads(4)
+#endif
+    for(int row = 0; row < (int)lHeight; row ++)
+    {
+        const precomputedData_t* pRow = &pPrecomputedData[row * lWidth];
+        int32* pCoordinates = &mCoordinates[2 * row * lWidth];
+
+        // the valid pixels of a row are contiguous (output is a disk)
+        int firstColumn = (int)lWidth;
+        int lastColumn  = 0;
+
+        for(int column = 0; column < (int)lWidth; column ++)
+        {
+            if(pRow[column].linearizationRadius)
+            {
+                firstColumn = MIN_VALUE(firstColumn, column);
+                lastColumn  = column + 1;
+
+                // coordinates are positive, truncation is the integer part
+                pCoordinates[2 * column]     = (int32)((double)pRow[column].linearizationTableX * (1 << REMAP_FRACTION_BITS));
+                pCoordinates[2 * column + 1] = (int32)((double)pRow[column].linearizationTableY * (1 << REMAP_FRACTION_BITS));
+            }
+        }
+
+        mFirstColumn[row] = MIN_VALUE(firstColumn, lastColumn);
+        mLastColumn[row]  = lastColumn;
+    }
+}
+
+void PipelineRemap::Apply(
+        const int16* pSource,
+        long    lSourceWidth,
+        const float* pGain,
+        int16   maxValue,
+        int16*  pTarget) const
+{
+    int tileRowCount    = (int)((mHeight + REMAP_TILE_HEIGHT - 1) / REMAP_TILE_HEIGHT);
+    int tileColumnCount = (int)((mWidth + REMAP_TILE_WIDTH - 1) / REMAP_TILE_WIDTH);
+    int tileCount       = tileRowCount * tileColumnCount;
+
+    // tiles write distinct parts of the output
+#ifdef OMP_PARAL
+#pragma omp parallel for schedule(dynamic) num_threads(4)
+#endif
+    for(int tileIndex = 0; tileIndex < tileCount; tileIndex ++)
+    {
+        _ApplyTile(pSource,
+                   lSourceWidth,
+                   pGain,
+                   maxValue,
+                   tileIndex / tileColumnCount,
+                   tileIndex % tileColumnCount,
+                   pTarget);
+    }
+}
+
+void PipelineRemap::_ApplyTile(
+        const int16* pSource,
+        long    lSourceWidth,
+        const float* pGain,
+        int16   maxValue,
+        int     tileRow,
+        int     tileColumn,
+        int16*  pTarget) const
+{
+    const Kernels_t& kernels = PipelineKernels::Get();
+
+    int firstRow = tileRow * REMAP_TILE_HEIGHT;
+    int lastRow  = MIN_VALUE(firstRow + REMAP_TILE_HEIGHT, (int)mHeight);
+
+    int tileStart = tileColumn * REMAP_TILE_WIDTH;
+    int tileEnd   = MIN_VALUE(tileStart + REMAP_TILE_WIDTH, (int)mWidth);
+
+    for(int row = firstRow; row < lastRow; row ++)
+    {
+        long lRowOffset = row * mWidth;
+
+        int start = MAX_VALUE(tileStart, mFirstColumn[row]);
+        int end   = MIN_VALUE(tileEnd, mLastColumn[row]);
+
+        if(start >= end)
+        {
+            // "Outside" pixels are zeroed
+            memset(&pTarget[lRowOffset + tileStart], 0, (tileEnd - tileStart) * sizeof(int16));
+            continue;
+        }
+
+        memset(&pTarget[lRowOffset + tileStart], 0, (start - tileStart) * sizeof(int16));
+
+        kernels.RemapBilinear(
+                    &pTarget[lRowOffset + start],
+                    pSource,
+                    (int)lSourceWidth,
+                    &mCoordinates[2 * (lRowOffset + start)],
+                    &pGain[lRowOffset + start],
+                    maxValue,
+                    end - start);
+
+        memset(&pTarget[lRowOffset + end], 0, (tileEnd - end) * sizeof(int16));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef PIPELINEREMAP_H
+#define PIPELINEREMAP_H
+
+#include <vector>
+
+#include "Types.h"
+#include "PipelineComputeTypes.h"
+
+/* Class PipelineRemap
+ * bilinear remap of the sensor image to the linearized output
+ *
+ * the source coordinates of each output pixel are stored as 16.16 fixed point
+ * (8 bytes per pixel) and the pixels outside the output disk are described by
+ * the first and last valid column of each row.
+ * the output is processed by tiles so the source pixels read by a tile stay
+ * in L2 cache, the interpolation is done by PipelineKernels::RemapBilinear.
+ */
+
+class PipelineRemap
+{
+public:
+    PipelineRemap();
+
+    // build the remap from the linearization tables
+    void Build(const precomputedData_t* pPrecomputedData,
+            long lWidth,
+            long lHeight);
+
+    // pTarget = pSource remapped and multiplied by pGain, limited to maxValue
+    void Apply(const int16* pSource,
+            long    lSourceWidth,
+            const float* pGain,
+            int16   maxValue,
+            int16*  pTarget) const;
+
+    long GetWidth() const { return mWidth; }
+    long GetHeight() const { return mHeight; }
+
+private:
+    long mWidth;
+    long mHeight;
+
+    std::vector<int32> mCoordinates;    // x, y (16.16) for each output pixel
+    std::vector<int32> mFirstColumn;    // first valid column of each row
+    std::vector<int32> mLastColumn;     // last valid column + 1 of each row
+
+    void _ApplyTile(const int16* pSource,
+            long    lSourceWidth,
+            const float* pGain,
+            int16   maxValue,
+            int     tileRow,
+            int     tileColumn,
+            int16*  pTarget) const;
+};
+
+#endif // PIPELINEREMAP_H
@@ -0,0 +1,69 @@
+#-------------------------------------------------
+#
+# PipelineLib benchmark
+# the pipeline sources are built in the executable so the stages can be timed
+#
+#-------------------------------------------------
+
+QT       -= gui
+QT       += core xml
+
+TARGET = PipelineBench
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+# the pipeline api is built in the executable
+DEFINES += PIPELINELIB_LIBRARY
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+DEFINES += AE_MEAS_AREA
+
+SOURCES += \
+    Bench/main.cpp \
+    Bench/PipelineBench.cpp \
+    PipelineLib.cpp \
+    Compute.cpp \
+    Pipeline/PipelineCompute.cpp \
+    Pipeline/PipelineDefectCorrector.cpp \
+    Pipeline/PipelineLinearizationCache.cpp \
+    Pipeline/PipelineGainMap.cpp \
+    Pipeline/PipelineRemap.cpp \
+    Pipeline/PipelineKernels.cpp \
+    Pipeline/PipelineKernelsScalar.cpp \
+    Pipeline/PipelineKernelsSse41.cpp \
+    Pipeline/PipelineKernelsAvx2.cpp \
+    Tools/toolErrorCode.cpp \
+    Tools/classcommon.cpp \
+    Tools/toolString.cpp
+
+HEADERS += \
+    Bench/PipelineBench.h \
+    PipelineLib.h \
+    PipelineLib_global.h \
+    configuration.h \
+    Compute.h \
+    Pipeline/logger.h \
+    Pipeline/Types.h \
+    Pipeline/imageConfiguration.h \
+    Pipeline/defines.h \
+    Pipeline/PipelineCompute.h \
+    Pipeline/PipelineDefectCorrector.h \
+    Pipeline/PipelineLinearizationCache.h \
+    Pipeline/PipelineGainMap.h \
+    Pipeline/PipelineRemap.h \
+    Pipeline/PipelineHash.h \
+    Pipeline/PipelineKernels.h \
+    Pipeline/PipelineComputeTypes.h \
+    Pipeline/PipelineDefines.h \
+    Tools/toolErrorCode.h \
+    Tools/classcommon.h \
+    Tools/toolString.h \
+    PipelineTypes.h \
+    Pipeline/PipelineHistogram.h
+
+INCLUDEPATH += './'
+INCLUDEPATH += './Pipeline'
+INCLUDEPATH += './Tools'
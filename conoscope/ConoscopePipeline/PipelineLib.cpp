@@ -5,6 +5,7 @@
 #include "configuration.h"
 
 #include "Compute.h"
+#include "PipelineKernels.h"
 
 #include "toolErrorCode.h"
 
@@ -32,6 +33,7 @@ const char* CmdGetVersion()
     eError.SetOption("Date", RELEASE_DATE);
     eError.SetOption("Version", VERSION_STR);
     eError.SetOption("Name", APPLICATION_NAME);
+    eError.SetOption("Kernels", QString(PipelineKernels::GetIsaName(PipelineKernels::GetIsa())));
 
     RETURN(eError.GetJsonCode());
 }
@@ -69,14 +71,8 @@ QString GetErrorMessage(Error_t error)
     return message;
 }
 
-const char* CmdComputeRawData(
-        int16* inputData,
-        Pipeline_RawDataParam* param,
-        Pipeline_ResultRawDataParam &resultParam)
+static QString _GetJsonResult(Error_t res)
 {
-    Error_t res;
-    res = Compute::ComputeRawData(inputData, param, resultParam);
-
     ClassCommon::Error eError = ClassCommon::Error::Ok;
     if(res != Error_Ok)
     {
@@ -87,7 +83,18 @@ const char* CmdComputeRawData(
 
     jsonError.SetOption(RETURN_ITEM_OPTION_ERROR_DESC, GetErrorMessage(res));
 
-    RETURN(jsonError.GetJsonCode());
+    return jsonError.GetJsonCode();
+}
+
+const char* CmdComputeRawData(
+        int16* inputData,
+        Pipeline_RawDataParam* param,
+        Pipeline_ResultRawDataParam &resultParam)
+{
+    Error_t res;
+    res = Compute::ComputeRawData(inputData, param, resultParam);
+
+    RETURN(_GetJsonResult(res));
 }
 
 const char* CmdComputeKLibData(
@@ -99,15 +106,44 @@ const char* CmdComputeKLibData(
     Error_t res;
     res = Compute::ComputeKLibData(inputData, param, calibration, klibData);
 
-    ClassCommon::Error eError = ClassCommon::Error::Ok;
-    if(res != Error_Ok)
-    {
-        eError = ClassCommon::Error::Failed;
-    }
+    RETURN(_GetJsonResult(res));
+}
 
-    ToolErrorCode jsonError = ToolErrorCode(eError);
+PipelineContext_t PipelineCreateContext()
+{
+    return (PipelineContext_t)Compute::CreateContext();
+}
 
-    jsonError.SetOption(RETURN_ITEM_OPTION_ERROR_DESC, GetErrorMessage(res));
+void PipelineDestroyContext(PipelineContext_t context)
+{
+    Compute::DestroyContext((Compute*)context);
+}
+
+const char* CmdComputeRawDataContext(
+        PipelineContext_t context,
+        int16* inputData,
+        Pipeline_RawDataParam* param,
+        Pipeline_ResultRawDataParam &resultParam)
+{
+    Compute* instance = Compute::GetContext((Compute*)context);
+
+    Error_t res;
+    res = Compute::ComputeRawData(instance, inputData, param, resultParam);
+
+    return instance->SetReturn(_GetJsonResult(res).toStdString());
+}
+
+const char* CmdComputeKLibDataContext(
+        PipelineContext_t context,
+        int16* inputData,
+        Pipeline_KLibDataParam &param,
+        Pipeline_CalibrationParam *calibration,
+        int16* klibData)
+{
+    Compute* instance = Compute::GetContext((Compute*)context);
+
+    Error_t res;
+    res = Compute::ComputeKLibData(instance, inputData, param, calibration, klibData);
 
-    RETURN(jsonError.GetJsonCode());
+    return instance->SetReturn(_GetJsonResult(res).toStdString());
 }
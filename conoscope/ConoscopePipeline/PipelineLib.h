@@ -11,4 +11,12 @@ extern "C" PIPELINELIBSHARED_EXPORT const char* CmdGetVersion();
 extern "C" PIPELINELIBSHARED_EXPORT const char *CmdComputeRawData(int16 *inputData, Pipeline_RawDataParam* param, Pipeline_ResultRawDataParam &resultParam);
 extern "C" PIPELINELIBSHARED_EXPORT const char *CmdComputeKLibData(int16* inputData, Pipeline_KLibDataParam &param, Pipeline_CalibrationParam *calibration, int16 *klibData);
 
+// reentrant API: each context has its own configuration, caches and buffers
+// a context must not be used by two threads at the same time
+// the returned message is valid until the next call with the same context
+extern "C" PIPELINELIBSHARED_EXPORT PipelineContext_t PipelineCreateContext();
+extern "C" PIPELINELIBSHARED_EXPORT void PipelineDestroyContext(PipelineContext_t context);
+extern "C" PIPELINELIBSHARED_EXPORT const char *CmdComputeRawDataContext(PipelineContext_t context, int16 *inputData, Pipeline_RawDataParam* param, Pipeline_ResultRawDataParam &resultParam);
+extern "C" PIPELINELIBSHARED_EXPORT const char *CmdComputeKLibDataContext(PipelineContext_t context, int16* inputData, Pipeline_KLibDataParam &param, Pipeline_CalibrationParam *calibration, int16 *klibData);
+
 #endif // PIPELINELIB_H
@@ -30,6 +30,13 @@ SOURCES += \
     Compute.cpp \
     Pipeline/PipelineCompute.cpp \
     Pipeline/PipelineDefectCorrector.cpp \
+    Pipeline/PipelineLinearizationCache.cpp \
+    Pipeline/PipelineGainMap.cpp \
+    Pipeline/PipelineRemap.cpp \
+    Pipeline/PipelineKernels.cpp \
+    Pipeline/PipelineKernelsScalar.cpp \
+    Pipeline/PipelineKernelsSse41.cpp \
+    Pipeline/PipelineKernelsAvx2.cpp \
     Tools/toolErrorCode.cpp \
     Tools/classcommon.cpp \
     Tools/toolString.cpp
@@ -45,6 +52,11 @@ HEADERS += \
     Pipeline/defines.h \
     Pipeline/PipelineCompute.h \
     Pipeline/PipelineDefectCorrector.h \
+    Pipeline/PipelineLinearizationCache.h \
+    Pipeline/PipelineGainMap.h \
+    Pipeline/PipelineRemap.h \
+    Pipeline/PipelineHash.h \
+    Pipeline/PipelineKernels.h \
     Pipeline/PipelineComputeTypes.h \
     Pipeline/PipelineDefines.h \
     Tools/toolErrorCode.h \
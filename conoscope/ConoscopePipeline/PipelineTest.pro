@@ -0,0 +1,55 @@
+#-------------------------------------------------
+#
+# PipelineLib tests
+# the pipeline sources under test are built in the executable
+#
+#-------------------------------------------------
+
+QT       -= gui
+QT       += core
+
+TARGET = PipelineTest
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+DEFINES += AE_MEAS_AREA
+
+SOURCES += \
+    Test/main.cpp \
+    Test/testKernels.cpp \
+    Test/testRemap.cpp \
+    Test/testImageConfiguration.cpp \
+    Pipeline/PipelineCompute.cpp \
+    Pipeline/PipelineDefectCorrector.cpp \
+    Pipeline/PipelineLinearizationCache.cpp \
+    Pipeline/PipelineGainMap.cpp \
+    Pipeline/PipelineRemap.cpp \
+    Pipeline/PipelineKernels.cpp \
+    Pipeline/PipelineKernelsScalar.cpp \
+    Pipeline/PipelineKernelsSse41.cpp \
+    Pipeline/PipelineKernelsAvx2.cpp
+
+HEADERS += \
+    Test/test.h \
+    Pipeline/Types.h \
+    Pipeline/defines.h \
+    Pipeline/logger.h \
+    Pipeline/imageConfiguration.h \
+    Pipeline/PipelineCompute.h \
+    Pipeline/PipelineDefectCorrector.h \
+    Pipeline/PipelineLinearizationCache.h \
+    Pipeline/PipelineGainMap.h \
+    Pipeline/PipelineRemap.h \
+    Pipeline/PipelineHash.h \
+    Pipeline/PipelineKernels.h \
+    Pipeline/PipelineComputeTypes.h \
+    Pipeline/PipelineDefines.h \
+    Pipeline/PipelineHistogram.h \
+    PipelineTypes.h
+
+INCLUDEPATH += './'
+INCLUDEPATH += './Pipeline'
@@ -10,6 +10,9 @@
 
 #define SQUARE(Value) ((Value)*(Value))
 
+// handle of a pipeline context (see PipelineCreateContext)
+typedef void* PipelineContext_t;
+
 class ImageSize
 {
 public:
@@ -374,9 +377,13 @@ public:
     float                         conversionFactor_Value;
     SensorTemperature             conversionFactor_SensorTemperature;
 
+    // identify the flat field (camera, iris, filter, nd) so its gain map can be reused
+    // 0 means the gain map is computed for each call
+    uint64                        gainMapId;
+
     Pipeline_CalibrationParam()
     {
-
+        gainMapId = 0;
     }
 
     Pipeline_CalibrationParam(const Pipeline_CalibrationParam& calib)
@@ -394,6 +401,8 @@ public:
 
         conversionFactor_Value              = calib.conversionFactor_Value;
         conversionFactor_SensorTemperature  = calib.conversionFactor_SensorTemperature;
+
+        gainMapId                           = calib.gainMapId;
     }
 };
 
@@ -428,6 +437,9 @@ public:
     float                            prnuScaleFactor;
     bool                             prnuCorrectionEnabled;
     std::vector<char>*               prnuData;
+    // identify the PRNU calibration (camera) so its gain map can be reused
+    // 0 means the gain map is computed for each call
+    uint64                           gainMapId;
 
     Pipeline_RawDataParam()
     {
@@ -441,6 +453,7 @@ public:
         prnuEnable = false;
         prnuScaleFactor = 0;
         prnuCorrectionEnabled = false;
+        gainMapId = 0;
     }
 };
 
@@ -0,0 +1,20 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// a test stops at the first check which fails, the check is written on the error output
+#define TEST_CHECK(condition) \
+    if(!(condition)) \
+    { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return false; \
+    }
+
+bool TestKernels();
+
+bool TestRemap();
+
+bool TestImageConfiguration();
+
+#endif // TEST_H
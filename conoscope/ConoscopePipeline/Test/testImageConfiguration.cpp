@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include "PipelineCompute.h"
+
+#include <vector>
+
+// smaller than the sensor (IMAGE_WIDTH x IMAGE_HEIGHT)
+#define TEST_WIDTH  640
+#define TEST_HEIGHT 480
+
+class PipelineComputeTest
+{
+public:
+    static bool SetImageConfiguration();
+
+private:
+    // the geometry is the one of the frame
+    static bool _CheckGeometry(const ImageConfiguration& configuration, const ImageSize& size);
+
+    // linearization tables and compiled defect list of the current geometry
+    static void _Fill(PipelineCompute& compute, const ImageSize& size, uint64 key);
+};
+
+bool PipelineComputeTest::_CheckGeometry(const ImageConfiguration& configuration, const ImageSize& size)
+{
+    TEST_CHECK(configuration.image_width  == size.width);
+    TEST_CHECK(configuration.image_height == size.height);
+    TEST_CHECK(configuration.active_horizontal_offset == 0);
+    TEST_CHECK(configuration.active_vertical_offset   == 0);
+    TEST_CHECK(configuration.active_width  == size.width);
+    TEST_CHECK(configuration.active_height == size.height);
+
+    return true;
+}
+
+void PipelineComputeTest::_Fill(PipelineCompute& compute, const ImageSize& size, uint64 key)
+{
+    compute.m_LinearizationCache.Add(key, new PipelineRemap());
+
+    std::vector<Defect> defects(1);
+    defects[0].coord.x = 10;
+    defects[0].coord.y = 10;
+
+    std::vector<int16> rawData(size.width * size.height, 100);
+
+    compute.m_DefectCorrector.Correct(rawData.data(), size, &defects);
+}
+
+bool PipelineComputeTest::SetImageConfiguration()
+{
+    PipelineCompute compute;
+
+    ImageConfiguration reference;
+    compute.SetImageConfiguration(reference);
+
+    ImageSize size(TEST_WIDTH, TEST_HEIGHT);
+
+    compute._SetImageConfiguration(size);
+
+    if(_CheckGeometry(compute.m_ImageConfiguration, size) == false)
+    {
+        return false;
+    }
+
+    const uint64 key = 1;
+
+    _Fill(compute, size, key);
+
+    TEST_CHECK(compute.m_DefectCorrector.IsCompiled() == true);
+
+    // the same frame size again: the geometry and the caches are kept
+    for(int call = 0; call < 3; call ++)
+    {
+        compute._SetImageConfiguration(size);
+
+        if(_CheckGeometry(compute.m_ImageConfiguration, size) == false)
+        {
+            return false;
+        }
+
+        TEST_CHECK(compute.m_LinearizationCache.Get(key) != NULL);
+        TEST_CHECK(compute.m_DefectCorrector.IsCompiled() == true);
+    }
+
+    // the sensor size: back to the reference, the caches of the other geometry are dropped
+    ImageSize sensorSize(reference.image_width, reference.image_height);
+
+    compute._SetImageConfiguration(sensorSize);
+
+    TEST_CHECK(compute.m_ImageConfiguration.image_width  == reference.image_width);
+    TEST_CHECK(compute.m_ImageConfiguration.image_height == reference.image_height);
+    TEST_CHECK(compute.m_ImageConfiguration.active_horizontal_offset == reference.active_horizontal_offset);
+    TEST_CHECK(compute.m_ImageConfiguration.active_width == reference.active_width);
+
+    TEST_CHECK(compute.m_LinearizationCache.Get(key) == NULL);
+    TEST_CHECK(compute.m_DefectCorrector.IsCompiled() == false);
+
+    // and the reference again is kept as well
+    _Fill(compute, sensorSize, key);
+
+    compute._SetImageConfiguration(sensorSize);
+
+    TEST_CHECK(compute.m_ImageConfiguration.image_width == reference.image_width);
+    TEST_CHECK(compute.m_LinearizationCache.Get(key) != NULL);
+    TEST_CHECK(compute.m_DefectCorrector.IsCompiled() == true);
+
+    return true;
+}
+
+bool TestImageConfiguration()
+{
+    return PipelineComputeTest::SetImageConfiguration();
+}
@@ -0,0 +1,216 @@
+#include "test.h"
+
+#include "PipelineKernels.h"
+
+#include <vector>
+#include <random>
+#include <string.h>
+
+// lengths around the vector sizes (8 and 16 pixels) and tails shorter than a vector
+static const int counts[] = {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 23, 24, 31, 32, 33, 63, 64, 65, 127, 1021, 1024, 1029};
+
+#define TEST_MAX_COUNT 1029
+
+// pixels after count, they must not be written
+#define TEST_GUARD 32
+
+#define TEST_SENTINEL ((int16)0x5A5A)
+
+// remap source image
+#define TEST_SOURCE_WIDTH  37
+#define TEST_SOURCE_HEIGHT 29
+
+typedef struct
+{
+    std::vector<int16> a;
+    std::vector<int16> b;
+    std::vector<int16> source;
+    std::vector<float> gain;
+    std::vector<float> values;
+    std::vector<int32> coordinates;
+} KernelInput_t;
+
+// limits of int16, saturated 12 bits pixels and random values
+static int16 _Pixel(std::mt19937& random)
+{
+    switch(random() % 8)
+    {
+    case 0:  return INT16_MIN;
+    case 1:  return INT16_MAX;
+    case 2:  return 0;
+    case 3:  return 4095;
+    case 4:
+    case 5:  return (int16)(random() & 0xFFF);
+    default: return (int16)random();
+    }
+}
+
+// gains of the prnu and flat field, with products falling on .5 and out of the int16 range
+static float _Gain(std::mt19937& random)
+{
+    switch(random() % 6)
+    {
+    case 0:  return 0.5f;
+    case 1:  return 1.5f;
+    case 2:  return 1.0f;
+    case 3:  return 3.0f;
+    default: return std::uniform_real_distribution<float>(0.0f, 2.0f)(random);
+    }
+}
+
+// truncation of negative values, fractions close to 1 and values wrapped by the int16 cast
+static float _Float(std::mt19937& random)
+{
+    switch(random() % 6)
+    {
+    case 0:  return -0.5f;
+    case 1:  return 32767.99f;
+    case 2:  return -32768.0f;
+    case 3:  return std::uniform_real_distribution<float>(-70000.0f, 70000.0f)(random);
+    default: return std::uniform_real_distribution<float>(-4096.0f, 4096.0f)(random);
+    }
+}
+
+// 16.16 coordinates inside the source, on the pixels and just before the next one
+static int32 _Coordinate(std::mt19937& random, int size)
+{
+    int32 position = (int32)(random() % (size - 1)) << REMAP_FRACTION_BITS;
+
+    switch(random() % 4)
+    {
+    case 0:  return position;
+    case 1:  return position + 0xFFFF;
+    default: return position + (int32)(random() & 0xFFFF);
+    }
+}
+
+static void _Generate(KernelInput_t& input, std::mt19937& random)
+{
+    int size = TEST_MAX_COUNT + TEST_GUARD;
+
+    input.a.resize(size);
+    input.b.resize(size);
+    input.gain.resize(size);
+    input.values.resize(size);
+    input.coordinates.resize(2 * size);
+    input.source.resize(TEST_SOURCE_WIDTH * TEST_SOURCE_HEIGHT);
+
+    for(int index = 0; index < size; index ++)
+    {
+        input.a[index]      = _Pixel(random);
+        input.b[index]      = _Pixel(random);
+        input.gain[index]   = _Gain(random);
+        input.values[index] = _Float(random);
+
+        input.coordinates[2 * index]     = _Coordinate(random, TEST_SOURCE_WIDTH);
+        input.coordinates[2 * index + 1] = _Coordinate(random, TEST_SOURCE_HEIGHT);
+    }
+
+    for(int index = 0; index < (int)input.source.size(); index ++)
+    {
+        input.source[index] = _Pixel(random);
+    }
+}
+
+// the output (and the guard after it) is identical to the scalar one
+#define TEST_OUTPUT(type, call) \
+    { \
+        std::vector<type> expected(count + TEST_GUARD, (type)TEST_SENTINEL); \
+        std::vector<type> result(count + TEST_GUARD, (type)TEST_SENTINEL); \
+        { const Kernels_t& kernels = scalar; type* dst = expected.data(); call; } \
+        { const Kernels_t& kernels = tested; type* dst = result.data(); call; } \
+        TEST_CHECK(memcmp(expected.data(), result.data(), expected.size() * sizeof(type)) == 0); \
+    }
+
+// first pixel at offset, so the loads are not aligned
+static bool _CheckKernels(const Kernels_t& scalar, const Kernels_t& tested, const KernelInput_t& input, int count, int offset)
+{
+    const int16* a      = &input.a[offset];
+    const int16* b      = &input.b[offset];
+    const float* gain   = &input.gain[offset];
+    const float* values = &input.values[offset];
+    const int32* coordinates = &input.coordinates[2 * offset];
+
+    TEST_OUTPUT(int16, kernels.SubtractValue(dst, a, 4095, count));
+    TEST_OUTPUT(int16, kernels.SubtractValue(dst, a, -1000, count));
+    TEST_OUTPUT(int16, kernels.Subtract(dst, a, b, count));
+    TEST_OUTPUT(int16, kernels.SubtractSaturate(dst, a, b, count));
+    TEST_OUTPUT(int16, kernels.ScaleRound(dst, a, gain, count));
+    TEST_OUTPUT(int16, kernels.Clamp(dst, a, 0, 4095, count));
+    TEST_OUTPUT(int16, kernels.Clamp(dst, a, INT16_MIN, INT16_MAX, count));
+    TEST_OUTPUT(float, kernels.Int16ToFloat(dst, a, count));
+    TEST_OUTPUT(int16, kernels.FloatToInt16(dst, values, count));
+    TEST_OUTPUT(int16, kernels.RemapBilinear(dst, input.source.data(), TEST_SOURCE_WIDTH, coordinates, gain, INT16_MAX, count));
+    TEST_OUTPUT(int16, kernels.RemapBilinear(dst, input.source.data(), TEST_SOURCE_WIDTH, coordinates, gain, 4095, count));
+
+    // in place (the pipeline scales and subtracts in the raw data)
+    {
+        std::vector<int16> expected(a, a + count);
+        std::vector<int16> result(a, a + count);
+
+        scalar.ScaleRound(expected.data(), expected.data(), gain, count);
+        tested.ScaleRound(result.data(), result.data(), gain, count);
+
+        TEST_CHECK(expected == result);
+
+        scalar.SubtractValue(expected.data(), expected.data(), 64, count);
+        tested.SubtractValue(result.data(), result.data(), 64, count);
+
+        TEST_CHECK(expected == result);
+    }
+
+    int16 expectedMin = 0, expectedMax = 0, resultMin = 0, resultMax = 0;
+
+    scalar.MinMax(a, count, &expectedMin, &expectedMax);
+    tested.MinMax(a, count, &resultMin, &resultMax);
+
+    TEST_CHECK(expectedMin == resultMin);
+    TEST_CHECK(expectedMax == resultMax);
+
+    TEST_CHECK(scalar.MaxUnsigned(a, count) == tested.MaxUnsigned(a, count));
+    TEST_CHECK(scalar.Sum(a, count) == tested.Sum(a, count));
+
+    return true;
+}
+
+bool TestKernels()
+{
+    const Kernels_t& scalar = PipelineKernels::Get(KernelIsa_Scalar);
+
+    std::mt19937 random(1);
+
+    for(int isa = KernelIsa_Scalar + 1; isa < KernelIsa_Count; isa ++)
+    {
+        KernelIsa_t eIsa = (KernelIsa_t)isa;
+
+        if(PipelineKernels::IsSupported(eIsa) == false)
+        {
+            printf("  %s not supported by this cpu\n", PipelineKernels::GetIsaName(eIsa));
+            continue;
+        }
+
+        const Kernels_t& tested = PipelineKernels::Get(eIsa);
+
+        for(int repeat = 0; repeat < 8; repeat ++)
+        {
+            KernelInput_t input;
+
+            _Generate(input, random);
+
+            for(int count : counts)
+            {
+                for(int offset = 0; offset < 2; offset ++)
+                {
+                    if((count + offset <= TEST_MAX_COUNT) &&
+                       (_CheckKernels(scalar, tested, input, count, offset) == false))
+                    {
+                        fprintf(stderr, "%s count %d offset %d\n", PipelineKernels::GetIsaName(eIsa), count, offset);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
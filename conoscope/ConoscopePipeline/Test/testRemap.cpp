@@ -0,0 +1,188 @@
+#include "test.h"
+
+#include "PipelineRemap.h"
+#include "PipelineKernels.h"
+#include "defines.h"
+
+#include <vector>
+#include <random>
+#include <math.h>
+
+// output disk (wider than a tile: REMAP_TILE_WIDTH x REMAP_TILE_HEIGHT)
+#define TEST_RADIUS 550
+#define TEST_OUTPUT_SIZE (2 * TEST_RADIUS + 1)
+
+// the disk is mapped on the whole source, up to its last pixels
+#define TEST_SOURCE_SIZE 1104
+
+// linearization tables like PrecomputeLinearizationTables: a radial correction
+// around the optical axis, the pixels after the radius limit are not used
+static void _BuildTables(std::vector<precomputedData_t>& tables)
+{
+    const long  lAxis  = TEST_RADIUS;
+    const float center = (TEST_SOURCE_SIZE - 1) / 2.0f;
+    const float fB0    = 0.9f;
+    const float fB2    = 0.1024f / (TEST_RADIUS * TEST_RADIUS);
+
+    long lMaximumRadiusSquare = TEST_RADIUS * TEST_RADIUS;
+
+    tables.assign(TEST_OUTPUT_SIZE * TEST_OUTPUT_SIZE, precomputedData_t());
+
+    for(long lRow = 0; lRow < TEST_OUTPUT_SIZE; lRow ++)
+    {
+        for(long lColumn = 0; lColumn < TEST_OUTPUT_SIZE; lColumn ++)
+        {
+            precomputedData_t& data = tables[lRow * TEST_OUTPUT_SIZE + lColumn];
+
+            long lRadiusSquare = (lRow - lAxis) * (lRow - lAxis) + (lColumn - lAxis) * (lColumn - lAxis);
+
+            data.linearizationRadius = (lRadiusSquare <= (lMaximumRadiusSquare + 1));
+
+            if(data.linearizationRadius)
+            {
+                float fCorrection = fB0 + lRadiusSquare * fB2;
+
+                data.linearizationTableY = center + fCorrection * (lRow    - lAxis);
+                data.linearizationTableX = center + fCorrection * (lColumn - lAxis);
+            }
+        }
+    }
+}
+
+// smooth 12 bits image with noise, saturated pixels and a saturated border
+static void _BuildSource(std::vector<int16>& source, std::mt19937& random)
+{
+    source.resize(TEST_SOURCE_SIZE * TEST_SOURCE_SIZE);
+
+    for(int row = 0; row < TEST_SOURCE_SIZE; row ++)
+    {
+        for(int column = 0; column < TEST_SOURCE_SIZE; column ++)
+        {
+            int value = 300 + (row * 7 + column * 3) % 3000 + (int)(random() % 64);
+
+            if((row == 0) || (column == 0) || (row == TEST_SOURCE_SIZE - 1) || (column == TEST_SOURCE_SIZE - 1) ||
+               ((random() % 50) == 0))
+            {
+                value = 4095;
+            }
+
+            source[row * TEST_SOURCE_SIZE + column] = (int16)value;
+        }
+    }
+}
+
+// float bilinear interpolation used before the fixed point remap
+static int16 _FloatRemap(const precomputedData_t& data, const int16* pSource, long lSourceWidth, float gain, int16 maxValue)
+{
+    if(data.linearizationRadius == false)
+    {
+        return 0;
+    }
+
+    float fRow    = data.linearizationTableY;
+    float fColumn = data.linearizationTableX;
+
+    long lSourceRow    = (long)(fRow);
+    long lSourceColumn = (long)(fColumn);
+    float fAlpha = fRow    - lSourceRow;
+    float fBeta  = fColumn - lSourceColumn;
+
+    const int16* psPixel = pSource + lSourceWidth * lSourceRow + lSourceColumn;
+    float fPixel = (1 - fBeta) * psPixel[0] + fBeta * psPixel[1];
+    psPixel = psPixel + lSourceWidth;
+    fPixel = (1 - fAlpha) * fPixel + fAlpha * ((1 - fBeta) * psPixel[0] + fBeta * psPixel[1]);
+
+    double dPixel = (double)fPixel * gain;
+
+    return (dPixel < maxValue) ? (int16)dPixel : maxValue;
+}
+
+static bool _CheckRemap(const PipelineRemap& remap,
+                        const std::vector<precomputedData_t>& tables,
+                        const std::vector<int16>& source,
+                        const std::vector<float>& gain,
+                        int16 maxValue)
+{
+    std::vector<int16> target(TEST_OUTPUT_SIZE * TEST_OUTPUT_SIZE, -1);
+
+    remap.Apply(source.data(), TEST_SOURCE_SIZE, gain.data(), maxValue, target.data());
+
+    for(int index = 0; index < (int)target.size(); index ++)
+    {
+        int16 expected = _FloatRemap(tables[index], source.data(), TEST_SOURCE_SIZE, gain[index], maxValue);
+
+        if(abs(target[index] - expected) > ((tables[index].linearizationRadius == true) ? 1 : 0))
+        {
+            fprintf(stderr, "row %d column %d: %d instead of %d\n",
+                    index / TEST_OUTPUT_SIZE, index % TEST_OUTPUT_SIZE, target[index], expected);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TestRemap()
+{
+    std::mt19937 random(2);
+
+    std::vector<precomputedData_t> tables;
+    std::vector<int16> source;
+    std::vector<float> gain(TEST_OUTPUT_SIZE * TEST_OUTPUT_SIZE);
+
+    _BuildTables(tables);
+    _BuildSource(source, random);
+
+    for(int index = 0; index < (int)gain.size(); index ++)
+    {
+        gain[index] = std::uniform_real_distribution<float>(0.5f, 2.0f)(random);
+    }
+
+    // the tables read the whole source: pixels of the first and last columns and rows are interpolated
+    float minimum = TEST_SOURCE_SIZE;
+    float maximum = 0;
+
+    for(const precomputedData_t& data : tables)
+    {
+        if(data.linearizationRadius == true)
+        {
+            minimum = fminf(minimum, fminf(data.linearizationTableX, data.linearizationTableY));
+            maximum = fmaxf(maximum, fmaxf(data.linearizationTableX, data.linearizationTableY));
+        }
+    }
+
+    TEST_CHECK((minimum >= 0) && (minimum < 1));
+    TEST_CHECK((maximum >= TEST_SOURCE_SIZE - 2) && (maximum < TEST_SOURCE_SIZE - 1));
+
+    PipelineRemap remap;
+
+    remap.Build(tables.data(), TEST_OUTPUT_SIZE, TEST_OUTPUT_SIZE);
+
+    TEST_CHECK(remap.GetWidth() == TEST_OUTPUT_SIZE);
+    TEST_CHECK(remap.GetHeight() == TEST_OUTPUT_SIZE);
+
+    KernelIsa_t eDefaultIsa = PipelineKernels::GetIsa();
+
+    bool bSuccess = true;
+
+    for(int isa = KernelIsa_Scalar; (isa < KernelIsa_Count) && (bSuccess == true); isa ++)
+    {
+        if(PipelineKernels::Select((KernelIsa_t)isa) == false)
+        {
+            continue;
+        }
+
+        // limit of the pipeline and limit reached by the saturated pixels
+        bSuccess = (_CheckRemap(remap, tables, source, gain, SHORT_MAXIMUM) == true) &&
+                   (_CheckRemap(remap, tables, source, gain, 4095) == true);
+
+        if(bSuccess == false)
+        {
+            fprintf(stderr, "%s\n", PipelineKernels::GetIsaName((KernelIsa_t)isa));
+        }
+    }
+
+    PipelineKernels::Select(eDefaultIsa);
+
+    return bSuccess;
+}